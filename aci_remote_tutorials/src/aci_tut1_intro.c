@@ -69,7 +69,7 @@ void versions(struct ACI_INFO aciInfo) {
 	printf("* MAX_DESC_LENGTH\t%d\t=\t\%d\t*\n",aciInfo.maxDescLength,MAX_DESC_LENGTH);
 	printf("* MAX_NAME_LENGTH\t%d\t=\t\%d\t*\n",aciInfo.maxNameLength,MAX_NAME_LENGTH);
 	printf("* MAX_UNIT_LENGTH\t%d\t=\t\%d\t*\n",aciInfo.maxUnitLength,MAX_UNIT_LENGTH);
-	printf("* MAX_VAR_PACKETS\t%d\t=\t\%d\t*\n",aciInfo.maxVarPackets,MAX_VAR_PACKETS);
+	printf("* MAX_VAR_PACKETS\t%d\t<=\t\%d\t*\n",aciInfo.maxVarPackets,MAX_VAR_PACKETS);
 	printf("*************************************************\n");
 }
 
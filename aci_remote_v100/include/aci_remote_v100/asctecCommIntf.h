@@ -39,6 +39,16 @@ extern "C"
 #include <stdio.h>
 #include "asctecDefines.h"
 
+/// all state of one connection to a device, see \ref context
+typedef struct aci_context aci_context_t;
+
+/// one piece of a packet passed to the send segments callback, at most #ACI_TX_MAX_SEGMENTS per packet
+struct ACI_TX_SEGMENT
+{
+	const void * data;
+	unsigned short length;
+};
+
 
 
 /** Has to be called ones during initialisation
@@ -46,6 +56,19 @@ extern "C"
  * **/
 extern void aciInit(void);
 
+/**
+ * Lets the remote take all its memory (tables, packet lists and buffers) from a fixed arena instead of the heap. Has to be called before aciInit(), which starts every time with an empty arena.<br>
+ * Once the tables are loaded and the packets are configured, neither aciEngine() nor the receive handler allocate any memory, with or without an arena.
+ * @param arena memory for the remote, it has to stay valid as long as the remote is used. NULL goes back to malloc. Everything kept in a previous arena is dropped, so call aciInit() afterwards.
+ * @param size size of the arena in bytes. Use aciGetMemoryArenaPeak() after a full table download to find out, how much is needed.
+ */
+extern void aciSetMemoryArena(void * arena, size_t size);
+
+/**
+ * Returns the maximum number of arena bytes, which were in use at the same time since aciInit().
+ */
+extern size_t aciGetMemoryArenaPeak(void);
+
 /**
  * If you are not sure, if the version and configurations of the device is the same like the version of this SDK, you can check this with this function <br>
  *
@@ -59,6 +82,25 @@ extern void aciCheckVerConf(void);
 **/
 extern void aciReceiveHandler(unsigned char receivedByte);
 
+/** Same as aciReceiveHandler, but for a whole block of received bytes. Use this one if your uart rx function delivers more than one byte at a time, it is much faster than calling aciReceiveHandler for every byte.
+*   Both functions share the same decoder state, so they can be mixed.
+*   @param data received bytes from uart.
+*   @param length number of received bytes.
+*   @see aciReceiveHandler
+**/
+extern void aciReceiveBuffer(const unsigned char * data, size_t length);
+
+/** Same as aciReceiveBuffer, but also tells when the bytes were received. The frames completed in data get the time their last byte arrived,
+*   which is stored with the variable packets and passed to the timed var packet callback.
+*   @param data received bytes from uart.
+*   @param length number of received bytes.
+*   @param endTime time the last byte of data was received, in seconds of a clock of your choice. 0 if unknown
+*   @param byteTime time it takes to transmit one byte, i.e. 10 / baud rate for 8N1. 0 if the bytes arrived all at once
+*   @see aciGetVarPacketSnapshotTimed
+*   @see aciVarPacketReceivedTimedCallback
+**/
+extern void aciReceiveBufferTimed(const unsigned char * data, size_t length, double endTime, double byteTime);
+
 /**
  *  Has to be called a specified number of times per second. You have to set the rate for the Engine and the heartbeat in aciSetEngineRate().<br>
  *  It handles the transmission to the device and send also a signal, that inform the device, that the remote is still alive and able to send data. If too much data would come from the device and would use the whole bandwidth, it may happen, that the remote cannot send any data. With the signal of a heartbeat, the host is informed, that it could get data from the remote.<br>
@@ -72,6 +114,15 @@ extern void aciEngine(void);
  * **/
 extern void aciSetEngineRate(const unsigned short callsPerSecond, const unsigned short heartbeat);
 
+/** Set the number of variable, command and parameter table entries, which are requested at once while downloading the lists.
+ * The window is shared by the three lists. <br>
+ * Entries may arrive in any order, only missing ones are requested again after a timeout. The window is only used, if the device
+ * announces ACI_INFO_FLAG_QUEUED_TABLE_REQUESTS in its info packet (see aciCheckVerConf()), otherwise one entry is requested at a time.
+ * @param window 1 up to #ACI_LIST_REQUEST_WINDOW_MAX, default 4
+ * @return none
+ **/
+extern void aciSetListRequestWindow(unsigned char window);
+
 /** resets remote interface to a zero variable packet configuration **/
 extern void aciResetRemote(void);
 
@@ -104,6 +155,21 @@ extern void aciSendParamStore();
  */
 extern void aciSendParamLoad();
 
+/**
+ * Ask the device to switch its UART to baudrate. The device replies with ACI_BAUDRATE_SWITCHING on the current rate
+ * and switches right after, or with ACI_BAUDRATE_UNSUPPORTED (see aciSetBaudRateCallback()). Only devices which announce
+ * ACI_INFO_FLAG_BAUDRATE_SWITCH in their info packet know this request. <br>
+ * After ACI_BAUDRATE_SWITCHING, switch your port as well and call aciConfirmBaudRate(). The device goes back to the
+ * previous rate, if it does not receive the confirmation within 1s.
+ */
+extern void aciRequestBaudRate(unsigned int baudrate);
+
+/**
+ * Confirm the rate requested with aciRequestBaudRate() on the new rate. The device replies with ACI_BAUDRATE_CONFIRMED.
+ * Repeat it until the reply arrives, a repeated confirmation is answered again.
+ */
+extern void aciConfirmBaudRate(unsigned int baudrate);
+
 /**
  * Request the value of a parameter from the device. The content will be written in the assign variable for that parameter.
  * @param id The id of the parameter
@@ -258,6 +324,13 @@ unsigned short aciGetVarPacketRate(unsigned char packetId);
 /** Request the transmission rate of every variable package on the device. After receiving the data, you get it over aciGetVarPacketRate().**/
 void aciGetVarPacketRateFromDevice();
 
+/** Get the number of variable, command and parameter packets, which can be used with the device. The device announces it in its info packet
+ * (see aciCheckVerConf()), up to #MAX_VAR_PACKETS. Until then it is #ACI_DEFAULT_VAR_PACKETS.<br>
+ * Configurations of packets beyond that number are not sent.
+ * @return number of packets, the packet ids go from 0 to the number - 1
+ * **/
+unsigned char aciGetVarPacketCount(void);
+
 /** Adds content to packet. <br>
  * Call aciSendVariablePacketConfiguration() for changes to get effective
  * @param packetId Define the id of the packet, where the variable should be send. The first id is 0 and the numbers of packets is defined in #MAX_VAR_PACKETS (by default: 3)
@@ -303,9 +376,36 @@ extern void aciVarPacketUpdateTransmissionRates();
 /* assign local variable to ID. By calling aciSynchronizeVars() the most recent content get's copied to all assigned variables **/
 //extern unsigned char aciAssignVariableToId(void * ptrToVar, unsigned char varType, unsigned short id);
 
-/** By calling aciSynchronizeVars() the content of all requested variables in every package will be updated from the content in the receiving buffer. */
+/** By calling aciSynchronizeVars() the content of all requested variables in every package will be updated from the content in the receiving buffer.
+ * Only packets, which were received since the last call, are copied. The copy follows the decode plan built by aciSendVariablePacketConfiguration(),
+ * which merges variables lying next to each other in the packet and in memory into a single copy. */
 extern void aciSynchronizeVars(void);
 
+/** Decode received variable packets straight into the assigned variables instead of the receiving buffer. <br>
+ * The variables are then written from within aciReceiveHandler() and aciSynchronizeVars() has nothing left to do. Make sure, that nobody reads the variables while the receive handler runs.
+ * @param enable 1 to decode on reception, 0 to decode in aciSynchronizeVars() (default)
+ * @return none
+ **/
+extern void aciSetVarPacketDirectDecode(unsigned char enable);
+
+/** Take a consistent copy of the last received content of a variable packet without blocking the receive handler. <br>
+ * Every variable of the packet, whose assigned variable lies inside [base, base+size), is copied to the same offset in copy.
+ * Everything else in copy stays untouched. Pass e.g. the struct holding the assigned variables as base and a local struct of the same type as copy.
+ * The receive handler keeps two buffers per packet and a sequence counter, a reader only repeats the copy if a new packet arrived meanwhile.
+ * Do not call aciSendVariablePacketConfiguration() for the packet while other threads take snapshots of it.
+ * @param packetId The id of the packet
+ * @param base Start of the memory range of the assigned variables
+ * @param copy Start of the memory, where the copy is written to
+ * @param size Size of the memory range in bytes
+ * @return 1 if copy holds the content of a received packet, 0 if nothing was received since the last configuration
+ **/
+extern unsigned char aciGetVarPacketSnapshot(unsigned char packetId, const void * base, void * copy, unsigned int size);
+
+/** Same as aciGetVarPacketSnapshot, but also returns the time the copied packet was received.
+ * @param rxTime Receives the time passed to aciReceiveBufferTimed for the packet, 0 if unknown. May be NULL
+ **/
+extern unsigned char aciGetVarPacketSnapshotTimed(unsigned char packetId, const void * base, void * copy, unsigned int size, double * rxTime);
+
 
 /** Adds content to command packet. <br>
  * @param packetId Define the id of the packet, where the command should be received by the device. The first id is 0 and the numbers of packets is defined in #MAX_VAR_PACKETS (by default: 3).
@@ -353,6 +453,16 @@ extern void aciUpdateParamPacket(const unsigned short packetId);
  **/
 extern void aciSetSendDataCallback(void (*aciSendDataCallback_func)(void * data, unsigned short cnt));
 
+/**
+ * \ingroup callbacks
+ * Set send segments callback.<br>
+ * Like the send data callback, but the packet is not copied into one buffer before. The callback gets the pieces of the packet in order: the header, the
+ * payload in one or more segments and the CRC. Command and parameter packets point directly to the variables of the packet, so the callback has to copy
+ * or send the segments before it returns. If this callback is set, the send data callback is not called.
+ * @see ACI_TX_SEGMENT
+ **/
+extern void aciSetSendSegmentsCallback(void (*aciSendSegmentsCallback_func)(const struct ACI_TX_SEGMENT * segments, unsigned char count));
+
 /**
  * \ingroup callbacks
  * Set variable list update finished callback. <br>
@@ -395,6 +505,13 @@ extern void aciInfoPacketReceivedCallback(void (*aciInfoRec_func)(struct ACI_INF
  **/
 extern void aciVarPacketReceivedCallback(void (*aciVarPacketRec_func)(unsigned char));
 
+/**
+ * \ingroup callbacks
+ * Set timed variable packet received callback. <br>
+ * Same as aciVarPacketReceivedCallback, the second parameter is the time the packet was received, see aciReceiveBufferTimed().
+ **/
+extern void aciVarPacketReceivedTimedCallback(void (*aciVarPacketRec_func)(unsigned char, double));
+
 /**
  * \ingroup callbacks
  * Set parameter saved callback. <br>
@@ -408,6 +525,13 @@ extern void aciParPacketStoredCallback(void (*aciParPacketStored_func)(void));
  **/
 extern void aciParPacketLoadedCallback(void (*aciParPacketLoaded_func)(void));
 
+/**
+ * \ingroup callbacks
+ * Set baud rate callback. <br>
+ * The callback is called with the rate and the status of each reply to aciRequestBaudRate() and aciConfirmBaudRate().
+ **/
+extern void aciSetBaudRateCallback(void (*aciBaudRate_func)(unsigned int baudrate, unsigned char status));
+
 /**
  * \ingroup callbacks
  * Set the callback, that will be executed after receiving a single variable from the device. A single variable is a variable, that will be send instantly from the device to the remote. It is useful, if you want to commit a status update. The sending id depends on none of the ids in any list and is individual set by the user.
@@ -494,6 +618,32 @@ struct __attribute__((packed)) ACI_INFO
 	unsigned short dummy[8];
 };
 
+///payload of ACIMT_SETBAUDRATE, ACIMT_CONFIRMBAUDRATE and ACIMT_BAUDRATE
+struct __attribute__((packed)) ACI_BAUDRATE
+{
+	unsigned int baudrate;
+	unsigned char status;
+};
+
+///counters of a context since aciCtxCreate(), see aciCtxGetLinkStats(). aciCtxInit() does not reset them
+struct ACI_LINK_STATS
+{
+	///frames which passed the CRC check
+	unsigned long framesReceived;
+	///frames dropped because of a wrong CRC
+	unsigned long crcErrors;
+	///var packets which matched their configuration, per packet
+	unsigned long varPacketsReceived[MAX_VAR_PACKETS];
+	///var packets dropped because magic code or length did not match the configuration, per packet
+	unsigned long varPacketsInvalid[MAX_VAR_PACKETS];
+	///packet configurations sent again, because the device did not acknowledge them
+	unsigned long varConfigResends;
+	unsigned long cmdConfigResends;
+	unsigned long paramConfigResends;
+	///command packets sent again, because the device did not acknowledge them
+	unsigned long cmdPacketResends;
+};
+
 struct __attribute__((packed)) ACI_MEM_VAR_ASSIGN_TABLE
 {
 	void * ptrToVar;
@@ -502,14 +652,145 @@ struct __attribute__((packed)) ACI_MEM_VAR_ASSIGN_TABLE
 	struct ACI_MEM_VAR_ASSIGN_TABLE * next;
 };
 
-extern struct ACI_MEM_VAR_TABLE * aciMemVarTableStart;
-extern struct ACI_MEM_VAR_TABLE * aciMemVarTableCurrent;
+/**
+ * The table lists of the default context. They replace the former globals aciMemVarTableStart, aciMemVarTableCurrent and so on, which moved into the
+ * context. Current is only a cursor of the last walk through a list.
+ * @deprecated Use aciGetVariableItemByIndex(), aciGetCommandItemByIndex() and aciGetParameterItemByIndex() or their Ctx versions.
+ */
+extern struct ACI_MEM_VAR_TABLE * aciGetMemVarTableStart(void) __attribute__((deprecated));
+extern struct ACI_MEM_VAR_TABLE * aciGetMemVarTableCurrent(void) __attribute__((deprecated));
+extern struct ACI_MEM_VAR_TABLE * aciGetMemCmdTableStart(void) __attribute__((deprecated));
+extern struct ACI_MEM_VAR_TABLE * aciGetMemCmdTableCurrent(void) __attribute__((deprecated));
+extern struct ACI_MEM_VAR_TABLE * aciGetMemParamTableStart(void) __attribute__((deprecated));
+extern struct ACI_MEM_VAR_TABLE * aciGetMemParamTableCurrent(void) __attribute__((deprecated));
+
+/**
+ * \defgroup context Context API
+ * \brief Functions for talking to more than one device from one process.
+ *
+ * All state of a connection lives in an ::aci_context_t. Every function of the API has a context version with Ctx in its name, which does the same
+ * as the function without Ctx, but works on the given context. The functions without context use a default context, see aciGetDefaultContext().<br>
+ * The callbacks of a context get the pointer set with aciCtxSetUserData() as first argument, i.e. the object which owns the connection.
+ * Different contexts can be used from different threads, one context has to be used by one thread at a time.
+ */
+
+/**
+ * \ingroup context
+ * Creates a new context with the same defaults like the default context. Call aciCtxInit() on it, before using it.
+ * @return the new context or NULL, if there is no memory.
+ */
+extern aci_context_t * aciCtxCreate(void);
+
+/**
+ * \ingroup context
+ * Frees a context created with aciCtxCreate() and all memory of its tables and packets.
+ */
+extern void aciCtxDestroy(aci_context_t * ctx);
+
+/**
+ * \ingroup context
+ * Returns the context used by all functions without Ctx in the name.
+ */
+extern aci_context_t * aciGetDefaultContext(void);
 
-extern struct ACI_MEM_VAR_TABLE * aciMemCmdTableStart;
-extern struct ACI_MEM_VAR_TABLE * aciMemCmdTableCurrent;
+/**
+ * \ingroup context
+ * Sets the pointer, which every callback of the context gets as first argument.
+ */
+extern void aciCtxSetUserData(aci_context_t * ctx, void * userData);
 
-extern struct ACI_MEM_VAR_TABLE * aciMemParamTableStart;
-extern struct ACI_MEM_VAR_TABLE * aciMemParamTableCurrent;
+/**
+ * \ingroup context
+ * Returns the pointer set with aciCtxSetUserData().
+ */
+extern void * aciCtxGetUserData(aci_context_t * ctx);
+
+extern void aciCtxCheckVerConf(aci_context_t * ctx);
+extern void aciCtxInit(aci_context_t * ctx);
+extern void aciCtxResetRemote(aci_context_t * ctx);
+extern void aciCtxEngine(aci_context_t * ctx);
+extern void aciCtxSetEngineRate(aci_context_t * ctx, const unsigned short callsPerSecond, const unsigned short heartbeat);
+extern void aciCtxSetListRequestWindow(aci_context_t * ctx, unsigned char window);
+extern void aciCtxResetVarPacketContent(aci_context_t * ctx, unsigned char packetId);
+extern void aciCtxResetCmdPacketContent(aci_context_t * ctx, unsigned char packetId);
+extern void aciCtxResetParPacketContent(aci_context_t * ctx, unsigned char packetId);
+extern unsigned short aciCtxGetVarPacketLength(aci_context_t * ctx, unsigned char packetId);
+extern unsigned short aciCtxGetCmdPacketLength(aci_context_t * ctx, unsigned char packetId);
+extern unsigned short aciCtxGetParPacketLength(aci_context_t * ctx, unsigned char packetId);
+extern unsigned short aciCtxGetVarPacketItem(aci_context_t * ctx, unsigned char packetId, unsigned short index);
+extern unsigned short aciCtxGetCmdPacketItem(aci_context_t * ctx, unsigned char packetId, unsigned short index);
+extern unsigned short aciCtxGetParPacketItem(aci_context_t * ctx, unsigned char packetId, unsigned short index);
+extern unsigned short aciCtxGetVarPacketRate(aci_context_t * ctx, unsigned char packetId);
+extern unsigned char aciCtxGetVarPacketCount(aci_context_t * ctx);
+extern void aciCtxGetVarPacketRateFromDevice(aci_context_t * ctx);
+extern void aciCtxAddContentToVarPacket(aci_context_t * ctx, unsigned char packetId, unsigned short id, void *var_ptr);
+extern void aciCtxAddContentToCmdPacket(aci_context_t * ctx, const unsigned char packetId, const unsigned short id, void *var_ptr);
+extern void aciCtxAddContentToParamPacket(aci_context_t * ctx, unsigned char packetId, unsigned short id, void *var_ptr);
+extern void aciCtxSetVarPacketTransmissionRate(aci_context_t * ctx, unsigned char packetId, unsigned short callsPerSecond);
+extern void aciCtxVarPacketUpdateTransmissionRates(aci_context_t * ctx);
+extern char aciCtxGetVarById(aci_context_t * ctx, void * ptrToVar, const unsigned char varType, const unsigned short id);
+extern void aciCtxSynchronizeVars(aci_context_t * ctx);
+extern void aciCtxSetVarPacketDirectDecode(aci_context_t * ctx, unsigned char enable);
+extern unsigned char aciCtxGetVarPacketSnapshot(aci_context_t * ctx, unsigned char packetId, const void * base, void * copy, unsigned int size);
+extern unsigned char aciCtxGetVarPacketSnapshotTimed(aci_context_t * ctx, unsigned char packetId, const void * base, void * copy, unsigned int size, double * rxTime);
+extern void aciCtxSendVariablePacketConfiguration(aci_context_t * ctx, unsigned char packetId);
+extern void aciCtxSendCommandPacketConfiguration(aci_context_t * ctx, unsigned char packetId, unsigned char with_ack);
+extern void aciCtxSendParameterPacketConfiguration(aci_context_t * ctx, unsigned char packetId);
+extern void aciCtxSetVarListUpdateFinishedCallback(aci_context_t * ctx, void (*aciVarListUpdateFinished_func)(void * userData));
+extern void aciCtxSetCmdListUpdateFinishedCallback(aci_context_t * ctx, void (*aciCmdListUpdateFinished_func)(void * userData));
+extern void aciCtxSetParamListUpdateFinishedCallback(aci_context_t * ctx, void (*aciParamListUpdateFinished_func)(void * userData));
+extern void aciCtxSetCmdAckCallback(aci_context_t * ctx, void (*aciCmdAck_func)(void * userData, unsigned char packet));
+extern void aciCtxInfoPacketReceivedCallback(aci_context_t * ctx, void (*aciInfoRec_func)(void * userData, struct ACI_INFO));
+extern void aciCtxVarPacketReceivedCallback(aci_context_t * ctx, void (*aciVarPacketRec_func)(void * userData, unsigned char packet));
+extern void aciCtxVarPacketReceivedTimedCallback(aci_context_t * ctx, void (*aciVarPacketRec_func)(void * userData, unsigned char packet, double rxTime));
+extern void aciCtxParPacketStoredCallback(aci_context_t * ctx, void (*aciParPacketStored_func)(void * userData));
+extern void aciCtxParPacketLoadedCallback(aci_context_t * ctx, void (*aciParPacketLoaded_func)(void * userData));
+extern void aciCtxGetDeviceVariablesList(aci_context_t * ctx);
+extern void aciCtxGetDeviceCommandsList(aci_context_t * ctx);
+extern void aciCtxGetDeviceParametersList(aci_context_t * ctx);
+extern void aciCtxForceListRequestFromDevice(aci_context_t * ctx);
+extern void aciCtxGetParamFromDevice(aci_context_t * ctx, unsigned short id);
+extern struct ACI_MEM_TABLE_ENTRY *aciCtxGetVariableItemByIndex(aci_context_t * ctx, unsigned short index);
+extern struct ACI_MEM_TABLE_ENTRY *aciCtxGetVariableItemById(aci_context_t * ctx, unsigned short id);
+extern struct ACI_MEM_TABLE_ENTRY *aciCtxGetVariableItemByName(aci_context_t * ctx, char * name);
+extern unsigned short aciCtxGetVarTableLength(aci_context_t * ctx);
+extern struct ACI_INFO aciCtxGetInfo(aci_context_t * ctx);
+extern struct ACI_MEM_TABLE_ENTRY *aciCtxGetParameterItemByIndex(aci_context_t * ctx, unsigned short index);
+extern struct ACI_MEM_TABLE_ENTRY *aciCtxGetParameterItemById(aci_context_t * ctx, unsigned short id);
+extern struct ACI_MEM_TABLE_ENTRY *aciCtxGetParameterItemByName(aci_context_t * ctx, char * name);
+extern unsigned short aciCtxGetParamTableLenth(aci_context_t * ctx);
+extern struct ACI_MEM_TABLE_ENTRY *aciCtxGetCommandItemByIndex(aci_context_t * ctx, unsigned short index);
+extern struct ACI_MEM_TABLE_ENTRY *aciCtxGetCommandItemById(aci_context_t * ctx, unsigned short id);
+extern struct ACI_MEM_TABLE_ENTRY *aciCtxGetCommandItemByName(aci_context_t * ctx, char * name);
+extern unsigned short aciCtxGetCmdTableLenth(aci_context_t * ctx);
+extern void aciCtxUpdateCmdPacket(aci_context_t * ctx, const unsigned short packetId);
+extern void aciCtxUpdateParamPacket(aci_context_t * ctx, const unsigned short packetId);
+extern unsigned char aciCtxGetCmdSendStatus(aci_context_t * ctx, const unsigned short packetId);
+extern void aciCtxSetSingleReceivedCallback(aci_context_t * ctx, void (*aciSingleReceived)(void * userData, unsigned short id, void * data, unsigned char varType));
+extern void aciCtxSetSingleRequestReceivedCallback(aci_context_t * ctx, void (*aciSingleReqReceived)(void * userData, unsigned short id, void * data, unsigned char varType));
+extern void aciCtxSetReadHDCallback(aci_context_t * ctx, int (*aciReadHD)(void * userData, void *data, int bytes));
+extern void aciCtxSetWriteHDCallback(aci_context_t * ctx, int (*aciWriteHD)(void * userData, void *data, int bytes));
+extern void aciCtxSetResetHDCallback(aci_context_t * ctx, void (*aciResetHD)(void * userData));
+extern void aciCtxRequestSingleVariable(aci_context_t * ctx, unsigned short id);
+extern void aciCtxSendParamStore(aci_context_t * ctx);
+extern void aciCtxSendParamLoad(aci_context_t * ctx);
+extern void aciCtxRequestBaudRate(aci_context_t * ctx, unsigned int baudrate);
+extern void aciCtxConfirmBaudRate(aci_context_t * ctx, unsigned int baudrate);
+extern void aciCtxSetBaudRateCallback(aci_context_t * ctx, void (*aciBaudRate_func)(void * userData, unsigned int baudrate, unsigned char status));
+extern unsigned char aciCtxGetParamPacketStatus(aci_context_t * ctx, unsigned short packetid);
+extern void aciCtxReceiveHandler(aci_context_t * ctx, unsigned char rxByte);
+extern void aciCtxReceiveBuffer(aci_context_t * ctx, const unsigned char * data, size_t length);
+extern void aciCtxReceiveBufferTimed(aci_context_t * ctx, const unsigned char * data, size_t length, double endTime, double byteTime);
+
+/**
+ * \ingroup context
+ * Copies the counters of received frames, CRC errors and resends of the context to stats.
+ */
+extern void aciCtxGetLinkStats(aci_context_t * ctx, struct ACI_LINK_STATS * stats);
+extern void aciCtxSetMemoryArena(aci_context_t * ctx, void * arena, size_t size);
+extern size_t aciCtxGetMemoryArenaPeak(aci_context_t * ctx);
+extern void aciCtxSetSendDataCallback(aci_context_t * ctx, void (*aciSendDataCallback_func)(void * userData, void * data, unsigned short cnt));
+extern void aciCtxSetSendSegmentsCallback(aci_context_t * ctx, void (*aciSendSegmentsCallback_func)(void * userData, const struct ACI_TX_SEGMENT * segments, unsigned char count));
 
 #ifdef __cplusplus
 }
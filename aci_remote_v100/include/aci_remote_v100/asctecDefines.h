@@ -6,10 +6,13 @@
 #define ACI_VER_MAJOR   1
 #define ACI_VER_MINOR	0
 
-/// Defines the maximum number of different variables packets. Both (onboard and offboard) have to be compiled with
-/// the setting. 3 is standard due to limited memory of the onboard code.<br>
-/// It is recommended, that you don't change the value for that.
-#define MAX_VAR_PACKETS 3
+/// Defines the maximum number of different variables, command and parameter packets of the remote. The message types
+/// leave room for 16 of each.<br>
+/// The device announces how many packets it has in ACI_INFO, only that many are used (see aciGetVarPacketCount()).
+#define MAX_VAR_PACKETS 16
+
+/// Number of packets used, until the device announces its number. 3 is standard due to limited memory of the onboard code.
+#define ACI_DEFAULT_VAR_PACKETS 3
 
 
 
@@ -38,6 +41,16 @@
 
 #define ACI_RX_BUFFER_SIZE		512
 #define ACI_TX_RINGBUFFER_SIZE 	512
+/// most segments of one frame passed to the send segments callback: header, magic code, one per variable of a packet and CRC
+#define ACI_TX_MAX_SEGMENTS		(MEMPACKET_MAX_VARS+3)
+
+/// The id index of the variable, command and parameter tables is split into ACI_INDEX_PAGES pages (high byte of the id)
+/// of ACI_INDEX_PAGE_SIZE entries (low byte of the id). Pages are only allocated for used id ranges.
+#define ACI_INDEX_PAGES			256
+#define ACI_INDEX_PAGE_SIZE		256
+
+/// Upper limit for the number of table entries requested at once, see aciSetListRequestWindow()
+#define ACI_LIST_REQUEST_WINDOW_MAX	16
 
 /// ID defines
 #define ID_NONE 0
@@ -174,6 +187,8 @@
 #define ACIMT_SETHEARTBEATTIMEOUT       0x23
 #define ACIMT_GETHEARTBEATTIMEOUT       0x24
 #define ACIMT_RESETREMOTE				0x25
+#define ACIMT_SETBAUDRATE				0x26
+#define ACIMT_CONFIRMBAUDRATE			0x27
 
 #define ACIMT_UPDATECMDPACKET           0x30
 //0x30-0x3f are reserved for update cmd packet config!
@@ -212,6 +227,7 @@
 #define ACIMT_SINGLESEND					0xA3
 #define ACIMT_SINGLEREQ						0xA4
 #define ACIMT_MAGICCODES					0xA5
+#define ACIMT_BAUDRATE						0xA6
 
 //GENERAL
 #define ACIMT_INFO_REQUEST				0xF0
@@ -235,12 +251,28 @@
 
 #define ACI_DBG								0xFF
 
+/// flags of struct ACI_INFO
+/// the device queues requested table entries and sends them as soon as they fit, so several may be requested at once
+#define ACI_INFO_FLAG_QUEUED_TABLE_REQUESTS	0x0001
+/// the device changes its UART rate on request, see aciRequestBaudRate()
+#define ACI_INFO_FLAG_BAUDRATE_SWITCH		0x0002
+
+/// status of struct ACI_BAUDRATE
+/// the rate is supported, the device switches to it right after this reply
+#define ACI_BAUDRATE_SWITCHING				0x01
+/// the device received the confirmation on the new rate and keeps it
+#define ACI_BAUDRATE_CONFIRMED				0x02
+#define ACI_BAUDRATE_UNSUPPORTED			0xF0
+
+/// the device falls back to the previous rate, if the new one is not confirmed within 1s
+#define ACI_BAUDRATE_CONFIRM_TIMEOUT(engineRate) (1000*(engineRate)/1000)
+
 //internal structures
 
 #define PACKEDDEF __attribute__((packed))
 
-#define ACI_REQUEST_LIST_TIMEOUT (200*aciEngineRate/1000)
-#define ACI_UPDATE_PACKET_TIMEOUT (500*aciEngineRate/1000)
+#define ACI_REQUEST_LIST_TIMEOUT(engineRate) (200*(engineRate)/1000)
+#define ACI_UPDATE_PACKET_TIMEOUT(engineRate) (500*(engineRate)/1000)
 #define TIMEOUT_INVALID_PACKET 5
 
 
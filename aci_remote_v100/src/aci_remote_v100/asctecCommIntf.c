@@ -32,155 +32,310 @@ extern "C"
  #endif
 #include "asctecCommIntf.h"
 
-//internal global vars
-unsigned int aciEngineRate=100;
-
-//aci var table global variables
-unsigned short aciVarTableLength=0;
-unsigned short *aciRequestedPacketList=0;
-unsigned short aciRequestedPacketListLength=0;
-unsigned short aciRequestedPacketListTimeOut;
-
-unsigned short aciRequestVarListTimeout=60000;
-unsigned short aciRequestCmdListTimeout=60000;
-unsigned short aciRequestParListTimeout=60000;
-
-unsigned char aciCmdWithAck[MAX_VAR_PACKETS] = {0,0,0};
-
-unsigned short * aciVarPacket[MAX_VAR_PACKETS];
-unsigned char * aciVarPacketBuffer[MAX_VAR_PACKETS];
-unsigned char * aciVarPacketContentBuffer[MAX_VAR_PACKETS];
-
-unsigned char aciVarPacketContentBufferValid[MAX_VAR_PACKETS];
-unsigned char aciVarPacketContentBufferInvalidCnt[MAX_VAR_PACKETS];
-
-unsigned short aciVarPacketContentBufferLength[MAX_VAR_PACKETS];
-unsigned short aciVarPacketLength[MAX_VAR_PACKETS]={0,0,0};
-unsigned short aciUpdateVarPacketTimeOut[MAX_VAR_PACKETS]={0,0,0};
-unsigned char aciVarPacketMagicCode[MAX_VAR_PACKETS]={0,0,0}; 
-unsigned short aciVarPacketTransmissionRate[MAX_VAR_PACKETS]={100,10,1};
-
-// Command
-//internal global vars
-unsigned short aciCmdTableLength=0;
-unsigned short *aciRequestedCmdPacketList;
-unsigned short aciRequestedCmdPacketListLength=0;
-unsigned short aciRequestedCmdPacketListTimeOut;
-
-unsigned char aciCmdPacketSendStatus[MAX_VAR_PACKETS]={0,0,0}; // 0 nothing to send, 1 something to send, 2 waiting for ACK
-unsigned short *aciCmdPacket[MAX_VAR_PACKETS];
-unsigned short aciCmdPacketLength[MAX_VAR_PACKETS]={0,0,0};
-unsigned short aciUpdateCmdPacketTimeOut[MAX_VAR_PACKETS]={0,0,0};
-unsigned char aciCmdPacketMagicCode[MAX_VAR_PACKETS]={0,0,0};
-unsigned short aciCmdPacketContentBufferLength[MAX_VAR_PACKETS];
-
-unsigned char * aciCmdPacketContentBuffer[MAX_VAR_PACKETS];
-
-// Parameter
-unsigned short aciParamTableLength=0;
-unsigned short *aciRequestedParamPacketList;
-unsigned short aciRequestedParamPacketListLength=0;
-unsigned short aciRequestedParamPacketListTimeOut;
-
-unsigned char aciParamPacketSendStatus[MAX_VAR_PACKETS]={0,0,0}; // 0 nothing to send, 1 something to send, 2 waiting for ACK
-unsigned short *aciParamPacket[MAX_VAR_PACKETS];
-unsigned short aciParamPacketLength[MAX_VAR_PACKETS]={0,0,0};
-unsigned short aciUpdateParamPacketTimeOut[MAX_VAR_PACKETS]={0,0,0};
-unsigned char aciParamPacketStatus[MAX_VAR_PACKETS]={0,0,0};
-unsigned char aciParamPacketMagicCode[MAX_VAR_PACKETS]={0,0,0};
-unsigned short aciParamPacketContentBufferLength[MAX_VAR_PACKETS];
-
-unsigned char * aciParamPacketContentBuffer[MAX_VAR_PACKETS];
-
-// unsigned short aciVarPacketCurrentSize[MAX_VAR_PACKETS]={0,0,0};
-// unsigned short aciVarPacketNumberOfVars[MAX_VAR_PACKETS]={0,0,0};
-unsigned char aciCmdPacketUpdated[MAX_VAR_PACKETS]={0,0,0};
-
-///heart beat in HZ
-unsigned short aciHeartBeatRate=10; 
+///full memory barrier for the var packet snapshots, which are read without any lock
+#if defined(__GNUC__)
+#define ACI_MEMORY_BARRIER() __sync_synchronize()
+#else
+#define ACI_MEMORY_BARRIER()
+#endif
 
-///table to handle local ID to var connection
-struct ACI_MEM_VAR_ASSIGN_TABLE * aciVarAssignTableStart;
-struct ACI_MEM_VAR_ASSIGN_TABLE * aciVarAssignTableCurrent;
 
-struct ACI_MEM_VAR_ASSIGN_TABLE * aciCmdAssignTableStart;
-struct ACI_MEM_VAR_ASSIGN_TABLE * aciCmdAssignTableCurrent;
+///one memcpy of the var packet decode plan: size bytes at offset in the packet content go to dst
+struct ACI_VAR_PACKET_DECODE_RUN
+{
+	unsigned short offset;
+	unsigned short size;
+	unsigned char * dst;
+};
 
-struct ACI_MEM_VAR_ASSIGN_TABLE * aciParamAssignTableStart;
-struct ACI_MEM_VAR_ASSIGN_TABLE * aciParamAssignTableCurrent;
 
-struct ACI_INFO aciInfo;
+//memory arena, if set with aciSetMemoryArena all memory of the remote is taken from there instead of the heap
+struct ACI_ARENA_BLOCK {
+	size_t size;
+	size_t used;
+};
 
-//RX global variables
-unsigned char aciRxDataBuffer[ACI_RX_BUFFER_SIZE];
-unsigned short aciRxDataCnt;
 
-struct ACI_MEM_VAR_TABLE * aciMemVarTableStart;
-struct ACI_MEM_VAR_TABLE * aciMemVarTableCurrent;
+///id index of a downloaded table. The high byte of the id selects the page, the low byte the slot in the page.
+struct ACI_MEM_TABLE_INDEX
+{
+	struct ACI_MEM_TABLE_ENTRY ** page[ACI_INDEX_PAGES];
+	unsigned char valid;
+};
 
-struct ACI_MEM_VAR_TABLE * aciMemCmdTableStart;
-struct ACI_MEM_VAR_TABLE * aciMemCmdTableCurrent;
+///windowed download of the var, cmd or param table. Entries may arrive in any order, they get linked into the table in
+///the order of the device when the last one is there
+struct ACI_LIST_DOWNLOAD
+{
+	unsigned short * id; //ids of the table in the order of the device
+	struct ACI_MEM_VAR_TABLE ** entry; //received entry per id, NULL if the id was already in the table
+	unsigned char * received;
+	unsigned short * slot; //hash of the ids with linear probing: position in id + 1, 0 for an empty bucket
+	unsigned int slotMask; //number of buckets - 1, a power of two
+	unsigned short length; //number of ids
+	unsigned short missing; //entries not received yet, 0 if no download is running
+	unsigned short next; //ids before next were requested at least once
+	unsigned short inFlight; //requested ids, which did not arrive yet
+	unsigned short timeOut;
+};
+
+/// all state of one connection to a device. The functions without Ctx in their name use the default context
+struct aci_context
+{
+	//internal global vars
+	unsigned int aciEngineRate;
+
+	//aci var table global variables
+	unsigned short aciVarTableLength;
+	struct ACI_LIST_DOWNLOAD aciVarListDownload;
+	///number of table entries requested at once, if the device supports it
+	unsigned char aciListRequestWindow;
+	///number of variable, command and parameter packets of the device, up to MAX_VAR_PACKETS
+	unsigned char aciVarPacketCount;
+
+	unsigned short aciRequestVarListTimeout;
+	unsigned short aciRequestCmdListTimeout;
+	unsigned short aciRequestParListTimeout;
+
+	unsigned char aciCmdWithAck[MAX_VAR_PACKETS];
+
+	unsigned short *aciVarPacket[MAX_VAR_PACKETS];
+	unsigned char *aciVarPacketBuffer[MAX_VAR_PACKETS];
+	unsigned char *aciVarPacketContentBuffer[MAX_VAR_PACKETS];
+
+	unsigned char aciVarPacketContentBufferValid[MAX_VAR_PACKETS];
+	unsigned char aciVarPacketContentBufferInvalidCnt[MAX_VAR_PACKETS];
+	unsigned char aciVarPacketContentBufferUpdated[MAX_VAR_PACKETS];
+
+	struct ACI_VAR_PACKET_DECODE_RUN *aciVarPacketDecodePlan[MAX_VAR_PACKETS];
+	unsigned short aciVarPacketDecodePlanLength[MAX_VAR_PACKETS];
+	unsigned char aciVarPacketDirectDecode;
+
+	// double buffered snapshots of the received var packets. The writer fills the buffer not selected by the sequence counter and
+	// bumps the counter afterwards, readers copy buffer seq&1 and retry if the counter moved meanwhile
+	unsigned char aciVarPacketSnapshot[MAX_VAR_PACKETS][2][ACI_RX_BUFFER_SIZE];
+	unsigned short aciVarPacketSnapshotLength[MAX_VAR_PACKETS][2];
+	// time the packet was received, see aciCtxReceiveBufferTimed
+	double aciVarPacketSnapshotTime[MAX_VAR_PACKETS][2];
+	volatile unsigned int aciVarPacketSnapshotSeq[MAX_VAR_PACKETS];
+
+	unsigned short aciVarPacketContentBufferLength[MAX_VAR_PACKETS];
+	unsigned short aciVarPacketLength[MAX_VAR_PACKETS];
+	unsigned short aciUpdateVarPacketTimeOut[MAX_VAR_PACKETS];
+	unsigned char aciVarPacketMagicCode[MAX_VAR_PACKETS];
+	unsigned short aciVarPacketTransmissionRate[MAX_VAR_PACKETS];
+
+	// Command
+	//internal global vars
+	unsigned short aciCmdTableLength;
+	struct ACI_LIST_DOWNLOAD aciCmdListDownload;
+
+	unsigned char aciCmdPacketSendStatus[MAX_VAR_PACKETS]; // 0 nothing to send, 1 something to send, 2 waiting for ACK
+	unsigned short *aciCmdPacket[MAX_VAR_PACKETS];
+	unsigned short aciCmdPacketLength[MAX_VAR_PACKETS];
+	unsigned short aciUpdateCmdPacketTimeOut[MAX_VAR_PACKETS];
+	unsigned char aciCmdPacketMagicCode[MAX_VAR_PACKETS];
+	unsigned short aciCmdPacketContentBufferLength[MAX_VAR_PACKETS];
+
+	unsigned char *aciCmdPacketContentBuffer[MAX_VAR_PACKETS];
+
+	// Parameter
+	unsigned short aciParamTableLength;
+	struct ACI_LIST_DOWNLOAD aciParamListDownload;
+
+	unsigned char aciParamPacketSendStatus[MAX_VAR_PACKETS]; // 0 nothing to send, 1 something to send, 2 waiting for ACK
+	unsigned short *aciParamPacket[MAX_VAR_PACKETS];
+	unsigned short aciParamPacketLength[MAX_VAR_PACKETS];
+	unsigned short aciUpdateParamPacketTimeOut[MAX_VAR_PACKETS];
+	unsigned char aciParamPacketStatus[MAX_VAR_PACKETS];
+	unsigned char aciParamPacketMagicCode[MAX_VAR_PACKETS];
+	unsigned short aciParamPacketContentBufferLength[MAX_VAR_PACKETS];
+
+	unsigned char *aciParamPacketContentBuffer[MAX_VAR_PACKETS];
+
+	// unsigned short aciVarPacketCurrentSize[MAX_VAR_PACKETS]={0,0,0};
+	// unsigned short aciVarPacketNumberOfVars[MAX_VAR_PACKETS]={0,0,0};
+	unsigned char aciCmdPacketUpdated[MAX_VAR_PACKETS];
+
+	///heart beat in HZ
+	unsigned short aciHeartBeatRate;
+
+	///table to handle local ID to var connection
+	struct ACI_MEM_VAR_ASSIGN_TABLE *aciVarAssignTableStart;
+	struct ACI_MEM_VAR_ASSIGN_TABLE *aciVarAssignTableCurrent;
+
+	struct ACI_MEM_VAR_ASSIGN_TABLE *aciCmdAssignTableStart;
+	struct ACI_MEM_VAR_ASSIGN_TABLE *aciCmdAssignTableCurrent;
+
+	struct ACI_MEM_VAR_ASSIGN_TABLE *aciParamAssignTableStart;
+	struct ACI_MEM_VAR_ASSIGN_TABLE *aciParamAssignTableCurrent;
+
+	struct ACI_INFO aciInfo;
+
+	//memory arena, if set with aciSetMemoryArena all memory of the remote is taken from there instead of the heap
+	unsigned char *aciArena;
+	size_t aciArenaSize;
+	size_t aciArenaFirstFree;
+	size_t aciArenaUsed;
+	size_t aciArenaPeak;
+
+	//RX global variables
+	unsigned char aciRxDataBuffer[ACI_RX_BUFFER_SIZE];
+	unsigned short aciRxDataCnt;
+
+	// parser state, shared by aciReceiveHandler and aciReceiveBuffer
+	unsigned char aciRxState;
+	unsigned char aciRxMessageType;
+	unsigned short aciRxLength;
+	unsigned short aciRxCrc;
+	unsigned short aciRxReceivedCrc;
+	// time the byte passed to aciReceiveHandler was received, 0 if unknown
+	double aciRxTime;
+
+	struct ACI_MEM_VAR_TABLE *aciMemVarTableStart;
+	struct ACI_MEM_VAR_TABLE *aciMemVarTableCurrent;
+
+	struct ACI_MEM_VAR_TABLE *aciMemCmdTableStart;
+	struct ACI_MEM_VAR_TABLE *aciMemCmdTableCurrent;
+
+	struct ACI_MEM_VAR_TABLE *aciMemParamTableStart;
+	struct ACI_MEM_VAR_TABLE *aciMemParamTableCurrent;
+
+	struct ACI_MEM_TABLE_INDEX aciMemVarTableIndex;
+	struct ACI_MEM_TABLE_INDEX aciMemCmdTableIndex;
+	struct ACI_MEM_TABLE_INDEX aciMemParamTableIndex;
+
+	//callbacks, they all get aciUserData as first argument
+	void * aciUserData;
+	void (*aciSendData)(void * userData, void * data, unsigned short cnt);
+	void (*aciSendSegments)(void * userData, const struct ACI_TX_SEGMENT * segments, unsigned char count);
+	void (*aciVarListUpdateFinished)(void * userData);
+	void (*aciCmdListUpdateFinished)(void * userData);
+	void (*aciCmdAck)(void * userData, unsigned char packet);
+	void (*aciParamListUpdateFinished)(void * userData);
+	void (*aciInfoRec)(void * userData, struct ACI_INFO);
+	void (*aciVarPacketRec)(void * userData, unsigned char packet);
+	void (*aciVarPacketRecTimed)(void * userData, unsigned char packet, double rxTime);
+	void (*aciParaStoredC)(void * userData);
+	void (*aciParaLoadedC)(void * userData);
+	void (*aciSingleReceivedC)(void * userData, unsigned short id, void * data, unsigned char varType);
+	void (*aciSingleReqReceivedC)(void * userData, unsigned short id, void * data, unsigned char varType);
+	int (*aciReadHDC)(void * userData, void *data, int bytes);
+	int (*aciWriteHDC)(void * userData, void *data, int bytes);
+	void (*aciResetHDC)(void * userData);
+	void (*aciBaudRateC)(void * userData, unsigned int baudrate, unsigned char status);
+
+	unsigned short aciHeartBeatCnt;
+
+	unsigned short aciMagicCodeVarLoaded;
+	unsigned short aciMagicCodeCmdLoaded;
+	unsigned short aciMagicCodeParLoaded;
+
+	unsigned short aciMagicCodeVar;
+	unsigned short aciMagicCodeCmd;
+	unsigned short aciMagicCodePar;
+
+	unsigned short aciRequestMagicCodes;
+
+	unsigned char aciMagicCodeOnHDFalse;
+
+	/*
+	 * 0x01 var, 0x02 Cmd, 0x04 par
+	 * 0x10 var already loaded succesfully
+	 * 0x20 cmd already loaded succesfully
+	 * 0x40 par already loaded succesfully
+	 *
+	 */
+	unsigned char aciRequestListType;
+
+
+	//former static locals of aciEngine and aciRxHandleMessage
+	unsigned int aciParPacketCnt[MAX_VAR_PACKETS];
+	unsigned int aciCmdPacketCnt[MAX_VAR_PACKETS];
+	struct ACI_LINK_STATS aciLinkStats;
+	char magicCodeAlreadyRequested; // It may happen, that it will get it 2 times in a row and that is bad for loading/saving
+};
+
+/// settings of a new context, everything not named here is 0
+#define ACI_CONTEXT_DEFAULTS { \
+	.aciEngineRate = 100, \
+	.aciRequestVarListTimeout = 60000, \
+	.aciRequestCmdListTimeout = 60000, \
+	.aciRequestParListTimeout = 60000, \
+	.aciVarPacketTransmissionRate = { 100, 10, 1 }, \
+	.aciHeartBeatRate = 10, \
+	.aciListRequestWindow = 4, \
+	.aciRxState = ARS_IDLE, \
+	.aciMagicCodeVar = 0x00FF, \
+	.aciMagicCodeCmd = 0x00FF, \
+	.aciMagicCodePar = 0x00FF }
+
+/// context used by the API without context. Initialised at load time, so no thread can see it half set up
+static aci_context_t aciDefaultContext = ACI_CONTEXT_DEFAULTS;
 
-struct ACI_MEM_VAR_TABLE * aciMemParamTableStart;
-struct ACI_MEM_VAR_TABLE * aciMemParamTableCurrent;
 
 //aci helper prototypes
-void aciFreeMemVarTable(struct ACI_MEM_VAR_TABLE * ptr);
+void aciFreeMemVarTable(aci_context_t * ctx, struct ACI_MEM_VAR_TABLE * ptr);
+
+///(re)build the id index of a table, called after the list download has finished
+void aciBuildTableIndex(aci_context_t * ctx, struct ACI_MEM_TABLE_INDEX * index, struct ACI_MEM_VAR_TABLE * start);
+///free the pages of an index and mark it invalid
+void aciFreeTableIndex(aci_context_t * ctx, struct ACI_MEM_TABLE_INDEX * index);
+///look up an entry in the index. Only valid, if index->valid is set
+struct ACI_MEM_TABLE_ENTRY * aciLookupTableIndex(struct ACI_MEM_TABLE_INDEX * index, unsigned short id);
 
 ///update CRC with 1 byte
 unsigned short aciCrcUpdate (unsigned short crc, unsigned char data);
 ///update crc with multiple bytes
 unsigned short aciUpdateCrc16(unsigned short crc, void * data, unsigned short cnt);
 
+//list download prototypes
+///start the download of the ids in data, which hold count ids. Returns 0, if there is no memory for it
+unsigned char aciListDownloadStart(aci_context_t * ctx, struct ACI_LIST_DOWNLOAD * dl, unsigned char requestType, unsigned char * data, unsigned short count);
+///request further ids, as long as the window allows it
+void aciListDownloadRequest(aci_context_t * ctx, struct ACI_LIST_DOWNLOAD * dl, unsigned char requestType);
+///request all ids again, which are in flight for too long
+void aciListDownloadRetry(aci_context_t * ctx, struct ACI_LIST_DOWNLOAD * dl, unsigned char requestType);
+///position of id in the download, dl->length if it is not part of it
+unsigned short aciListDownloadSlot(struct ACI_LIST_DOWNLOAD * dl, unsigned short id);
+///store the received table entry in aciRxDataBuffer. Returns 1, if it was the last one and the entries got linked into the table
+unsigned char aciListDownloadEntry(aci_context_t * ctx, struct ACI_LIST_DOWNLOAD * dl, unsigned char requestType, struct ACI_MEM_VAR_TABLE * start,
+		struct ACI_MEM_TABLE_INDEX * index, struct ACI_MEM_VAR_TABLE ** current, unsigned short * magicCode, unsigned short * loaded);
+///stop a download and free everything of it
+void aciListDownloadFree(aci_context_t * ctx, struct ACI_LIST_DOWNLOAD * dl);
+
+//memory prototypes
+///allocate from the arena, or from the heap if no arena is set
+void * aciMalloc(aci_context_t * ctx, size_t size);
+///give memory back to the arena or the heap
+void aciFree(aci_context_t * ctx, void * ptr);
+///forget all memory of the remote and start again with an empty arena
+void aciResetMemoryArena(aci_context_t * ctx);
+///drop all pointers into the arena without freeing them
+void aciForgetArenaMemory(aci_context_t * ctx);
+///free all tables and packets allocated on the heap and drop the pointers
+void aciFreeHeapMemory(aci_context_t * ctx);
+
 //aciRxHandler prototypes
-void aciRxHandleMessage(unsigned char messagetype, unsigned short length);
+void aciRxHandleMessage(aci_context_t * ctx, unsigned char messagetype, unsigned short length);
+
+///build the decode plan of a var packet from its current id list and the assigned variables
+void aciCompileVarPacketDecodePlan(aci_context_t * ctx, unsigned char packetId);
+///copy the content of a var packet into the assigned variables
+void aciRunVarPacketDecodePlan(aci_context_t * ctx, unsigned char packetId, unsigned char * content);
+///publish new content of a var packet for aciGetVarPacketSnapshot(), a length of 0 invalidates the snapshot
+void aciStoreVarPacketSnapshot(aci_context_t * ctx, unsigned char packetId, unsigned char * content, unsigned short length);
 
 // aci
-void aciParamAck(unsigned char packet);
+void aciParamAck(aci_context_t * ctx, unsigned char packet);
 
-void aciStoreList();
-void aciLoadHeaderList();
-void aciLoadList();
+void aciStoreList(aci_context_t * ctx);
+void aciLoadHeaderList(aci_context_t * ctx);
+void aciLoadList(aci_context_t * ctx);
 
 //aci TX prototypes
-void aciTxSendPacket(unsigned char aciMessageType, void * data, unsigned short cnt);
-void (*aciSendData)(void * data, unsigned short cnt);
-void (*aciVarListUpdateFinished)(void);
-void (*aciCmdListUpdateFinished)(void);
-void (*aciCmdAck)(unsigned char packet);
-void (*aciParamListUpdateFinished)(void);
-void (*aciInfoRec)(struct ACI_INFO);
-void (*aciVarPacketRec)(unsigned char packet);
-void (*aciParaStoredC) (void);
-void (*aciParaLoadedC) (void);
-void (*aciSingleReceivedC)(unsigned short id, void * data, unsigned char varType);
-void (*aciSingleReqReceivedC)(unsigned short id, void * data, unsigned char varType);
-int (*aciReadHDC)(void *data, int bytes);
-int (*aciWriteHDC)(void *data, int bytes);
-void (*aciResetHDC)();
-
-unsigned short aciHeartBeatCnt=0;
-
-unsigned short aciMagicCodeVarLoaded = 0;
-unsigned short aciMagicCodeCmdLoaded = 0;
-unsigned short aciMagicCodeParLoaded = 0;
-
-unsigned short aciMagicCodeVar = 0x00FF;
-unsigned short aciMagicCodeCmd = 0x00FF;
-unsigned short aciMagicCodePar = 0x00FF;
-
-unsigned short aciRequestMagicCodes = 0;
-
-unsigned char aciMagicCodeOnHDFalse = 0;
-
-/*
- * 0x01 var, 0x02 Cmd, 0x04 par
- * 0x10 var already loaded succesfully
- * 0x20 cmd already loaded succesfully
- * 0x40 par already loaded succesfully
- *
- */
-unsigned char aciRequestListType=0;
+void aciTxSendPacket(aci_context_t * ctx, unsigned char aciMessageType, void * data, unsigned short cnt);
+void aciTxSendSegments(aci_context_t * ctx, unsigned char aciMessageType, const struct ACI_TX_SEGMENT * payload, unsigned char count);
 
 /** Search for a variable in any created packet and returns its success.
  * @param ptrToVar Pointer to the variable, where the value will be stored. If there is no memory allocated for the pointer, there will be allocated with the size of varType. Make sure, that the size of allocated memory is the same as varType.
@@ -188,236 +343,240 @@ unsigned char aciRequestListType=0;
  * @param id The id of the variable, which should be set in \a ptrToVar
  * @return If the value could be set, it returns 1 otherwise 0.
 **/
-char aciGetVarById(void * ptrToVar, const unsigned char varType, const unsigned short id);
+char aciCtxGetVarById(aci_context_t * ctx, void * ptrToVar, const unsigned char varType, const unsigned short id);
      
 
 //aci assignment table prototypes
 
-void aciFreeMemVarTable(struct ACI_MEM_VAR_TABLE * ptr)
+void aciFreeMemVarTable(aci_context_t * ctx, struct ACI_MEM_VAR_TABLE * ptr)
 {
 	if (ptr->next)
-		aciFreeMemVarTable(ptr->next);
-	free(ptr);
+		aciFreeMemVarTable(ctx, ptr->next);
+	aciFree(ctx, ptr);
 }
 
-void aciCheckVerConf() {
-	aciTxSendPacket(ACIMT_INFO_REQUEST,NULL,0);
+void aciCtxCheckVerConf(aci_context_t * ctx) {
+	aciTxSendPacket(ctx, ACIMT_INFO_REQUEST,NULL,0);
 }
 
-void aciParamAck(unsigned char packet)
+void aciParamAck(aci_context_t * ctx, unsigned char packet)
 {
-	aciParamPacketSendStatus[packet]=0;
+	ctx->aciParamPacketSendStatus[packet]=0;
 }
 
 /** has to be called ones during initialisation **/
-void aciInit(void)
+void aciCtxInit(aci_context_t * ctx)
 {
      int i;
-    if (aciMemVarTableStart)
-		aciFreeMemVarTable(aciMemVarTableStart);
+    if (ctx->aciArena)
+		aciResetMemoryArena(ctx);
+    else {
+		if (ctx->aciMemVarTableStart)
+			aciFreeMemVarTable(ctx, ctx->aciMemVarTableStart);
+		if (ctx->aciMemCmdTableStart)
+			aciFreeMemVarTable(ctx, ctx->aciMemCmdTableStart);
+		if (ctx->aciMemParamTableStart)
+			aciFreeMemVarTable(ctx, ctx->aciMemParamTableStart);
+		aciListDownloadFree(ctx, &ctx->aciVarListDownload);
+		aciListDownloadFree(ctx, &ctx->aciCmdListDownload);
+		aciListDownloadFree(ctx, &ctx->aciParamListDownload);
+    }
+
+    aciFreeTableIndex(ctx, &ctx->aciMemVarTableIndex);
+    aciFreeTableIndex(ctx, &ctx->aciMemCmdTableIndex);
+    aciFreeTableIndex(ctx, &ctx->aciMemParamTableIndex);
 
     for (i=0;i<MAX_VAR_PACKETS;i++)
     {
-        aciResetVarPacketContent(i);
-        aciVarPacketContentBufferValid[i]=0;  
-        aciVarPacketContentBufferInvalidCnt[i]=0;  
+        aciCtxResetVarPacketContent(ctx, i);
+        aciCtxResetCmdPacketContent(ctx, i);
+        aciCtxResetParPacketContent(ctx, i);
+        ctx->aciCmdPacketSendStatus[i]=0;
+        ctx->aciParamPacketSendStatus[i]=0;
+        ctx->aciVarPacketContentBufferValid[i]=0;  
+        ctx->aciVarPacketContentBufferInvalidCnt[i]=0;  
+        ctx->aciVarPacketContentBufferUpdated[i]=0;
+        aciStoreVarPacketSnapshot(ctx, i, NULL, 0);
     }
-    aciHeartBeatCnt=0;
+    ctx->aciHeartBeatCnt=0;
     
-    aciVarAssignTableStart=(struct ACI_MEM_VAR_ASSIGN_TABLE *) malloc(sizeof(struct ACI_MEM_VAR_ASSIGN_TABLE));
-    aciVarAssignTableStart->next=NULL;
+    ctx->aciVarAssignTableStart=(struct ACI_MEM_VAR_ASSIGN_TABLE *) aciMalloc(ctx, sizeof(struct ACI_MEM_VAR_ASSIGN_TABLE));
+    ctx->aciVarAssignTableStart->next=NULL;
              
-	aciMemVarTableStart=(struct ACI_MEM_VAR_TABLE *) malloc(sizeof(struct ACI_MEM_VAR_TABLE));
+	ctx->aciMemVarTableStart=(struct ACI_MEM_VAR_TABLE *) aciMalloc(ctx, sizeof(struct ACI_MEM_VAR_TABLE));
 
-	aciMemVarTableStart->next=NULL;
+	ctx->aciMemVarTableStart->next=NULL;
     
-    aciCmdAssignTableStart=(struct ACI_MEM_VAR_ASSIGN_TABLE *) malloc(sizeof(struct ACI_MEM_VAR_ASSIGN_TABLE));
-    aciCmdAssignTableStart->next=NULL;
+    ctx->aciCmdAssignTableStart=(struct ACI_MEM_VAR_ASSIGN_TABLE *) aciMalloc(ctx, sizeof(struct ACI_MEM_VAR_ASSIGN_TABLE));
+    ctx->aciCmdAssignTableStart->next=NULL;
              
-	aciMemCmdTableStart=(struct ACI_MEM_VAR_TABLE *) malloc(sizeof(struct ACI_MEM_VAR_TABLE));
+	ctx->aciMemCmdTableStart=(struct ACI_MEM_VAR_TABLE *) aciMalloc(ctx, sizeof(struct ACI_MEM_VAR_TABLE));
 
-	aciMemCmdTableStart->next=NULL;
+	ctx->aciMemCmdTableStart->next=NULL;
     
-    aciParamAssignTableStart=(struct ACI_MEM_VAR_ASSIGN_TABLE *) malloc(sizeof(struct ACI_MEM_VAR_ASSIGN_TABLE));
-    aciParamAssignTableStart->next=NULL;
+    ctx->aciParamAssignTableStart=(struct ACI_MEM_VAR_ASSIGN_TABLE *) aciMalloc(ctx, sizeof(struct ACI_MEM_VAR_ASSIGN_TABLE));
+    ctx->aciParamAssignTableStart->next=NULL;
              
-	aciMemParamTableStart=(struct ACI_MEM_VAR_TABLE *) malloc(sizeof(struct ACI_MEM_VAR_TABLE));
+	ctx->aciMemParamTableStart=(struct ACI_MEM_VAR_TABLE *) aciMalloc(ctx, sizeof(struct ACI_MEM_VAR_TABLE));
 
-	aciMemParamTableStart->next=NULL;
+	ctx->aciMemParamTableStart->next=NULL;
     
-    aciRequestedPacketList=NULL;
-
-    aciInfo.verMajor=0;
-    aciInfo.verMinor=0;
-    aciInfo.maxNameLength=0;
-    aciInfo.maxDescLength=0;
-    aciInfo.maxUnitLength=0;
-    aciInfo.maxVarPackets=0;
-    aciInfo.memPacketMaxVars=0;
-}
-
-void aciResetRemote(void)
+    ctx->aciInfo.verMajor=0;
+    ctx->aciInfo.verMinor=0;
+    ctx->aciInfo.maxNameLength=0;
+    ctx->aciInfo.maxDescLength=0;
+    ctx->aciInfo.maxUnitLength=0;
+    ctx->aciInfo.maxVarPackets=0;
+    ctx->aciInfo.memPacketMaxVars=0;
+    ctx->aciInfo.flags=0;
+    ctx->aciVarPacketCount=ACI_DEFAULT_VAR_PACKETS;
+}
+
+void aciCtxResetRemote(aci_context_t * ctx)
 {
      //reset remote link
-     aciTxSendPacket(ACIMT_RESETREMOTE,NULL,0);
+     aciTxSendPacket(ctx, ACIMT_RESETREMOTE,NULL,0);
 }
 
-void aciEngine(void)
+void aciCtxEngine(aci_context_t * ctx)
 {
     int i;
-    static unsigned int aciParPacketCnt[MAX_VAR_PACKETS] = {0,0,0};
-    static unsigned int aciCmdPacketCnt[MAX_VAR_PACKETS] = {0,0,0};
     unsigned short crc=0xff;
    // unsigned char heartbeat_to_send = 1;
 
-    if(aciRequestMagicCodes) {
-    	if(aciRequestMagicCodes==1) {
-    		aciTxSendPacket(ACIMT_MAGICCODES,NULL,0);
-    	} else if (aciRequestMagicCodes>aciEngineRate) aciRequestMagicCodes=1;
-    	else aciRequestMagicCodes++;
+    if(ctx->aciRequestMagicCodes) {
+    	if(ctx->aciRequestMagicCodes==1) {
+    		aciTxSendPacket(ctx, ACIMT_MAGICCODES,NULL,0);
+    	} else if (ctx->aciRequestMagicCodes>ctx->aciEngineRate) ctx->aciRequestMagicCodes=1;
+    	else ctx->aciRequestMagicCodes++;
     }
 
-    if(aciRequestVarListTimeout!=60000)
+    if(ctx->aciRequestVarListTimeout!=60000)
     {
-   	 aciHeartBeatCnt=0;
-   	 if(aciRequestVarListTimeout) aciRequestVarListTimeout--;
+   	 ctx->aciHeartBeatCnt=0;
+   	 if(ctx->aciRequestVarListTimeout) ctx->aciRequestVarListTimeout--;
    	 else {
-   		 aciTxSendPacket(ACIMT_GETVARTABLEINFO, NULL, 0);
-   		 aciRequestVarListTimeout=ACI_REQUEST_LIST_TIMEOUT;
+   		 aciTxSendPacket(ctx, ACIMT_GETVARTABLEINFO, NULL, 0);
+   		 ctx->aciRequestVarListTimeout=ACI_REQUEST_LIST_TIMEOUT(ctx->aciEngineRate);
    	 }
     }
 
-    if(aciRequestCmdListTimeout!=60000)
+    if(ctx->aciRequestCmdListTimeout!=60000)
     {
-   	 aciHeartBeatCnt=0;
-   	 if(aciRequestCmdListTimeout) aciRequestCmdListTimeout--;
+   	 ctx->aciHeartBeatCnt=0;
+   	 if(ctx->aciRequestCmdListTimeout) ctx->aciRequestCmdListTimeout--;
    	 else {
-   		 aciTxSendPacket(ACIMT_GETCMDTABLEINFO, NULL, 0);
-   		 aciRequestCmdListTimeout=ACI_REQUEST_LIST_TIMEOUT;
+   		 aciTxSendPacket(ctx, ACIMT_GETCMDTABLEINFO, NULL, 0);
+   		 ctx->aciRequestCmdListTimeout=ACI_REQUEST_LIST_TIMEOUT(ctx->aciEngineRate);
    	 }
     }
 
-    if(aciRequestParListTimeout!=60000)
+    if(ctx->aciRequestParListTimeout!=60000)
     {
-   	 aciHeartBeatCnt=0;
-   	 if(aciRequestParListTimeout) aciRequestParListTimeout--;
+   	 ctx->aciHeartBeatCnt=0;
+   	 if(ctx->aciRequestParListTimeout) ctx->aciRequestParListTimeout--;
    	 else {
-   		 aciTxSendPacket(ACIMT_GETPARAMTABLEINFO, NULL, 0);
-   		 aciRequestParListTimeout=ACI_REQUEST_LIST_TIMEOUT;
+   		 aciTxSendPacket(ctx, ACIMT_GETPARAMTABLEINFO, NULL, 0);
+   		 ctx->aciRequestParListTimeout=ACI_REQUEST_LIST_TIMEOUT(ctx->aciEngineRate);
    	 }
     }
 
 
 
-    if (aciRequestedPacketListLength)
+    if (ctx->aciVarListDownload.missing)
     {
-   	 aciHeartBeatCnt=0;
-       if (aciRequestedPacketListTimeOut)
-          aciRequestedPacketListTimeOut--;
-       else
-       {
-               aciTxSendPacket(ACIMT_REQUESTVARTABLEENTRIES,aciRequestedPacketList,2);
-               aciRequestedPacketListTimeOut=ACI_REQUEST_LIST_TIMEOUT;
-       }
-
+   	 ctx->aciHeartBeatCnt=0;
+       aciListDownloadRequest(ctx, &ctx->aciVarListDownload, ACIMT_REQUESTVARTABLEENTRIES);
+       aciListDownloadRetry(ctx, &ctx->aciVarListDownload, ACIMT_REQUESTVARTABLEENTRIES);
     }
-    if (aciRequestedCmdPacketListLength)
+    if (ctx->aciCmdListDownload.missing)
     {
-   	 aciHeartBeatCnt=0;
-       if (aciRequestedCmdPacketListTimeOut)
-       	aciRequestedCmdPacketListTimeOut--;
-       else
-       {
-               aciTxSendPacket(ACIMT_REQUESTCMDTABLEENTRIES,aciRequestedCmdPacketList,2);
-               aciRequestedCmdPacketListTimeOut=ACI_REQUEST_LIST_TIMEOUT;
-       }
-
+   	 ctx->aciHeartBeatCnt=0;
+       aciListDownloadRequest(ctx, &ctx->aciCmdListDownload, ACIMT_REQUESTCMDTABLEENTRIES);
+       aciListDownloadRetry(ctx, &ctx->aciCmdListDownload, ACIMT_REQUESTCMDTABLEENTRIES);
     }
-    if (aciRequestedParamPacketListLength)
+    if (ctx->aciParamListDownload.missing)
     {
-   	 aciHeartBeatCnt=0;
-       if (aciRequestedParamPacketListTimeOut)
-       	aciRequestedParamPacketListTimeOut--;
-       else
-       {
-               aciTxSendPacket(ACIMT_REQUESTPARAMTABLEENTRIES,aciRequestedParamPacketList,2);
-               aciRequestedParamPacketListTimeOut=ACI_REQUEST_LIST_TIMEOUT;
-       }
-
+   	 ctx->aciHeartBeatCnt=0;
+       aciListDownloadRequest(ctx, &ctx->aciParamListDownload, ACIMT_REQUESTPARAMTABLEENTRIES);
+       aciListDownloadRetry(ctx, &ctx->aciParamListDownload, ACIMT_REQUESTPARAMTABLEENTRIES);
     }
 
 
 
     for (i=0;i<MAX_VAR_PACKETS;i++)
     {
-        if (aciUpdateVarPacketTimeOut[i])
+        if (ctx->aciUpdateVarPacketTimeOut[i])
         {
-         aciUpdateVarPacketTimeOut[i]--;
-         if (!aciUpdateVarPacketTimeOut[i])
+         ctx->aciUpdateVarPacketTimeOut[i]--;
+         if (!ctx->aciUpdateVarPacketTimeOut[i])
             {
                //packet was not acknoledged -> send again
 
-                unsigned char * temp;
+                unsigned char temp[ACI_TX_RINGBUFFER_SIZE];
                 crc=0xff;
-
-                crc=aciUpdateCrc16(crc,aciVarPacket[i],aciVarPacketLength[i]*2);
-
-                temp=(unsigned char*) malloc(aciVarPacketLength[i]*2+1);
-                memcpy(&temp[1],aciVarPacket[i],aciVarPacketLength[i]*2);
-                temp[0]=crc;
-                aciVarPacketMagicCode[i]=crc;
-
-                aciTxSendPacket(ACIMT_UPDATEVARPACKET+i,temp,aciVarPacketLength[i]*2+1);
-                aciUpdateVarPacketTimeOut[i]=ACI_UPDATE_PACKET_TIMEOUT;
-                free(temp);
+                ctx->aciLinkStats.varConfigResends++;
+
+                crc=aciUpdateCrc16(crc,ctx->aciVarPacket[i],ctx->aciVarPacketLength[i]*2);
+
+                ctx->aciVarPacketMagicCode[i]=crc;
+                if (ctx->aciVarPacketLength[i]*2+1<=ACI_TX_RINGBUFFER_SIZE)
+                {
+                    memcpy(&temp[1],ctx->aciVarPacket[i],ctx->aciVarPacketLength[i]*2);
+                    temp[0]=crc;
+                    aciTxSendPacket(ctx, ACIMT_UPDATEVARPACKET+i,temp,ctx->aciVarPacketLength[i]*2+1);
+                }
+                ctx->aciUpdateVarPacketTimeOut[i]=ACI_UPDATE_PACKET_TIMEOUT(ctx->aciEngineRate);
             }
         }
 
-        if (aciUpdateCmdPacketTimeOut[i])
+        if (ctx->aciUpdateCmdPacketTimeOut[i])
         {
-       	 aciHeartBeatCnt=0;
-         aciUpdateCmdPacketTimeOut[i]--;
-         if (!aciUpdateCmdPacketTimeOut[i])
+       	 ctx->aciHeartBeatCnt=0;
+         ctx->aciUpdateCmdPacketTimeOut[i]--;
+         if (!ctx->aciUpdateCmdPacketTimeOut[i])
             {
               // packet was not acknoledged -> send again
-                unsigned char * temp;
+                unsigned char temp[ACI_TX_RINGBUFFER_SIZE];
+                ctx->aciLinkStats.cmdConfigResends++;
 
             	crc = 0xff;
-            	crc = aciUpdateCrc16(crc, aciCmdPacket[i],
-            			aciCmdPacketLength[i] * 2);
-
-            	temp = malloc(aciCmdPacketLength[i] * 2 + 2);
-            	memcpy(&temp[2], aciCmdPacket[i], aciCmdPacketLength[i] * 2);
-            	temp[0] = crc;
-            	temp[1] = aciCmdWithAck[i];
-                aciCmdPacketMagicCode[i]=crc;
-
-                aciTxSendPacket(ACIMT_UPDATECMDPACKET+i,temp,aciCmdPacketLength[i]*2+2);
-                aciUpdateCmdPacketTimeOut[i]=ACI_UPDATE_PACKET_TIMEOUT;
-                free(temp);
+            	crc = aciUpdateCrc16(crc, ctx->aciCmdPacket[i],
+            			ctx->aciCmdPacketLength[i] * 2);
+
+                ctx->aciCmdPacketMagicCode[i]=crc;
+                if (ctx->aciCmdPacketLength[i]*2+2<=ACI_TX_RINGBUFFER_SIZE)
+                {
+                    memcpy(&temp[2], ctx->aciCmdPacket[i], ctx->aciCmdPacketLength[i] * 2);
+                    temp[0] = crc;
+                    temp[1] = ctx->aciCmdWithAck[i];
+                    aciTxSendPacket(ctx, ACIMT_UPDATECMDPACKET+i,temp,ctx->aciCmdPacketLength[i]*2+2);
+                }
+                ctx->aciUpdateCmdPacketTimeOut[i]=ACI_UPDATE_PACKET_TIMEOUT(ctx->aciEngineRate);
             }
         }
 
-        if (aciUpdateParamPacketTimeOut[i])
+        if (ctx->aciUpdateParamPacketTimeOut[i])
         {
-       	 aciHeartBeatCnt=0;
-         aciUpdateParamPacketTimeOut[i]--;
-         if (!aciUpdateParamPacketTimeOut[i])
+       	 ctx->aciHeartBeatCnt=0;
+         ctx->aciUpdateParamPacketTimeOut[i]--;
+         if (!ctx->aciUpdateParamPacketTimeOut[i])
             {
                //packet was not acknoledged -> send again
-                unsigned char * temp;
+                unsigned char temp[ACI_TX_RINGBUFFER_SIZE];
                 crc=0xff;
-
-                crc=aciUpdateCrc16(crc,aciParamPacket[i],aciParamPacketLength[i]*2);
-
-                temp=(unsigned char*)malloc(aciParamPacketLength[i]*2+1);
-                memcpy(&temp[1],aciParamPacket[i],aciParamPacketLength[i]*2);
-                temp[0]=crc;
-                aciParamPacketMagicCode[i]=crc;
-
-                aciTxSendPacket(ACIMT_UPDATEPARAMPACKET+i,temp,aciParamPacketLength[i]*2+1);
-                aciUpdateParamPacketTimeOut[i]=ACI_UPDATE_PACKET_TIMEOUT;
-                free(temp);
+                ctx->aciLinkStats.paramConfigResends++;
+
+                crc=aciUpdateCrc16(crc,ctx->aciParamPacket[i],ctx->aciParamPacketLength[i]*2);
+
+                ctx->aciParamPacketMagicCode[i]=crc;
+                if (ctx->aciParamPacketLength[i]*2+1<=ACI_TX_RINGBUFFER_SIZE)
+                {
+                    memcpy(&temp[1],ctx->aciParamPacket[i],ctx->aciParamPacketLength[i]*2);
+                    temp[0]=crc;
+                    aciTxSendPacket(ctx, ACIMT_UPDATEPARAMPACKET+i,temp,ctx->aciParamPacketLength[i]*2+1);
+                }
+                ctx->aciUpdateParamPacketTimeOut[i]=ACI_UPDATE_PACKET_TIMEOUT(ctx->aciEngineRate);
             }
         }
     }
@@ -426,210 +585,398 @@ void aciEngine(void)
 	 {
 
 		// Check Status, if packet for send is avaible.
-		if ((aciCmdPacketSendStatus[i] == 1)) {
-			aciHeartBeatCnt=0;
-			// Send Commando
-			unsigned char *temp;
+		if ((ctx->aciCmdPacketSendStatus[i] == 1) && (ctx->aciCmdPacketContentBufferLength[i]+1<=ACI_TX_RINGBUFFER_SIZE)) {
+			ctx->aciHeartBeatCnt=0;
+			// Send Commando, the segments point to the variables, so they are not copied here
+			struct ACI_TX_SEGMENT seg[MEMPACKET_MAX_VARS+1];
 			unsigned char cnt=0;
-			temp = (unsigned char*)malloc(aciCmdPacketContentBufferLength[i]+1);
-			temp[cnt++]=aciCmdPacketMagicCode[i];
-
-			//add data to ringbuffer and calculate CRC
-			for (int z = 0; z < aciCmdPacketLength[i]; z++) {
-				memcpy(&temp[cnt],aciGetCommandItemById(aciCmdPacket[i][z])->ptrToVar,aciGetCommandItemById(aciCmdPacket[i][z])->varType >> 2);
-				cnt+=(aciGetCommandItemById(aciCmdPacket[i][z])->varType >> 2);
+			seg[cnt].data=&ctx->aciCmdPacketMagicCode[i];
+			seg[cnt++].length=1;
+			for (int z = 0; (z < ctx->aciCmdPacketLength[i]) && (cnt <= MEMPACKET_MAX_VARS); z++) {
+				struct ACI_MEM_TABLE_ENTRY *entry = aciCtxGetCommandItemById(ctx, ctx->aciCmdPacket[i][z]);
+				if (entry==NULL)
+					continue;
+				seg[cnt].data=entry->ptrToVar;
+				seg[cnt++].length=entry->varType >> 2;
 			}
-			aciTxSendPacket(ACIMT_CMDPACKET + i, &temp[0],	aciCmdPacketContentBufferLength[i] + 1);
+			aciTxSendSegments(ctx, ACIMT_CMDPACKET + i, seg, cnt);
 
-			if(!aciCmdWithAck[i])
-					aciCmdPacketSendStatus[i] = 0; // Commando sended, do not send it again
+			if(!ctx->aciCmdWithAck[i])
+					ctx->aciCmdPacketSendStatus[i] = 0; // Commando sended, do not send it again
 			else {
-				aciCmdPacketSendStatus[i] = 2;
+				ctx->aciCmdPacketSendStatus[i] = 2;
 			}
-			free(temp);
-		}  else if (aciCmdPacketSendStatus[i] == 2) {
-			aciCmdPacketCnt[i]++;
-			if(aciCmdPacketCnt[i]%(aciEngineRate/2)==0)
+		}  else if (ctx->aciCmdPacketSendStatus[i] == 2) {
+			ctx->aciCmdPacketCnt[i]++;
+			if(ctx->aciCmdPacketCnt[i]%(ctx->aciEngineRate/2)==0)
 				{
-				aciCmdPacketCnt[i]=0;
-				aciCmdPacketSendStatus[i] = 1;
+				ctx->aciCmdPacketCnt[i]=0;
+				ctx->aciCmdPacketSendStatus[i] = 1;
+				ctx->aciLinkStats.cmdPacketResends++;
 				}
 		}
 
 		// Check Status, if packet for send is available.
-		if (!aciParamPacketSendStatus[i])
+		if (!ctx->aciParamPacketSendStatus[i])
 			continue;
-		else if (aciParamPacketSendStatus[i] == 1) {
+		else if ((ctx->aciParamPacketSendStatus[i] == 1) && (ctx->aciParamPacketContentBufferLength[i]+1<=ACI_TX_RINGBUFFER_SIZE)) {
 
 			// Send Parameter
-			unsigned char *temp;
+			struct ACI_TX_SEGMENT seg[MEMPACKET_MAX_VARS+1];
 			unsigned char cnt=0;
-			temp = (unsigned char*)malloc(aciParamPacketContentBufferLength[i]+1);
-			temp[cnt++]=aciParamPacketMagicCode[i];
-			for (int z = 0; z < aciParamPacketLength[i]; z++) {
-				memcpy(&temp[cnt],aciGetParameterItemById(aciParamPacket[i][z])->ptrToVar,aciGetParameterItemById(aciParamPacket[i][z])->varType >> 2);
-				cnt+=(aciGetParameterItemById(aciParamPacket[i][z])->varType >> 2);
+			seg[cnt].data=&ctx->aciParamPacketMagicCode[i];
+			seg[cnt++].length=1;
+			for (int z = 0; (z < ctx->aciParamPacketLength[i]) && (cnt <= MEMPACKET_MAX_VARS); z++) {
+				struct ACI_MEM_TABLE_ENTRY *entry = aciCtxGetParameterItemById(ctx, ctx->aciParamPacket[i][z]);
+				if (entry==NULL)
+					continue;
+				seg[cnt].data=entry->ptrToVar;
+				seg[cnt++].length=entry->varType >> 2;
 			}
-			aciTxSendPacket(ACIMT_PARAMPACKET + i, &temp[0], aciParamPacketContentBufferLength[i] + 1);
-			aciParamPacketSendStatus[i] = 2;
-			free(temp);
-		} else if (aciParamPacketSendStatus[i] == 2) {
-			aciParPacketCnt[i]++;
-			if(aciParPacketCnt[i]%(aciEngineRate/2)==0)
+			aciTxSendSegments(ctx, ACIMT_PARAMPACKET + i, seg, cnt);
+			ctx->aciParamPacketSendStatus[i] = 2;
+		} else if (ctx->aciParamPacketSendStatus[i] == 2) {
+			ctx->aciParPacketCnt[i]++;
+			if(ctx->aciParPacketCnt[i]%(ctx->aciEngineRate/2)==0)
 				{
-				aciParPacketCnt[i]=0;
-				aciParamPacketSendStatus[i] = 1;
+				ctx->aciParPacketCnt[i]=0;
+				ctx->aciParamPacketSendStatus[i] = 1;
 				}
 		}
 
 	 }
 
-    aciHeartBeatCnt++;
+    ctx->aciHeartBeatCnt++;
 
-    if (aciHeartBeatCnt>=(aciEngineRate/aciHeartBeatRate))
+    if (ctx->aciHeartBeatCnt>=(ctx->aciEngineRate/ctx->aciHeartBeatRate))
     {
-       aciHeartBeatCnt=0;
-      aciTxSendPacket(ACIMT_HEARBEAT,NULL,0);
+       ctx->aciHeartBeatCnt=0;
+      aciTxSendPacket(ctx, ACIMT_HEARBEAT,NULL,0);
     }
 }
 
-void aciSetEngineRate(const unsigned short callsPerSecond, const unsigned short heartbeat)
+void aciCtxSetEngineRate(aci_context_t * ctx, const unsigned short callsPerSecond, const unsigned short heartbeat)
 {
-     aciEngineRate=callsPerSecond;
-     aciHeartBeatRate=heartbeat;
+     ctx->aciEngineRate=callsPerSecond;
+     ctx->aciHeartBeatRate=heartbeat;
 }     
 
-#ifdef __cplusplus
-void aciSetSendDataCallback(void (*aciSendDataCallback_func)(unsigned char * data, unsigned short cnt))
-#else
-void aciSetSendDataCallback(void (*aciSendDataCallback_func)(void * data, unsigned short cnt))
-#endif
+void aciCtxSetListRequestWindow(aci_context_t * ctx, unsigned char window)
 {
- aciSendData=aciSendDataCallback_func; 
+	if (window < 1)
+		window = 1;
+	if (window > ACI_LIST_REQUEST_WINDOW_MAX)
+		window = ACI_LIST_REQUEST_WINDOW_MAX;
+	ctx->aciListRequestWindow = window;
 }
 
+unsigned char aciListDownloadStart(aci_context_t * ctx, struct ACI_LIST_DOWNLOAD * dl, unsigned char requestType, unsigned char * data, unsigned short count)
+{
+	unsigned short i;
+	unsigned int buckets = 2;
+	unsigned int b;
+
+	aciListDownloadFree(ctx, dl);
+	if (!count)
+		return 1;
+	//at most half of the buckets are used, that keeps the probe sequences short
+	while (buckets < 2 * (unsigned int) count)
+		buckets <<= 1;
+	//one block for all arrays, the pointers first to keep them aligned
+	dl->entry = aciMalloc(ctx, count * (sizeof(struct ACI_MEM_VAR_TABLE *) + sizeof(unsigned short) + 1) + buckets * sizeof(unsigned short));
+	if (!dl->entry)
+		return 0;
+	dl->id = (unsigned short *) &dl->entry[count];
+	dl->slot = &dl->id[count];
+	dl->received = (unsigned char *) &dl->slot[buckets];
+	dl->slotMask = buckets - 1;
+	memset(dl->slot, 0, buckets * sizeof(unsigned short));
+	dl->length = count;
+	for (i = 0; i < count; i++) {
+		dl->id[i] = (data[i * 2 + 1] << 8) | data[i * 2];
+		dl->entry[i] = NULL;
+		dl->received[i] = 0;
+		//an id listed twice is only looked up at its first position
+		if (aciListDownloadSlot(dl, dl->id[i]) < count)
+			continue;
+		for (b = (dl->id[i] ^ (dl->id[i] >> 7)) & dl->slotMask; dl->slot[b]; b = (b + 1) & dl->slotMask)
+			;
+		dl->slot[b] = i + 1;
+	}
+	dl->missing = count;
+	aciListDownloadRequest(ctx, dl, requestType);
+	return 1;
+}
 
-void aciResetVarPacketContent(unsigned char packetId)
+void aciListDownloadRequest(aci_context_t * ctx, struct ACI_LIST_DOWNLOAD * dl, unsigned char requestType)
 {
-    if (aciVarPacket[packetId])
-       free(aciVarPacket[packetId]);
-    aciVarPacket[packetId]=NULL;
-    aciVarPacketLength[packetId]=0;
+	unsigned short window = 1;
+	unsigned short inFlight = dl->inFlight;
+	unsigned short cnt = 0;
+
+	//old devices send only one entry per request and drop the others, they get one request per list at a time.
+	//Otherwise the window is shared by all lists, the device queues their requests together
+	if (ctx->aciInfo.flags & ACI_INFO_FLAG_QUEUED_TABLE_REQUESTS) {
+		window = ctx->aciListRequestWindow;
+		inFlight = ctx->aciVarListDownload.inFlight + ctx->aciCmdListDownload.inFlight + ctx->aciParamListDownload.inFlight;
+	}
+
+	while ((inFlight + cnt < window) && (dl->next + cnt < dl->length))
+		cnt++;
+	if (!cnt)
+		return;
+	//the ids to request lie next to each other
+	aciTxSendPacket(ctx, requestType, &dl->id[dl->next], cnt * 2);
+	dl->next += cnt;
+	dl->inFlight += cnt;
+	dl->timeOut = ACI_REQUEST_LIST_TIMEOUT(ctx->aciEngineRate);
 }
 
-void aciResetCmdPacketContent(unsigned char packetId)
+void aciListDownloadRetry(aci_context_t * ctx, struct ACI_LIST_DOWNLOAD * dl, unsigned char requestType)
 {
-    if (aciCmdPacket[packetId])
-       free(aciCmdPacket[packetId]);
-    aciCmdPacket[packetId]=NULL;
-    aciCmdPacketLength[packetId]=0;
+	unsigned short ids[ACI_LIST_REQUEST_WINDOW_MAX];
+	unsigned short cnt = 0;
+	unsigned short i;
+
+	if (dl->timeOut) {
+		dl->timeOut--;
+		return;
+	}
+	//only the ids, which did not arrive, are requested again
+	for (i = 0; (i < dl->next) && (cnt < ACI_LIST_REQUEST_WINDOW_MAX); i++)
+		if (!dl->received[i])
+			ids[cnt++] = dl->id[i];
+	if (cnt)
+		aciTxSendPacket(ctx, requestType, ids, cnt * 2);
+	dl->timeOut = ACI_REQUEST_LIST_TIMEOUT(ctx->aciEngineRate);
 }
 
-void aciResetParPacketContent(unsigned char packetId)
+unsigned short aciListDownloadSlot(struct ACI_LIST_DOWNLOAD * dl, unsigned short id)
 {
-    if (aciParamPacket[packetId])
-       free(aciParamPacket[packetId]);
-    aciParamPacket[packetId]=NULL;
-    aciParamPacketLength[packetId]=0;
+	unsigned int b;
+
+	for (b = (id ^ (id >> 7)) & dl->slotMask; dl->slot[b]; b = (b + 1) & dl->slotMask)
+		if (dl->id[dl->slot[b] - 1] == id)
+			return dl->slot[b] - 1;
+	return dl->length;
+}
+
+unsigned char aciListDownloadEntry(aci_context_t * ctx, struct ACI_LIST_DOWNLOAD * dl, unsigned char requestType, struct ACI_MEM_VAR_TABLE * start,
+		struct ACI_MEM_TABLE_INDEX * index, struct ACI_MEM_VAR_TABLE ** current, unsigned short * magicCode, unsigned short * loaded)
+{
+	unsigned short id = (ctx->aciRxDataBuffer[1] << 8) | (ctx->aciRxDataBuffer[0]);
+	struct ACI_MEM_VAR_TABLE * tail;
+	unsigned short i;
+	unsigned char known;
+
+	//only requested ids, every one once
+	i = aciListDownloadSlot(dl, id);
+	if ((i >= dl->next) || (dl->received[i]))
+		return 0;
+
+	//ids, which are already in the table, are not stored again
+	if (index->valid)
+		known = aciLookupTableIndex(index, id) != NULL;
+	else {
+		for (tail = start->next; tail; tail = tail->next)
+			if (tail->tableEntry.id == id)
+				break;
+		known = tail != NULL;
+	}
+	if (!known) {
+		dl->entry[i] = aciMalloc(ctx, sizeof(struct ACI_MEM_VAR_TABLE));
+		//no memory, ask for it again later
+		if (!dl->entry[i])
+			return 0;
+		memcpy(&(dl->entry[i]->tableEntry), &ctx->aciRxDataBuffer[0], sizeof(struct ACI_MEM_TABLE_ENTRY)-sizeof(void*));
+		dl->entry[i]->next = NULL;
+	}
+	dl->received[i] = 1;
+	dl->inFlight--;
+	dl->missing--;
+	//the time out runs from the last entry, a full window takes a while to arrive
+	dl->timeOut = ACI_REQUEST_LIST_TIMEOUT(ctx->aciEngineRate);
+
+	if (dl->missing) {
+		aciListDownloadRequest(ctx, dl, requestType);
+		return 0;
+	}
+
+	//complete: link the entries in the order of the device, the magic code depends on it
+	for (tail = start; tail->next; tail = tail->next)
+		;
+	for (i = 0; i < dl->length; i++) {
+		if (!dl->entry[i])
+			continue;
+		tail->next = dl->entry[i];
+		tail = tail->next;
+		dl->entry[i] = NULL;
+		(*loaded)++;
+		*magicCode = aciUpdateCrc16(*magicCode, &tail->tableEntry.id, 2);
+		*magicCode = aciUpdateCrc16(*magicCode, &tail->tableEntry.varType, 1);
+	}
+	*current = tail;
+	aciListDownloadFree(ctx, dl);
+	return 1;
+}
+
+void aciListDownloadFree(aci_context_t * ctx, struct ACI_LIST_DOWNLOAD * dl)
+{
+	unsigned short i;
+
+	if (dl->entry)
+		for (i = 0; i < dl->length; i++)
+			aciFree(ctx, dl->entry[i]);
+	aciFree(ctx, dl->entry);
+	memset(dl, 0, sizeof(struct ACI_LIST_DOWNLOAD));
+}
+
+void aciCtxSetSendDataCallback(aci_context_t * ctx, void (*aciSendDataCallback_func)(void * userData, void * data, unsigned short cnt))
+{
+ ctx->aciSendData=aciSendDataCallback_func; 
+}
+
+void aciCtxSetSendSegmentsCallback(aci_context_t * ctx, void (*aciSendSegmentsCallback_func)(void * userData, const struct ACI_TX_SEGMENT * segments, unsigned char count))
+{
+	ctx->aciSendSegments=aciSendSegmentsCallback_func;
+}
+
+
+void aciCtxResetVarPacketContent(aci_context_t * ctx, unsigned char packetId)
+{
+    if (ctx->aciVarPacket[packetId])
+       aciFree(ctx, ctx->aciVarPacket[packetId]);
+    ctx->aciVarPacket[packetId]=NULL;
+    ctx->aciVarPacketLength[packetId]=0;
+    ctx->aciVarPacketDecodePlanLength[packetId]=0;
+}
+
+void aciCtxResetCmdPacketContent(aci_context_t * ctx, unsigned char packetId)
+{
+    if (ctx->aciCmdPacket[packetId])
+       aciFree(ctx, ctx->aciCmdPacket[packetId]);
+    ctx->aciCmdPacket[packetId]=NULL;
+    ctx->aciCmdPacketLength[packetId]=0;
+}
+
+void aciCtxResetParPacketContent(aci_context_t * ctx, unsigned char packetId)
+{
+    if (ctx->aciParamPacket[packetId])
+       aciFree(ctx, ctx->aciParamPacket[packetId]);
+    ctx->aciParamPacket[packetId]=NULL;
+    ctx->aciParamPacketLength[packetId]=0;
 }
 
 /** get length of ID list of Packet **/
-unsigned short aciGetVarPacketLength(unsigned char packetId)
+unsigned short aciCtxGetVarPacketLength(aci_context_t * ctx, unsigned char packetId)
 {
-         return aciVarPacketLength[packetId];         
+         return ctx->aciVarPacketLength[packetId];         
 }
 
 /* get length of ID list of Packet */
-unsigned short aciGetCmdPacketLength(unsigned char packetId)
+unsigned short aciCtxGetCmdPacketLength(aci_context_t * ctx, unsigned char packetId)
 {
-         return aciCmdPacketLength[packetId];
+         return ctx->aciCmdPacketLength[packetId];
 }
 
-unsigned short aciGetParPacketLength(unsigned char packetId)
+unsigned short aciCtxGetParPacketLength(aci_context_t * ctx, unsigned char packetId)
 {
-         return aciParamPacketLength[packetId];
+         return ctx->aciParamPacketLength[packetId];
 }
 
 /**get variable packet item by index **/
-unsigned short aciGetVarPacketItem(unsigned char packetId, unsigned short index)
+unsigned short aciCtxGetVarPacketItem(aci_context_t * ctx, unsigned char packetId, unsigned short index)
 {
- if (index<aciGetVarPacketLength(packetId))
-    return aciVarPacket[packetId][index];
+ if (index<aciCtxGetVarPacketLength(ctx, packetId))
+    return ctx->aciVarPacket[packetId][index];
  else
     return 0;         
 }
 
-unsigned short aciGetCmdPacketItem(unsigned char packetId, unsigned short index)
+unsigned short aciCtxGetCmdPacketItem(aci_context_t * ctx, unsigned char packetId, unsigned short index)
 {
- if (index<aciGetCmdPacketLength(packetId))
-    return aciCmdPacket[packetId][index];
+ if (index<aciCtxGetCmdPacketLength(ctx, packetId))
+    return ctx->aciCmdPacket[packetId][index];
  else
     return 0;
 }
 
-unsigned short aciGetParPacketItem(unsigned char packetId, unsigned short index)
+unsigned short aciCtxGetParPacketItem(aci_context_t * ctx, unsigned char packetId, unsigned short index)
 {
- if (index<aciGetParPacketLength(packetId))
-    return aciParamPacket[packetId][index];
+ if (index<aciCtxGetParPacketLength(ctx, packetId))
+    return ctx->aciParamPacket[packetId][index];
  else
     return 0;
 }
 
-unsigned short aciGetVarPacketRate(unsigned char packetId)
+unsigned short aciCtxGetVarPacketRate(aci_context_t * ctx, unsigned char packetId)
+{
+	if (packetId >= MAX_VAR_PACKETS)
+		return 0;
+	return ctx->aciVarPacketTransmissionRate[packetId];
+}
+
+unsigned char aciCtxGetVarPacketCount(aci_context_t * ctx)
 {
-	return aciVarPacketTransmissionRate[packetId];
+	return ctx->aciVarPacketCount;
 }
 
-void aciGetVarPacketRateFromDevice()
+void aciCtxGetVarPacketRateFromDevice(aci_context_t * ctx)
 {
-	 aciTxSendPacket(ACIMT_GETPACKETRATE,NULL,0);
+	 aciTxSendPacket(ctx, ACIMT_GETPACKETRATE,NULL,0);
 }
 
-void aciAddContentToVarPacket(unsigned char packetId, unsigned short id,  void *var_ptr)
+void aciCtxAddContentToVarPacket(aci_context_t * ctx, unsigned char packetId, unsigned short id,  void *var_ptr)
 {
 	if(var_ptr==NULL) return;
-	if(aciGetVariableItemById(id)==NULL) return;
+	if(aciCtxGetVariableItemById(ctx, id)==NULL) return;
 	if(packetId>=MAX_VAR_PACKETS) return;
-     if (aciVarPacket[packetId]==NULL)
+     if (ctx->aciVarPacket[packetId]==NULL)
         {
-           aciVarPacket[packetId]=malloc(2);
-           aciVarPacket[packetId][0]=id;
-           aciVarPacketLength[packetId]=1;
-           aciGetVariableItemById(id)->ptrToVar=var_ptr;
+           ctx->aciVarPacket[packetId]=aciMalloc(ctx, 2);
+           if (ctx->aciVarPacket[packetId]==NULL)
+              return;
+           ctx->aciVarPacket[packetId][0]=id;
+           ctx->aciVarPacketLength[packetId]=1;
+           aciCtxGetVariableItemById(ctx, id)->ptrToVar=var_ptr;
         } else {
            unsigned short * ptr;
            int i;
  
            //check for double entries
-           for (i=0;i<aciVarPacketLength[packetId];i++)
-               if (aciVarPacket[packetId][i]==id)
+           for (i=0;i<ctx->aciVarPacketLength[packetId];i++)
+               if (ctx->aciVarPacket[packetId][i]==id)
                   return;
                   
-           aciVarPacketLength[packetId]++;
-           ptr=malloc(2*aciVarPacketLength[packetId]);
-           memcpy(ptr,aciVarPacket[packetId],(aciVarPacketLength[packetId]-1)*2);
-           free(aciVarPacket[packetId]);
-           aciVarPacket[packetId]=ptr;
-           aciVarPacket[packetId][aciVarPacketLength[packetId]-1]=id;
-           aciGetVariableItemById(id)->ptrToVar=var_ptr;
+           ptr=aciMalloc(ctx, 2*(ctx->aciVarPacketLength[packetId]+1));
+           if (ptr==NULL)
+              return;
+           ctx->aciVarPacketLength[packetId]++;
+           memcpy(ptr,ctx->aciVarPacket[packetId],(ctx->aciVarPacketLength[packetId]-1)*2);
+           aciFree(ctx, ctx->aciVarPacket[packetId]);
+           ctx->aciVarPacket[packetId]=ptr;
+           ctx->aciVarPacket[packetId][ctx->aciVarPacketLength[packetId]-1]=id;
+           aciCtxGetVariableItemById(ctx, id)->ptrToVar=var_ptr;
         }
 }
 
-void aciAddContentToCmdPacket(const unsigned char packetId,const unsigned short id, void *var_ptr)
+void aciCtxAddContentToCmdPacket(aci_context_t * ctx, const unsigned char packetId,const unsigned short id, void *var_ptr)
 {
 	if(var_ptr==NULL) return;
-	if(aciGetCommandItemById(id)==NULL) return;
+	if(aciCtxGetCommandItemById(ctx, id)==NULL) return;
 	if(packetId>=MAX_VAR_PACKETS) return;
 	if(packetId<MAX_VAR_PACKETS) {
-		aciCmdPacketUpdated[packetId]=1;
+		ctx->aciCmdPacketUpdated[packetId]=1;
 
-     if (aciCmdPacket[packetId]==NULL)
+     if (ctx->aciCmdPacket[packetId]==NULL)
         {
-           aciCmdPacket[packetId]=malloc(2);
-           aciCmdPacket[packetId][0]=id;
-           aciCmdPacketLength[packetId]=1;
-           if(aciGetCommandItemById(id)==NULL) return;
-           aciGetCommandItemById(id)->ptrToVar=var_ptr;
+           ctx->aciCmdPacket[packetId]=aciMalloc(ctx, 2);
+           if (ctx->aciCmdPacket[packetId]==NULL)
+              return;
+           ctx->aciCmdPacket[packetId][0]=id;
+           ctx->aciCmdPacketLength[packetId]=1;
+           if(aciCtxGetCommandItemById(ctx, id)==NULL) return;
+           aciCtxGetCommandItemById(ctx, id)->ptrToVar=var_ptr;
         }
      else
         {
@@ -637,33 +984,41 @@ void aciAddContentToCmdPacket(const unsigned char packetId,const unsigned short
            int i;
 
            //check for double entries
-           for (i=0;i<aciCmdPacketLength[packetId];i++)
-               if (aciCmdPacket[packetId][i]==id)
+           for (i=0;i<ctx->aciCmdPacketLength[packetId];i++)
+               if (ctx->aciCmdPacket[packetId][i]==id)
                   return;
 
-           aciCmdPacketLength[packetId]++;
-           ptr=malloc(2*aciCmdPacketLength[packetId]);
-           memcpy(ptr,aciCmdPacket[packetId],(aciCmdPacketLength[packetId]-1)*2);
-           free(aciCmdPacket[packetId]);
-           aciCmdPacket[packetId]=ptr;
-           aciCmdPacket[packetId][aciCmdPacketLength[packetId]-1]=id;
-           aciGetCommandItemById(id)->ptrToVar=var_ptr;
+           // the engine sends at most MEMPACKET_MAX_VARS items per packet
+           if (ctx->aciCmdPacketLength[packetId]>=MEMPACKET_MAX_VARS)
+              return;
+
+           ptr=aciMalloc(ctx, 2*(ctx->aciCmdPacketLength[packetId]+1));
+           if (ptr==NULL)
+              return;
+           ctx->aciCmdPacketLength[packetId]++;
+           memcpy(ptr,ctx->aciCmdPacket[packetId],(ctx->aciCmdPacketLength[packetId]-1)*2);
+           aciFree(ctx, ctx->aciCmdPacket[packetId]);
+           ctx->aciCmdPacket[packetId]=ptr;
+           ctx->aciCmdPacket[packetId][ctx->aciCmdPacketLength[packetId]-1]=id;
+           aciCtxGetCommandItemById(ctx, id)->ptrToVar=var_ptr;
         }
 	}
 }
 
-void aciAddContentToParamPacket(unsigned char packetId,unsigned short id, void *var_ptr) {
+void aciCtxAddContentToParamPacket(aci_context_t * ctx, unsigned char packetId,unsigned short id, void *var_ptr) {
 	if(var_ptr==NULL) return;
-	if(aciGetParameterItemById(id)==NULL) return;
+	if(aciCtxGetParameterItemById(ctx, id)==NULL) return;
 	if(packetId>=MAX_VAR_PACKETS) return;
 	if(packetId<MAX_VAR_PACKETS) {
 
-     if (aciParamPacket[packetId]==NULL)
+     if (ctx->aciParamPacket[packetId]==NULL)
         {
-           aciParamPacket[packetId]=malloc(2);
-           aciParamPacket[packetId][0]=id;
-           aciParamPacketLength[packetId]=1;
-           aciGetParameterItemById(id)->ptrToVar=var_ptr;
+           ctx->aciParamPacket[packetId]=aciMalloc(ctx, 2);
+           if (ctx->aciParamPacket[packetId]==NULL)
+              return;
+           ctx->aciParamPacket[packetId][0]=id;
+           ctx->aciParamPacketLength[packetId]=1;
+           aciCtxGetParameterItemById(ctx, id)->ptrToVar=var_ptr;
         }
      else
         {
@@ -671,52 +1026,59 @@ void aciAddContentToParamPacket(unsigned char packetId,unsigned short id, void *
            int i;
 
            //check for double entries
-           for (i=0;i<aciParamPacketLength[packetId];i++)
-               if (aciParamPacket[packetId][i]==id)
+           for (i=0;i<ctx->aciParamPacketLength[packetId];i++)
+               if (ctx->aciParamPacket[packetId][i]==id)
                   return;
 
-           aciParamPacketLength[packetId]++;
-           ptr=malloc(2*aciParamPacketLength[packetId]);
-           memcpy(ptr,aciParamPacket[packetId],(aciParamPacketLength[packetId]-1)*2);
-           free(aciParamPacket[packetId]);
-           aciParamPacket[packetId]=ptr;
-           aciParamPacket[packetId][aciParamPacketLength[packetId]-1]=id;
-           aciGetParameterItemById(id)->ptrToVar=var_ptr;
+           // the engine sends at most MEMPACKET_MAX_VARS items per packet
+           if (ctx->aciParamPacketLength[packetId]>=MEMPACKET_MAX_VARS)
+              return;
+
+           ptr=aciMalloc(ctx, 2*(ctx->aciParamPacketLength[packetId]+1));
+           if (ptr==NULL)
+              return;
+           ctx->aciParamPacketLength[packetId]++;
+           memcpy(ptr,ctx->aciParamPacket[packetId],(ctx->aciParamPacketLength[packetId]-1)*2);
+           aciFree(ctx, ctx->aciParamPacket[packetId]);
+           ctx->aciParamPacket[packetId]=ptr;
+           ctx->aciParamPacket[packetId][ctx->aciParamPacketLength[packetId]-1]=id;
+           aciCtxGetParameterItemById(ctx, id)->ptrToVar=var_ptr;
         }
-     aciTxSendPacket(ACIMT_PARAM, &id,2);
+     aciTxSendPacket(ctx, ACIMT_PARAM, &id,2);
 	}
 }
 
 
-struct ACI_MEM_VAR_ASSIGN_TABLE *aciVarGetAssignmentById(unsigned short id) {
-	aciVarAssignTableCurrent = aciVarAssignTableStart;
+struct ACI_MEM_VAR_ASSIGN_TABLE *aciVarGetAssignmentById(aci_context_t * ctx, unsigned short id) {
+	ctx->aciVarAssignTableCurrent = ctx->aciVarAssignTableStart;
 
 	//check for existing variable assignments
-	while (aciVarAssignTableCurrent->next) {
-		aciVarAssignTableCurrent = aciVarAssignTableCurrent->next;
-		if (aciVarAssignTableCurrent->id == id)
-			return aciVarAssignTableCurrent;
+	while (ctx->aciVarAssignTableCurrent->next) {
+		ctx->aciVarAssignTableCurrent = ctx->aciVarAssignTableCurrent->next;
+		if (ctx->aciVarAssignTableCurrent->id == id)
+			return ctx->aciVarAssignTableCurrent;
 	}
 	return NULL;
 }
 
-void aciSetVarPacketTransmissionRate(unsigned char packetId, unsigned short callsPerSecond)
+void aciCtxSetVarPacketTransmissionRate(aci_context_t * ctx, unsigned char packetId, unsigned short callsPerSecond)
 {
 	if(packetId<MAX_VAR_PACKETS)
 	{
-		aciVarPacketTransmissionRate[packetId]=callsPerSecond;
+		ctx->aciVarPacketTransmissionRate[packetId]=callsPerSecond;
 	}
 }
 
-void aciVarPacketUpdateTransmissionRates(void)
+void aciCtxVarPacketUpdateTransmissionRates(aci_context_t * ctx)
 {
-	aciTxSendPacket(ACIMT_CHANGEPACKETRATE,&aciVarPacketTransmissionRate[0],sizeof(aciVarPacketTransmissionRate));
+	//older devices only take exactly one rate per packet they have
+	aciTxSendPacket(ctx, ACIMT_CHANGEPACKETRATE,&ctx->aciVarPacketTransmissionRate[0],ctx->aciVarPacketCount*2);
 }
 
 
 
 
-char aciGetVarById(void * ptrToVar, const unsigned char varType, const unsigned short id)
+char aciCtxGetVarById(aci_context_t * ctx, void * ptrToVar, const unsigned char varType, const unsigned short id)
 {
   int i;
   
@@ -724,25 +1086,25 @@ char aciGetVarById(void * ptrToVar, const unsigned char varType, const unsigned
   {
       int z;
       unsigned char * ptr;
-      if (!aciVarPacketContentBufferValid[i])
+      if (!ctx->aciVarPacketContentBufferValid[i])
          continue;
-      ptr=aciVarPacketContentBuffer[i];
-      for (z=0;z<aciVarPacketLength[i];z++)
+      ptr=ctx->aciVarPacketContentBuffer[i];
+      for (z=0;z<ctx->aciVarPacketLength[i];z++)
       {
           struct ACI_MEM_TABLE_ENTRY *entry;
           
-          entry=aciGetVariableItemById(aciVarPacket[i][z]);
-          if ((aciVarPacket[i][z]==id) && (entry))
+          entry=aciCtxGetVariableItemById(ctx, ctx->aciVarPacket[i][z]);
+          if ((ctx->aciVarPacket[i][z]==id) && (entry))
           {
 
              if (entry->varType==varType)
              {
+            	//with direct decoding the content buffer is not filled, the assigned variable holds the value
+            	if (ctx->aciVarPacketDirectDecode)
+            		ptr=entry->ptrToVar;
+
             	if(ptrToVar)
             		memcpy(ptrToVar,ptr,varType>>2);
-            	else {
-            		ptrToVar=malloc(varType>>2);
-            		memcpy(ptrToVar,ptr,varType>>2);
-            	}
                 return 1;
              }
           }
@@ -758,432 +1120,565 @@ char aciGetVarById(void * ptrToVar, const unsigned char varType, const unsigned
 
 }
 
-void aciSynchronizeVars(void)
+void aciCtxSynchronizeVars(aci_context_t * ctx)
 {
   int i;
   
   for (i=0;i<MAX_VAR_PACKETS;i++)
   {
-      int z;
-      unsigned char * ptr;
-      if (!aciVarPacketContentBufferValid[i])
+      //nothing to do for packets, which were not received since the last call
+      if ((!ctx->aciVarPacketContentBufferValid[i]) || (!ctx->aciVarPacketContentBufferUpdated[i]))
          continue;
 
-      ptr=aciVarPacketContentBuffer[i];
-      for (z=0;z<aciVarPacketLength[i];z++)
-      {
-          struct ACI_MEM_TABLE_ENTRY *entry;
-          entry=aciGetVariableItemById(aciVarPacket[i][z]);
-          if ((entry))
-          {
-             memcpy(entry->ptrToVar,ptr,entry->varType>>2);
-          }
-          //entry should always exist!
-          if (entry)
-             ptr+=entry->varType>>2;
-          else
-             return; //otherwise stop sync!
-      }
+      ctx->aciVarPacketContentBufferUpdated[i]=0;
+      aciRunVarPacketDecodePlan(ctx, i,ctx->aciVarPacketContentBuffer[i]);
   }
 }
 
+void aciCtxSetVarPacketDirectDecode(aci_context_t * ctx, unsigned char enable)
+{
+	int i;
+
+	ctx->aciVarPacketDirectDecode=enable;
+	for (i=0;i<MAX_VAR_PACKETS;i++)
+		ctx->aciVarPacketContentBufferUpdated[i]=0;
+}
+
+void aciCompileVarPacketDecodePlan(aci_context_t * ctx, unsigned char packetId)
+{
+	int i;
+	unsigned short offset = 0;
+	unsigned short runs = 0;
+
+	aciFree(ctx, ctx->aciVarPacketDecodePlan[packetId]);
+	ctx->aciVarPacketDecodePlan[packetId] = aciMalloc(ctx, sizeof(struct ACI_VAR_PACKET_DECODE_RUN) * (ctx->aciVarPacketLength[packetId] + 1));
+	ctx->aciVarPacketDecodePlanLength[packetId] = 0;
+	if (!ctx->aciVarPacketDecodePlan[packetId])
+		return;
+
+	for (i = 0; i < ctx->aciVarPacketLength[packetId]; i++) {
+		struct ACI_MEM_TABLE_ENTRY *entry;
+		unsigned short size;
+
+		entry = aciCtxGetVariableItemById(ctx, ctx->aciVarPacket[packetId][i]);
+		//entry should always exist! otherwise stop here like the sync always did
+		if (!entry)
+			break;
+		size = entry->varType >> 2;
+
+		//merge with the previous run, if the variable follows it in the packet and in memory
+		if ((runs) && (ctx->aciVarPacketDecodePlan[packetId][runs-1].dst + ctx->aciVarPacketDecodePlan[packetId][runs-1].size == (unsigned char *) entry->ptrToVar))
+			ctx->aciVarPacketDecodePlan[packetId][runs-1].size += size;
+		else {
+			ctx->aciVarPacketDecodePlan[packetId][runs].offset = offset;
+			ctx->aciVarPacketDecodePlan[packetId][runs].size = size;
+			ctx->aciVarPacketDecodePlan[packetId][runs].dst = (unsigned char *) entry->ptrToVar;
+			runs++;
+		}
+		offset += size;
+	}
+	ctx->aciVarPacketDecodePlanLength[packetId] = runs;
+}
+
+void aciRunVarPacketDecodePlan(aci_context_t * ctx, unsigned char packetId, unsigned char * content)
+{
+	struct ACI_VAR_PACKET_DECODE_RUN * run = ctx->aciVarPacketDecodePlan[packetId];
+	struct ACI_VAR_PACKET_DECODE_RUN * end = run + ctx->aciVarPacketDecodePlanLength[packetId];
+
+	for (;run<end;run++)
+		memcpy(run->dst,&content[run->offset],run->size);
+}
+
+void aciStoreVarPacketSnapshot(aci_context_t * ctx, unsigned char packetId, unsigned char * content, unsigned short length)
+{
+	unsigned int seq = ctx->aciVarPacketSnapshotSeq[packetId] + 1;
+
+	//readers are on buffer (seq-1)&1, so the other one is free
+	if (length)
+		memcpy(ctx->aciVarPacketSnapshot[packetId][seq & 1], content, length);
+	ctx->aciVarPacketSnapshotLength[packetId][seq & 1] = length;
+	ctx->aciVarPacketSnapshotTime[packetId][seq & 1] = length ? ctx->aciRxTime : 0;
+	ACI_MEMORY_BARRIER();
+	ctx->aciVarPacketSnapshotSeq[packetId] = seq;
+	ACI_MEMORY_BARRIER();
+}
+
+unsigned char aciCtxGetVarPacketSnapshot(aci_context_t * ctx, unsigned char packetId, const void * base, void * copy, unsigned int size)
+{
+	return aciCtxGetVarPacketSnapshotTimed(ctx, packetId, base, copy, size, NULL);
+}
+
+unsigned char aciCtxGetVarPacketSnapshotTimed(aci_context_t * ctx, unsigned char packetId, const void * base, void * copy, unsigned int size, double * rxTime)
+{
+	const unsigned char * start = (const unsigned char *) base;
+	const unsigned char * stop = start + size;
+	struct ACI_VAR_PACKET_DECODE_RUN * run;
+	struct ACI_VAR_PACKET_DECODE_RUN * end;
+	unsigned char * content;
+	unsigned short length;
+	unsigned int seq;
+
+	if (packetId >= MAX_VAR_PACKETS)
+		return 0;
+
+	for (;;) {
+		seq = ctx->aciVarPacketSnapshotSeq[packetId];
+		ACI_MEMORY_BARRIER();
+		content = ctx->aciVarPacketSnapshot[packetId][seq & 1];
+		length = ctx->aciVarPacketSnapshotLength[packetId][seq & 1];
+		run = ctx->aciVarPacketDecodePlan[packetId];
+		end = run + ctx->aciVarPacketDecodePlanLength[packetId];
+
+		//copy the part of every run, which lies inside [base, base+size)
+		for (; (length) && (run < end); run++) {
+			const unsigned char * lo = run->dst < start ? start : run->dst;
+			const unsigned char * hi = run->dst + run->size > stop ? stop : run->dst + run->size;
+
+			if ((lo < hi) && (run->offset + run->size <= length))
+				memcpy((unsigned char *) copy + (lo - start), &content[run->offset + (lo - run->dst)], hi - lo);
+		}
+		ACI_MEMORY_BARRIER();
+		if (rxTime)
+			*rxTime = ctx->aciVarPacketSnapshotTime[packetId][seq & 1];
+		//the writer did not touch our buffer meanwhile
+		if (ctx->aciVarPacketSnapshotSeq[packetId] == seq)
+			return length ? 1 : 0;
+	}
+}
+
 /**send variables packet configuration onboard**/
-void aciSendVariablePacketConfiguration(unsigned char packetId) {
+void aciCtxSendVariablePacketConfiguration(aci_context_t * ctx, unsigned char packetId) {
 
-	if(packetId>=MAX_VAR_PACKETS) return;
-	unsigned char * temp;
+	if(packetId>=ctx->aciVarPacketCount) return;
+	unsigned char temp[ACI_TX_RINGBUFFER_SIZE];
 	unsigned short crc = 0xff;
 	int i;
 	unsigned short packetDataLength = 0;
+	if(ctx->aciVarPacketLength[packetId] * 2 + 1 > ACI_TX_RINGBUFFER_SIZE) return;
 	crc = 0xff;
-	crc = aciUpdateCrc16(crc, aciVarPacket[packetId],
-			aciVarPacketLength[packetId] * 2);
+	crc = aciUpdateCrc16(crc, ctx->aciVarPacket[packetId],
+			ctx->aciVarPacketLength[packetId] * 2);
 
-	temp = malloc(aciVarPacketLength[packetId] * 2 + 1);
-	memcpy(&temp[1], aciVarPacket[packetId], aciVarPacketLength[packetId] * 2);
+	memcpy(&temp[1], ctx->aciVarPacket[packetId], ctx->aciVarPacketLength[packetId] * 2);
 	temp[0] = crc;
 
-	for (i = 0; i < aciVarPacketLength[packetId]; i++) {
+	for (i = 0; i < ctx->aciVarPacketLength[packetId]; i++) {
 		struct ACI_MEM_TABLE_ENTRY *entry;
 
-		entry = aciGetVariableItemById(aciVarPacket[packetId][i]);
+		entry = aciCtxGetVariableItemById(ctx, ctx->aciVarPacket[packetId][i]);
 		packetDataLength += entry->varType >> 2;
 	}
 
-	aciVarPacketMagicCode[packetId] = crc;
-	aciVarPacketContentBufferLength[packetId] = 0;
+	ctx->aciVarPacketMagicCode[packetId] = crc;
+	ctx->aciVarPacketContentBufferLength[packetId] = 0;
 
 	//reallocate temporary buffer
-	free(aciVarPacketContentBuffer[packetId]);
-	aciVarPacketContentBuffer[packetId] = malloc(packetDataLength);
-	aciVarPacketContentBufferLength[packetId] = packetDataLength;
+	aciFree(ctx, ctx->aciVarPacketContentBuffer[packetId]);
+	ctx->aciVarPacketContentBuffer[packetId] = aciMalloc(ctx, packetDataLength);
+	ctx->aciVarPacketContentBufferLength[packetId] = ctx->aciVarPacketContentBuffer[packetId] ? packetDataLength : 0;
+	ctx->aciVarPacketContentBufferUpdated[packetId] = 0;
 
-	aciTxSendPacket(ACIMT_UPDATEVARPACKET + packetId, temp,
-			aciVarPacketLength[packetId] * 2 + 1);
-	aciUpdateVarPacketTimeOut[packetId] = ACI_UPDATE_PACKET_TIMEOUT;
-	free(temp);
+	//the old snapshot does not fit the new configuration anymore
+	aciStoreVarPacketSnapshot(ctx, packetId, NULL, 0);
+	aciCompileVarPacketDecodePlan(ctx, packetId);
+
+	aciTxSendPacket(ctx, ACIMT_UPDATEVARPACKET + packetId, temp,
+			ctx->aciVarPacketLength[packetId] * 2 + 1);
+	ctx->aciUpdateVarPacketTimeOut[packetId] = ACI_UPDATE_PACKET_TIMEOUT(ctx->aciEngineRate);
 
 }
 
 /**send command packet configuration onboard**/
-void aciSendCommandPacketConfiguration(unsigned char packetId, unsigned char with_ack) {
-	unsigned char * temp;
+void aciCtxSendCommandPacketConfiguration(aci_context_t * ctx, unsigned char packetId, unsigned char with_ack) {
+	unsigned char temp[ACI_TX_RINGBUFFER_SIZE];
 	unsigned short crc = 0xff;
 	int i;
 	unsigned short packetDataLength = 0;
-	if(packetId>=MAX_VAR_PACKETS) return;
+	if(packetId>=ctx->aciVarPacketCount) return;
+	if(ctx->aciCmdPacketLength[packetId] * 2 + 2 > ACI_TX_RINGBUFFER_SIZE) return;
 	crc = 0xff;
-	crc = aciUpdateCrc16(crc, aciCmdPacket[packetId],
-			aciCmdPacketLength[packetId] * 2);
+	crc = aciUpdateCrc16(crc, ctx->aciCmdPacket[packetId],
+			ctx->aciCmdPacketLength[packetId] * 2);
 
-	temp = malloc(aciCmdPacketLength[packetId] * 2 + 2);
-	memcpy(&temp[2], aciCmdPacket[packetId], aciCmdPacketLength[packetId] * 2);
+	memcpy(&temp[2], ctx->aciCmdPacket[packetId], ctx->aciCmdPacketLength[packetId] * 2);
 	temp[0] = crc;
 	temp[1] = with_ack;
 
-	for (i = 0; i < aciCmdPacketLength[packetId]; i++) {
+	for (i = 0; i < ctx->aciCmdPacketLength[packetId]; i++) {
 		struct ACI_MEM_TABLE_ENTRY *entry;
 
-		entry = aciGetCommandItemById(aciCmdPacket[packetId][i]);
+		entry = aciCtxGetCommandItemById(ctx, ctx->aciCmdPacket[packetId][i]);
 		packetDataLength += entry->varType >> 2;
 	}
 
-	aciCmdPacketMagicCode[packetId] = crc;
-	aciCmdPacketContentBufferLength[packetId] = 0;
+	ctx->aciCmdPacketMagicCode[packetId] = crc;
+	ctx->aciCmdPacketContentBufferLength[packetId] = 0;
 
-	aciCmdWithAck[packetId]=with_ack;
+	ctx->aciCmdWithAck[packetId]=with_ack;
 	//reallocate temporary buffer
-	free(aciCmdPacketContentBuffer[packetId]);
-	aciCmdPacketContentBuffer[packetId] = malloc(packetDataLength);
-	aciCmdPacketContentBufferLength[packetId] = packetDataLength;
+	aciFree(ctx, ctx->aciCmdPacketContentBuffer[packetId]);
+	ctx->aciCmdPacketContentBuffer[packetId] = aciMalloc(ctx, packetDataLength);
+	ctx->aciCmdPacketContentBufferLength[packetId] = ctx->aciCmdPacketContentBuffer[packetId] ? packetDataLength : 0;
 
-	aciTxSendPacket(ACIMT_UPDATECMDPACKET + packetId, temp,
-			aciCmdPacketLength[packetId] * 2 + 2);
-	aciUpdateCmdPacketTimeOut[packetId] = ACI_UPDATE_PACKET_TIMEOUT;
-	free(temp);
+	aciTxSendPacket(ctx, ACIMT_UPDATECMDPACKET + packetId, temp,
+			ctx->aciCmdPacketLength[packetId] * 2 + 2);
+	ctx->aciUpdateCmdPacketTimeOut[packetId] = ACI_UPDATE_PACKET_TIMEOUT(ctx->aciEngineRate);
 }
 
 /**send command packet configuration onboard**/
-void aciSendParameterPacketConfiguration(unsigned char packetId) {
-	unsigned char * temp;
+void aciCtxSendParameterPacketConfiguration(aci_context_t * ctx, unsigned char packetId) {
+	unsigned char temp[ACI_TX_RINGBUFFER_SIZE];
 	unsigned short crc = 0xff;
 	int i;
 	unsigned short packetDataLength = 0;
+	if(packetId>=ctx->aciVarPacketCount) return;
+	if(ctx->aciParamPacketLength[packetId] * 2 + 1 > ACI_TX_RINGBUFFER_SIZE) return;
 	crc = 0xff;
-	crc = aciUpdateCrc16(crc, aciParamPacket[packetId],
-			aciParamPacketLength[packetId] * 2);
+	crc = aciUpdateCrc16(crc, ctx->aciParamPacket[packetId],
+			ctx->aciParamPacketLength[packetId] * 2);
 
-	temp = malloc(aciParamPacketLength[packetId] * 2 + 1);
-	memcpy(&temp[1], aciParamPacket[packetId], aciParamPacketLength[packetId] * 2);
+	memcpy(&temp[1], ctx->aciParamPacket[packetId], ctx->aciParamPacketLength[packetId] * 2);
 	temp[0] = crc;
 
-	for (i = 0; i < aciParamPacketLength[packetId]; i++) {
+	for (i = 0; i < ctx->aciParamPacketLength[packetId]; i++) {
 		struct ACI_MEM_TABLE_ENTRY *entry;
 
-		entry = aciGetParameterItemById(aciParamPacket[packetId][i]);
+		entry = aciCtxGetParameterItemById(ctx, ctx->aciParamPacket[packetId][i]);
 		packetDataLength += entry->varType >> 2;
 	}
 
-	aciParamPacketMagicCode[packetId] = crc;
-	aciParamPacketContentBufferLength[packetId] = 0;
+	ctx->aciParamPacketMagicCode[packetId] = crc;
+	ctx->aciParamPacketContentBufferLength[packetId] = 0;
 
 	//reallocate temporary buffer
-	free(aciParamPacketContentBuffer[packetId]);
-	aciParamPacketContentBuffer[packetId] = malloc(packetDataLength);
-	aciParamPacketContentBufferLength[packetId] = packetDataLength;
+	aciFree(ctx, ctx->aciParamPacketContentBuffer[packetId]);
+	ctx->aciParamPacketContentBuffer[packetId] = aciMalloc(ctx, packetDataLength);
+	ctx->aciParamPacketContentBufferLength[packetId] = ctx->aciParamPacketContentBuffer[packetId] ? packetDataLength : 0;
 
-	aciTxSendPacket(ACIMT_UPDATEPARAMPACKET + packetId, temp,
-			aciParamPacketLength[packetId] * 2 + 1);
-	aciUpdateParamPacketTimeOut[packetId] = ACI_UPDATE_PACKET_TIMEOUT;
-	free(temp);
+	aciTxSendPacket(ctx, ACIMT_UPDATEPARAMPACKET + packetId, temp,
+			ctx->aciParamPacketLength[packetId] * 2 + 1);
+	ctx->aciUpdateParamPacketTimeOut[packetId] = ACI_UPDATE_PACKET_TIMEOUT(ctx->aciEngineRate);
 }
 
 
-void aciSetVarListUpdateFinishedCallback(void(*aciVarListUpdateFinished_func)(void)) {
-	aciVarListUpdateFinished = aciVarListUpdateFinished_func;
+void aciCtxSetVarListUpdateFinishedCallback(aci_context_t * ctx, void (*aciVarListUpdateFinished_func)(void * userData)) {
+	ctx->aciVarListUpdateFinished = aciVarListUpdateFinished_func;
 }
 
-void aciSetCmdListUpdateFinishedCallback(void(*aciCmdListUpdateFinished_func)(void)) {
-	aciCmdListUpdateFinished = aciCmdListUpdateFinished_func;
+void aciCtxSetCmdListUpdateFinishedCallback(aci_context_t * ctx, void (*aciCmdListUpdateFinished_func)(void * userData)) {
+	ctx->aciCmdListUpdateFinished = aciCmdListUpdateFinished_func;
 }
 
-void aciSetParamListUpdateFinishedCallback(void(*aciParamListUpdateFinished_func)(void)) {
-	aciParamListUpdateFinished = aciParamListUpdateFinished_func;
+void aciCtxSetParamListUpdateFinishedCallback(aci_context_t * ctx, void (*aciParamListUpdateFinished_func)(void * userData)) {
+	ctx->aciParamListUpdateFinished = aciParamListUpdateFinished_func;
 }
-void aciSetCmdAckCallback(void (*aciCmdAck_func)(unsigned char)) {
-	aciCmdAck = aciCmdAck_func;
+void aciCtxSetCmdAckCallback(aci_context_t * ctx, void (*aciCmdAck_func)(void * userData, unsigned char packet)) {
+	ctx->aciCmdAck = aciCmdAck_func;
 }
 
-void aciInfoPacketReceivedCallback(void (*aciInfoRec_func)(struct ACI_INFO)) {
-	aciInfoRec = aciInfoRec_func;
+void aciCtxInfoPacketReceivedCallback(aci_context_t * ctx, void (*aciInfoRec_func)(void * userData, struct ACI_INFO)) {
+	ctx->aciInfoRec = aciInfoRec_func;
 }
 
-void aciVarPacketReceivedCallback(void (*aciVarPacketRec_func)(unsigned char)) {
-	aciVarPacketRec = aciVarPacketRec_func;
+void aciCtxVarPacketReceivedCallback(aci_context_t * ctx, void (*aciVarPacketRec_func)(void * userData, unsigned char packet)) {
+	ctx->aciVarPacketRec = aciVarPacketRec_func;
 }
 
-void aciParPacketStoredCallback(void (*aciParPacketStored_func)(void)) {
-	aciParaStoredC=aciParPacketStored_func;
+void aciCtxVarPacketReceivedTimedCallback(aci_context_t * ctx, void (*aciVarPacketRec_func)(void * userData, unsigned char packet, double rxTime)) {
+	ctx->aciVarPacketRecTimed = aciVarPacketRec_func;
 }
 
-void aciParPacketLoadedCallback(void (*aciParPacketLoaded_func)(void)) {
-	aciParaLoadedC=aciParPacketLoaded_func;
+void aciCtxParPacketStoredCallback(aci_context_t * ctx, void (*aciParPacketStored_func)(void * userData)) {
+	ctx->aciParaStoredC=aciParPacketStored_func;
 }
 
-void aciTxSendPacket(unsigned char aciMessageType, void * data,
-		unsigned short cnt) {
-	unsigned char startstring[3] = { '!', '#', '!' };
-	unsigned short crc = 0xFF;
-	unsigned char packetTxBuffer[ACI_TX_RINGBUFFER_SIZE];
-	int pos = 0;
-
-	if (cnt + 10 >= ACI_TX_RINGBUFFER_SIZE)
-		return;
+void aciCtxParPacketLoadedCallback(aci_context_t * ctx, void (*aciParPacketLoaded_func)(void * userData)) {
+	ctx->aciParaLoadedC=aciParPacketLoaded_func;
+}
 
-	//add header to ringbuffer
-	memcpy(&packetTxBuffer[pos], &startstring, 3);
-	pos += 3;
-	//add message type to ringbuffer
-	memcpy(&packetTxBuffer[pos], &aciMessageType, 1);
-	pos += 1;
-	crc = aciUpdateCrc16(crc, &aciMessageType, 1);
+void aciCtxSetBaudRateCallback(aci_context_t * ctx, void (*aciBaudRate_func)(void * userData, unsigned int baudrate, unsigned char status)) {
+	ctx->aciBaudRateC=aciBaudRate_func;
+}
 
-	//add data size to ringbuffer
-	memcpy(&packetTxBuffer[pos], &cnt, 2);
-	pos += 2;
-	crc = aciUpdateCrc16(crc, &cnt, 2);
+void aciTxSendPacket(aci_context_t * ctx, unsigned char aciMessageType, void * data,
+		unsigned short cnt) {
+	struct ACI_TX_SEGMENT seg;
 
-	memcpy(&packetTxBuffer[pos], data, cnt);
-	pos += cnt;
-	crc = aciUpdateCrc16(crc, data, cnt);
+	seg.data = data;
+	seg.length = cnt;
+	aciTxSendSegments(ctx, aciMessageType, &seg, cnt ? 1 : 0);
+}
 
-	//add CRC to ringbuffer
-	memcpy(&packetTxBuffer[pos], &crc, 2);
-	pos += 2;
+void aciTxSendSegments(aci_context_t * ctx, unsigned char aciMessageType,
+		const struct ACI_TX_SEGMENT * payload, unsigned char count) {
+	unsigned char header[6] = { '!', '#', '!' };
+	unsigned short crc = 0xFF;
+	unsigned short cnt = 0;
+	int i;
 
-	if (aciSendData)
-		aciSendData(&packetTxBuffer[0], pos);
+	if (count > ACI_TX_MAX_SEGMENTS - 2)
+		return;
+	for (i = 0; i < count; i++)
+		cnt += payload[i].length;
+	if (cnt + 10 >= ACI_TX_RINGBUFFER_SIZE)
+		return;
 
+	//message type and data size follow the start string
+	header[3] = aciMessageType;
+	memcpy(&header[4], &cnt, 2);
+	crc = aciUpdateCrc16(crc, &header[3], 3);
+	for (i = 0; i < count; i++)
+		crc = aciUpdateCrc16(crc, (void *) payload[i].data, payload[i].length);
+
+	if (ctx->aciSendSegments) {
+		struct ACI_TX_SEGMENT seg[ACI_TX_MAX_SEGMENTS];
+
+		seg[0].data = header;
+		seg[0].length = 6;
+		memcpy(&seg[1], payload, count * sizeof(struct ACI_TX_SEGMENT));
+		seg[count + 1].data = &crc;
+		seg[count + 1].length = 2;
+		ctx->aciSendSegments(ctx->aciUserData, seg, count + 2);
+	} else if (ctx->aciSendData) {
+		unsigned char packetTxBuffer[ACI_TX_RINGBUFFER_SIZE];
+		int pos = 6;
+
+		memcpy(&packetTxBuffer[0], header, 6);
+		for (i = 0; i < count; i++) {
+			memcpy(&packetTxBuffer[pos], payload[i].data, payload[i].length);
+			pos += payload[i].length;
+		}
+		memcpy(&packetTxBuffer[pos], &crc, 2);
+		pos += 2;
+		ctx->aciSendData(ctx->aciUserData, &packetTxBuffer[0], pos);
+	}
 }
 
-void aciGetDeviceVariablesList(void) {
+void aciCtxGetDeviceVariablesList(aci_context_t * ctx) {
 
-	if(!(aciRequestListType&0x10)) {
-		if(aciReadHDC && !aciMagicCodeOnHDFalse) {
-			aciRequestListType|=0x01;
-			aciRequestMagicCodes=1;
+	if(!(ctx->aciRequestListType&0x10)) {
+		if(ctx->aciReadHDC && !ctx->aciMagicCodeOnHDFalse) {
+			ctx->aciRequestListType|=0x01;
+			ctx->aciRequestMagicCodes=1;
 		} else {
-			aciRequestVarListTimeout=0;
+			ctx->aciRequestVarListTimeout=0;
 		}
 	}
 }
 
-void aciGetDeviceCommandsList(void) {
+void aciCtxGetDeviceCommandsList(aci_context_t * ctx) {
 
-	if(!(aciRequestListType&0x20)) {
-		if(aciReadHDC && !aciMagicCodeOnHDFalse) {
-			aciRequestListType|=0x02;
-			aciRequestMagicCodes=1;
+	if(!(ctx->aciRequestListType&0x20)) {
+		if(ctx->aciReadHDC && !ctx->aciMagicCodeOnHDFalse) {
+			ctx->aciRequestListType|=0x02;
+			ctx->aciRequestMagicCodes=1;
 		} else {
-			aciRequestCmdListTimeout=0;
+			ctx->aciRequestCmdListTimeout=0;
 		}
 	}
 }
 
-void aciGetDeviceParametersList(void) {
-	if(!(aciRequestListType&0x40)) {
-		if(aciReadHDC && !aciMagicCodeOnHDFalse) {
-			aciRequestListType|=0x04;
-			aciRequestMagicCodes=1;
+void aciCtxGetDeviceParametersList(aci_context_t * ctx) {
+	if(!(ctx->aciRequestListType&0x40)) {
+		if(ctx->aciReadHDC && !ctx->aciMagicCodeOnHDFalse) {
+			ctx->aciRequestListType|=0x04;
+			ctx->aciRequestMagicCodes=1;
 		} else {
-			aciRequestParListTimeout=0;
+			ctx->aciRequestParListTimeout=0;
 		}
 	}
 }
 
-void aciForceListRequestFromDevice() {
-	aciMagicCodeOnHDFalse=1;
-	aciRequestListType=0;
+void aciCtxForceListRequestFromDevice(aci_context_t * ctx) {
+	ctx->aciMagicCodeOnHDFalse=1;
+	ctx->aciRequestListType=0;
 }
 
-void aciGetParamFromDevice(unsigned short id) {
-	aciTxSendPacket(ACIMT_PARAM, &id, 2);
+void aciCtxGetParamFromDevice(aci_context_t * ctx, unsigned short id) {
+	aciTxSendPacket(ctx, ACIMT_PARAM, &id, 2);
 }
 
 /** get list item by index **/
-struct ACI_MEM_TABLE_ENTRY *aciGetVariableItemByIndex(unsigned short index) {
+struct ACI_MEM_TABLE_ENTRY *aciCtxGetVariableItemByIndex(aci_context_t * ctx, unsigned short index) {
 	unsigned short i = 0;
-	aciMemVarTableCurrent = aciMemVarTableStart;
-	while (aciMemVarTableCurrent->next) {
-		aciMemVarTableCurrent = aciMemVarTableCurrent->next;
+	ctx->aciMemVarTableCurrent = ctx->aciMemVarTableStart;
+	while (ctx->aciMemVarTableCurrent->next) {
+		ctx->aciMemVarTableCurrent = ctx->aciMemVarTableCurrent->next;
 		if (i == index)
-			return (&aciMemVarTableCurrent->tableEntry);
+			return (&ctx->aciMemVarTableCurrent->tableEntry);
 		i++;
 	}
 	return NULL;
 }
 
 /** try to find a list item by id **/
-struct ACI_MEM_TABLE_ENTRY *aciGetVariableItemById(unsigned short id) {
-	aciMemVarTableCurrent = aciMemVarTableStart;
-	while (aciMemVarTableCurrent->next) {
-		aciMemVarTableCurrent = aciMemVarTableCurrent->next;
-		if (aciMemVarTableCurrent->tableEntry.id == id)
-			return (&aciMemVarTableCurrent->tableEntry);
+struct ACI_MEM_TABLE_ENTRY *aciCtxGetVariableItemById(aci_context_t * ctx, unsigned short id) {
+	if (ctx->aciMemVarTableIndex.valid)
+		return aciLookupTableIndex(&ctx->aciMemVarTableIndex, id);
+	ctx->aciMemVarTableCurrent = ctx->aciMemVarTableStart;
+	while (ctx->aciMemVarTableCurrent->next) {
+		ctx->aciMemVarTableCurrent = ctx->aciMemVarTableCurrent->next;
+		if (ctx->aciMemVarTableCurrent->tableEntry.id == id)
+			return (&ctx->aciMemVarTableCurrent->tableEntry);
 	}
 	return NULL;
 }
 
 /** try to find a list item by name **/
-struct ACI_MEM_TABLE_ENTRY *aciGetVariableItemByName(char * name) {
+struct ACI_MEM_TABLE_ENTRY *aciCtxGetVariableItemByName(aci_context_t * ctx, char * name) {
 	if(name==NULL) return NULL;
-	aciMemVarTableCurrent = aciMemVarTableStart;
-	while (aciMemVarTableCurrent->next) {
-		aciMemVarTableCurrent = aciMemVarTableCurrent->next;
-		if (strcmp(&(aciMemVarTableCurrent->tableEntry.name[0]), name))
-			return (&aciMemVarTableCurrent->tableEntry);
+	ctx->aciMemVarTableCurrent = ctx->aciMemVarTableStart;
+	while (ctx->aciMemVarTableCurrent->next) {
+		ctx->aciMemVarTableCurrent = ctx->aciMemVarTableCurrent->next;
+		if (strcmp(&(ctx->aciMemVarTableCurrent->tableEntry.name[0]), name))
+			return (&ctx->aciMemVarTableCurrent->tableEntry);
 	}
 	return NULL;
 }
 
 /**get length of var table**/
-unsigned short aciGetVarTableLength(void) {
+unsigned short aciCtxGetVarTableLength(aci_context_t * ctx) {
 	unsigned short length = 0;
 
-	aciMemVarTableCurrent = aciMemVarTableStart;
-	while (aciMemVarTableCurrent->next) {
+	ctx->aciMemVarTableCurrent = ctx->aciMemVarTableStart;
+	while (ctx->aciMemVarTableCurrent->next) {
 		length++;
-		aciMemVarTableCurrent = aciMemVarTableCurrent->next;
+		ctx->aciMemVarTableCurrent = ctx->aciMemVarTableCurrent->next;
 	}
 	return length;
 }
 
 
-struct ACI_INFO aciGetInfo(void)
+struct ACI_INFO aciCtxGetInfo(aci_context_t * ctx)
 {
-	return aciInfo;
+	return ctx->aciInfo;
 }
 
 /** get list item by index **/
-struct ACI_MEM_TABLE_ENTRY *aciGetParameterItemByIndex(unsigned short index) {
+struct ACI_MEM_TABLE_ENTRY *aciCtxGetParameterItemByIndex(aci_context_t * ctx, unsigned short index) {
 	unsigned short i = 0;
-	aciMemParamTableCurrent = aciMemParamTableStart;
-	while (aciMemParamTableCurrent->next) {
-		aciMemParamTableCurrent = aciMemParamTableCurrent->next;
+	ctx->aciMemParamTableCurrent = ctx->aciMemParamTableStart;
+	while (ctx->aciMemParamTableCurrent->next) {
+		ctx->aciMemParamTableCurrent = ctx->aciMemParamTableCurrent->next;
 		if (i == index)
-			return (&aciMemParamTableCurrent->tableEntry);
+			return (&ctx->aciMemParamTableCurrent->tableEntry);
 		i++;
 	}
 	return NULL;
 }
 
 /** try to find a list item by id **/
-struct ACI_MEM_TABLE_ENTRY *aciGetParameterItemById(unsigned short id) {
-	aciMemParamTableCurrent = aciMemParamTableStart;
-	while (aciMemParamTableCurrent->next) {
-		aciMemParamTableCurrent = aciMemParamTableCurrent->next;
-		if (aciMemParamTableCurrent->tableEntry.id == id)
-			return (&aciMemParamTableCurrent->tableEntry);
+struct ACI_MEM_TABLE_ENTRY *aciCtxGetParameterItemById(aci_context_t * ctx, unsigned short id) {
+	if (ctx->aciMemParamTableIndex.valid)
+		return aciLookupTableIndex(&ctx->aciMemParamTableIndex, id);
+	ctx->aciMemParamTableCurrent = ctx->aciMemParamTableStart;
+	while (ctx->aciMemParamTableCurrent->next) {
+		ctx->aciMemParamTableCurrent = ctx->aciMemParamTableCurrent->next;
+		if (ctx->aciMemParamTableCurrent->tableEntry.id == id)
+			return (&ctx->aciMemParamTableCurrent->tableEntry);
 	}
 	return NULL;
 }
 
 /** try to find a list item by name **/
-struct ACI_MEM_TABLE_ENTRY *aciGetParameterItemByName(char * name) {
+struct ACI_MEM_TABLE_ENTRY *aciCtxGetParameterItemByName(aci_context_t * ctx, char * name) {
 	if(name==NULL) return NULL;
-	aciMemParamTableCurrent = aciMemParamTableStart;
-	while (aciMemParamTableCurrent->next) {
-		aciMemParamTableCurrent = aciMemParamTableCurrent->next;
-		if (strcmp(&(aciMemParamTableCurrent->tableEntry.name[0]), name))
-			return (&aciMemParamTableCurrent->tableEntry);
+	ctx->aciMemParamTableCurrent = ctx->aciMemParamTableStart;
+	while (ctx->aciMemParamTableCurrent->next) {
+		ctx->aciMemParamTableCurrent = ctx->aciMemParamTableCurrent->next;
+		if (strcmp(&(ctx->aciMemParamTableCurrent->tableEntry.name[0]), name))
+			return (&ctx->aciMemParamTableCurrent->tableEntry);
 	}
 	return NULL;
 }
 
 /**get length of var table**/
-unsigned short aciGetParamTableLenth(void) {
+unsigned short aciCtxGetParamTableLenth(aci_context_t * ctx) {
 	unsigned short length = 0;
 
-	aciMemParamTableCurrent = aciMemParamTableStart;
-	while (aciMemParamTableCurrent->next) {
+	ctx->aciMemParamTableCurrent = ctx->aciMemParamTableStart;
+	while (ctx->aciMemParamTableCurrent->next) {
 		length++;
-		aciMemParamTableCurrent = aciMemParamTableCurrent->next;
+		ctx->aciMemParamTableCurrent = ctx->aciMemParamTableCurrent->next;
 	}
 	return length;
 }
 
 /** get list item by index **/
-struct ACI_MEM_TABLE_ENTRY *aciGetCommandItemByIndex(unsigned short index) {
+struct ACI_MEM_TABLE_ENTRY *aciCtxGetCommandItemByIndex(aci_context_t * ctx, unsigned short index) {
 	unsigned short i = 0;
-	aciMemCmdTableCurrent = aciMemCmdTableStart;
-	while (aciMemCmdTableCurrent->next) {
-		aciMemCmdTableCurrent = aciMemCmdTableCurrent->next;
+	ctx->aciMemCmdTableCurrent = ctx->aciMemCmdTableStart;
+	while (ctx->aciMemCmdTableCurrent->next) {
+		ctx->aciMemCmdTableCurrent = ctx->aciMemCmdTableCurrent->next;
 		if (i == index)
-			return (&aciMemCmdTableCurrent->tableEntry);
+			return (&ctx->aciMemCmdTableCurrent->tableEntry);
 		i++;
 	}
 	return NULL;
 }
 
 /** try to find a list item by id **/
-struct ACI_MEM_TABLE_ENTRY *aciGetCommandItemById(unsigned short id) {
-	aciMemCmdTableCurrent = aciMemCmdTableStart;
-	while (aciMemCmdTableCurrent->next) {
-		aciMemCmdTableCurrent = aciMemCmdTableCurrent->next;
-		if (aciMemCmdTableCurrent->tableEntry.id == id)
-			return (&aciMemCmdTableCurrent->tableEntry);
+struct ACI_MEM_TABLE_ENTRY *aciCtxGetCommandItemById(aci_context_t * ctx, unsigned short id) {
+	if (ctx->aciMemCmdTableIndex.valid)
+		return aciLookupTableIndex(&ctx->aciMemCmdTableIndex, id);
+	ctx->aciMemCmdTableCurrent = ctx->aciMemCmdTableStart;
+	while (ctx->aciMemCmdTableCurrent->next) {
+		ctx->aciMemCmdTableCurrent = ctx->aciMemCmdTableCurrent->next;
+		if (ctx->aciMemCmdTableCurrent->tableEntry.id == id)
+			return (&ctx->aciMemCmdTableCurrent->tableEntry);
 	}
 	return NULL;
 }
 
 /** try to find a list item by name **/
-struct ACI_MEM_TABLE_ENTRY *aciGetCommandItemByName(char * name) {
+struct ACI_MEM_TABLE_ENTRY *aciCtxGetCommandItemByName(aci_context_t * ctx, char * name) {
 	if(name==NULL) return NULL;
-	aciMemCmdTableCurrent = aciMemCmdTableStart;
-	while (aciMemCmdTableCurrent->next) {
-		aciMemCmdTableCurrent = aciMemCmdTableCurrent->next;
-		if (strcmp(&(aciMemCmdTableCurrent->tableEntry.name[0]), name))
-			return (&aciMemCmdTableCurrent->tableEntry);
+	ctx->aciMemCmdTableCurrent = ctx->aciMemCmdTableStart;
+	while (ctx->aciMemCmdTableCurrent->next) {
+		ctx->aciMemCmdTableCurrent = ctx->aciMemCmdTableCurrent->next;
+		if (strcmp(&(ctx->aciMemCmdTableCurrent->tableEntry.name[0]), name))
+			return (&ctx->aciMemCmdTableCurrent->tableEntry);
 	}
 	return NULL;
 }
 
 /**get length of var table**/
-unsigned short aciGetCmdTableLenth(void) {
+unsigned short aciCtxGetCmdTableLenth(aci_context_t * ctx) {
 	unsigned short length = 0;
 
-	aciMemCmdTableCurrent = aciMemCmdTableStart;
-	while (aciMemCmdTableCurrent->next) {
+	ctx->aciMemCmdTableCurrent = ctx->aciMemCmdTableStart;
+	while (ctx->aciMemCmdTableCurrent->next) {
 		length++;
-		aciMemCmdTableCurrent = aciMemCmdTableCurrent->next;
+		ctx->aciMemCmdTableCurrent = ctx->aciMemCmdTableCurrent->next;
 	}
 	return length;
 }
 
-void aciUpdateCmdPacket(const unsigned short packetId)
+void aciCtxUpdateCmdPacket(aci_context_t * ctx, const unsigned short packetId)
 {
-	aciCmdPacketSendStatus[packetId]=1;
+	if(packetId<ctx->aciVarPacketCount)
+		ctx->aciCmdPacketSendStatus[packetId]=1;
 }
 
-void aciUpdateParamPacket(const unsigned short packetId)
+void aciCtxUpdateParamPacket(aci_context_t * ctx, const unsigned short packetId)
 {
-	aciParamPacketSendStatus[packetId]=1;
+	if(packetId<ctx->aciVarPacketCount)
+		ctx->aciParamPacketSendStatus[packetId]=1;
 }
 
-unsigned char aciGetCmdSendStatus(const unsigned short packetId)
+unsigned char aciCtxGetCmdSendStatus(aci_context_t * ctx, const unsigned short packetId)
 {
-	return aciCmdPacketSendStatus[packetId];
+	return ctx->aciCmdPacketSendStatus[packetId];
 }
 
 
-void aciRxHandleMessage(unsigned char messagetype, unsigned short length) {
+void aciRxHandleMessage(aci_context_t * ctx, unsigned char messagetype, unsigned short length) {
 	int i;
 	unsigned char packetSelect;
 	unsigned char temp_ack;
 	unsigned char switch_type;
 	unsigned short temp_id;
 
-	static char magicCodeAlreadyRequested = 0; // It may happen, that it will get it 2 times in a row and that is bad for loading/saving
 
 	if((messagetype >= ACIMT_VARPACKET) && (messagetype <= ACIMT_VARPACKET + 0x0f)) switch_type = ACIMT_VARPACKET;
 	else if((messagetype >= ACIMT_CMDPACKET) && (messagetype <= ACIMT_CMDPACKET + 0x0f)) switch_type = ACIMT_UPDATECMDPACKET;
@@ -1192,87 +1687,52 @@ void aciRxHandleMessage(unsigned char messagetype, unsigned short length) {
 	switch (switch_type) {
 
 	case ACIMT_INFO_REQUEST:
-		aciInfo.verMajor = ACI_VER_MAJOR;
-		aciInfo.verMinor = ACI_VER_MINOR;
-		aciInfo.maxDescLength = MAX_DESC_LENGTH;
-		aciInfo.maxNameLength = MAX_NAME_LENGTH;
-		aciInfo.maxUnitLength = MAX_UNIT_LENGTH;
-		aciInfo.maxVarPackets = MAX_VAR_PACKETS;
-		aciInfo.flags = 0;
+		ctx->aciInfo.verMajor = ACI_VER_MAJOR;
+		ctx->aciInfo.verMinor = ACI_VER_MINOR;
+		ctx->aciInfo.maxDescLength = MAX_DESC_LENGTH;
+		ctx->aciInfo.maxNameLength = MAX_NAME_LENGTH;
+		ctx->aciInfo.maxUnitLength = MAX_UNIT_LENGTH;
+		ctx->aciInfo.maxVarPackets = MAX_VAR_PACKETS;
+		ctx->aciInfo.flags = 0;
 		for (i = 0; i < 8; i++)
-			aciInfo.dummy[i] = 0;
-		aciTxSendPacket(ACIMT_INFO_REPLY, &aciInfo, sizeof(aciInfo));
+			ctx->aciInfo.dummy[i] = 0;
+		aciTxSendPacket(ctx, ACIMT_INFO_REPLY, &ctx->aciInfo, sizeof(ctx->aciInfo));
 
 		break;
 
 	case ACIMT_INFO_REPLY:
 		if (length == sizeof(struct ACI_INFO)) {
-			memcpy(&aciInfo,&aciRxDataBuffer[0],length);
-			if(aciInfoRec) aciInfoRec(aciInfo);
+			memcpy(&ctx->aciInfo,&ctx->aciRxDataBuffer[0],length);
+			//use as many packets as the device has, as far as there is room for them
+			if (ctx->aciInfo.maxVarPackets)
+				ctx->aciVarPacketCount = (ctx->aciInfo.maxVarPackets < MAX_VAR_PACKETS) ? ctx->aciInfo.maxVarPackets : MAX_VAR_PACKETS;
+			if(ctx->aciInfoRec) ctx->aciInfoRec(ctx->aciUserData, ctx->aciInfo);
 		}
 		break;
 	case ACIMT_SENDVARTABLEINFO:
 		if (length >= 2) {
-			aciVarTableLength = (aciRxDataBuffer[1] << 8) | aciRxDataBuffer[0];
+			ctx->aciVarTableLength = (ctx->aciRxDataBuffer[1] << 8) | ctx->aciRxDataBuffer[0];
+			//the index stays valid for the download, it tells which entries are known already
+			aciBuildTableIndex(ctx, &ctx->aciMemVarTableIndex, ctx->aciMemVarTableStart);
 
-			if (length == aciVarTableLength * 2 + 2) {
-				aciRequestedPacketList = malloc(sizeof(unsigned short)*aciVarTableLength);
-				aciRequestedPacketListLength = aciVarTableLength;
-				for (i = 0; i < aciVarTableLength; i++) {
-					aciRequestedPacketList[i] = (aciRxDataBuffer[3 + i * 2] << 8) | aciRxDataBuffer[2 + i * 2];
-				}
-				//request first entry
-				aciTxSendPacket(ACIMT_REQUESTVARTABLEENTRIES, aciRequestedPacketList, 2);
-				aciRequestedPacketListTimeOut = ACI_REQUEST_LIST_TIMEOUT;
-				aciRequestVarListTimeout=60000;
+			if (length == ctx->aciVarTableLength * 2 + 2) {
+				if (!aciListDownloadStart(ctx, &ctx->aciVarListDownload, ACIMT_REQUESTVARTABLEENTRIES, &ctx->aciRxDataBuffer[2], ctx->aciVarTableLength))
+					break;
+				ctx->aciRequestVarListTimeout=60000;
 			}
 
 		}
 		break;
 
 	case ACIMT_SENDVARTABLEENTRY:
-		if ((length == (sizeof(struct ACI_MEM_TABLE_ENTRY))-sizeof(void*)) && (aciRequestedPacketListLength)) {
-			unsigned short id = (aciRxDataBuffer[1] << 8) | (aciRxDataBuffer[0]);
-			unsigned char idAlreadyExists = 0;
-
-			aciMemVarTableCurrent = aciMemVarTableStart;
-			while (aciMemVarTableCurrent->next) {
-				aciMemVarTableCurrent = aciMemVarTableCurrent->next;
-				if (aciMemVarTableCurrent->tableEntry.id == id)
-					idAlreadyExists = 1;
-			}
-
-			if (!idAlreadyExists) {
-				aciMemVarTableCurrent->next = malloc(sizeof(struct ACI_MEM_VAR_TABLE));
-				aciMemVarTableCurrent = aciMemVarTableCurrent->next;
-				memcpy(&(aciMemVarTableCurrent->tableEntry), &aciRxDataBuffer[0], sizeof(struct ACI_MEM_TABLE_ENTRY)-sizeof(void*));
-				aciMagicCodeVarLoaded++;
-				aciMagicCodeVar  = aciUpdateCrc16(aciMagicCodeVar,&aciMemVarTableCurrent->tableEntry.id,2);
-				aciMagicCodeVar = aciUpdateCrc16(aciMagicCodeVar,&aciMemVarTableCurrent->tableEntry.varType,1);
-				aciMemVarTableCurrent->next = NULL;
-			}
-
-			for (i = 0; i < aciRequestedPacketListLength; i++)
-				if (aciRequestedPacketList[i] == id) {
-					int z;
-
-					for (z = i; z < aciRequestedPacketListLength - 1; z++)
-						aciRequestedPacketList[z] = aciRequestedPacketList[z + 1];
-
-					aciRequestedPacketListLength--;
-					if (!aciRequestedPacketListLength) {
-						free(aciRequestedPacketList);
-						aciRequestListType|=0x10;
-						if((aciRequestListType&0x10)&&(aciRequestListType&0x20)&&(aciRequestListType&0x40)&&(aciWriteHDC)&&(aciResetHDC)) aciStoreList();
-						if (aciVarListUpdateFinished)
-							aciVarListUpdateFinished();
-					}
-					break;
-				}
-			if (aciRequestedPacketListLength) {
-				//request next entry
-				aciTxSendPacket(ACIMT_REQUESTVARTABLEENTRIES, aciRequestedPacketList, 2);
-				aciRequestedPacketListTimeOut = ACI_REQUEST_LIST_TIMEOUT;
+		if ((length == (sizeof(struct ACI_MEM_TABLE_ENTRY))-sizeof(void*)) && (ctx->aciVarListDownload.missing)) {
+			if (aciListDownloadEntry(ctx, &ctx->aciVarListDownload, ACIMT_REQUESTVARTABLEENTRIES, ctx->aciMemVarTableStart,
+					&ctx->aciMemVarTableIndex, &ctx->aciMemVarTableCurrent, &ctx->aciMagicCodeVar, &ctx->aciMagicCodeVarLoaded)) {
+				aciBuildTableIndex(ctx, &ctx->aciMemVarTableIndex, ctx->aciMemVarTableStart);
+				ctx->aciRequestListType|=0x10;
+				if((ctx->aciRequestListType&0x10)&&(ctx->aciRequestListType&0x20)&&(ctx->aciRequestListType&0x40)&&(ctx->aciWriteHDC)&&(ctx->aciResetHDC)) aciStoreList(ctx);
+				if (ctx->aciVarListUpdateFinished)
+					ctx->aciVarListUpdateFinished(ctx->aciUserData);
 			}
 		}
 
@@ -1286,71 +1746,27 @@ void aciRxHandleMessage(unsigned char messagetype, unsigned short length) {
 		break;
 	case ACIMT_SENDCMDTABLEINFO:
 		if (length >= 2) {
-			aciCmdTableLength = (aciRxDataBuffer[1] << 8) | aciRxDataBuffer[0];
-
-			if (length == aciCmdTableLength * 2 + 2) {
-				aciRequestCmdListTimeout=60000;
-				if (aciRequestedCmdPacketList)
-					free(aciRequestedCmdPacketList);
-				aciRequestedCmdPacketList = (unsigned short*) malloc(aciCmdTableLength * 2);
-				aciRequestedCmdPacketListLength = aciCmdTableLength;
-				for (i = 0; i < aciCmdTableLength; i++)
-					aciRequestedCmdPacketList[i] = (aciRxDataBuffer[3 + i * 2] << 8) | aciRxDataBuffer[2 + i * 2];
-				//request first entry
-				aciTxSendPacket(ACIMT_REQUESTCMDTABLEENTRIES, aciRequestedCmdPacketList, 2);
-				aciRequestedCmdPacketListTimeOut = ACI_REQUEST_LIST_TIMEOUT;
+			ctx->aciCmdTableLength = (ctx->aciRxDataBuffer[1] << 8) | ctx->aciRxDataBuffer[0];
+			aciBuildTableIndex(ctx, &ctx->aciMemCmdTableIndex, ctx->aciMemCmdTableStart);
+
+			if (length == ctx->aciCmdTableLength * 2 + 2) {
+				if (!aciListDownloadStart(ctx, &ctx->aciCmdListDownload, ACIMT_REQUESTCMDTABLEENTRIES, &ctx->aciRxDataBuffer[2], ctx->aciCmdTableLength))
+					break;
+				ctx->aciRequestCmdListTimeout=60000;
 			}
 		}
 		break;
 
 	case ACIMT_SENDCMDTABLEENTRY:
 
-		if ((length == (sizeof(struct ACI_MEM_TABLE_ENTRY))-sizeof(void*)) && (aciRequestedCmdPacketListLength)) {
-			unsigned short id = (aciRxDataBuffer[1] << 8) | (aciRxDataBuffer[0]);
-			unsigned char idAlreadyExists = 0;
-
-			aciMemCmdTableCurrent = aciMemCmdTableStart;
-			while (aciMemCmdTableCurrent->next) {
-				aciMemCmdTableCurrent = aciMemCmdTableCurrent->next;
-				if (aciMemCmdTableCurrent->tableEntry.id == id)
-					idAlreadyExists = 1;
-			}
-			if (!idAlreadyExists) {
-
-				aciMemCmdTableCurrent->next = malloc(sizeof(struct ACI_MEM_VAR_TABLE));
-				aciMemCmdTableCurrent = aciMemCmdTableCurrent->next;
-				memcpy(&(aciMemCmdTableCurrent->tableEntry), &aciRxDataBuffer[0], sizeof(struct ACI_MEM_TABLE_ENTRY)-sizeof(void*));
-				aciMagicCodeCmdLoaded++;
-				aciMagicCodeCmd  = aciUpdateCrc16(aciMagicCodeCmd,&aciMemCmdTableCurrent->tableEntry.id,2);
-				aciMagicCodeCmd = aciUpdateCrc16(aciMagicCodeCmd,&aciMemCmdTableCurrent->tableEntry.varType,1);
-				aciMemCmdTableCurrent->next = NULL;
-			}
-
-			//remove entry from requestedPacketList
-			for (i = 0; i < aciRequestedCmdPacketListLength; i++)
-				if (aciRequestedCmdPacketList[i] == id) {
-					//remove from list
-					int z;
-
-					for (z = i; z < aciRequestedCmdPacketListLength - 1; z++)
-						aciRequestedCmdPacketList[z] = aciRequestedCmdPacketList[z + 1];
-
-					aciRequestedCmdPacketListLength--;
-					if (!aciRequestedCmdPacketListLength) {
-						free(aciRequestedCmdPacketList);
-						aciRequestListType|=0x20;
-						if((aciRequestListType&0x10)&&(aciRequestListType&0x20)&&(aciRequestListType&0x40)&&(aciWriteHDC)&&(aciResetHDC)) aciStoreList();
-						if (aciCmdListUpdateFinished)
-							aciCmdListUpdateFinished();
-					}
-					break;
-				}
-
-			if (aciRequestedCmdPacketListLength) {
-				//request next entry
-
-				aciTxSendPacket(ACIMT_REQUESTCMDTABLEENTRIES, aciRequestedCmdPacketList, 2);
-				aciRequestedCmdPacketListTimeOut = ACI_REQUEST_LIST_TIMEOUT;
+		if ((length == (sizeof(struct ACI_MEM_TABLE_ENTRY))-sizeof(void*)) && (ctx->aciCmdListDownload.missing)) {
+			if (aciListDownloadEntry(ctx, &ctx->aciCmdListDownload, ACIMT_REQUESTCMDTABLEENTRIES, ctx->aciMemCmdTableStart,
+					&ctx->aciMemCmdTableIndex, &ctx->aciMemCmdTableCurrent, &ctx->aciMagicCodeCmd, &ctx->aciMagicCodeCmdLoaded)) {
+				aciBuildTableIndex(ctx, &ctx->aciMemCmdTableIndex, ctx->aciMemCmdTableStart);
+				ctx->aciRequestListType|=0x20;
+				if((ctx->aciRequestListType&0x10)&&(ctx->aciRequestListType&0x20)&&(ctx->aciRequestListType&0x40)&&(ctx->aciWriteHDC)&&(ctx->aciResetHDC)) aciStoreList(ctx);
+				if (ctx->aciCmdListUpdateFinished)
+					ctx->aciCmdListUpdateFinished(ctx->aciUserData);
 			}
 		}
 
@@ -1358,74 +1774,32 @@ void aciRxHandleMessage(unsigned char messagetype, unsigned short length) {
 
 	case ACIMT_SENDPARAMTABLEINFO:
 		if (length >= 2) {
-			aciParamTableLength = (aciRxDataBuffer[1] << 8) | aciRxDataBuffer[0];
-			if (length == aciParamTableLength * 2 + 2) {
-				aciRequestParListTimeout=60000;
-				aciRequestedParamPacketList = (unsigned short*)  malloc(aciParamTableLength * 2);
-				aciRequestedParamPacketListLength = aciParamTableLength;
-				for (i = 0; i < aciParamTableLength; i++)
-					aciRequestedParamPacketList[i] = (aciRxDataBuffer[3 + i * 2] << 8) | aciRxDataBuffer[2 + i * 2];
-				//request first entry
-				if(aciParamTableLength==0){
-					aciRequestListType|=0x40;
-					if((aciRequestListType&0x10)&&(aciRequestListType&0x20)&&(aciRequestListType&0x40)&&(aciWriteHDC)&&(aciResetHDC)) aciStoreList();
-					if (aciParamListUpdateFinished)
-						aciParamListUpdateFinished();
-				} else {
-					aciTxSendPacket(ACIMT_REQUESTPARAMTABLEENTRIES, aciRequestedParamPacketList, 2);
-					aciRequestedParamPacketListTimeOut = ACI_REQUEST_LIST_TIMEOUT;
-				}
+			ctx->aciParamTableLength = (ctx->aciRxDataBuffer[1] << 8) | ctx->aciRxDataBuffer[0];
+			aciBuildTableIndex(ctx, &ctx->aciMemParamTableIndex, ctx->aciMemParamTableStart);
+			if (length == ctx->aciParamTableLength * 2 + 2) {
+				if(ctx->aciParamTableLength==0){
+					aciListDownloadFree(ctx, &ctx->aciParamListDownload);
+					ctx->aciRequestListType|=0x40;
+					if((ctx->aciRequestListType&0x10)&&(ctx->aciRequestListType&0x20)&&(ctx->aciRequestListType&0x40)&&(ctx->aciWriteHDC)&&(ctx->aciResetHDC)) aciStoreList(ctx);
+					if (ctx->aciParamListUpdateFinished)
+						ctx->aciParamListUpdateFinished(ctx->aciUserData);
+				} else if (!aciListDownloadStart(ctx, &ctx->aciParamListDownload, ACIMT_REQUESTPARAMTABLEENTRIES, &ctx->aciRxDataBuffer[2], ctx->aciParamTableLength))
+					break;
+				ctx->aciRequestParListTimeout=60000;
 			}
 		}
 		break;
 
 	case ACIMT_SENDPARAMTABLEENTRY:
 
-		if ((length == ((sizeof(struct ACI_MEM_TABLE_ENTRY))-sizeof(void*))) && (aciRequestedParamPacketListLength)) {
-			unsigned short id = (aciRxDataBuffer[1] << 8) | (aciRxDataBuffer[0]);
-			unsigned char idAlreadyExists = 0;
-
-			aciMemParamTableCurrent = aciMemParamTableStart;
-			while (aciMemParamTableCurrent->next) {
-				aciMemParamTableCurrent = aciMemParamTableCurrent->next;
-				if (aciMemParamTableCurrent->tableEntry.id == id)
-					idAlreadyExists = 1;
-			}
-			if (!idAlreadyExists) {
-
-				aciMemParamTableCurrent->next = malloc(sizeof(struct ACI_MEM_VAR_TABLE));
-				aciMemParamTableCurrent = aciMemParamTableCurrent->next;
-				memcpy(&(aciMemParamTableCurrent->tableEntry), &aciRxDataBuffer[0], (sizeof(struct ACI_MEM_TABLE_ENTRY))-sizeof(void*));
-				aciMagicCodeParLoaded++;
-				aciMagicCodePar  = aciUpdateCrc16(aciMagicCodePar,&aciMemParamTableCurrent->tableEntry.id,2);
-				aciMagicCodePar = aciUpdateCrc16(aciMagicCodePar,&aciMemParamTableCurrent->tableEntry.varType,1);
-				aciMemParamTableCurrent->next = NULL;
-			}
-
-			//remove entry from requestedPacketList
-			for (i = 0; i < aciRequestedParamPacketListLength; i++)
-				if (aciRequestedParamPacketList[i] == id) {
-					//remove from list
-					int z;
-
-					for (z = i; z < aciRequestedParamPacketListLength - 1; z++)
-						aciRequestedParamPacketList[z] = aciRequestedParamPacketList[z + 1];
-
-					aciRequestedParamPacketListLength--;
-					if (!aciRequestedParamPacketListLength) {
-						free(aciRequestedParamPacketList);
-						aciRequestListType|=0x40;
-						if((aciRequestListType&0x10)&&(aciRequestListType&0x20)&&(aciRequestListType&0x40)&&(aciWriteHDC)&&(aciResetHDC)) aciStoreList();
-						if (aciParamListUpdateFinished)
-							aciParamListUpdateFinished();
-					}
-					break;
-				}
-
-			if (aciRequestedParamPacketListLength) {
-				//request next entry
-				aciTxSendPacket(ACIMT_REQUESTPARAMTABLEENTRIES, aciRequestedParamPacketList, 2);
-				aciRequestedParamPacketListTimeOut = ACI_REQUEST_LIST_TIMEOUT;
+		if ((length == ((sizeof(struct ACI_MEM_TABLE_ENTRY))-sizeof(void*))) && (ctx->aciParamListDownload.missing)) {
+			if (aciListDownloadEntry(ctx, &ctx->aciParamListDownload, ACIMT_REQUESTPARAMTABLEENTRIES, ctx->aciMemParamTableStart,
+					&ctx->aciMemParamTableIndex, &ctx->aciMemParamTableCurrent, &ctx->aciMagicCodePar, &ctx->aciMagicCodeParLoaded)) {
+				aciBuildTableIndex(ctx, &ctx->aciMemParamTableIndex, ctx->aciMemParamTableStart);
+				ctx->aciRequestListType|=0x40;
+				if((ctx->aciRequestListType&0x10)&&(ctx->aciRequestListType&0x20)&&(ctx->aciRequestListType&0x40)&&(ctx->aciWriteHDC)&&(ctx->aciResetHDC)) aciStoreList(ctx);
+				if (ctx->aciParamListUpdateFinished)
+					ctx->aciParamListUpdateFinished(ctx->aciUserData);
 			}
 		}
 
@@ -1436,110 +1810,133 @@ void aciRxHandleMessage(unsigned char messagetype, unsigned short length) {
 		packetSelect = messagetype - ACIMT_VARPACKET;
 		if (packetSelect >= MAX_VAR_PACKETS)
 			break;
-		if ((aciVarPacketMagicCode[packetSelect] == aciRxDataBuffer[0]) && (aciVarPacketContentBufferLength[packetSelect] == length - 1)) {
-			//copy packet data to temporary buffer
-			memcpy(aciVarPacketContentBuffer[packetSelect], &aciRxDataBuffer[1], length - 1);
-			aciVarPacketContentBufferValid[packetSelect] = 1;
-			aciVarPacketContentBufferInvalidCnt[packetSelect] = 0;
+		if ((ctx->aciVarPacketMagicCode[packetSelect] == ctx->aciRxDataBuffer[0]) && (ctx->aciVarPacketContentBufferLength[packetSelect] == length - 1)) {
+			if (ctx->aciVarPacketDirectDecode)
+				//decode straight into the assigned variables
+				aciRunVarPacketDecodePlan(ctx, packetSelect, &ctx->aciRxDataBuffer[1]);
+			else {
+				//copy packet data to temporary buffer
+				memcpy(ctx->aciVarPacketContentBuffer[packetSelect], &ctx->aciRxDataBuffer[1], length - 1);
+				ctx->aciVarPacketContentBufferUpdated[packetSelect] = 1;
+			}
+			aciStoreVarPacketSnapshot(ctx, packetSelect, &ctx->aciRxDataBuffer[1], length - 1);
+			ctx->aciLinkStats.varPacketsReceived[packetSelect]++;
+			ctx->aciVarPacketContentBufferValid[packetSelect] = 1;
+			ctx->aciVarPacketContentBufferInvalidCnt[packetSelect] = 0;
 
-			if(aciVarPacketRec) aciVarPacketRec(packetSelect);
+			if(ctx->aciVarPacketRec) ctx->aciVarPacketRec(ctx->aciUserData, packetSelect);
+			if(ctx->aciVarPacketRecTimed) ctx->aciVarPacketRecTimed(ctx->aciUserData, packetSelect, ctx->aciRxTime);
 
 		} else {
-			aciVarPacketContentBufferValid[packetSelect] = 0;
-			aciVarPacketContentBufferInvalidCnt[packetSelect]++;
-			if (aciVarPacketContentBufferInvalidCnt[packetSelect] == TIMEOUT_INVALID_PACKET) {
-				aciVarPacketContentBufferInvalidCnt[packetSelect]--;
-				aciUpdateVarPacketTimeOut[packetSelect] = 1; //trigger resend packet configuration
+			ctx->aciVarPacketContentBufferValid[packetSelect] = 0;
+			ctx->aciVarPacketContentBufferInvalidCnt[packetSelect]++;
+			ctx->aciLinkStats.varPacketsInvalid[packetSelect]++;
+			if (ctx->aciVarPacketContentBufferInvalidCnt[packetSelect] == TIMEOUT_INVALID_PACKET) {
+				ctx->aciVarPacketContentBufferInvalidCnt[packetSelect]--;
+				ctx->aciUpdateVarPacketTimeOut[packetSelect] = 1; //trigger resend packet configuration
 			}
 		}
 		break;
 
 	case ACIMT_PARAM:
-		temp_id = (aciRxDataBuffer[1] << 8) | aciRxDataBuffer[0];
+		{
+			struct ACI_MEM_TABLE_ENTRY *entry;
+			temp_id = (ctx->aciRxDataBuffer[1] << 8) | ctx->aciRxDataBuffer[0];
+			entry = aciCtxGetParameterItemById(ctx, temp_id);
 
-		if(((short)(aciGetParameterItemById(temp_id)->varType>>2))==(length-2))
-			memcpy(aciGetParameterItemById(temp_id)->ptrToVar,&aciRxDataBuffer[2],length-2);
+			if((entry) && (((short)(entry->varType>>2))==(length-2)))
+				memcpy(entry->ptrToVar,&ctx->aciRxDataBuffer[2],length-2);
+		}
 
 
 		break;
 
 	case ACIMT_PACKETRATEINFO:
-		memcpy(&aciVarPacketTransmissionRate[0], &aciRxDataBuffer[0], MAX_VAR_PACKETS*2);
+		//one rate per packet of the device
+		if (length > ctx->aciVarPacketCount*2)
+			length = ctx->aciVarPacketCount*2;
+		memcpy(&ctx->aciVarPacketTransmissionRate[0], &ctx->aciRxDataBuffer[0], length & ~1);
 		break;
 
 	case ACIMT_SAVEPARAM:
 		if(length==2){
-			if(aciParaStoredC) aciParaStoredC();
+			if(ctx->aciParaStoredC) ctx->aciParaStoredC(ctx->aciUserData);
 		}
 		break;
 
 	case ACIMT_SINGLESEND:
 		if(length>4) {
-		temp_id = (aciRxDataBuffer[1] << 8) | aciRxDataBuffer[0];
-		if(temp_id!=0) aciTxSendPacket(ACIMT_SINGLESEND, &temp_id, 2);
-		temp_id = (aciRxDataBuffer[3] << 8) | aciRxDataBuffer[2];
-		temp_ack = aciRxDataBuffer[4];
+		temp_id = (ctx->aciRxDataBuffer[1] << 8) | ctx->aciRxDataBuffer[0];
+		if(temp_id!=0) aciTxSendPacket(ctx, ACIMT_SINGLESEND, &temp_id, 2);
+		temp_id = (ctx->aciRxDataBuffer[3] << 8) | ctx->aciRxDataBuffer[2];
+		temp_ack = ctx->aciRxDataBuffer[4];
 
-		if(aciSingleReceivedC) aciSingleReceivedC(temp_id,&aciRxDataBuffer[5],temp_ack);
+		if(ctx->aciSingleReceivedC) ctx->aciSingleReceivedC(ctx->aciUserData, temp_id,&ctx->aciRxDataBuffer[5],temp_ack);
 		}
 		break;
 
 	case ACIMT_SINGLEREQ:
 		if(length>3) {
-		temp_id = (aciRxDataBuffer[1] << 8) | aciRxDataBuffer[0];
-		temp_ack = aciRxDataBuffer[2];
+		temp_id = (ctx->aciRxDataBuffer[1] << 8) | ctx->aciRxDataBuffer[0];
+		temp_ack = ctx->aciRxDataBuffer[2];
 
-		if(aciSingleReqReceivedC) aciSingleReqReceivedC(temp_id, &aciRxDataBuffer[3],temp_ack);
+		if(ctx->aciSingleReqReceivedC) ctx->aciSingleReqReceivedC(ctx->aciUserData, temp_id, &ctx->aciRxDataBuffer[3],temp_ack);
 
 		}
 		break;
 
 	case ACIMT_MAGICCODES:
-		if((length==12) && (magicCodeAlreadyRequested==0)) {
-			magicCodeAlreadyRequested=1;
-			aciRequestMagicCodes=0;
+		if((length==12) && (ctx->magicCodeAlreadyRequested==0)) {
+			ctx->magicCodeAlreadyRequested=1;
+			ctx->aciRequestMagicCodes=0;
 
 			unsigned short tempMagicVar, tempMagicCmd, tempMagicPar;
 			unsigned short tempVarCount, tempCmdCount, tempParCount;
 
-			tempMagicVar = (aciRxDataBuffer[1] << 8) | aciRxDataBuffer[0];
-			tempMagicCmd = (aciRxDataBuffer[3] << 8) | aciRxDataBuffer[2];
-			tempMagicPar = (aciRxDataBuffer[5] << 8) | aciRxDataBuffer[4];
+			tempMagicVar = (ctx->aciRxDataBuffer[1] << 8) | ctx->aciRxDataBuffer[0];
+			tempMagicCmd = (ctx->aciRxDataBuffer[3] << 8) | ctx->aciRxDataBuffer[2];
+			tempMagicPar = (ctx->aciRxDataBuffer[5] << 8) | ctx->aciRxDataBuffer[4];
 
-			tempVarCount = (aciRxDataBuffer[7] << 8) | aciRxDataBuffer[6];
-			tempCmdCount = (aciRxDataBuffer[9] << 8) | aciRxDataBuffer[8];
-			tempParCount = (aciRxDataBuffer[11] << 8) | aciRxDataBuffer[10];
+			tempVarCount = (ctx->aciRxDataBuffer[7] << 8) | ctx->aciRxDataBuffer[6];
+			tempCmdCount = (ctx->aciRxDataBuffer[9] << 8) | ctx->aciRxDataBuffer[8];
+			tempParCount = (ctx->aciRxDataBuffer[11] << 8) | ctx->aciRxDataBuffer[10];
 
-			aciLoadHeaderList();
+			aciLoadHeaderList(ctx);
 
-			if( (tempMagicVar==aciMagicCodeVar) && (tempMagicCmd==aciMagicCodeCmd) && (tempMagicPar==aciMagicCodePar) && (tempVarCount==aciMagicCodeVarLoaded) && (tempCmdCount==aciMagicCodeCmdLoaded) && (tempParCount==aciMagicCodeParLoaded))
+			if( (tempMagicVar==ctx->aciMagicCodeVar) && (tempMagicCmd==ctx->aciMagicCodeCmd) && (tempMagicPar==ctx->aciMagicCodePar) && (tempVarCount==ctx->aciMagicCodeVarLoaded) && (tempCmdCount==ctx->aciMagicCodeCmdLoaded) && (tempParCount==ctx->aciMagicCodeParLoaded))
 			{
-				aciLoadList();
-				aciRequestListType=0x70;
-				if(aciVarListUpdateFinished) aciVarListUpdateFinished();
-				if(aciCmdListUpdateFinished)  aciCmdListUpdateFinished();
-				if(aciParamListUpdateFinished) aciParamListUpdateFinished();
+				aciLoadList(ctx);
+				aciBuildTableIndex(ctx, &ctx->aciMemVarTableIndex, ctx->aciMemVarTableStart);
+				aciBuildTableIndex(ctx, &ctx->aciMemCmdTableIndex, ctx->aciMemCmdTableStart);
+				aciBuildTableIndex(ctx, &ctx->aciMemParamTableIndex, ctx->aciMemParamTableStart);
+				ctx->aciRequestListType=0x70;
+				if(ctx->aciVarListUpdateFinished) ctx->aciVarListUpdateFinished(ctx->aciUserData);
+				if(ctx->aciCmdListUpdateFinished)  ctx->aciCmdListUpdateFinished(ctx->aciUserData);
+				if(ctx->aciParamListUpdateFinished) ctx->aciParamListUpdateFinished(ctx->aciUserData);
 
 			} else {
-				aciMagicCodeVarLoaded = 0;
-				aciMagicCodeCmdLoaded = 0;
-				aciMagicCodeParLoaded = 0;
-
-				aciMagicCodeVar = 0x00FF;
-				aciMagicCodeCmd = 0x00FF;
-				aciMagicCodePar = 0x00FF;
-
-				aciMagicCodeOnHDFalse=1;
-
-				if(aciRequestListType&0x01) {
-					aciRequestVarListTimeout=0;
-					aciRequestListType&=~0x01;
-				} else 	if(aciRequestListType&0x02) {
-					aciRequestCmdListTimeout=0;
-					aciRequestListType&=~0x02;
-				} else 	if(aciRequestListType&0x04) {
-					aciRequestParListTimeout=0;
-					aciRequestListType&=~0x04;
+				ctx->aciMagicCodeVarLoaded = 0;
+				ctx->aciMagicCodeCmdLoaded = 0;
+				ctx->aciMagicCodeParLoaded = 0;
+
+				ctx->aciMagicCodeVar = 0x00FF;
+				ctx->aciMagicCodeCmd = 0x00FF;
+				ctx->aciMagicCodePar = 0x00FF;
+
+				ctx->aciMagicCodeOnHDFalse=1;
+
+				//all lists, which were requested, are downloaded now
+				if(ctx->aciRequestListType&0x01) {
+					ctx->aciRequestVarListTimeout=0;
+					ctx->aciRequestListType&=~0x01;
+				}
+				if(ctx->aciRequestListType&0x02) {
+					ctx->aciRequestCmdListTimeout=0;
+					ctx->aciRequestListType&=~0x02;
+				}
+				if(ctx->aciRequestListType&0x04) {
+					ctx->aciRequestParListTimeout=0;
+					ctx->aciRequestListType&=~0x04;
 				}
 			}
 
@@ -1548,87 +1945,95 @@ void aciRxHandleMessage(unsigned char messagetype, unsigned short length) {
 
 	case ACIMT_LOADPARAM:
 		if(length==2) {
-			if(aciParaLoadedC) aciParaLoadedC();
+			if(ctx->aciParaLoadedC) ctx->aciParaLoadedC(ctx->aciUserData);
+		}
+		break;
+
+	case ACIMT_BAUDRATE:
+		if(length==sizeof(struct ACI_BAUDRATE)) {
+			struct ACI_BAUDRATE reply;
+			memcpy(&reply, &ctx->aciRxDataBuffer[0], sizeof(reply));
+			if(ctx->aciBaudRateC) ctx->aciBaudRateC(ctx->aciUserData, reply.baudrate, reply.status);
 		}
 		break;
 
 	case ACI_DBG:
-		if(length==1) printf("ACI DEVICE DEBUG L1: %d\n", aciRxDataBuffer[0]);
+		if(length==1) printf("ACI DEVICE DEBUG L1: %d\n", ctx->aciRxDataBuffer[0]);
 		else if(length==2){
-			unsigned short temp_sh = (aciRxDataBuffer[1] << 8) | aciRxDataBuffer[0];
+			unsigned short temp_sh = (ctx->aciRxDataBuffer[1] << 8) | ctx->aciRxDataBuffer[0];
 			printf("ACI DEVICE DEBUG L2: %d\n",temp_sh);
 		}
 		else if(length==4){
 			int temp_int = 0;
-			memcpy(&temp_int,&aciRxDataBuffer[0],4);
+			memcpy(&temp_int,&ctx->aciRxDataBuffer[0],4);
 			printf("ACI DEVICE DEBUG L4: %d\n",temp_int);
 		}
 		break;
 
 	case ACIMT_ACK:
-		if ((aciRxDataBuffer[0] >= ACI_ACK_UPDATEVARPACKET) && (aciRxDataBuffer[0] <= ACI_ACK_UPDATEVARPACKET + 0x0f))
+		if ((ctx->aciRxDataBuffer[0] >= ACI_ACK_UPDATEVARPACKET) && (ctx->aciRxDataBuffer[0] <= ACI_ACK_UPDATEVARPACKET + 0x0f))
 			temp_ack = ACI_ACK_UPDATEVARPACKET;
-		else if ((aciRxDataBuffer[0] >= ACI_ACK_UPDATECMDPACKET) && (aciRxDataBuffer[0] <= ACI_ACK_UPDATECMDPACKET + 0x0f))
+		else if ((ctx->aciRxDataBuffer[0] >= ACI_ACK_UPDATECMDPACKET) && (ctx->aciRxDataBuffer[0] <= ACI_ACK_UPDATECMDPACKET + 0x0f))
 			temp_ack = ACI_ACK_UPDATECMDPACKET;
-		else if ((aciRxDataBuffer[0] >= ACIMT_UPDATEPARAMPACKET) && (aciRxDataBuffer[0] <= ACIMT_UPDATEPARAMPACKET + 0x0f))
+		else if ((ctx->aciRxDataBuffer[0] >= ACIMT_UPDATEPARAMPACKET) && (ctx->aciRxDataBuffer[0] <= ACIMT_UPDATEPARAMPACKET + 0x0f))
 			temp_ack = ACIMT_UPDATEPARAMPACKET;
-		else if ((aciRxDataBuffer[0] >= ACIMT_CMDACK) && (aciRxDataBuffer[0] <= ACIMT_CMDACK + 0x0f))
+		else if ((ctx->aciRxDataBuffer[0] >= ACIMT_CMDACK) && (ctx->aciRxDataBuffer[0] <= ACIMT_CMDACK + 0x0f))
 			temp_ack = ACIMT_CMDACK;
-		else if ((aciRxDataBuffer[0] >= ACIMT_PARAMPACKET) && (aciRxDataBuffer[0] <= ACIMT_PARAMPACKET + 0x0f))
+		else if ((ctx->aciRxDataBuffer[0] >= ACIMT_PARAMPACKET) && (ctx->aciRxDataBuffer[0] <= ACIMT_PARAMPACKET + 0x0f))
 			temp_ack = ACIMT_PARAMPACKET;
 
 		switch (temp_ack) {
 		case ACI_ACK_UPDATEVARPACKET:
-			packetSelect = aciRxDataBuffer[0] - ACI_ACK_UPDATEVARPACKET;
+			packetSelect = ctx->aciRxDataBuffer[0] - ACI_ACK_UPDATEVARPACKET;
 
-			if (packetSelect > MAX_VAR_PACKETS)
+			if (packetSelect >= MAX_VAR_PACKETS)
 				break;
-			if (aciRxDataBuffer[1] == ACI_ACK_OK)
-				aciUpdateVarPacketTimeOut[packetSelect] = 0;
-			else if (aciRxDataBuffer[1] == ACI_ACK_PACKET_TOO_LONG) {
+			if (ctx->aciRxDataBuffer[1] == ACI_ACK_OK)
+				ctx->aciUpdateVarPacketTimeOut[packetSelect] = 0;
+			else if (ctx->aciRxDataBuffer[1] == ACI_ACK_PACKET_TOO_LONG) {
 				// Variable packet too long
 				//printf("Variable packet too long\n");
 			} else
-				aciUpdateVarPacketTimeOut[packetSelect] = 1; //resend with next engine cycle
+				ctx->aciUpdateVarPacketTimeOut[packetSelect] = 1; //resend with next engine cycle
 			break;
 		case ACI_ACK_UPDATECMDPACKET:
-			packetSelect = aciRxDataBuffer[0] - ACI_ACK_UPDATECMDPACKET;
-			if (packetSelect > MAX_VAR_PACKETS)
+			packetSelect = ctx->aciRxDataBuffer[0] - ACI_ACK_UPDATECMDPACKET;
+			if (packetSelect >= MAX_VAR_PACKETS)
 				break;
-			if (aciRxDataBuffer[1] == ACI_ACK_OK)
-				aciUpdateCmdPacketTimeOut[packetSelect] = 0;
-			else if (aciRxDataBuffer[1] == ACI_ACK_PACKET_TOO_LONG) {
+			if (ctx->aciRxDataBuffer[1] == ACI_ACK_OK)
+				ctx->aciUpdateCmdPacketTimeOut[packetSelect] = 0;
+			else if (ctx->aciRxDataBuffer[1] == ACI_ACK_PACKET_TOO_LONG) {
 				// Command packet too long
 				//	printf("Command packet too long\n");
 				} else
-				aciUpdateCmdPacketTimeOut[packetSelect] = 1; //resend with next engine cycle
+				ctx->aciUpdateCmdPacketTimeOut[packetSelect] = 1; //resend with next engine cycle
 			break;
 
 		case ACIMT_CMDACK:
-			packetSelect = aciRxDataBuffer[0] - ACIMT_CMDACK;
-			aciCmdPacketSendStatus[packetSelect]=0;
-			if(aciCmdAck) aciCmdAck(packetSelect);
+			packetSelect = ctx->aciRxDataBuffer[0] - ACIMT_CMDACK;
+			ctx->aciCmdPacketSendStatus[packetSelect]=0;
+			if(ctx->aciCmdAck) ctx->aciCmdAck(ctx->aciUserData, packetSelect);
 			break;
 
 
 
 		case ACIMT_PARAMPACKET:
-			packetSelect = aciRxDataBuffer[0] - ACIMT_PARAMPACKET;
-			aciParamAck(packetSelect);
+			packetSelect = ctx->aciRxDataBuffer[0] - ACIMT_PARAMPACKET;
+			aciParamAck(ctx, packetSelect);
 			break;
 
 		case ACIMT_UPDATEPARAMPACKET:
-			packetSelect = aciRxDataBuffer[0] - ACIMT_UPDATEPARAMPACKET;
-			if (packetSelect > MAX_VAR_PACKETS)
+			packetSelect = ctx->aciRxDataBuffer[0] - ACIMT_UPDATEPARAMPACKET;
+			if (packetSelect >= MAX_VAR_PACKETS)
 				break;
-			if (aciRxDataBuffer[1] == ACI_ACK_OK) {
-				aciUpdateParamPacketTimeOut[packetSelect] = 0;
-				aciParamPacketStatus[packetSelect] = 1;
+			if (ctx->aciRxDataBuffer[1] == ACI_ACK_OK) {
+				ctx->aciUpdateParamPacketTimeOut[packetSelect] = 0;
+				ctx->aciParamPacketStatus[packetSelect] = 1;
 			}
-			else if (aciRxDataBuffer[1] == ACI_ACK_PACKET_TOO_LONG) {
+			else if (ctx->aciRxDataBuffer[1] == ACI_ACK_PACKET_TOO_LONG) {
 					//printf("Parameter packet too long\n");
 			} else
-				aciUpdateParamPacketTimeOut[packetSelect] = 1; //resend with next engine cycle
+				ctx->aciUpdateParamPacketTimeOut[packetSelect] = 1; //resend with next engine cycle
 			break;
 		}
 		break;
@@ -1636,213 +2041,284 @@ void aciRxHandleMessage(unsigned char messagetype, unsigned short length) {
 
 }
 
-void aciSetSingleReceivedCallback(void (*aciSingleReceived)(unsigned short id, void * data, unsigned char varType)) {
-	aciSingleReceivedC=aciSingleReceived;
+void aciCtxSetSingleReceivedCallback(aci_context_t * ctx, void (*aciSingleReceived)(void * userData, unsigned short id, void * data, unsigned char varType)) {
+	ctx->aciSingleReceivedC=aciSingleReceived;
 }
 
-void aciSetSingleRequestReceivedCallback(void (*aciSingleReqReceived)(unsigned short id, void * data, unsigned char varType)) {
-	aciSingleReqReceivedC=aciSingleReqReceived;
+void aciCtxSetSingleRequestReceivedCallback(aci_context_t * ctx, void (*aciSingleReqReceived)(void * userData, unsigned short id, void * data, unsigned char varType)) {
+	ctx->aciSingleReqReceivedC=aciSingleReqReceived;
 }
 
-void aciSetReadHDCallback(int (*aciReadHD)(void *data, int bytes)) {
-	aciReadHDC = aciReadHD;
+void aciCtxSetReadHDCallback(aci_context_t * ctx, int (*aciReadHD)(void * userData, void *data, int bytes)) {
+	ctx->aciReadHDC = aciReadHD;
 }
 
-void aciSetWriteHDCallback(int (*aciWriteHD)(void *data, int bytes)) {
-	aciWriteHDC = aciWriteHD;
+void aciCtxSetWriteHDCallback(aci_context_t * ctx, int (*aciWriteHD)(void * userData, void *data, int bytes)) {
+	ctx->aciWriteHDC = aciWriteHD;
 }
 
-void aciSetResetHDCallback(void (*aciResetHD)()) {
-	aciResetHDC = aciResetHD;
+void aciCtxSetResetHDCallback(aci_context_t * ctx, void (*aciResetHD)(void * userData)) {
+	ctx->aciResetHDC = aciResetHD;
 }
 
-void aciRequestSingleVariable(unsigned short id) {
-	if(aciRequestListType&0x10)
-	aciTxSendPacket(ACIMT_SINGLEREQ, &id, 2);
+void aciCtxRequestSingleVariable(aci_context_t * ctx, unsigned short id) {
+	if(ctx->aciRequestListType&0x10)
+	aciTxSendPacket(ctx, ACIMT_SINGLEREQ, &id, 2);
 }
 
-void aciSendParamStore(){
-	aciTxSendPacket(ACIMT_SAVEPARAM, NULL, 0);
+void aciCtxSendParamStore(aci_context_t * ctx){
+	aciTxSendPacket(ctx, ACIMT_SAVEPARAM, NULL, 0);
 }
 
-void aciSendParamLoad(){
-	aciTxSendPacket(ACIMT_LOADPARAM, NULL, 0);
+void aciCtxSendParamLoad(aci_context_t * ctx){
+	aciTxSendPacket(ctx, ACIMT_LOADPARAM, NULL, 0);
 }
 
+void aciCtxRequestBaudRate(aci_context_t * ctx, unsigned int baudrate){
+	struct ACI_BAUDRATE request;
+	request.baudrate = baudrate;
+	request.status = 0;
+	aciTxSendPacket(ctx, ACIMT_SETBAUDRATE, &request, sizeof(request));
+}
+
+void aciCtxConfirmBaudRate(aci_context_t * ctx, unsigned int baudrate){
+	struct ACI_BAUDRATE request;
+	request.baudrate = baudrate;
+	request.status = 0;
+	aciTxSendPacket(ctx, ACIMT_CONFIRMBAUDRATE, &request, sizeof(request));
+}
 
 
-unsigned char aciGetParamPacketStatus(unsigned short packetid)
+
+unsigned char aciCtxGetParamPacketStatus(aci_context_t * ctx, unsigned short packetid)
 {
 	if(packetid<MAX_VAR_PACKETS)
-	return aciParamPacketStatus[packetid];
+	return ctx->aciParamPacketStatus[packetid];
 	else return 0;
 }
 
 
 /** the aciReceiveHandler is fed by the uart rx function and decodes all neccessary packets  **/
-void aciReceiveHandler(unsigned char rxByte)
+void aciCtxReceiveHandler(aci_context_t * ctx, unsigned char rxByte)
 {
-	static unsigned char aciRxState=ARS_IDLE;
-	static unsigned char aciRxMessageType;
-	static unsigned short aciRxLength;
-	static unsigned short aciRxCrc;
-	static unsigned short aciRxReceivedCrc;
-
-
-	switch (aciRxState)
+	switch (ctx->aciRxState)
 	{
 		case ARS_IDLE:
 			if (rxByte=='!')
-				aciRxState=ARS_STARTBYTE1;
+				ctx->aciRxState=ARS_STARTBYTE1;
 		break;
 		case ARS_STARTBYTE1:
 			if (rxByte=='#')
-				aciRxState=ARS_STARTBYTE2;
+				ctx->aciRxState=ARS_STARTBYTE2;
 			else
-				aciRxState=ARS_IDLE;
+				ctx->aciRxState=ARS_IDLE;
 
 		break;
 		case ARS_STARTBYTE2:
 			if (rxByte=='!')
 			{
-                aciRxState=ARS_MESSAGETYPE;
+                ctx->aciRxState=ARS_MESSAGETYPE;
             }
 			else
-				aciRxState=ARS_IDLE;
+				ctx->aciRxState=ARS_IDLE;
 
 		break;
 		case ARS_MESSAGETYPE:
-			aciRxMessageType=rxByte;
-			aciRxCrc=0xff;
-			aciRxCrc=aciCrcUpdate(aciRxCrc,rxByte);
-			aciRxState=ARS_LENGTH1;
+			ctx->aciRxMessageType=rxByte;
+			ctx->aciRxCrc=0xff;
+			ctx->aciRxCrc=aciCrcUpdate(ctx->aciRxCrc,rxByte);
+			ctx->aciRxState=ARS_LENGTH1;
 		break;
 		case ARS_LENGTH1:
-			aciRxLength=rxByte;
-			aciRxCrc=aciCrcUpdate(aciRxCrc,rxByte);
-			aciRxState=ARS_LENGTH2;
+			ctx->aciRxLength=rxByte;
+			ctx->aciRxCrc=aciCrcUpdate(ctx->aciRxCrc,rxByte);
+			ctx->aciRxState=ARS_LENGTH2;
 		break;
 		case ARS_LENGTH2:
-			aciRxLength|=rxByte<<8;
-			if (aciRxLength>ACI_RX_BUFFER_SIZE)
-				aciRxState=ARS_IDLE;
+			ctx->aciRxLength|=rxByte<<8;
+			if (ctx->aciRxLength>ACI_RX_BUFFER_SIZE)
+				ctx->aciRxState=ARS_IDLE;
 			else
 			{
-			    aciRxCrc=aciCrcUpdate(aciRxCrc,rxByte);
-                aciRxDataCnt=0;
-			    if (aciRxLength)
-				   aciRxState=ARS_DATA;
+			    ctx->aciRxCrc=aciCrcUpdate(ctx->aciRxCrc,rxByte);
+                ctx->aciRxDataCnt=0;
+			    if (ctx->aciRxLength)
+				   ctx->aciRxState=ARS_DATA;
 			    else
-				    aciRxState=ARS_CRC1;
+				    ctx->aciRxState=ARS_CRC1;
             }
 		break;
 		case ARS_DATA:
-			aciRxCrc=aciCrcUpdate(aciRxCrc,rxByte);
-			aciRxDataBuffer[aciRxDataCnt++]=rxByte;
-			if ((aciRxDataCnt)==aciRxLength)
-				aciRxState=ARS_CRC1;
+			ctx->aciRxCrc=aciCrcUpdate(ctx->aciRxCrc,rxByte);
+			ctx->aciRxDataBuffer[ctx->aciRxDataCnt++]=rxByte;
+			if ((ctx->aciRxDataCnt)==ctx->aciRxLength)
+				ctx->aciRxState=ARS_CRC1;
 		break;
 		case ARS_CRC1:
-			aciRxReceivedCrc=rxByte;
-			aciRxState=ARS_CRC2;
+			ctx->aciRxReceivedCrc=rxByte;
+			ctx->aciRxState=ARS_CRC2;
 		break;
 		case ARS_CRC2:
-			aciRxReceivedCrc|=rxByte<<8;
-			if (aciRxReceivedCrc==aciRxCrc)
+			ctx->aciRxReceivedCrc|=rxByte<<8;
+			if (ctx->aciRxReceivedCrc==ctx->aciRxCrc)
 			{
-				aciRxHandleMessage(aciRxMessageType,aciRxLength);
+				ctx->aciLinkStats.framesReceived++;
+				aciRxHandleMessage(ctx, ctx->aciRxMessageType,ctx->aciRxLength);
 			}
-			aciRxState=ARS_IDLE;
+			else
+				ctx->aciLinkStats.crcErrors++;
+			ctx->aciRxState=ARS_IDLE;
 
 		break;
 	}
 }
 
-void aciStoreList() {
-	aciResetHDC();
+/** decodes a whole chunk of received bytes. Runs the same state machine as aciReceiveHandler, but
+ *  searches for the start byte with memchr and copies and checksums the payload in one go  **/
+void aciCtxReceiveBuffer(aci_context_t * ctx, const unsigned char * data, size_t length)
+{
+	aciCtxReceiveBufferTimed(ctx, data, length, 0, 0);
+}
+
+/** the last byte arrived at endTime, every byte before it byteTime earlier than its successor.
+ *  A frame is complete with its second crc byte, which always goes through aciReceiveHandler  **/
+void aciCtxReceiveBufferTimed(aci_context_t * ctx, const unsigned char * data, size_t length, double endTime, double byteTime)
+{
+	const unsigned char * end=data+length;
+	const unsigned char * next;
+	unsigned short cnt;
+
+	while (data<end)
+	{
+		if (ctx->aciRxState==ARS_IDLE)
+		{
+			next=(const unsigned char *)memchr(data,'!',end-data);
+			if (!next)
+				return;
+			data=next;
+		}
+		else if (ctx->aciRxState==ARS_DATA)
+		{
+			cnt=ctx->aciRxLength-ctx->aciRxDataCnt;
+			if ((size_t)(end-data)<cnt)
+				cnt=end-data;
+			memcpy(&ctx->aciRxDataBuffer[ctx->aciRxDataCnt],data,cnt);
+			ctx->aciRxCrc=aciUpdateCrc16(ctx->aciRxCrc,&ctx->aciRxDataBuffer[ctx->aciRxDataCnt],cnt);
+			ctx->aciRxDataCnt+=cnt;
+			data+=cnt;
+			if (ctx->aciRxDataCnt==ctx->aciRxLength)
+				ctx->aciRxState=ARS_CRC1;
+			continue;
+		}
+		if (endTime>0)
+			ctx->aciRxTime=endTime-(end-data-1)*byteTime;
+		aciCtxReceiveHandler(ctx, *data++);
+	}
+	ctx->aciRxTime=0;
+}
+
+void aciCtxGetLinkStats(aci_context_t * ctx, struct ACI_LINK_STATS * stats)
+{
+	*stats=ctx->aciLinkStats;
+}
+
+void aciStoreList(aci_context_t * ctx) {
+	ctx->aciResetHDC(ctx->aciUserData);
 	unsigned char buffer[12];
 
-	memcpy(&buffer[0],&aciMagicCodeVar,2);
-	memcpy(&buffer[2],&aciMagicCodeCmd,2);
-	memcpy(&buffer[4],&aciMagicCodePar,2);
+	memcpy(&buffer[0],&ctx->aciMagicCodeVar,2);
+	memcpy(&buffer[2],&ctx->aciMagicCodeCmd,2);
+	memcpy(&buffer[4],&ctx->aciMagicCodePar,2);
 
-	memcpy(&buffer[6],  &aciMagicCodeVarLoaded,2);
-	memcpy(&buffer[8],  &aciMagicCodeCmdLoaded,2);
-	memcpy(&buffer[10], &aciMagicCodeParLoaded,2);
+	memcpy(&buffer[6],  &ctx->aciMagicCodeVarLoaded,2);
+	memcpy(&buffer[8],  &ctx->aciMagicCodeCmdLoaded,2);
+	memcpy(&buffer[10], &ctx->aciMagicCodeParLoaded,2);
 
-	aciWriteHDC(buffer,12);
+	ctx->aciWriteHDC(ctx->aciUserData, buffer,12);
 
-	for(int i=0;i<aciMagicCodeVarLoaded;i++) {
-		if(aciGetVariableItemByIndex(i)==NULL) {
+	for(int i=0;i<ctx->aciMagicCodeVarLoaded;i++) {
+		if(aciCtxGetVariableItemByIndex(ctx, i)==NULL) {
 			return;
 		}
-		aciWriteHDC(aciGetVariableItemByIndex(i),sizeof(struct ACI_MEM_TABLE_ENTRY));
+		ctx->aciWriteHDC(ctx->aciUserData, aciCtxGetVariableItemByIndex(ctx, i),sizeof(struct ACI_MEM_TABLE_ENTRY));
 	}
 
-	for(int i=0;i<aciMagicCodeCmdLoaded;i++) {
-		if(aciGetCommandItemByIndex(i)==NULL) {
+	for(int i=0;i<ctx->aciMagicCodeCmdLoaded;i++) {
+		if(aciCtxGetCommandItemByIndex(ctx, i)==NULL) {
 			return;
 		}
-		aciWriteHDC(aciGetCommandItemByIndex(i),sizeof(struct ACI_MEM_TABLE_ENTRY));
+		ctx->aciWriteHDC(ctx->aciUserData, aciCtxGetCommandItemByIndex(ctx, i),sizeof(struct ACI_MEM_TABLE_ENTRY));
 	}
 
-	for(int i=0;i<aciMagicCodeParLoaded;i++) {
-		if(aciGetParameterItemByIndex(i)==NULL) {
+	for(int i=0;i<ctx->aciMagicCodeParLoaded;i++) {
+		if(aciCtxGetParameterItemByIndex(ctx, i)==NULL) {
 			return;
 		}
-		aciWriteHDC(aciGetParameterItemByIndex(i),sizeof(struct ACI_MEM_TABLE_ENTRY));
+		ctx->aciWriteHDC(ctx->aciUserData, aciCtxGetParameterItemByIndex(ctx, i),sizeof(struct ACI_MEM_TABLE_ENTRY));
 	}
 
 }
 
 
-void aciLoadHeaderList() {
+void aciLoadHeaderList(aci_context_t * ctx) {
 
 	unsigned char buffer[12];
-	if(aciReadHDC(buffer,12)<=0) {
+	if(ctx->aciReadHDC(ctx->aciUserData, buffer,12)<=0) {
 		return;
 	}
 
-	memcpy(&aciMagicCodeVar,&buffer[0],2);
-	memcpy(&aciMagicCodeCmd,&buffer[2],2);
-	memcpy(&aciMagicCodePar,&buffer[4],2);
+	memcpy(&ctx->aciMagicCodeVar,&buffer[0],2);
+	memcpy(&ctx->aciMagicCodeCmd,&buffer[2],2);
+	memcpy(&ctx->aciMagicCodePar,&buffer[4],2);
 
-	memcpy(&aciMagicCodeVarLoaded,  &buffer[6],2);
-	memcpy(&aciMagicCodeCmdLoaded,  &buffer[8],2);
-	memcpy(&aciMagicCodeParLoaded, &buffer[10],2);
+	memcpy(&ctx->aciMagicCodeVarLoaded,  &buffer[6],2);
+	memcpy(&ctx->aciMagicCodeCmdLoaded,  &buffer[8],2);
+	memcpy(&ctx->aciMagicCodeParLoaded, &buffer[10],2);
 
 }
 
-void aciLoadList() {
+void aciLoadList(aci_context_t * ctx) {
 
 	unsigned char buffer[sizeof(struct ACI_MEM_TABLE_ENTRY)];
 
-	aciMemVarTableCurrent = aciMemVarTableStart;
-	aciMemCmdTableCurrent = aciMemCmdTableStart;
-	aciMemParamTableCurrent = aciMemParamTableStart;
+	ctx->aciMemVarTableCurrent = ctx->aciMemVarTableStart;
+	ctx->aciMemCmdTableCurrent = ctx->aciMemCmdTableStart;
+	ctx->aciMemParamTableCurrent = ctx->aciMemParamTableStart;
 
-	for(int i=0;i<aciMagicCodeVarLoaded;i++) {
-		aciMemVarTableCurrent->next = malloc(sizeof(struct ACI_MEM_VAR_TABLE));
-		aciMemVarTableCurrent = aciMemVarTableCurrent->next;
-		aciReadHDC(buffer,sizeof(struct ACI_MEM_TABLE_ENTRY));
-		memcpy(&(aciMemVarTableCurrent->tableEntry), &buffer[0], sizeof(struct ACI_MEM_TABLE_ENTRY));
-		aciMemVarTableCurrent->next=NULL;
+	for(int i=0;i<ctx->aciMagicCodeVarLoaded;i++) {
+		ctx->aciMemVarTableCurrent->next = aciMalloc(ctx, sizeof(struct ACI_MEM_VAR_TABLE));
+		if (!ctx->aciMemVarTableCurrent->next)
+			break;
+		ctx->aciMemVarTableCurrent = ctx->aciMemVarTableCurrent->next;
+		ctx->aciReadHDC(ctx->aciUserData, buffer,sizeof(struct ACI_MEM_TABLE_ENTRY));
+		memcpy(&(ctx->aciMemVarTableCurrent->tableEntry), &buffer[0], sizeof(struct ACI_MEM_TABLE_ENTRY));
+		//the stored pointer belongs to the process, which wrote the list
+		ctx->aciMemVarTableCurrent->tableEntry.ptrToVar=NULL;
+		ctx->aciMemVarTableCurrent->next=NULL;
 	}
 
-	for(int i=0;i<aciMagicCodeCmdLoaded;i++) {
-		aciMemCmdTableCurrent->next = malloc(sizeof(struct ACI_MEM_VAR_TABLE));
-		aciMemCmdTableCurrent = aciMemCmdTableCurrent->next;
-		aciReadHDC(buffer,sizeof(struct ACI_MEM_TABLE_ENTRY));
-		memcpy(&(aciMemCmdTableCurrent->tableEntry), &buffer[0], sizeof(struct ACI_MEM_TABLE_ENTRY));
-		aciMemCmdTableCurrent->next=NULL;
+	for(int i=0;i<ctx->aciMagicCodeCmdLoaded;i++) {
+		ctx->aciMemCmdTableCurrent->next = aciMalloc(ctx, sizeof(struct ACI_MEM_VAR_TABLE));
+		if (!ctx->aciMemCmdTableCurrent->next)
+			break;
+		ctx->aciMemCmdTableCurrent = ctx->aciMemCmdTableCurrent->next;
+		ctx->aciReadHDC(ctx->aciUserData, buffer,sizeof(struct ACI_MEM_TABLE_ENTRY));
+		memcpy(&(ctx->aciMemCmdTableCurrent->tableEntry), &buffer[0], sizeof(struct ACI_MEM_TABLE_ENTRY));
+		//the stored pointer belongs to the process, which wrote the list
+		ctx->aciMemCmdTableCurrent->tableEntry.ptrToVar=NULL;
+		ctx->aciMemCmdTableCurrent->next=NULL;
 	}
 
-	for(int i=0;i<aciMagicCodeParLoaded;i++) {
-		aciMemParamTableCurrent->next = malloc(sizeof(struct ACI_MEM_VAR_TABLE));
-		aciMemParamTableCurrent = aciMemParamTableCurrent->next;
-		aciReadHDC(buffer,sizeof(struct ACI_MEM_TABLE_ENTRY));
-		memcpy(&(aciMemParamTableCurrent->tableEntry), &buffer[0], sizeof(struct ACI_MEM_TABLE_ENTRY));
-		aciMemParamTableCurrent->next=NULL;
+	for(int i=0;i<ctx->aciMagicCodeParLoaded;i++) {
+		ctx->aciMemParamTableCurrent->next = aciMalloc(ctx, sizeof(struct ACI_MEM_VAR_TABLE));
+		if (!ctx->aciMemParamTableCurrent->next)
+			break;
+		ctx->aciMemParamTableCurrent = ctx->aciMemParamTableCurrent->next;
+		ctx->aciReadHDC(ctx->aciUserData, buffer,sizeof(struct ACI_MEM_TABLE_ENTRY));
+		memcpy(&(ctx->aciMemParamTableCurrent->tableEntry), &buffer[0], sizeof(struct ACI_MEM_TABLE_ENTRY));
+		//the stored pointer belongs to the process, which wrote the list
+		ctx->aciMemParamTableCurrent->tableEntry.ptrToVar=NULL;
+		ctx->aciMemParamTableCurrent->next=NULL;
 	}
 
 
@@ -1855,27 +2331,1136 @@ void aciLoadList() {
  *
  */
 
-unsigned short aciCrcUpdate (unsigned short crc, unsigned char data)
-     {
-         data ^= (crc & 0xff);
-         data ^= data << 4;
+/// CRC-16/CCITT (reflected, poly 0x8408) of every single byte value
+const unsigned short aciCrcTable[256] = {
+	0x0000, 0x1189, 0x2312, 0x329b, 0x4624, 0x57ad, 0x6536, 0x74bf,
+	0x8c48, 0x9dc1, 0xaf5a, 0xbed3, 0xca6c, 0xdbe5, 0xe97e, 0xf8f7,
+	0x1081, 0x0108, 0x3393, 0x221a, 0x56a5, 0x472c, 0x75b7, 0x643e,
+	0x9cc9, 0x8d40, 0xbfdb, 0xae52, 0xdaed, 0xcb64, 0xf9ff, 0xe876,
+	0x2102, 0x308b, 0x0210, 0x1399, 0x6726, 0x76af, 0x4434, 0x55bd,
+	0xad4a, 0xbcc3, 0x8e58, 0x9fd1, 0xeb6e, 0xfae7, 0xc87c, 0xd9f5,
+	0x3183, 0x200a, 0x1291, 0x0318, 0x77a7, 0x662e, 0x54b5, 0x453c,
+	0xbdcb, 0xac42, 0x9ed9, 0x8f50, 0xfbef, 0xea66, 0xd8fd, 0xc974,
+	0x4204, 0x538d, 0x6116, 0x709f, 0x0420, 0x15a9, 0x2732, 0x36bb,
+	0xce4c, 0xdfc5, 0xed5e, 0xfcd7, 0x8868, 0x99e1, 0xab7a, 0xbaf3,
+	0x5285, 0x430c, 0x7197, 0x601e, 0x14a1, 0x0528, 0x37b3, 0x263a,
+	0xdecd, 0xcf44, 0xfddf, 0xec56, 0x98e9, 0x8960, 0xbbfb, 0xaa72,
+	0x6306, 0x728f, 0x4014, 0x519d, 0x2522, 0x34ab, 0x0630, 0x17b9,
+	0xef4e, 0xfec7, 0xcc5c, 0xddd5, 0xa96a, 0xb8e3, 0x8a78, 0x9bf1,
+	0x7387, 0x620e, 0x5095, 0x411c, 0x35a3, 0x242a, 0x16b1, 0x0738,
+	0xffcf, 0xee46, 0xdcdd, 0xcd54, 0xb9eb, 0xa862, 0x9af9, 0x8b70,
+	0x8408, 0x9581, 0xa71a, 0xb693, 0xc22c, 0xd3a5, 0xe13e, 0xf0b7,
+	0x0840, 0x19c9, 0x2b52, 0x3adb, 0x4e64, 0x5fed, 0x6d76, 0x7cff,
+	0x9489, 0x8500, 0xb79b, 0xa612, 0xd2ad, 0xc324, 0xf1bf, 0xe036,
+	0x18c1, 0x0948, 0x3bd3, 0x2a5a, 0x5ee5, 0x4f6c, 0x7df7, 0x6c7e,
+	0xa50a, 0xb483, 0x8618, 0x9791, 0xe32e, 0xf2a7, 0xc03c, 0xd1b5,
+	0x2942, 0x38cb, 0x0a50, 0x1bd9, 0x6f66, 0x7eef, 0x4c74, 0x5dfd,
+	0xb58b, 0xa402, 0x9699, 0x8710, 0xf3af, 0xe226, 0xd0bd, 0xc134,
+	0x39c3, 0x284a, 0x1ad1, 0x0b58, 0x7fe7, 0x6e6e, 0x5cf5, 0x4d7c,
+	0xc60c, 0xd785, 0xe51e, 0xf497, 0x8028, 0x91a1, 0xa33a, 0xb2b3,
+	0x4a44, 0x5bcd, 0x6956, 0x78df, 0x0c60, 0x1de9, 0x2f72, 0x3efb,
+	0xd68d, 0xc704, 0xf59f, 0xe416, 0x90a9, 0x8120, 0xb3bb, 0xa232,
+	0x5ac5, 0x4b4c, 0x79d7, 0x685e, 0x1ce1, 0x0d68, 0x3ff3, 0x2e7a,
+	0xe70e, 0xf687, 0xc41c, 0xd595, 0xa12a, 0xb0a3, 0x8238, 0x93b1,
+	0x6b46, 0x7acf, 0x4854, 0x59dd, 0x2d62, 0x3ceb, 0x0e70, 0x1ff9,
+	0xf78f, 0xe606, 0xd49d, 0xc514, 0xb1ab, 0xa022, 0x92b9, 0x8330,
+	0x7bc7, 0x6a4e, 0x58d5, 0x495c, 0x3de3, 0x2c6a, 0x1ef1, 0x0f78
+};
+
+/// aciCrcSliceTable[k][i] is the crc of byte i followed by k+1 zero bytes
+const unsigned short aciCrcSliceTable[7][256] = {
+	{
+		0x0000, 0x19d8, 0x33b0, 0x2a68, 0x6760, 0x7eb8, 0x54d0, 0x4d08,
+		0xcec0, 0xd718, 0xfd70, 0xe4a8, 0xa9a0, 0xb078, 0x9a10, 0x83c8,
+		0x9591, 0x8c49, 0xa621, 0xbff9, 0xf2f1, 0xeb29, 0xc141, 0xd899,
+		0x5b51, 0x4289, 0x68e1, 0x7139, 0x3c31, 0x25e9, 0x0f81, 0x1659,
+		0x2333, 0x3aeb, 0x1083, 0x095b, 0x4453, 0x5d8b, 0x77e3, 0x6e3b,
+		0xedf3, 0xf42b, 0xde43, 0xc79b, 0x8a93, 0x934b, 0xb923, 0xa0fb,
+		0xb6a2, 0xaf7a, 0x8512, 0x9cca, 0xd1c2, 0xc81a, 0xe272, 0xfbaa,
+		0x7862, 0x61ba, 0x4bd2, 0x520a, 0x1f02, 0x06da, 0x2cb2, 0x356a,
+		0x4666, 0x5fbe, 0x75d6, 0x6c0e, 0x2106, 0x38de, 0x12b6, 0x0b6e,
+		0x88a6, 0x917e, 0xbb16, 0xa2ce, 0xefc6, 0xf61e, 0xdc76, 0xc5ae,
+		0xd3f7, 0xca2f, 0xe047, 0xf99f, 0xb497, 0xad4f, 0x8727, 0x9eff,
+		0x1d37, 0x04ef, 0x2e87, 0x375f, 0x7a57, 0x638f, 0x49e7, 0x503f,
+		0x6555, 0x7c8d, 0x56e5, 0x4f3d, 0x0235, 0x1bed, 0x3185, 0x285d,
+		0xab95, 0xb24d, 0x9825, 0x81fd, 0xccf5, 0xd52d, 0xff45, 0xe69d,
+		0xf0c4, 0xe91c, 0xc374, 0xdaac, 0x97a4, 0x8e7c, 0xa414, 0xbdcc,
+		0x3e04, 0x27dc, 0x0db4, 0x146c, 0x5964, 0x40bc, 0x6ad4, 0x730c,
+		0x8ccc, 0x9514, 0xbf7c, 0xa6a4, 0xebac, 0xf274, 0xd81c, 0xc1c4,
+		0x420c, 0x5bd4, 0x71bc, 0x6864, 0x256c, 0x3cb4, 0x16dc, 0x0f04,
+		0x195d, 0x0085, 0x2aed, 0x3335, 0x7e3d, 0x67e5, 0x4d8d, 0x5455,
+		0xd79d, 0xce45, 0xe42d, 0xfdf5, 0xb0fd, 0xa925, 0x834d, 0x9a95,
+		0xafff, 0xb627, 0x9c4f, 0x8597, 0xc89f, 0xd147, 0xfb2f, 0xe2f7,
+		0x613f, 0x78e7, 0x528f, 0x4b57, 0x065f, 0x1f87, 0x35ef, 0x2c37,
+		0x3a6e, 0x23b6, 0x09de, 0x1006, 0x5d0e, 0x44d6, 0x6ebe, 0x7766,
+		0xf4ae, 0xed76, 0xc71e, 0xdec6, 0x93ce, 0x8a16, 0xa07e, 0xb9a6,
+		0xcaaa, 0xd372, 0xf91a, 0xe0c2, 0xadca, 0xb412, 0x9e7a, 0x87a2,
+		0x046a, 0x1db2, 0x37da, 0x2e02, 0x630a, 0x7ad2, 0x50ba, 0x4962,
+		0x5f3b, 0x46e3, 0x6c8b, 0x7553, 0x385b, 0x2183, 0x0beb, 0x1233,
+		0x91fb, 0x8823, 0xa24b, 0xbb93, 0xf69b, 0xef43, 0xc52b, 0xdcf3,
+		0xe999, 0xf041, 0xda29, 0xc3f1, 0x8ef9, 0x9721, 0xbd49, 0xa491,
+		0x2759, 0x3e81, 0x14e9, 0x0d31, 0x4039, 0x59e1, 0x7389, 0x6a51,
+		0x7c08, 0x65d0, 0x4fb8, 0x5660, 0x1b68, 0x02b0, 0x28d8, 0x3100,
+		0xb2c8, 0xab10, 0x8178, 0x98a0, 0xd5a8, 0xcc70, 0xe618, 0xffc0
+	},
+	{
+		0x0000, 0x5adc, 0xb5b8, 0xef64, 0x6361, 0x39bd, 0xd6d9, 0x8c05,
+		0xc6c2, 0x9c1e, 0x737a, 0x29a6, 0xa5a3, 0xff7f, 0x101b, 0x4ac7,
+		0x8595, 0xdf49, 0x302d, 0x6af1, 0xe6f4, 0xbc28, 0x534c, 0x0990,
+		0x4357, 0x198b, 0xf6ef, 0xac33, 0x2036, 0x7aea, 0x958e, 0xcf52,
+		0x033b, 0x59e7, 0xb683, 0xec5f, 0x605a, 0x3a86, 0xd5e2, 0x8f3e,
+		0xc5f9, 0x9f25, 0x7041, 0x2a9d, 0xa698, 0xfc44, 0x1320, 0x49fc,
+		0x86ae, 0xdc72, 0x3316, 0x69ca, 0xe5cf, 0xbf13, 0x5077, 0x0aab,
+		0x406c, 0x1ab0, 0xf5d4, 0xaf08, 0x230d, 0x79d1, 0x96b5, 0xcc69,
+		0x0676, 0x5caa, 0xb3ce, 0xe912, 0x6517, 0x3fcb, 0xd0af, 0x8a73,
+		0xc0b4, 0x9a68, 0x750c, 0x2fd0, 0xa3d5, 0xf909, 0x166d, 0x4cb1,
+		0x83e3, 0xd93f, 0x365b, 0x6c87, 0xe082, 0xba5e, 0x553a, 0x0fe6,
+		0x4521, 0x1ffd, 0xf099, 0xaa45, 0x2640, 0x7c9c, 0x93f8, 0xc924,
+		0x054d, 0x5f91, 0xb0f5, 0xea29, 0x662c, 0x3cf0, 0xd394, 0x8948,
+		0xc38f, 0x9953, 0x7637, 0x2ceb, 0xa0ee, 0xfa32, 0x1556, 0x4f8a,
+		0x80d8, 0xda04, 0x3560, 0x6fbc, 0xe3b9, 0xb965, 0x5601, 0x0cdd,
+		0x461a, 0x1cc6, 0xf3a2, 0xa97e, 0x257b, 0x7fa7, 0x90c3, 0xca1f,
+		0x0cec, 0x5630, 0xb954, 0xe388, 0x6f8d, 0x3551, 0xda35, 0x80e9,
+		0xca2e, 0x90f2, 0x7f96, 0x254a, 0xa94f, 0xf393, 0x1cf7, 0x462b,
+		0x8979, 0xd3a5, 0x3cc1, 0x661d, 0xea18, 0xb0c4, 0x5fa0, 0x057c,
+		0x4fbb, 0x1567, 0xfa03, 0xa0df, 0x2cda, 0x7606, 0x9962, 0xc3be,
+		0x0fd7, 0x550b, 0xba6f, 0xe0b3, 0x6cb6, 0x366a, 0xd90e, 0x83d2,
+		0xc915, 0x93c9, 0x7cad, 0x2671, 0xaa74, 0xf0a8, 0x1fcc, 0x4510,
+		0x8a42, 0xd09e, 0x3ffa, 0x6526, 0xe923, 0xb3ff, 0x5c9b, 0x0647,
+		0x4c80, 0x165c, 0xf938, 0xa3e4, 0x2fe1, 0x753d, 0x9a59, 0xc085,
+		0x0a9a, 0x5046, 0xbf22, 0xe5fe, 0x69fb, 0x3327, 0xdc43, 0x869f,
+		0xcc58, 0x9684, 0x79e0, 0x233c, 0xaf39, 0xf5e5, 0x1a81, 0x405d,
+		0x8f0f, 0xd5d3, 0x3ab7, 0x606b, 0xec6e, 0xb6b2, 0x59d6, 0x030a,
+		0x49cd, 0x1311, 0xfc75, 0xa6a9, 0x2aac, 0x7070, 0x9f14, 0xc5c8,
+		0x09a1, 0x537d, 0xbc19, 0xe6c5, 0x6ac0, 0x301c, 0xdf78, 0x85a4,
+		0xcf63, 0x95bf, 0x7adb, 0x2007, 0xac02, 0xf6de, 0x19ba, 0x4366,
+		0x8c34, 0xd6e8, 0x398c, 0x6350, 0xef55, 0xb589, 0x5aed, 0x0031,
+		0x4af6, 0x102a, 0xff4e, 0xa592, 0x2997, 0x734b, 0x9c2f, 0xc6f3
+	},
+	{
+		0x0000, 0x1cbb, 0x3976, 0x25cd, 0x72ec, 0x6e57, 0x4b9a, 0x5721,
+		0xe5d8, 0xf963, 0xdcae, 0xc015, 0x9734, 0x8b8f, 0xae42, 0xb2f9,
+		0xc3a1, 0xdf1a, 0xfad7, 0xe66c, 0xb14d, 0xadf6, 0x883b, 0x9480,
+		0x2679, 0x3ac2, 0x1f0f, 0x03b4, 0x5495, 0x482e, 0x6de3, 0x7158,
+		0x8f53, 0x93e8, 0xb625, 0xaa9e, 0xfdbf, 0xe104, 0xc4c9, 0xd872,
+		0x6a8b, 0x7630, 0x53fd, 0x4f46, 0x1867, 0x04dc, 0x2111, 0x3daa,
+		0x4cf2, 0x5049, 0x7584, 0x693f, 0x3e1e, 0x22a5, 0x0768, 0x1bd3,
+		0xa92a, 0xb591, 0x905c, 0x8ce7, 0xdbc6, 0xc77d, 0xe2b0, 0xfe0b,
+		0x16b7, 0x0a0c, 0x2fc1, 0x337a, 0x645b, 0x78e0, 0x5d2d, 0x4196,
+		0xf36f, 0xefd4, 0xca19, 0xd6a2, 0x8183, 0x9d38, 0xb8f5, 0xa44e,
+		0xd516, 0xc9ad, 0xec60, 0xf0db, 0xa7fa, 0xbb41, 0x9e8c, 0x8237,
+		0x30ce, 0x2c75, 0x09b8, 0x1503, 0x4222, 0x5e99, 0x7b54, 0x67ef,
+		0x99e4, 0x855f, 0xa092, 0xbc29, 0xeb08, 0xf7b3, 0xd27e, 0xcec5,
+		0x7c3c, 0x6087, 0x454a, 0x59f1, 0x0ed0, 0x126b, 0x37a6, 0x2b1d,
+		0x5a45, 0x46fe, 0x6333, 0x7f88, 0x28a9, 0x3412, 0x11df, 0x0d64,
+		0xbf9d, 0xa326, 0x86eb, 0x9a50, 0xcd71, 0xd1ca, 0xf407, 0xe8bc,
+		0x2d6e, 0x31d5, 0x1418, 0x08a3, 0x5f82, 0x4339, 0x66f4, 0x7a4f,
+		0xc8b6, 0xd40d, 0xf1c0, 0xed7b, 0xba5a, 0xa6e1, 0x832c, 0x9f97,
+		0xeecf, 0xf274, 0xd7b9, 0xcb02, 0x9c23, 0x8098, 0xa555, 0xb9ee,
+		0x0b17, 0x17ac, 0x3261, 0x2eda, 0x79fb, 0x6540, 0x408d, 0x5c36,
+		0xa23d, 0xbe86, 0x9b4b, 0x87f0, 0xd0d1, 0xcc6a, 0xe9a7, 0xf51c,
+		0x47e5, 0x5b5e, 0x7e93, 0x6228, 0x3509, 0x29b2, 0x0c7f, 0x10c4,
+		0x619c, 0x7d27, 0x58ea, 0x4451, 0x1370, 0x0fcb, 0x2a06, 0x36bd,
+		0x8444, 0x98ff, 0xbd32, 0xa189, 0xf6a8, 0xea13, 0xcfde, 0xd365,
+		0x3bd9, 0x2762, 0x02af, 0x1e14, 0x4935, 0x558e, 0x7043, 0x6cf8,
+		0xde01, 0xc2ba, 0xe777, 0xfbcc, 0xaced, 0xb056, 0x959b, 0x8920,
+		0xf878, 0xe4c3, 0xc10e, 0xddb5, 0x8a94, 0x962f, 0xb3e2, 0xaf59,
+		0x1da0, 0x011b, 0x24d6, 0x386d, 0x6f4c, 0x73f7, 0x563a, 0x4a81,
+		0xb48a, 0xa831, 0x8dfc, 0x9147, 0xc666, 0xdadd, 0xff10, 0xe3ab,
+		0x5152, 0x4de9, 0x6824, 0x749f, 0x23be, 0x3f05, 0x1ac8, 0x0673,
+		0x772b, 0x6b90, 0x4e5d, 0x52e6, 0x05c7, 0x197c, 0x3cb1, 0x200a,
+		0x92f3, 0x8e48, 0xab85, 0xb73e, 0xe01f, 0xfca4, 0xd969, 0xc5d2
+	},
+	{
+		0x0000, 0x0b44, 0x1688, 0x1dcc, 0x2d10, 0x2654, 0x3b98, 0x30dc,
+		0x5a20, 0x5164, 0x4ca8, 0x47ec, 0x7730, 0x7c74, 0x61b8, 0x6afc,
+		0xb440, 0xbf04, 0xa2c8, 0xa98c, 0x9950, 0x9214, 0x8fd8, 0x849c,
+		0xee60, 0xe524, 0xf8e8, 0xf3ac, 0xc370, 0xc834, 0xd5f8, 0xdebc,
+		0x6091, 0x6bd5, 0x7619, 0x7d5d, 0x4d81, 0x46c5, 0x5b09, 0x504d,
+		0x3ab1, 0x31f5, 0x2c39, 0x277d, 0x17a1, 0x1ce5, 0x0129, 0x0a6d,
+		0xd4d1, 0xdf95, 0xc259, 0xc91d, 0xf9c1, 0xf285, 0xef49, 0xe40d,
+		0x8ef1, 0x85b5, 0x9879, 0x933d, 0xa3e1, 0xa8a5, 0xb569, 0xbe2d,
+		0xc122, 0xca66, 0xd7aa, 0xdcee, 0xec32, 0xe776, 0xfaba, 0xf1fe,
+		0x9b02, 0x9046, 0x8d8a, 0x86ce, 0xb612, 0xbd56, 0xa09a, 0xabde,
+		0x7562, 0x7e26, 0x63ea, 0x68ae, 0x5872, 0x5336, 0x4efa, 0x45be,
+		0x2f42, 0x2406, 0x39ca, 0x328e, 0x0252, 0x0916, 0x14da, 0x1f9e,
+		0xa1b3, 0xaaf7, 0xb73b, 0xbc7f, 0x8ca3, 0x87e7, 0x9a2b, 0x916f,
+		0xfb93, 0xf0d7, 0xed1b, 0xe65f, 0xd683, 0xddc7, 0xc00b, 0xcb4f,
+		0x15f3, 0x1eb7, 0x037b, 0x083f, 0x38e3, 0x33a7, 0x2e6b, 0x252f,
+		0x4fd3, 0x4497, 0x595b, 0x521f, 0x62c3, 0x6987, 0x744b, 0x7f0f,
+		0x8a55, 0x8111, 0x9cdd, 0x9799, 0xa745, 0xac01, 0xb1cd, 0xba89,
+		0xd075, 0xdb31, 0xc6fd, 0xcdb9, 0xfd65, 0xf621, 0xebed, 0xe0a9,
+		0x3e15, 0x3551, 0x289d, 0x23d9, 0x1305, 0x1841, 0x058d, 0x0ec9,
+		0x6435, 0x6f71, 0x72bd, 0x79f9, 0x4925, 0x4261, 0x5fad, 0x54e9,
+		0xeac4, 0xe180, 0xfc4c, 0xf708, 0xc7d4, 0xcc90, 0xd15c, 0xda18,
+		0xb0e4, 0xbba0, 0xa66c, 0xad28, 0x9df4, 0x96b0, 0x8b7c, 0x8038,
+		0x5e84, 0x55c0, 0x480c, 0x4348, 0x7394, 0x78d0, 0x651c, 0x6e58,
+		0x04a4, 0x0fe0, 0x122c, 0x1968, 0x29b4, 0x22f0, 0x3f3c, 0x3478,
+		0x4b77, 0x4033, 0x5dff, 0x56bb, 0x6667, 0x6d23, 0x70ef, 0x7bab,
+		0x1157, 0x1a13, 0x07df, 0x0c9b, 0x3c47, 0x3703, 0x2acf, 0x218b,
+		0xff37, 0xf473, 0xe9bf, 0xe2fb, 0xd227, 0xd963, 0xc4af, 0xcfeb,
+		0xa517, 0xae53, 0xb39f, 0xb8db, 0x8807, 0x8343, 0x9e8f, 0x95cb,
+		0x2be6, 0x20a2, 0x3d6e, 0x362a, 0x06f6, 0x0db2, 0x107e, 0x1b3a,
+		0x71c6, 0x7a82, 0x674e, 0x6c0a, 0x5cd6, 0x5792, 0x4a5e, 0x411a,
+		0x9fa6, 0x94e2, 0x892e, 0x826a, 0xb2b6, 0xb9f2, 0xa43e, 0xaf7a,
+		0xc586, 0xcec2, 0xd30e, 0xd84a, 0xe896, 0xe3d2, 0xfe1e, 0xf55a
+	},
+	{
+		0x0000, 0x042b, 0x0856, 0x0c7d, 0x10ac, 0x1487, 0x18fa, 0x1cd1,
+		0x2158, 0x2573, 0x290e, 0x2d25, 0x31f4, 0x35df, 0x39a2, 0x3d89,
+		0x42b0, 0x469b, 0x4ae6, 0x4ecd, 0x521c, 0x5637, 0x5a4a, 0x5e61,
+		0x63e8, 0x67c3, 0x6bbe, 0x6f95, 0x7344, 0x776f, 0x7b12, 0x7f39,
+		0x8560, 0x814b, 0x8d36, 0x891d, 0x95cc, 0x91e7, 0x9d9a, 0x99b1,
+		0xa438, 0xa013, 0xac6e, 0xa845, 0xb494, 0xb0bf, 0xbcc2, 0xb8e9,
+		0xc7d0, 0xc3fb, 0xcf86, 0xcbad, 0xd77c, 0xd357, 0xdf2a, 0xdb01,
+		0xe688, 0xe2a3, 0xeede, 0xeaf5, 0xf624, 0xf20f, 0xfe72, 0xfa59,
+		0x02d1, 0x06fa, 0x0a87, 0x0eac, 0x127d, 0x1656, 0x1a2b, 0x1e00,
+		0x2389, 0x27a2, 0x2bdf, 0x2ff4, 0x3325, 0x370e, 0x3b73, 0x3f58,
+		0x4061, 0x444a, 0x4837, 0x4c1c, 0x50cd, 0x54e6, 0x589b, 0x5cb0,
+		0x6139, 0x6512, 0x696f, 0x6d44, 0x7195, 0x75be, 0x79c3, 0x7de8,
+		0x87b1, 0x839a, 0x8fe7, 0x8bcc, 0x971d, 0x9336, 0x9f4b, 0x9b60,
+		0xa6e9, 0xa2c2, 0xaebf, 0xaa94, 0xb645, 0xb26e, 0xbe13, 0xba38,
+		0xc501, 0xc12a, 0xcd57, 0xc97c, 0xd5ad, 0xd186, 0xddfb, 0xd9d0,
+		0xe459, 0xe072, 0xec0f, 0xe824, 0xf4f5, 0xf0de, 0xfca3, 0xf888,
+		0x05a2, 0x0189, 0x0df4, 0x09df, 0x150e, 0x1125, 0x1d58, 0x1973,
+		0x24fa, 0x20d1, 0x2cac, 0x2887, 0x3456, 0x307d, 0x3c00, 0x382b,
+		0x4712, 0x4339, 0x4f44, 0x4b6f, 0x57be, 0x5395, 0x5fe8, 0x5bc3,
+		0x664a, 0x6261, 0x6e1c, 0x6a37, 0x76e6, 0x72cd, 0x7eb0, 0x7a9b,
+		0x80c2, 0x84e9, 0x8894, 0x8cbf, 0x906e, 0x9445, 0x9838, 0x9c13,
+		0xa19a, 0xa5b1, 0xa9cc, 0xade7, 0xb136, 0xb51d, 0xb960, 0xbd4b,
+		0xc272, 0xc659, 0xca24, 0xce0f, 0xd2de, 0xd6f5, 0xda88, 0xdea3,
+		0xe32a, 0xe701, 0xeb7c, 0xef57, 0xf386, 0xf7ad, 0xfbd0, 0xfffb,
+		0x0773, 0x0358, 0x0f25, 0x0b0e, 0x17df, 0x13f4, 0x1f89, 0x1ba2,
+		0x262b, 0x2200, 0x2e7d, 0x2a56, 0x3687, 0x32ac, 0x3ed1, 0x3afa,
+		0x45c3, 0x41e8, 0x4d95, 0x49be, 0x556f, 0x5144, 0x5d39, 0x5912,
+		0x649b, 0x60b0, 0x6ccd, 0x68e6, 0x7437, 0x701c, 0x7c61, 0x784a,
+		0x8213, 0x8638, 0x8a45, 0x8e6e, 0x92bf, 0x9694, 0x9ae9, 0x9ec2,
+		0xa34b, 0xa760, 0xab1d, 0xaf36, 0xb3e7, 0xb7cc, 0xbbb1, 0xbf9a,
+		0xc0a3, 0xc488, 0xc8f5, 0xccde, 0xd00f, 0xd424, 0xd859, 0xdc72,
+		0xe1fb, 0xe5d0, 0xe9ad, 0xed86, 0xf157, 0xf57c, 0xf901, 0xfd2a
+	},
+	{
+		0x0000, 0x9fd5, 0x37bb, 0xa86e, 0x6f76, 0xf0a3, 0x58cd, 0xc718,
+		0xdeec, 0x4139, 0xe957, 0x7682, 0xb19a, 0x2e4f, 0x8621, 0x19f4,
+		0xb5c9, 0x2a1c, 0x8272, 0x1da7, 0xdabf, 0x456a, 0xed04, 0x72d1,
+		0x6b25, 0xf4f0, 0x5c9e, 0xc34b, 0x0453, 0x9b86, 0x33e8, 0xac3d,
+		0x6383, 0xfc56, 0x5438, 0xcbed, 0x0cf5, 0x9320, 0x3b4e, 0xa49b,
+		0xbd6f, 0x22ba, 0x8ad4, 0x1501, 0xd219, 0x4dcc, 0xe5a2, 0x7a77,
+		0xd64a, 0x499f, 0xe1f1, 0x7e24, 0xb93c, 0x26e9, 0x8e87, 0x1152,
+		0x08a6, 0x9773, 0x3f1d, 0xa0c8, 0x67d0, 0xf805, 0x506b, 0xcfbe,
+		0xc706, 0x58d3, 0xf0bd, 0x6f68, 0xa870, 0x37a5, 0x9fcb, 0x001e,
+		0x19ea, 0x863f, 0x2e51, 0xb184, 0x769c, 0xe949, 0x4127, 0xdef2,
+		0x72cf, 0xed1a, 0x4574, 0xdaa1, 0x1db9, 0x826c, 0x2a02, 0xb5d7,
+		0xac23, 0x33f6, 0x9b98, 0x044d, 0xc355, 0x5c80, 0xf4ee, 0x6b3b,
+		0xa485, 0x3b50, 0x933e, 0x0ceb, 0xcbf3, 0x5426, 0xfc48, 0x639d,
+		0x7a69, 0xe5bc, 0x4dd2, 0xd207, 0x151f, 0x8aca, 0x22a4, 0xbd71,
+		0x114c, 0x8e99, 0x26f7, 0xb922, 0x7e3a, 0xe1ef, 0x4981, 0xd654,
+		0xcfa0, 0x5075, 0xf81b, 0x67ce, 0xa0d6, 0x3f03, 0x976d, 0x08b8,
+		0x861d, 0x19c8, 0xb1a6, 0x2e73, 0xe96b, 0x76be, 0xded0, 0x4105,
+		0x58f1, 0xc724, 0x6f4a, 0xf09f, 0x3787, 0xa852, 0x003c, 0x9fe9,
+		0x33d4, 0xac01, 0x046f, 0x9bba, 0x5ca2, 0xc377, 0x6b19, 0xf4cc,
+		0xed38, 0x72ed, 0xda83, 0x4556, 0x824e, 0x1d9b, 0xb5f5, 0x2a20,
+		0xe59e, 0x7a4b, 0xd225, 0x4df0, 0x8ae8, 0x153d, 0xbd53, 0x2286,
+		0x3b72, 0xa4a7, 0x0cc9, 0x931c, 0x5404, 0xcbd1, 0x63bf, 0xfc6a,
+		0x5057, 0xcf82, 0x67ec, 0xf839, 0x3f21, 0xa0f4, 0x089a, 0x974f,
+		0x8ebb, 0x116e, 0xb900, 0x26d5, 0xe1cd, 0x7e18, 0xd676, 0x49a3,
+		0x411b, 0xdece, 0x76a0, 0xe975, 0x2e6d, 0xb1b8, 0x19d6, 0x8603,
+		0x9ff7, 0x0022, 0xa84c, 0x3799, 0xf081, 0x6f54, 0xc73a, 0x58ef,
+		0xf4d2, 0x6b07, 0xc369, 0x5cbc, 0x9ba4, 0x0471, 0xac1f, 0x33ca,
+		0x2a3e, 0xb5eb, 0x1d85, 0x8250, 0x4548, 0xda9d, 0x72f3, 0xed26,
+		0x2298, 0xbd4d, 0x1523, 0x8af6, 0x4dee, 0xd23b, 0x7a55, 0xe580,
+		0xfc74, 0x63a1, 0xcbcf, 0x541a, 0x9302, 0x0cd7, 0xa4b9, 0x3b6c,
+		0x9751, 0x0884, 0xa0ea, 0x3f3f, 0xf827, 0x67f2, 0xcf9c, 0x5049,
+		0x49bd, 0xd668, 0x7e06, 0xe1d3, 0x26cb, 0xb91e, 0x1170, 0x8ea5
+	},
+	{
+		0x0000, 0x81bf, 0x0b6f, 0x8ad0, 0x16de, 0x9761, 0x1db1, 0x9c0e,
+		0x2dbc, 0xac03, 0x26d3, 0xa76c, 0x3b62, 0xbadd, 0x300d, 0xb1b2,
+		0x5b78, 0xdac7, 0x5017, 0xd1a8, 0x4da6, 0xcc19, 0x46c9, 0xc776,
+		0x76c4, 0xf77b, 0x7dab, 0xfc14, 0x601a, 0xe1a5, 0x6b75, 0xeaca,
+		0xb6f0, 0x374f, 0xbd9f, 0x3c20, 0xa02e, 0x2191, 0xab41, 0x2afe,
+		0x9b4c, 0x1af3, 0x9023, 0x119c, 0x8d92, 0x0c2d, 0x86fd, 0x0742,
+		0xed88, 0x6c37, 0xe6e7, 0x6758, 0xfb56, 0x7ae9, 0xf039, 0x7186,
+		0xc034, 0x418b, 0xcb5b, 0x4ae4, 0xd6ea, 0x5755, 0xdd85, 0x5c3a,
+		0x65f1, 0xe44e, 0x6e9e, 0xef21, 0x732f, 0xf290, 0x7840, 0xf9ff,
+		0x484d, 0xc9f2, 0x4322, 0xc29d, 0x5e93, 0xdf2c, 0x55fc, 0xd443,
+		0x3e89, 0xbf36, 0x35e6, 0xb459, 0x2857, 0xa9e8, 0x2338, 0xa287,
+		0x1335, 0x928a, 0x185a, 0x99e5, 0x05eb, 0x8454, 0x0e84, 0x8f3b,
+		0xd301, 0x52be, 0xd86e, 0x59d1, 0xc5df, 0x4460, 0xceb0, 0x4f0f,
+		0xfebd, 0x7f02, 0xf5d2, 0x746d, 0xe863, 0x69dc, 0xe30c, 0x62b3,
+		0x8879, 0x09c6, 0x8316, 0x02a9, 0x9ea7, 0x1f18, 0x95c8, 0x1477,
+		0xa5c5, 0x247a, 0xaeaa, 0x2f15, 0xb31b, 0x32a4, 0xb874, 0x39cb,
+		0xcbe2, 0x4a5d, 0xc08d, 0x4132, 0xdd3c, 0x5c83, 0xd653, 0x57ec,
+		0xe65e, 0x67e1, 0xed31, 0x6c8e, 0xf080, 0x713f, 0xfbef, 0x7a50,
+		0x909a, 0x1125, 0x9bf5, 0x1a4a, 0x8644, 0x07fb, 0x8d2b, 0x0c94,
+		0xbd26, 0x3c99, 0xb649, 0x37f6, 0xabf8, 0x2a47, 0xa097, 0x2128,
+		0x7d12, 0xfcad, 0x767d, 0xf7c2, 0x6bcc, 0xea73, 0x60a3, 0xe11c,
+		0x50ae, 0xd111, 0x5bc1, 0xda7e, 0x4670, 0xc7cf, 0x4d1f, 0xcca0,
+		0x266a, 0xa7d5, 0x2d05, 0xacba, 0x30b4, 0xb10b, 0x3bdb, 0xba64,
+		0x0bd6, 0x8a69, 0x00b9, 0x8106, 0x1d08, 0x9cb7, 0x1667, 0x97d8,
+		0xae13, 0x2fac, 0xa57c, 0x24c3, 0xb8cd, 0x3972, 0xb3a2, 0x321d,
+		0x83af, 0x0210, 0x88c0, 0x097f, 0x9571, 0x14ce, 0x9e1e, 0x1fa1,
+		0xf56b, 0x74d4, 0xfe04, 0x7fbb, 0xe3b5, 0x620a, 0xe8da, 0x6965,
+		0xd8d7, 0x5968, 0xd3b8, 0x5207, 0xce09, 0x4fb6, 0xc566, 0x44d9,
+		0x18e3, 0x995c, 0x138c, 0x9233, 0x0e3d, 0x8f82, 0x0552, 0x84ed,
+		0x355f, 0xb4e0, 0x3e30, 0xbf8f, 0x2381, 0xa23e, 0x28ee, 0xa951,
+		0x439b, 0xc224, 0x48f4, 0xc94b, 0x5545, 0xd4fa, 0x5e2a, 0xdf95,
+		0x6e27, 0xef98, 0x6548, 0xe4f7, 0x78f9, 0xf946, 0x7396, 0xf229
+	}
+};
 
-         return ((((unsigned short )data << 8) | ((crc>>8)&0xff)) ^ (unsigned char )(data >> 4)
-                 ^ ((unsigned short )data << 3));
-     }
+unsigned short aciCrcUpdate (unsigned short crc, unsigned char data)
+{
+	return (crc>>8)^aciCrcTable[(crc^data)&0xff];
+}
 
 unsigned short aciUpdateCrc16(unsigned short crc, void * data, unsigned short cnt)
 {
 	unsigned short crcNew=crc;
 	unsigned char * chrData=(unsigned char *)data;
-    int i;
-    
-	for (i=0;i<cnt;i++)
-		crcNew=aciCrcUpdate(crcNew,chrData[i]);
+
+	// slice-by-8: eight table lookups per eight bytes, without a dependency between the lookups
+	while (cnt>=8)
+	{
+		crcNew^=chrData[0]|(chrData[1]<<8);
+		crcNew=aciCrcSliceTable[6][crcNew&0xff]^aciCrcSliceTable[5][crcNew>>8]
+			^aciCrcSliceTable[4][chrData[2]]^aciCrcSliceTable[3][chrData[3]]
+			^aciCrcSliceTable[2][chrData[4]]^aciCrcSliceTable[1][chrData[5]]
+			^aciCrcSliceTable[0][chrData[6]]^aciCrcTable[chrData[7]];
+		chrData+=8;
+		cnt-=8;
+	}
+
+	while (cnt--)
+		crcNew=(crcNew>>8)^aciCrcTable[(crcNew^*chrData++)&0xff];
 
 	return crcNew;
 }
 
+void aciFreeTableIndex(aci_context_t * ctx, struct ACI_MEM_TABLE_INDEX * index)
+{
+	int i;
+
+	for (i=0;i<ACI_INDEX_PAGES;i++)
+	{
+		if (index->page[i])
+			aciFree(ctx, index->page[i]);
+		index->page[i]=NULL;
+	}
+	index->valid=0;
+}
+
+void aciBuildTableIndex(aci_context_t * ctx, struct ACI_MEM_TABLE_INDEX * index, struct ACI_MEM_VAR_TABLE * start)
+{
+	struct ACI_MEM_VAR_TABLE * current = start;
+
+	aciFreeTableIndex(ctx, index);
+
+	while (current->next) {
+		unsigned char pageNo;
+
+		current = current->next;
+		pageNo = current->tableEntry.id >> 8;
+		if (!index->page[pageNo])
+		{
+			index->page[pageNo] = aciMalloc(ctx, ACI_INDEX_PAGE_SIZE * sizeof(struct ACI_MEM_TABLE_ENTRY *));
+			//without memory the linked list is still used for all lookups
+			if (!index->page[pageNo])
+			{
+				aciFreeTableIndex(ctx, index);
+				return;
+			}
+			memset(index->page[pageNo], 0, ACI_INDEX_PAGE_SIZE * sizeof(struct ACI_MEM_TABLE_ENTRY *));
+		}
+		//first entry wins, like the linked list search
+		if (!index->page[pageNo][current->tableEntry.id & 0xFF])
+			index->page[pageNo][current->tableEntry.id & 0xFF] = &current->tableEntry;
+	}
+	index->valid=1;
+}
+
+struct ACI_MEM_TABLE_ENTRY * aciLookupTableIndex(struct ACI_MEM_TABLE_INDEX * index, unsigned short id)
+{
+	struct ACI_MEM_TABLE_ENTRY ** page = index->page[id >> 8];
+
+	if (!page)
+		return NULL;
+	return page[id & 0xFF];
+}
+
+void aciCtxSetMemoryArena(aci_context_t * ctx, void * arena, size_t size)
+{
+	size_t align = sizeof(struct ACI_ARENA_BLOCK);
+	size_t skip = 0;
+
+	//the tables of the old arena must neither be used nor handed to free() later on, and the heap
+	//tables must not be handed to the arena
+	if (ctx->aciArena)
+		aciForgetArenaMemory(ctx);
+	else
+		aciFreeHeapMemory(ctx);
+	if (arena)
+		skip = (align - ((size_t) arena) % align) % align;
+	if ((!arena) || (size < skip + 2 * align)) {
+		ctx->aciArena = NULL;
+		ctx->aciArenaSize = 0;
+		return;
+	}
+	ctx->aciArena = (unsigned char *) arena + skip;
+	ctx->aciArenaSize = (size - skip) / align * align;
+}
+
+size_t aciCtxGetMemoryArenaPeak(aci_context_t * ctx)
+{
+	return ctx->aciArenaPeak;
+}
+
+void aciForgetArenaMemory(aci_context_t * ctx)
+{
+	int i;
+
+	ctx->aciMemVarTableStart = NULL;
+	ctx->aciMemCmdTableStart = NULL;
+	ctx->aciMemParamTableStart = NULL;
+	ctx->aciVarAssignTableStart = NULL;
+	ctx->aciCmdAssignTableStart = NULL;
+	ctx->aciParamAssignTableStart = NULL;
+	memset(&ctx->aciVarListDownload, 0, sizeof(ctx->aciVarListDownload));
+	memset(&ctx->aciCmdListDownload, 0, sizeof(ctx->aciCmdListDownload));
+	memset(&ctx->aciParamListDownload, 0, sizeof(ctx->aciParamListDownload));
+	for (i = 0; i < MAX_VAR_PACKETS; i++) {
+		ctx->aciVarPacket[i] = NULL;
+		ctx->aciVarPacketContentBuffer[i] = NULL;
+		ctx->aciVarPacketContentBufferLength[i] = 0;
+		ctx->aciVarPacketDecodePlan[i] = NULL;
+		ctx->aciCmdPacket[i] = NULL;
+		ctx->aciCmdPacketContentBuffer[i] = NULL;
+		ctx->aciCmdPacketContentBufferLength[i] = 0;
+		ctx->aciParamPacket[i] = NULL;
+		ctx->aciParamPacketContentBuffer[i] = NULL;
+		ctx->aciParamPacketContentBufferLength[i] = 0;
+	}
+	memset(&ctx->aciMemVarTableIndex, 0, sizeof(ctx->aciMemVarTableIndex));
+	memset(&ctx->aciMemCmdTableIndex, 0, sizeof(ctx->aciMemCmdTableIndex));
+	memset(&ctx->aciMemParamTableIndex, 0, sizeof(ctx->aciMemParamTableIndex));
+}
+
+void aciFreeHeapMemory(aci_context_t * ctx)
+{
+	int i;
+
+	if (ctx->aciMemVarTableStart)
+		aciFreeMemVarTable(ctx, ctx->aciMemVarTableStart);
+	if (ctx->aciMemCmdTableStart)
+		aciFreeMemVarTable(ctx, ctx->aciMemCmdTableStart);
+	if (ctx->aciMemParamTableStart)
+		aciFreeMemVarTable(ctx, ctx->aciMemParamTableStart);
+	aciFree(ctx, ctx->aciVarAssignTableStart);
+	aciFree(ctx, ctx->aciCmdAssignTableStart);
+	aciFree(ctx, ctx->aciParamAssignTableStart);
+	aciListDownloadFree(ctx, &ctx->aciVarListDownload);
+	aciListDownloadFree(ctx, &ctx->aciCmdListDownload);
+	aciListDownloadFree(ctx, &ctx->aciParamListDownload);
+	aciFreeTableIndex(ctx, &ctx->aciMemVarTableIndex);
+	aciFreeTableIndex(ctx, &ctx->aciMemCmdTableIndex);
+	aciFreeTableIndex(ctx, &ctx->aciMemParamTableIndex);
+	for (i = 0; i < MAX_VAR_PACKETS; i++) {
+		aciFree(ctx, ctx->aciVarPacket[i]);
+		aciFree(ctx, ctx->aciVarPacketContentBuffer[i]);
+		aciFree(ctx, ctx->aciVarPacketDecodePlan[i]);
+		aciFree(ctx, ctx->aciCmdPacket[i]);
+		aciFree(ctx, ctx->aciCmdPacketContentBuffer[i]);
+		aciFree(ctx, ctx->aciParamPacket[i]);
+		aciFree(ctx, ctx->aciParamPacketContentBuffer[i]);
+	}
+	//all of it is gone, so none of the pointers may be used again
+	aciForgetArenaMemory(ctx);
+}
+
+void aciResetMemoryArena(aci_context_t * ctx)
+{
+	struct ACI_ARENA_BLOCK * block = (struct ACI_ARENA_BLOCK *) ctx->aciArena;
+
+	//everything lived in the arena, so only the pointers have to be forgotten
+	aciForgetArenaMemory(ctx);
+	block->size = ctx->aciArenaSize - sizeof(struct ACI_ARENA_BLOCK);
+	block->used = 0;
+	ctx->aciArenaFirstFree = 0;
+	ctx->aciArenaUsed = 0;
+	ctx->aciArenaPeak = 0;
+}
+
+void * aciMalloc(aci_context_t * ctx, size_t size)
+{
+	struct ACI_ARENA_BLOCK * block;
+	struct ACI_ARENA_BLOCK * next;
+	size_t pos;
+
+	if (!ctx->aciArena)
+		return malloc(size);
+
+	//the arena is a row of blocks, each one starts with its header. First fit, free neighbours are merged on the way
+	size = (size + sizeof(struct ACI_ARENA_BLOCK) - 1) / sizeof(struct ACI_ARENA_BLOCK) * sizeof(struct ACI_ARENA_BLOCK);
+	for (pos = ctx->aciArenaFirstFree; pos < ctx->aciArenaSize; pos += sizeof(struct ACI_ARENA_BLOCK) + block->size) {
+		block = (struct ACI_ARENA_BLOCK *) &ctx->aciArena[pos];
+		if (block->used)
+			continue;
+		while (pos + sizeof(struct ACI_ARENA_BLOCK) + block->size < ctx->aciArenaSize) {
+			next = (struct ACI_ARENA_BLOCK *) &ctx->aciArena[pos + sizeof(struct ACI_ARENA_BLOCK) + block->size];
+			if (next->used)
+				break;
+			block->size += sizeof(struct ACI_ARENA_BLOCK) + next->size;
+		}
+		if (block->size < size)
+			continue;
+
+		if (block->size >= size + 2 * sizeof(struct ACI_ARENA_BLOCK)) {
+			next = (struct ACI_ARENA_BLOCK *) &ctx->aciArena[pos + sizeof(struct ACI_ARENA_BLOCK) + size];
+			next->size = block->size - size - sizeof(struct ACI_ARENA_BLOCK);
+			next->used = 0;
+			block->size = size;
+		}
+		block->used = 1;
+		if (pos == ctx->aciArenaFirstFree)
+			ctx->aciArenaFirstFree = pos + sizeof(struct ACI_ARENA_BLOCK) + block->size;
+		ctx->aciArenaUsed += sizeof(struct ACI_ARENA_BLOCK) + block->size;
+		if (ctx->aciArenaUsed > ctx->aciArenaPeak)
+			ctx->aciArenaPeak = ctx->aciArenaUsed;
+		return block + 1;
+	}
+	return NULL;
+}
+
+void aciFree(aci_context_t * ctx, void * ptr)
+{
+	struct ACI_ARENA_BLOCK * block;
+	size_t pos;
+
+	if (!ctx->aciArena) {
+		free(ptr);
+		return;
+	}
+	if (!ptr)
+		return;
+	block = (struct ACI_ARENA_BLOCK *) ptr - 1;
+	block->used = 0;
+	ctx->aciArenaUsed -= sizeof(struct ACI_ARENA_BLOCK) + block->size;
+	pos = (unsigned char *) block - ctx->aciArena;
+	if (pos < ctx->aciArenaFirstFree)
+		ctx->aciArenaFirstFree = pos;
+}
+
+/*
+ *
+ * ACI context
+ *
+ *
+ */
+
+void aciCtxSetDefaults(aci_context_t * ctx)
+{
+	static const aci_context_t defaults = ACI_CONTEXT_DEFAULTS;
+
+	*ctx = defaults;
+}
+
+aci_context_t * aciCtxCreate(void)
+{
+	aci_context_t * ctx = malloc(sizeof(aci_context_t));
+
+	if (ctx)
+		aciCtxSetDefaults(ctx);
+	return ctx;
+}
+
+void aciCtxDestroy(aci_context_t * ctx)
+{
+	if (!ctx)
+		return;
+	//memory of an arena belongs to the caller, only heap memory has to be given back
+	if (!ctx->aciArena)
+		aciFreeHeapMemory(ctx);
+	if (ctx != &aciDefaultContext)
+		free(ctx);
+}
+
+aci_context_t * aciGetDefaultContext(void)
+{
+	return &aciDefaultContext;
+}
+
+void aciCtxSetUserData(aci_context_t * ctx, void * userData)
+{
+	ctx->aciUserData = userData;
+}
+
+void * aciCtxGetUserData(aci_context_t * ctx)
+{
+	return ctx->aciUserData;
+}
+
+/*
+ *
+ * API without context, works on the default context
+ *
+ *
+ */
+
+//callbacks of the API without context, called through the adapters below
+void (*aciVarListUpdateFinishedLegacy)(void);
+void (*aciCmdListUpdateFinishedLegacy)(void);
+void (*aciParamListUpdateFinishedLegacy)(void);
+void (*aciCmdAckLegacy)(unsigned char packet);
+void (*aciInfoRecLegacy)(struct ACI_INFO);
+void (*aciVarPacketRecLegacy)(unsigned char packet);
+void (*aciVarPacketRecTimedLegacy)(unsigned char packet, double rxTime);
+void (*aciParaStoredCLegacy)(void);
+void (*aciParaLoadedCLegacy)(void);
+void (*aciSingleReceivedCLegacy)(unsigned short id, void * data, unsigned char varType);
+void (*aciSingleReqReceivedCLegacy)(unsigned short id, void * data, unsigned char varType);
+int (*aciReadHDCLegacy)(void *data, int bytes);
+int (*aciWriteHDCLegacy)(void *data, int bytes);
+void (*aciResetHDCLegacy)();
+void (*aciSendDataLegacy)(void * data, unsigned short cnt);
+void (*aciSendSegmentsLegacy)(const struct ACI_TX_SEGMENT * segments, unsigned char count);
+void (*aciBaudRateCLegacy)(unsigned int baudrate, unsigned char status);
+
+void aciVarListUpdateFinishedAdapter(void * userData)
+{
+	aciVarListUpdateFinishedLegacy();
+}
+
+void aciCmdListUpdateFinishedAdapter(void * userData)
+{
+	aciCmdListUpdateFinishedLegacy();
+}
+
+void aciParamListUpdateFinishedAdapter(void * userData)
+{
+	aciParamListUpdateFinishedLegacy();
+}
+
+void aciCmdAckAdapter(void * userData, unsigned char packet)
+{
+	aciCmdAckLegacy(packet);
+}
+
+void aciInfoRecAdapter(void * userData, struct ACI_INFO info)
+{
+	aciInfoRecLegacy(info);
+}
+
+void aciVarPacketRecAdapter(void * userData, unsigned char packet)
+{
+	aciVarPacketRecLegacy(packet);
+}
+
+void aciVarPacketRecTimedAdapter(void * userData, unsigned char packet, double rxTime)
+{
+	aciVarPacketRecTimedLegacy(packet, rxTime);
+}
+
+void aciParaStoredCAdapter(void * userData)
+{
+	aciParaStoredCLegacy();
+}
+
+void aciParaLoadedCAdapter(void * userData)
+{
+	aciParaLoadedCLegacy();
+}
+
+void aciBaudRateCAdapter(void * userData, unsigned int baudrate, unsigned char status)
+{
+	aciBaudRateCLegacy(baudrate, status);
+}
+
+void aciSingleReceivedCAdapter(void * userData, unsigned short id, void * data, unsigned char varType)
+{
+	aciSingleReceivedCLegacy(id, data, varType);
+}
+
+void aciSingleReqReceivedCAdapter(void * userData, unsigned short id, void * data, unsigned char varType)
+{
+	aciSingleReqReceivedCLegacy(id, data, varType);
+}
+
+int aciReadHDCAdapter(void * userData, void *data, int bytes)
+{
+	return aciReadHDCLegacy(data, bytes);
+}
+
+int aciWriteHDCAdapter(void * userData, void *data, int bytes)
+{
+	return aciWriteHDCLegacy(data, bytes);
+}
+
+void aciResetHDCAdapter(void * userData)
+{
+	aciResetHDCLegacy();
+}
+
+void aciSendDataAdapter(void * userData, void * data, unsigned short cnt)
+{
+	aciSendDataLegacy(data, cnt);
+}
+
+void aciSendSegmentsAdapter(void * userData, const struct ACI_TX_SEGMENT * segments, unsigned char count)
+{
+	aciSendSegmentsLegacy(segments, count);
+}
+
+void aciCheckVerConf(void)
+{
+	aciCtxCheckVerConf(aciGetDefaultContext());
+}
+
+void aciInit(void)
+{
+	aciCtxInit(aciGetDefaultContext());
+}
+
+void aciResetRemote(void)
+{
+	aciCtxResetRemote(aciGetDefaultContext());
+}
+
+void aciEngine(void)
+{
+	aciCtxEngine(aciGetDefaultContext());
+}
+
+void aciSetEngineRate(const unsigned short callsPerSecond, const unsigned short heartbeat)
+{
+	aciCtxSetEngineRate(aciGetDefaultContext(), callsPerSecond, heartbeat);
+}
+
+void aciResetVarPacketContent(unsigned char packetId)
+{
+	aciCtxResetVarPacketContent(aciGetDefaultContext(), packetId);
+}
+
+void aciResetCmdPacketContent(unsigned char packetId)
+{
+	aciCtxResetCmdPacketContent(aciGetDefaultContext(), packetId);
+}
+
+void aciResetParPacketContent(unsigned char packetId)
+{
+	aciCtxResetParPacketContent(aciGetDefaultContext(), packetId);
+}
+
+unsigned short aciGetVarPacketLength(unsigned char packetId)
+{
+	return aciCtxGetVarPacketLength(aciGetDefaultContext(), packetId);
+}
+
+unsigned short aciGetCmdPacketLength(unsigned char packetId)
+{
+	return aciCtxGetCmdPacketLength(aciGetDefaultContext(), packetId);
+}
+
+unsigned short aciGetParPacketLength(unsigned char packetId)
+{
+	return aciCtxGetParPacketLength(aciGetDefaultContext(), packetId);
+}
+
+unsigned short aciGetVarPacketItem(unsigned char packetId, unsigned short index)
+{
+	return aciCtxGetVarPacketItem(aciGetDefaultContext(), packetId, index);
+}
+
+unsigned short aciGetCmdPacketItem(unsigned char packetId, unsigned short index)
+{
+	return aciCtxGetCmdPacketItem(aciGetDefaultContext(), packetId, index);
+}
+
+unsigned short aciGetParPacketItem(unsigned char packetId, unsigned short index)
+{
+	return aciCtxGetParPacketItem(aciGetDefaultContext(), packetId, index);
+}
+
+unsigned short aciGetVarPacketRate(unsigned char packetId)
+{
+	return aciCtxGetVarPacketRate(aciGetDefaultContext(), packetId);
+}
+
+unsigned char aciGetVarPacketCount(void)
+{
+	return aciCtxGetVarPacketCount(aciGetDefaultContext());
+}
+
+void aciGetVarPacketRateFromDevice(void)
+{
+	aciCtxGetVarPacketRateFromDevice(aciGetDefaultContext());
+}
+
+void aciAddContentToVarPacket(unsigned char packetId, unsigned short id, void *var_ptr)
+{
+	aciCtxAddContentToVarPacket(aciGetDefaultContext(), packetId, id, var_ptr);
+}
+
+void aciAddContentToCmdPacket(const unsigned char packetId,const unsigned short id, void *var_ptr)
+{
+	aciCtxAddContentToCmdPacket(aciGetDefaultContext(), packetId, id, var_ptr);
+}
+
+void aciAddContentToParamPacket(unsigned char packetId,unsigned short id, void *var_ptr)
+{
+	aciCtxAddContentToParamPacket(aciGetDefaultContext(), packetId, id, var_ptr);
+}
+
+void aciSetVarPacketTransmissionRate(unsigned char packetId, unsigned short callsPerSecond)
+{
+	aciCtxSetVarPacketTransmissionRate(aciGetDefaultContext(), packetId, callsPerSecond);
+}
+
+void aciVarPacketUpdateTransmissionRates(void)
+{
+	aciCtxVarPacketUpdateTransmissionRates(aciGetDefaultContext());
+}
+
+char aciGetVarById(void * ptrToVar, const unsigned char varType, const unsigned short id)
+{
+	return aciCtxGetVarById(aciGetDefaultContext(), ptrToVar, varType, id);
+}
+
+void aciSynchronizeVars(void)
+{
+	aciCtxSynchronizeVars(aciGetDefaultContext());
+}
+
+void aciSetVarPacketDirectDecode(unsigned char enable)
+{
+	aciCtxSetVarPacketDirectDecode(aciGetDefaultContext(), enable);
+}
+
+void aciSetListRequestWindow(unsigned char window)
+{
+	aciCtxSetListRequestWindow(aciGetDefaultContext(), window);
+}
+
+unsigned char aciGetVarPacketSnapshot(unsigned char packetId, const void * base, void * copy, unsigned int size)
+{
+	return aciCtxGetVarPacketSnapshot(aciGetDefaultContext(), packetId, base, copy, size);
+}
+
+unsigned char aciGetVarPacketSnapshotTimed(unsigned char packetId, const void * base, void * copy, unsigned int size, double * rxTime)
+{
+	return aciCtxGetVarPacketSnapshotTimed(aciGetDefaultContext(), packetId, base, copy, size, rxTime);
+}
+
+void aciSendVariablePacketConfiguration(unsigned char packetId)
+{
+	aciCtxSendVariablePacketConfiguration(aciGetDefaultContext(), packetId);
+}
+
+void aciSendCommandPacketConfiguration(unsigned char packetId, unsigned char with_ack)
+{
+	aciCtxSendCommandPacketConfiguration(aciGetDefaultContext(), packetId, with_ack);
+}
+
+void aciSendParameterPacketConfiguration(unsigned char packetId)
+{
+	aciCtxSendParameterPacketConfiguration(aciGetDefaultContext(), packetId);
+}
+
+void aciSetVarListUpdateFinishedCallback(void(*aciVarListUpdateFinished_func)(void))
+{
+	aciVarListUpdateFinishedLegacy = aciVarListUpdateFinished_func;
+	aciCtxSetVarListUpdateFinishedCallback(aciGetDefaultContext(), aciVarListUpdateFinished_func ? aciVarListUpdateFinishedAdapter : NULL);
+}
+
+void aciSetCmdListUpdateFinishedCallback(void(*aciCmdListUpdateFinished_func)(void))
+{
+	aciCmdListUpdateFinishedLegacy = aciCmdListUpdateFinished_func;
+	aciCtxSetCmdListUpdateFinishedCallback(aciGetDefaultContext(), aciCmdListUpdateFinished_func ? aciCmdListUpdateFinishedAdapter : NULL);
+}
+
+void aciSetParamListUpdateFinishedCallback(void(*aciParamListUpdateFinished_func)(void))
+{
+	aciParamListUpdateFinishedLegacy = aciParamListUpdateFinished_func;
+	aciCtxSetParamListUpdateFinishedCallback(aciGetDefaultContext(), aciParamListUpdateFinished_func ? aciParamListUpdateFinishedAdapter : NULL);
+}
+
+void aciSetCmdAckCallback(void (*aciCmdAck_func)(unsigned char))
+{
+	aciCmdAckLegacy = aciCmdAck_func;
+	aciCtxSetCmdAckCallback(aciGetDefaultContext(), aciCmdAck_func ? aciCmdAckAdapter : NULL);
+}
+
+void aciInfoPacketReceivedCallback(void (*aciInfoRec_func)(struct ACI_INFO))
+{
+	aciInfoRecLegacy = aciInfoRec_func;
+	aciCtxInfoPacketReceivedCallback(aciGetDefaultContext(), aciInfoRec_func ? aciInfoRecAdapter : NULL);
+}
+
+void aciVarPacketReceivedCallback(void (*aciVarPacketRec_func)(unsigned char))
+{
+	aciVarPacketRecLegacy = aciVarPacketRec_func;
+	aciCtxVarPacketReceivedCallback(aciGetDefaultContext(), aciVarPacketRec_func ? aciVarPacketRecAdapter : NULL);
+}
+
+void aciVarPacketReceivedTimedCallback(void (*aciVarPacketRec_func)(unsigned char, double))
+{
+	aciVarPacketRecTimedLegacy = aciVarPacketRec_func;
+	aciCtxVarPacketReceivedTimedCallback(aciGetDefaultContext(), aciVarPacketRec_func ? aciVarPacketRecTimedAdapter : NULL);
+}
+
+void aciParPacketStoredCallback(void (*aciParPacketStored_func)(void))
+{
+	aciParaStoredCLegacy = aciParPacketStored_func;
+	aciCtxParPacketStoredCallback(aciGetDefaultContext(), aciParPacketStored_func ? aciParaStoredCAdapter : NULL);
+}
+
+void aciParPacketLoadedCallback(void (*aciParPacketLoaded_func)(void))
+{
+	aciParaLoadedCLegacy = aciParPacketLoaded_func;
+	aciCtxParPacketLoadedCallback(aciGetDefaultContext(), aciParPacketLoaded_func ? aciParaLoadedCAdapter : NULL);
+}
+
+void aciSetBaudRateCallback(void (*aciBaudRate_func)(unsigned int baudrate, unsigned char status))
+{
+	aciBaudRateCLegacy = aciBaudRate_func;
+	aciCtxSetBaudRateCallback(aciGetDefaultContext(), aciBaudRate_func ? aciBaudRateCAdapter : NULL);
+}
+
+void aciGetDeviceVariablesList(void)
+{
+	aciCtxGetDeviceVariablesList(aciGetDefaultContext());
+}
+
+void aciGetDeviceCommandsList(void)
+{
+	aciCtxGetDeviceCommandsList(aciGetDefaultContext());
+}
+
+void aciGetDeviceParametersList(void)
+{
+	aciCtxGetDeviceParametersList(aciGetDefaultContext());
+}
+
+void aciForceListRequestFromDevice(void)
+{
+	aciCtxForceListRequestFromDevice(aciGetDefaultContext());
+}
+
+void aciGetParamFromDevice(unsigned short id)
+{
+	aciCtxGetParamFromDevice(aciGetDefaultContext(), id);
+}
+
+struct ACI_MEM_TABLE_ENTRY *aciGetVariableItemByIndex(unsigned short index)
+{
+	return aciCtxGetVariableItemByIndex(aciGetDefaultContext(), index);
+}
+
+struct ACI_MEM_TABLE_ENTRY *aciGetVariableItemById(unsigned short id)
+{
+	return aciCtxGetVariableItemById(aciGetDefaultContext(), id);
+}
+
+struct ACI_MEM_TABLE_ENTRY *aciGetVariableItemByName(char * name)
+{
+	return aciCtxGetVariableItemByName(aciGetDefaultContext(), name);
+}
+
+unsigned short aciGetVarTableLength(void)
+{
+	return aciCtxGetVarTableLength(aciGetDefaultContext());
+}
+
+struct ACI_INFO aciGetInfo(void)
+{
+	return aciCtxGetInfo(aciGetDefaultContext());
+}
+
+struct ACI_MEM_TABLE_ENTRY *aciGetParameterItemByIndex(unsigned short index)
+{
+	return aciCtxGetParameterItemByIndex(aciGetDefaultContext(), index);
+}
+
+struct ACI_MEM_TABLE_ENTRY *aciGetParameterItemById(unsigned short id)
+{
+	return aciCtxGetParameterItemById(aciGetDefaultContext(), id);
+}
+
+struct ACI_MEM_TABLE_ENTRY *aciGetParameterItemByName(char * name)
+{
+	return aciCtxGetParameterItemByName(aciGetDefaultContext(), name);
+}
+
+unsigned short aciGetParamTableLenth(void)
+{
+	return aciCtxGetParamTableLenth(aciGetDefaultContext());
+}
+
+struct ACI_MEM_TABLE_ENTRY *aciGetCommandItemByIndex(unsigned short index)
+{
+	return aciCtxGetCommandItemByIndex(aciGetDefaultContext(), index);
+}
+
+struct ACI_MEM_TABLE_ENTRY *aciGetCommandItemById(unsigned short id)
+{
+	return aciCtxGetCommandItemById(aciGetDefaultContext(), id);
+}
+
+struct ACI_MEM_TABLE_ENTRY *aciGetCommandItemByName(char * name)
+{
+	return aciCtxGetCommandItemByName(aciGetDefaultContext(), name);
+}
+
+unsigned short aciGetCmdTableLenth(void)
+{
+	return aciCtxGetCmdTableLenth(aciGetDefaultContext());
+}
+
+void aciUpdateCmdPacket(const unsigned short packetId)
+{
+	aciCtxUpdateCmdPacket(aciGetDefaultContext(), packetId);
+}
+
+void aciUpdateParamPacket(const unsigned short packetId)
+{
+	aciCtxUpdateParamPacket(aciGetDefaultContext(), packetId);
+}
+
+unsigned char aciGetCmdSendStatus(const unsigned short packetId)
+{
+	return aciCtxGetCmdSendStatus(aciGetDefaultContext(), packetId);
+}
+
+void aciSetSingleReceivedCallback(void (*aciSingleReceived)(unsigned short id, void * data, unsigned char varType))
+{
+	aciSingleReceivedCLegacy = aciSingleReceived;
+	aciCtxSetSingleReceivedCallback(aciGetDefaultContext(), aciSingleReceived ? aciSingleReceivedCAdapter : NULL);
+}
+
+void aciSetSingleRequestReceivedCallback(void (*aciSingleReqReceived)(unsigned short id, void * data, unsigned char varType))
+{
+	aciSingleReqReceivedCLegacy = aciSingleReqReceived;
+	aciCtxSetSingleRequestReceivedCallback(aciGetDefaultContext(), aciSingleReqReceived ? aciSingleReqReceivedCAdapter : NULL);
+}
+
+void aciSetReadHDCallback(int (*aciReadHD)(void *data, int bytes))
+{
+	aciReadHDCLegacy = aciReadHD;
+	aciCtxSetReadHDCallback(aciGetDefaultContext(), aciReadHD ? aciReadHDCAdapter : NULL);
+}
+
+void aciSetWriteHDCallback(int (*aciWriteHD)(void *data, int bytes))
+{
+	aciWriteHDCLegacy = aciWriteHD;
+	aciCtxSetWriteHDCallback(aciGetDefaultContext(), aciWriteHD ? aciWriteHDCAdapter : NULL);
+}
+
+void aciSetResetHDCallback(void (*aciResetHD)())
+{
+	aciResetHDCLegacy = aciResetHD;
+	aciCtxSetResetHDCallback(aciGetDefaultContext(), aciResetHD ? aciResetHDCAdapter : NULL);
+}
+
+void aciRequestSingleVariable(unsigned short id)
+{
+	aciCtxRequestSingleVariable(aciGetDefaultContext(), id);
+}
+
+void aciSendParamStore(void)
+{
+	aciCtxSendParamStore(aciGetDefaultContext());
+}
+
+void aciSendParamLoad(void)
+{
+	aciCtxSendParamLoad(aciGetDefaultContext());
+}
+
+void aciRequestBaudRate(unsigned int baudrate)
+{
+	aciCtxRequestBaudRate(aciGetDefaultContext(), baudrate);
+}
+
+void aciConfirmBaudRate(unsigned int baudrate)
+{
+	aciCtxConfirmBaudRate(aciGetDefaultContext(), baudrate);
+}
+
+unsigned char aciGetParamPacketStatus(unsigned short packetid)
+{
+	return aciCtxGetParamPacketStatus(aciGetDefaultContext(), packetid);
+}
+
+void aciReceiveHandler(unsigned char rxByte)
+{
+	aciCtxReceiveHandler(aciGetDefaultContext(), rxByte);
+}
+
+void aciReceiveBuffer(const unsigned char * data, size_t length)
+{
+	aciCtxReceiveBuffer(aciGetDefaultContext(), data, length);
+}
+
+void aciReceiveBufferTimed(const unsigned char * data, size_t length, double endTime, double byteTime)
+{
+	aciCtxReceiveBufferTimed(aciGetDefaultContext(), data, length, endTime, byteTime);
+}
+
+void aciSetMemoryArena(void * arena, size_t size)
+{
+	aciCtxSetMemoryArena(aciGetDefaultContext(), arena, size);
+}
+
+size_t aciGetMemoryArenaPeak(void)
+{
+	return aciCtxGetMemoryArenaPeak(aciGetDefaultContext());
+}
+
+struct ACI_MEM_VAR_TABLE * aciGetMemVarTableStart(void)
+{
+	return aciDefaultContext.aciMemVarTableStart;
+}
+
+struct ACI_MEM_VAR_TABLE * aciGetMemVarTableCurrent(void)
+{
+	return aciDefaultContext.aciMemVarTableCurrent;
+}
+
+struct ACI_MEM_VAR_TABLE * aciGetMemCmdTableStart(void)
+{
+	return aciDefaultContext.aciMemCmdTableStart;
+}
+
+struct ACI_MEM_VAR_TABLE * aciGetMemCmdTableCurrent(void)
+{
+	return aciDefaultContext.aciMemCmdTableCurrent;
+}
+
+struct ACI_MEM_VAR_TABLE * aciGetMemParamTableStart(void)
+{
+	return aciDefaultContext.aciMemParamTableStart;
+}
+
+struct ACI_MEM_VAR_TABLE * aciGetMemParamTableCurrent(void)
+{
+	return aciDefaultContext.aciMemParamTableCurrent;
+}
+
+#ifdef __cplusplus
+void aciSetSendDataCallback(void (*aciSendDataCallback_func)(unsigned char * data, unsigned short cnt))
+#else
+void aciSetSendDataCallback(void (*aciSendDataCallback_func)(void * data, unsigned short cnt))
+#endif
+{
+	aciSendDataLegacy = (void (*)(void *, unsigned short)) aciSendDataCallback_func;
+	aciCtxSetSendDataCallback(aciGetDefaultContext(), aciSendDataCallback_func ? aciSendDataAdapter : NULL);
+}
+
+void aciSetSendSegmentsCallback(void (*aciSendSegmentsCallback_func)(const struct ACI_TX_SEGMENT * segments, unsigned char count))
+{
+	aciSendSegmentsLegacy = aciSendSegmentsCallback_func;
+	aciCtxSetSendSegmentsCallback(aciGetDefaultContext(), aciSendSegmentsCallback_func ? aciSendSegmentsAdapter : NULL);
+}
+
 #ifdef __cplusplus
 
  }
@@ -0,0 +1,704 @@
+/*
+ * bench_aci.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ */
+
+// Benchmarks of the ACI remote against the firmware ACI (hlp_sim.c), connected through a simulated serial link.
+// Every scenario runs in its own process, because both ACIs keep their state in globals.
+//   bench_aci startup  time until the three lists are downloaded, per request window and USB latency
+//   bench_aci lookup   cost of aciGetVariableItemById per table size
+//   bench_aci decode   cost of decoding one second of var packet data, byte by byte and block-wise
+//   bench_aci sync     cost of aciSynchronizeVars per tick with 70 variables, against a lookup per variable through the index or the list
+//   bench_aci crc      cost of the frame CRC per byte: the former bitwise routine, one table lookup per byte and slice-by-8
+//   bench_aci locks    lock waits of the engine and the receive path while publishers copy the variables,
+//                      under a reader/writer lock as hlp_node did before and from the var packet snapshots as it does now
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include <utility>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "asctecCommIntf.h"
+#include "hlp_sim.h"
+
+// internal functions of the remote, not part of the public header
+extern "C" {
+extern const unsigned short aciCrcTable[256];
+unsigned short aciUpdateCrc16(unsigned short crc, void * data, unsigned short cnt);
+}
+
+// serial link between both ACIs, stepped in 1 ms ticks like the firmware main loop
+class SimLink
+{
+public:
+	SimLink(unsigned int baud, unsigned int usbLatencyMs, unsigned short engineRate) :
+		bytes_per_ms_(baud / 10.0 / 1000.0), latency_(usbLatencyMs), engine_period_(1000 / engineRate),
+		hlp_credit_(0), remote_credit_(0), now_(0), sniff_(NULL)
+	{
+		instance_ = this;
+		aciSetSendDataCallback(SimLink::remoteSend);
+		aciSetEngineRate(engineRate, 10);
+	}
+
+	// runs the link for one ms. The HLP sends at line speed, the remote reads what the USB adapter delivered
+	void tick()
+	{
+		unsigned char byte;
+		std::vector<unsigned char> rx;
+
+		hlpSimTick();
+		hlp_credit_ += bytes_per_ms_;
+		while ((hlp_credit_ >= 1.0) && hlpSimTransmit(&byte)) {
+			to_remote_.push_back(std::make_pair(now_ + latency_, byte));
+			if (sniff_)
+				sniff_->push_back(byte);
+			hlp_credit_ -= 1.0;
+		}
+		if (hlp_credit_ > 1.0)
+			hlp_credit_ = 1.0;
+
+		remote_credit_ += bytes_per_ms_;
+		while ((remote_credit_ >= 1.0) && !remote_out_.empty()) {
+			hlpSimReceive(remote_out_.front());
+			remote_out_.pop_front();
+			remote_credit_ -= 1.0;
+		}
+		if (remote_credit_ > 1.0)
+			remote_credit_ = 1.0;
+
+		while (!to_remote_.empty() && (to_remote_.front().first <= now_)) {
+			rx.push_back(to_remote_.front().second);
+			to_remote_.pop_front();
+		}
+		if (!rx.empty())
+			aciReceiveBuffer(&rx[0], rx.size());
+
+		if ((now_ % engine_period_) == 0)
+			aciEngine();
+		now_++;
+	}
+
+	unsigned long now() const
+	{
+		return now_;
+	}
+
+	// runs the link for ms and keeps a copy of everything the HLP sent
+	void capture(std::vector<unsigned char> & out, unsigned long ms)
+	{
+		sniff_ = &out;
+		for (unsigned long end = now_ + ms; now_ < end;)
+			tick();
+		sniff_ = NULL;
+	}
+
+private:
+	static void remoteSend(void * data, unsigned short cnt)
+	{
+		unsigned char * bytes = (unsigned char *) data;
+
+		instance_->remote_out_.insert(instance_->remote_out_.end(), bytes, bytes + cnt);
+	}
+
+	static SimLink * instance_;
+
+	double bytes_per_ms_;
+	unsigned long latency_;
+	unsigned long engine_period_;
+	double hlp_credit_;
+	double remote_credit_;
+	unsigned long now_;
+	std::vector<unsigned char> * sniff_;
+	std::deque<unsigned char> remote_out_;
+	std::deque<std::pair<unsigned long, unsigned char> > to_remote_;
+};
+
+SimLink * SimLink::instance_ = NULL;
+
+static unsigned char listsDone = 0;
+
+static void varListFinished(void)
+{
+	listsDone |= 1;
+}
+
+static void cmdListFinished(void)
+{
+	listsDone |= 2;
+}
+
+static void paramListFinished(void)
+{
+	listsDone |= 4;
+}
+
+static double seconds(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// connects both sides and downloads the lists, returns the simulated ms it took or 0 on a time out
+static unsigned long startLink(SimLink & link, unsigned short vars, unsigned short cmds, unsigned short params, unsigned char window)
+{
+	hlpSimInit(vars, cmds, params);
+	aciInit();
+	aciSetVarListUpdateFinishedCallback(varListFinished);
+	aciSetCmdListUpdateFinishedCallback(cmdListFinished);
+	aciSetParamListUpdateFinishedCallback(paramListFinished);
+	aciSetListRequestWindow(window);
+	listsDone = 0;
+
+	aciCheckVerConf();
+	aciGetDeviceCommandsList();
+	aciGetDeviceParametersList();
+	aciGetDeviceVariablesList();
+	while (listsDone != 7) {
+		if (link.now() > 60000)
+			return 0;
+		link.tick();
+	}
+	return link.now();
+}
+
+static void benchStartup(unsigned int baud, unsigned int latency, unsigned char window)
+{
+	SimLink link(baud, latency, 100);
+	unsigned long ms = startLink(link, 56, 29, 7, window);
+
+	if (ms)
+		printf("startup  %6u baud  usb latency %2u ms  window %2u: %5lu ms\n", baud, latency, window, ms);
+	else
+		printf("startup  %6u baud  usb latency %2u ms  window %2u: timed out\n", baud, latency, window);
+}
+
+static void benchLookup(unsigned short vars)
+{
+	SimLink link(921600, 1, 100);
+	const int rounds = 200000;
+	volatile unsigned long sum = 0;
+
+	if (!startLink(link, vars, 1, 1, 4)) {
+		printf("lookup   %3u variables: list download timed out\n", vars);
+		return;
+	}
+
+	double start = seconds();
+	for (int r = 0; r < rounds; r++)
+		for (unsigned short i = 0; i < vars; i++)
+			sum += aciGetVariableItemById(0x0100 + i)->varType;
+	double elapsed = seconds() - start;
+
+	printf("lookup   %3u variables: %6.1f ns per lookup\n", vars, elapsed * 1e9 / rounds / vars);
+}
+
+static unsigned long varPackets = 0;
+
+static void varPacketReceived(unsigned char packet)
+{
+	varPackets++;
+}
+
+// one var packet of 4 INT32, 25 bytes on the wire, sent as often as the link allows
+static bool captureVarPacket(std::vector<unsigned char> & frame)
+{
+	SimLink link(921600, 1, 100);
+	static int vars[4];
+	std::vector<unsigned char> stream;
+
+	if (!startLink(link, 4, 1, 1, 4))
+		return false;
+	for (unsigned short i = 0; i < 4; i++)
+		aciAddContentToVarPacket(0, 0x0100 + i, &vars[i]);
+	aciSetVarPacketTransmissionRate(0, 1);
+	aciVarPacketUpdateTransmissionRates();
+	aciSendVariablePacketConfiguration(0);
+	link.capture(stream, 2000);
+
+	for (size_t i = 0; i + 25 <= stream.size(); i++)
+		if ((stream[i] == '!') && (stream[i + 1] == '#') && (stream[i + 2] == '!') && (stream[i + 3] == ACIMT_VARPACKET)
+				&& (stream[i + 4] == 17) && (stream[i + 5] == 0)) {
+			frame.assign(stream.begin() + i, stream.begin() + i + 25);
+			return true;
+		}
+	return false;
+}
+
+static void benchDecode(const std::vector<unsigned char> & frame, unsigned int baud)
+{
+	const int rounds = 50;
+	std::vector<unsigned char> second;
+
+	// the remote still has the configuration the frame was captured with, so it decodes every packet
+	aciVarPacketReceivedCallback(varPacketReceived);
+	while (second.size() + frame.size() <= baud / 10)
+		second.insert(second.end(), frame.begin(), frame.end());
+
+	double start = seconds();
+	varPackets = 0;
+	for (int r = 0; r < rounds; r++)
+		for (size_t i = 0; i < second.size(); i++)
+			aciReceiveHandler(second[i]);
+	double perByte = (seconds() - start) / rounds;
+	unsigned long perBytePackets = varPackets / rounds;
+
+	start = seconds();
+	varPackets = 0;
+	for (int r = 0; r < rounds; r++)
+		for (size_t i = 0; i < second.size(); i += 512)
+			aciReceiveBuffer(&second[i], (second.size() - i < 512) ? second.size() - i : 512);
+	double buffer = (seconds() - start) / rounds;
+
+	printf("decode   %6u baud: per byte %7.1f us, buffer %7.1f us, %lu / %lu packets\n", baud, perByte * 1e6, buffer * 1e6,
+			perBytePackets, varPackets / rounds);
+}
+
+// the shift and xor routine the remote used before the tables
+static unsigned short bitwiseCrcUpdate(unsigned short crc, unsigned char data)
+{
+	data ^= (crc & 0xff);
+	data ^= data << 4;
+
+	return ((((unsigned short)data << 8) | ((crc >> 8) & 0xff)) ^ (unsigned char)(data >> 4)
+			^ ((unsigned short)data << 3));
+}
+
+static void benchCrc(unsigned short length)
+{
+	const int rounds = 2000000 / length;
+	unsigned char frame[512];
+	volatile unsigned short sink = 0;
+	unsigned short crc;
+
+	for (unsigned short i = 0; i < length; i++)
+		frame[i] = (i * 131 + 7) & 0xff;
+
+	double start = seconds();
+	for (int r = 0; r < rounds; r++) {
+		crc = 0xff;
+		for (unsigned short i = 0; i < length; i++)
+			crc = bitwiseCrcUpdate(crc, frame[i]);
+		sink = crc;
+	}
+	double bitwise = seconds() - start;
+
+	// the byte loop of aciUpdateCrc16, which still handles the last bytes of a frame
+	start = seconds();
+	for (int r = 0; r < rounds; r++) {
+		crc = 0xff;
+		for (unsigned short i = 0; i < length; i++)
+			crc = (crc >> 8) ^ aciCrcTable[(crc ^ frame[i]) & 0xff];
+		sink = crc;
+	}
+	double table = seconds() - start;
+
+	start = seconds();
+	for (int r = 0; r < rounds; r++)
+		sink = aciUpdateCrc16(0xff, frame, length);
+	double slice = seconds() - start;
+
+	printf("crc      %3u bytes: bitwise %5.2f ns/byte, table %5.2f ns/byte, slice-by-8 %5.2f ns/byte\n", length,
+			bitwise * 1e9 / rounds / length, table * 1e9 / rounds / length, slice * 1e9 / rounds / length);
+	(void) sink;
+}
+
+// aciSynchronizeVars as it was before the decode plan: every variable looked up in the linked list, then copied
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+static void listScanSync(const unsigned char * const content[], unsigned char packets)
+{
+	for (unsigned char p = 0; p < packets; p++) {
+		const unsigned char * ptr = content[p];
+
+		for (unsigned short z = 0; z < aciGetVarPacketLength(p); z++) {
+			unsigned short id = aciGetVarPacketItem(p, z);
+			struct ACI_MEM_VAR_TABLE * current = aciGetMemVarTableStart();
+			struct ACI_MEM_TABLE_ENTRY * entry = NULL;
+
+			while (current->next) {
+				current = current->next;
+				if (current->tableEntry.id == id) {
+					entry = &current->tableEntry;
+					break;
+				}
+			}
+			if (!entry)
+				return;
+			memcpy(entry->ptrToVar, ptr, entry->varType >> 2);
+			ptr += entry->varType >> 2;
+		}
+	}
+}
+#pragma GCC diagnostic pop
+
+// the same with aciGetVariableItemById, which goes through the id index
+static void indexSync(const unsigned char * const content[], unsigned char packets)
+{
+	for (unsigned char p = 0; p < packets; p++) {
+		const unsigned char * ptr = content[p];
+
+		for (unsigned short z = 0; z < aciGetVarPacketLength(p); z++) {
+			struct ACI_MEM_TABLE_ENTRY * entry = aciGetVariableItemById(aciGetVarPacketItem(p, z));
+
+			if (!entry)
+				return;
+			memcpy(entry->ptrToVar, ptr, entry->varType >> 2);
+			ptr += entry->varType >> 2;
+		}
+	}
+}
+
+static int syncVars[70];
+
+// 70 INT32 variables, the most the firmware publishes, assigned to syncVars in two var packets of 35.
+// Returns the last frame of each packet the HLP sent
+static bool captureSyncFrames(std::vector<unsigned char> frames[2])
+{
+	SimLink link(921600, 1, 100);
+	std::vector<unsigned char> stream;
+
+	if (!startLink(link, 70, 1, 1, 4)) {
+		printf("list download timed out\n");
+		return false;
+	}
+	for (unsigned short i = 0; i < 70; i++)
+		aciAddContentToVarPacket(i / 35, 0x0100 + i, &syncVars[i]);
+	for (unsigned char p = 0; p < 2; p++) {
+		// both packets at 100 Hz, at full rate the first one alone fills the link
+		aciSetVarPacketTransmissionRate(p, 10);
+		aciSendVariablePacketConfiguration(p);
+	}
+	aciVarPacketUpdateTransmissionRates();
+	link.capture(stream, 2000);
+
+	// the last frame of each packet, by then the HLP has taken the configuration
+	for (size_t i = 0; i + 8 <= stream.size(); i++)
+		if ((stream[i] == '!') && (stream[i + 1] == '#') && (stream[i + 2] == '!') && (stream[i + 3] >= ACIMT_VARPACKET)
+				&& (stream[i + 3] < ACIMT_VARPACKET + 2) && (stream[i + 4] == 35 * 4 + 1) && (stream[i + 5] == 0)
+				&& (i + 35 * 4 + 9 <= stream.size()))
+			frames[stream[i + 3] - ACIMT_VARPACKET].assign(stream.begin() + i, stream.begin() + i + 35 * 4 + 9);
+	if (frames[0].empty() || frames[1].empty()) {
+		printf("the HLP sent no var packets\n");
+		return false;
+	}
+	return true;
+}
+
+static void benchSync(void)
+{
+	std::vector<unsigned char> frames[2];
+	const int rounds = 100000;
+
+	if (!captureSyncFrames(frames))
+		return;
+	// the payload after the magic code is what the list scan copied from
+	const unsigned char * const content[2] = { &frames[0][7], &frames[1][7] };
+
+	// only the sync is timed, every round receives both packets first, so there is something to copy
+	double plan = 0, index = 0, scan = 0, clock = 0;
+	for (int r = 0; r < rounds; r++) {
+		aciReceiveBuffer(&frames[0][0], frames[0].size());
+		aciReceiveBuffer(&frames[1][0], frames[1].size());
+		double start = seconds();
+		aciSynchronizeVars();
+		double middle = seconds();
+		indexSync(content, 2);
+		double last = seconds();
+		listScanSync(content, 2);
+		double end = seconds();
+		plan += middle - start;
+		index += last - middle;
+		scan += end - last;
+		clock += seconds() - end;
+	}
+	plan -= clock;
+	index -= clock;
+	scan -= clock;
+
+	printf("sync      70 variables: decode plan %6.1f ns, id index %6.1f ns, list scan %6.1f ns per tick\n", plan * 1e9 / rounds,
+			index * 1e9 / rounds, scan * 1e9 / rounds);
+}
+
+// one run of the locks scenario: the threads of hlp_node around one ACI, driven by the clock for a few seconds
+struct LockRun
+{
+	bool snapshots;
+	long publishUs;
+	bool publishBlocks;
+	double end;
+	pthread_mutex_t bufMutex;
+	pthread_rwlock_t sharedMutex;
+	std::vector<double> engineWaits;
+	std::vector<double> engineLate;
+	std::vector<double> rxWaits;
+	std::vector<unsigned char> frames[2];
+};
+
+static void discardSend(void * data, unsigned short cnt)
+{
+	(void) data;
+	(void) cnt;
+}
+
+static void sleepUntil(double t)
+{
+	struct timespec ts;
+
+	ts.tv_sec = (time_t) t;
+	ts.tv_nsec = (long) ((t - ts.tv_sec) * 1e9);
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0)
+		;
+}
+
+// the IO thread, a var packet every ms, each under buf_mtx_ like the receive handler of the node
+static void * lockRunIo(void * arg)
+{
+	LockRun * run = (LockRun *) arg;
+	double next = seconds();
+
+	for (unsigned long i = 0; next < run->end; i++) {
+		next += 0.001;
+		sleepUntil(next);
+		double start = seconds();
+		pthread_mutex_lock(&run->bufMutex);
+		run->rxWaits.push_back(seconds() - start);
+		aciReceiveBuffer(&run->frames[i & 1][0], run->frames[i & 1].size());
+		pthread_mutex_unlock(&run->bufMutex);
+	}
+	return NULL;
+}
+
+// the ACI Engine at 100 Hz. Formerly it kept buf_mtx_ and synchronised the variables under the exclusive lock
+static void * lockRunEngine(void * arg)
+{
+	LockRun * run = (LockRun *) arg;
+	double next = seconds();
+
+	while (next < run->end) {
+		next += 0.01;
+		sleepUntil(next);
+		double start = seconds();
+		run->engineLate.push_back(start - next);
+		pthread_mutex_lock(&run->bufMutex);
+		aciEngine();
+		if (run->snapshots) {
+			run->engineWaits.push_back(seconds() - start);
+		}
+		else {
+			pthread_rwlock_wrlock(&run->sharedMutex);
+			run->engineWaits.push_back(seconds() - start);
+			aciSynchronizeVars();
+			pthread_rwlock_unlock(&run->sharedMutex);
+		}
+		pthread_mutex_unlock(&run->bufMutex);
+	}
+	return NULL;
+}
+
+// converting and publishing, either on the CPU or blocked like a publish to a full connection
+static void lockRunPublish(const LockRun * run, const int * vars)
+{
+	volatile double sink = 0;
+
+	if (run->publishBlocks) {
+		sleepUntil(seconds() + run->publishUs * 1e-6);
+		return;
+	}
+	for (double stop = seconds() + run->publishUs * 1e-6; seconds() < stop;)
+		for (int i = 0; i < 70; i++)
+			sink = sink + vars[i] * 0.001;
+}
+
+struct LockRunPublisher
+{
+	LockRun * run;
+	double period;
+};
+
+static void * lockRunPublisher(void * arg)
+{
+	LockRunPublisher * pub = (LockRunPublisher *) arg;
+	LockRun * run = pub->run;
+	int copy[70];
+	double next = seconds();
+
+	while (next < run->end) {
+		next += pub->period;
+		sleepUntil(next);
+		if (run->snapshots) {
+			for (unsigned char p = 0; p < 2; p++)
+				aciGetVarPacketSnapshot(p, syncVars, copy, sizeof(copy));
+			lockRunPublish(run, copy);
+		}
+		else {
+			pthread_rwlock_rdlock(&run->sharedMutex);
+			lockRunPublish(run, syncVars);
+			pthread_rwlock_unlock(&run->sharedMutex);
+		}
+	}
+	return NULL;
+}
+
+static double percentile(std::vector<double> v, double p)
+{
+	if (v.empty())
+		return 0;
+	std::sort(v.begin(), v.end());
+	return v[(size_t) (p * (v.size() - 1) + 0.5)];
+}
+
+static void benchLocks(bool snapshots, long publishUs, bool publishBlocks)
+{
+	// the publisher threads of the node: IMU, status, GPS and laser. Their timers drift against the one
+	// of the engine, 0.7 % here, so that every phase between them turns up within the run
+	static const double periods[] = { 0.01007, 0.1007, 0.2007, 0.02007 };
+	LockRun run;
+	LockRunPublisher pubs[4];
+	pthread_t threads[6];
+	pthread_rwlockattr_t attr;
+
+	if (!captureSyncFrames(run.frames))
+		return;
+	// the simulated link is gone, the heartbeats of the engine go nowhere
+	aciSetSendDataCallback(discardSend);
+
+	run.snapshots = snapshots;
+	run.publishUs = publishUs;
+	run.publishBlocks = publishBlocks;
+	run.end = seconds() + 5.0;
+	run.engineWaits.reserve(1000);
+	run.engineLate.reserve(1000);
+	run.rxWaits.reserve(10000);
+	pthread_mutex_init(&run.bufMutex, NULL);
+	// boost::shared_mutex lets no new reader in while a writer waits
+	pthread_rwlockattr_init(&attr);
+	pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+	pthread_rwlock_init(&run.sharedMutex, &attr);
+
+	pthread_create(&threads[0], NULL, lockRunIo, &run);
+	pthread_create(&threads[1], NULL, lockRunEngine, &run);
+	for (int i = 0; i < 4; i++) {
+		pubs[i].run = &run;
+		pubs[i].period = periods[i];
+		pthread_create(&threads[2 + i], NULL, lockRunPublisher, &pubs[i]);
+	}
+	for (int i = 0; i < 6; i++)
+		pthread_join(threads[i], NULL);
+
+	printf("locks    %-8s publish %4ld us %-8s: engine locks p50 %5.1f p99 %7.1f max %7.1f us,"
+			" engine late p50 %5.1f p99 %7.1f us, rx lock p50 %5.1f p99 %7.1f max %7.1f us\n",
+			snapshots ? "snapshot" : "rwlock", publishUs, publishBlocks ? "blocking" : "on CPU",
+			percentile(run.engineWaits, 0.5) * 1e6, percentile(run.engineWaits, 0.99) * 1e6,
+			percentile(run.engineWaits, 1.0) * 1e6, percentile(run.engineLate, 0.5) * 1e6, percentile(run.engineLate, 0.99) * 1e6,
+			percentile(run.rxWaits, 0.5) * 1e6, percentile(run.rxWaits, 0.99) * 1e6, percentile(run.rxWaits, 1.0) * 1e6);
+}
+
+template<typename F>
+static void isolated(F run)
+{
+	fflush(stdout);
+	pid_t pid = fork();
+
+	if (pid == 0) {
+		run();
+		fflush(stdout);
+		_exit(0);
+	}
+	waitpid(pid, NULL, 0);
+}
+
+struct Startup
+{
+	unsigned int baud, latency;
+	unsigned char window;
+	void operator()() const { benchStartup(baud, latency, window); }
+};
+
+struct Lookup
+{
+	unsigned short vars;
+	void operator()() const { benchLookup(vars); }
+};
+
+struct Locks
+{
+	bool snapshots;
+	long publishUs;
+	bool publishBlocks;
+	void operator()() const { benchLocks(snapshots, publishUs, publishBlocks); }
+};
+
+struct Decode
+{
+	void operator()() const
+	{
+		static const unsigned int bauds[] = { 57600, 115200, 230400, 460800, 921600 };
+		std::vector<unsigned char> frame;
+
+		if (!captureVarPacket(frame)) {
+			printf("decode: the HLP sent no var packet\n");
+			return;
+		}
+		for (size_t i = 0; i < sizeof(bauds) / sizeof(bauds[0]); i++)
+			benchDecode(frame, bauds[i]);
+	}
+};
+
+int main(int argc, char **argv)
+{
+	const char * which = (argc > 1) ? argv[1] : "all";
+	bool all = !strcmp(which, "all");
+
+	if (all || !strcmp(which, "startup")) {
+		static const unsigned int latencies[] = { 1, 16 };
+		static const unsigned char windows[] = { 1, 4 };
+
+		for (int l = 0; l < 2; l++)
+			for (int w = 0; w < 2; w++) {
+				Startup s = { 57600, latencies[l], windows[w] };
+				isolated(s);
+			}
+	}
+	if (all || !strcmp(which, "lookup")) {
+		// 70 is MAX_VARIABLE_LIST of the firmware
+		static const unsigned short sizes[] = { 16, 70 };
+
+		for (int i = 0; i < 2; i++) {
+			Lookup l = { sizes[i] };
+			isolated(l);
+		}
+	}
+	if (all || !strcmp(which, "decode"))
+		isolated(Decode());
+	if (all || !strcmp(which, "sync"))
+		isolated(benchSync);
+	if (all || !strcmp(which, "crc")) {
+		// a var packet of 4 INT32, a table entry and a full receive buffer
+		static const unsigned short lengths[] = { 17, 131, 512 };
+
+		for (int i = 0; i < 3; i++)
+			benchCrc(lengths[i]);
+	}
+	if (all || !strcmp(which, "locks")) {
+		// converting a message, and a publish that waits 2 ms for a slow subscriber
+		static const Locks runs[] = {
+			{ false, 50, false }, { true, 50, false }, { false, 2000, true }, { true, 2000, true }
+		};
+
+		for (int i = 0; i < 4; i++)
+			isolated(runs[i]);
+	}
+	return 0;
+}
@@ -0,0 +1,141 @@
+/*
+ * hlp_pty.c
+ *
+ *  Created on: 17 Oct 2026
+ *
+ */
+
+// Stand-in HLP on a serial device: the firmware ACI of hlp_sim.c with the ids of the SDK firmware,
+// run at 1 kHz like the firmware main loop, sending no faster than the given baud rate would.
+// Meant for the slave of the pty the node creates with transport:=pty, e.g.
+//   hlp_pty /tmp/hlp 921600
+// Variable 0x0206 (Hx, published on the mag topic) carries the CLOCK_MONOTONIC microseconds of the tick
+// that sent it, so the receiver can tell the latency from the tick to the publish.
+// Runs until SIGTERM/SIGINT or until the other side of the pty goes away.
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "hlp_sim.h"
+
+#define HLP_PTY_TICK_NS 1000000L
+
+static volatile sig_atomic_t hlpPtyStop = 0;
+
+static void hlpPtySignal(int sig)
+{
+	(void)sig;
+	hlpPtyStop = 1;
+}
+
+static int hlpPtyOpen(const char * path)
+{
+	struct termios tio;
+	int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+	if (fd < 0)
+		return -1;
+	if (tcgetattr(fd, &tio) == 0) {
+		//raw, like the UART of the HLP
+		tio.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON);
+		tio.c_oflag &= ~OPOST;
+		tio.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+		tio.c_cflag &= ~(CSIZE | PARENB);
+		tio.c_cflag |= CS8;
+		//a read without data fails with EAGAIN, one returning 0 means the other side hung up
+		tio.c_cc[VMIN] = 1;
+		tio.c_cc[VTIME] = 0;
+		tcsetattr(fd, TCSANOW, &tio);
+	}
+	return fd;
+}
+
+int main(int argc, char ** argv)
+{
+	unsigned char rx[256];
+	unsigned char tx[4096];
+	struct timespec next;
+	struct sigaction sa;
+	double budget = 0.0;
+	double bytesPerTick;
+	long baud;
+	int fd;
+
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s <device> [baud, default 921600]\n", argv[0]);
+		return 2;
+	}
+	baud = (argc > 2) ? atol(argv[2]) : 921600;
+	//start bit, 8 data bits, stop bit
+	bytesPerTick = baud / 10.0 * HLP_PTY_TICK_NS / 1e9;
+
+	fd = hlpPtyOpen(argv[1]);
+	if (fd < 0) {
+		fprintf(stderr, "hlp_pty: cannot open %s: %s\n", argv[1], strerror(errno));
+		return 1;
+	}
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = hlpPtySignal;
+	sigaction(SIGTERM, &sa, NULL);
+	sigaction(SIGINT, &sa, NULL);
+
+	hlpSimInitFirmware();
+	hlpSimStampVariable(0x0206);
+
+	clock_gettime(CLOCK_MONOTONIC, &next);
+	while (!hlpPtyStop) {
+		ssize_t n;
+		ssize_t i;
+		int len = 0;
+
+		//the rx interrupt, everything that arrived since the last tick
+		while ((n = read(fd, rx, sizeof(rx))) > 0)
+			for (i = 0; i < n; i++)
+				hlpSimReceive(rx[i]);
+		if ((n == 0) || ((n < 0) && (errno != EAGAIN) && (errno != EINTR)))
+			break;
+
+		hlpSimTick();
+
+		//the UART drains the ring buffer at the line rate, a short tick never makes up for a long one
+		budget += bytesPerTick;
+		if (budget > (double)sizeof(tx))
+			budget = sizeof(tx);
+		while ((len < (int)budget) && hlpSimTransmit(&tx[len]))
+			len++;
+		budget = (len < (int)budget) ? 0.0 : budget - len;
+		if (len > 0) {
+			int off = 0;
+			while (off < len) {
+				n = write(fd, tx + off, len - off);
+				if (n > 0)
+					off += n;
+				else if ((n < 0) && (errno != EAGAIN) && (errno != EINTR))
+					break;
+			}
+			if (off < len)
+				break;
+		}
+
+		next.tv_nsec += HLP_PTY_TICK_NS;
+		if (next.tv_nsec >= 1000000000L) {
+			next.tv_nsec -= 1000000000L;
+			next.tv_sec++;
+		}
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR && !hlpPtyStop)
+			;
+	}
+
+	close(fd);
+	return 0;
+}
@@ -0,0 +1,194 @@
+/*
+ * hlp_sim.c
+ *
+ *  Created on: 17 Oct 2026
+ *
+ */
+
+// clock_gettime with -std=c99
+#define _POSIX_C_SOURCE 200112L
+
+// the firmware ACI is linked next to the remote, so the names both define get a prefix here
+#define aciCrcTable hlpAciCrcTable
+#define aciCrcUpdate hlpAciCrcUpdate
+#define aciUpdateCrc16 hlpAciUpdateCrc16
+#define aciEngine hlpAciEngine
+#define aciInit hlpAciInit
+#define aciReceiveHandler hlpAciReceiveHandler
+#define aciRxHandleMessage hlpAciRxHandleMessage
+#define aciSetBaudRateCallback hlpAciSetBaudRateCallback
+#define aciTxSendPacket hlpAciTxSendPacket
+
+#include "asctecCommIntfOnboard.c"
+
+#include <stdio.h>
+#include <time.h>
+
+static int hlpVar[MAX_VARIABLE_LIST];
+static short hlpCmd[MAX_COMMAND_LIST];
+static short hlpPar[MAX_PARAMETER_LIST];
+static char hlpNames[MAX_VARIABLE_LIST + MAX_COMMAND_LIST + MAX_PARAMETER_LIST][MAX_NAME_LENGTH];
+static unsigned short hlpVarId[MAX_VARIABLE_LIST];
+static int * hlpStamp = NULL;
+
+//the firmware storage of the ids, the host is little endian so an int holds any of the types
+static int hlpFwCmd[MAX_COMMAND_LIST];
+static int hlpFwPar[MAX_PARAMETER_LIST];
+
+struct HLP_SIM_RANGE
+{
+	unsigned short first;
+	unsigned short last;
+	unsigned char type;
+};
+
+//published by main.c of asctec_sdk3_firmware, plus the laser variable of the lab firmware
+static const struct HLP_SIM_RANGE hlpFwVars[] = {
+	{ 0x0001, 0x0005, VARTYPE_INT16 },
+	{ 0x0100, 0x0105, VARTYPE_UINT8 },
+	{ 0x0106, 0x010B, VARTYPE_INT32 },
+	{ 0x010C, 0x010F, VARTYPE_UINT32 },
+	{ 0x0110, 0x0110, VARTYPE_INT32 },
+	{ 0x0111, 0x0111, VARTYPE_UINT32 },
+	{ 0x0112, 0x0112, VARTYPE_UINT16 },
+	{ 0x0200, 0x0202, VARTYPE_INT32 },
+	{ 0x0203, 0x0205, VARTYPE_INT16 },
+	{ 0x0206, 0x0208, VARTYPE_INT32 },
+	{ 0x0300, 0x0306, VARTYPE_INT32 },
+	{ 0x0307, 0x0308, VARTYPE_INT16 },
+	{ 0x0600, 0x0607, VARTYPE_UINT16 },
+	{ 0x1001, 0x1001, VARTYPE_UINT16 },
+	{ 0x100C, 0x100D, VARTYPE_UINT16 },
+	{ 0x100F, 0x1011, VARTYPE_UINT8 },
+	{ 0x101E, 0x101E, VARTYPE_UINT16 },
+};
+
+static const struct HLP_SIM_RANGE hlpFwCmds[] = {
+	{ 0x0500, 0x0509, VARTYPE_UINT8 },
+	{ 0x050A, 0x050E, VARTYPE_INT16 },
+	{ 0x0600, 0x0602, VARTYPE_UINT8 },
+	{ 0x1001, 0x1001, VARTYPE_UINT32 },
+	{ 0x1002, 0x1003, VARTYPE_UINT8 },
+	{ 0x1004, 0x1005, VARTYPE_UINT16 },
+	{ 0x1006, 0x1006, VARTYPE_INT16 },
+	{ 0x1007, 0x100A, VARTYPE_INT32 },
+	{ 0x100B, 0x100B, VARTYPE_UINT8 },
+};
+
+static const struct HLP_SIM_RANGE hlpFwPars[] = {
+	{ 0x0001, 0x0002, VARTYPE_UINT16 },
+	{ 0x0003, 0x0005, VARTYPE_UINT8 },
+	{ 0x0400, 0x0401, VARTYPE_INT32 },
+};
+
+//byte in the UART holding register, written when the ringbuffer starts a transmission
+static unsigned char hlpTxByte;
+static unsigned char hlpTxPending = 0;
+
+static void hlpStartTx(unsigned char byte)
+{
+	hlpTxByte = byte;
+	hlpTxPending = 1;
+}
+
+static char * hlpName(int i, const char * prefix, int n)
+{
+	snprintf(hlpNames[i], MAX_NAME_LENGTH, "%s_%d", prefix, n);
+	return hlpNames[i];
+}
+
+void hlpSimInit(unsigned short vars, unsigned short cmds, unsigned short params)
+{
+	int i;
+	int n = 0;
+
+	hlpAciInit(1000);
+	aciSetStartTxCallback(hlpStartTx);
+	hlpTxPending = 0;
+
+	hlpStamp = NULL;
+	for (i = 0; (i < vars) && (i < MAX_VARIABLE_LIST); i++) {
+		hlpVar[i] = i * 1000;
+		hlpVarId[i] = 0x0100 + i;
+		aciPublishVariableInt(&hlpVar[i], VARTYPE_INT32, 0x0100 + i, hlpName(n++, "var", i), "simulated variable", "-");
+	}
+	for (i = 0; (i < cmds) && (i < MAX_COMMAND_LIST); i++)
+		aciPublishCommandInt(&hlpCmd[i], VARTYPE_INT16, 0x0500 + i, hlpName(n++, "cmd", i), "simulated command", "-");
+	for (i = 0; (i < params) && (i < MAX_PARAMETER_LIST); i++)
+		aciPublishParameterInt(&hlpPar[i], VARTYPE_INT16, 0x0900 + i, hlpName(n++, "par", i), "simulated parameter", "-");
+}
+
+void hlpSimInitFirmware(void)
+{
+	unsigned int r;
+	unsigned short id;
+	int v = 0;
+	int c = 0;
+	int p = 0;
+	int n = 0;
+
+	hlpAciInit(1000);
+	aciSetStartTxCallback(hlpStartTx);
+	hlpTxPending = 0;
+	hlpStamp = NULL;
+
+	for (r = 0; r < sizeof(hlpFwVars) / sizeof(hlpFwVars[0]); r++)
+		for (id = hlpFwVars[r].first; id <= hlpFwVars[r].last; id++, v++) {
+			hlpVar[v] = 0;
+			hlpVarId[v] = id;
+			aciPublishVariableInt(&hlpVar[v], hlpFwVars[r].type, id, hlpName(n++, "var", id), "simulated variable", "-");
+		}
+	for (r = 0; r < sizeof(hlpFwCmds) / sizeof(hlpFwCmds[0]); r++)
+		for (id = hlpFwCmds[r].first; id <= hlpFwCmds[r].last; id++, c++)
+			aciPublishCommandInt(&hlpFwCmd[c], hlpFwCmds[r].type, id, hlpName(n++, "cmd", id), "simulated command", "-");
+	for (r = 0; r < sizeof(hlpFwPars) / sizeof(hlpFwPars[0]); r++)
+		for (id = hlpFwPars[r].first; id <= hlpFwPars[r].last; id++, p++)
+			aciPublishParameterInt(&hlpFwPar[p], hlpFwPars[r].type, id, hlpName(n++, "par", id), "simulated parameter", "-");
+}
+
+void hlpSimStampVariable(unsigned short id)
+{
+	int i;
+
+	hlpStamp = NULL;
+	for (i = 0; i < aciListVarCount; i++)
+		if (hlpVarId[i] == id)
+			hlpStamp = &hlpVar[i];
+}
+
+void hlpSimTick(void)
+{
+	int i;
+	struct timespec now;
+
+	//the variables change every tick, like the sensor data on the vehicle
+	for (i = 0; i < aciListVarCount; i++)
+		hlpVar[i]++;
+	if (hlpStamp) {
+		//wraps every 71 minutes, the receiver takes the difference modulo 2^32
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		*hlpStamp = (int)(unsigned int)((unsigned long long)now.tv_sec * 1000000ULL + now.tv_nsec / 1000);
+	}
+	aciSyncVar();
+	aciSyncCmd();
+	aciSyncPar();
+	hlpAciEngine();
+}
+
+void hlpSimReceive(unsigned char byte)
+{
+	hlpAciReceiveHandler(byte);
+}
+
+int hlpSimTransmit(unsigned char * byte)
+{
+	if (hlpTxPending) {
+		*byte = hlpTxByte;
+		hlpTxPending = 0;
+		return 1;
+	}
+	if (!aciTxRingBufferByteAvailable())
+		return 0;
+	*byte = aciTxRingBufferGetNextByte();
+	return 1;
+}
@@ -0,0 +1,33 @@
+/*
+ * hlp_sim.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ */
+
+#ifndef HLP_SIM_H_
+#define HLP_SIM_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// runs the ACI of the HLP firmware on the host, publishing vars INT32 variables and cmds/params INT16 commands and parameters
+void hlpSimInit(unsigned short vars, unsigned short cmds, unsigned short params);
+/// runs the ACI of the HLP firmware with the ids and types the AscTec SDK firmware publishes, see main.c
+void hlpSimInitFirmware(void);
+/// the variable carries the CLOCK_MONOTONIC time in microseconds of the tick that sent it, instead of a counter
+void hlpSimStampVariable(unsigned short id);
+/// one pass of the 1 kHz firmware main loop
+void hlpSimTick(void);
+/// one byte from the remote, like the UART rx interrupt
+void hlpSimReceive(unsigned char byte);
+/// the next byte the UART sends, returns 0 while there is nothing to send
+int hlpSimTransmit(unsigned char * byte);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HLP_SIM_H_ */
@@ -0,0 +1,141 @@
+/*
+ * test_arena.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "asctecCommIntf.h"
+
+// glibc's own allocator, the test wraps it to count the calls of the remote
+extern "C" {
+void * __libc_malloc(size_t size);
+void __libc_free(void * ptr);
+}
+
+static unsigned char arena[64 * 1024];
+
+static bool counting = false;
+static unsigned int mallocCalls = 0;
+static unsigned int freeCalls = 0;
+static unsigned int arenaFrees = 0;
+
+extern "C" void * malloc(size_t size)
+{
+	if (counting)
+		mallocCalls++;
+	return __libc_malloc(size);
+}
+
+extern "C" void free(void * ptr)
+{
+	if (counting)
+		freeCalls++;
+	// arena memory never came from the heap, handing it on would abort the test
+	if (((unsigned char *)ptr >= arena) && ((unsigned char *)ptr < arena + sizeof(arena))) {
+		arenaFrees++;
+		return;
+	}
+	__libc_free(ptr);
+}
+
+static void startCounting()
+{
+	mallocCalls = 0;
+	freeCalls = 0;
+	counting = true;
+}
+
+static void stopCounting()
+{
+	counting = false;
+}
+
+TEST(AciArena, InitDoesNotTouchTheHeap)
+{
+	aciSetMemoryArena(arena, sizeof(arena));
+
+	startCounting();
+	aciInit();
+	aciInit();
+	stopCounting();
+	EXPECT_EQ(0u, mallocCalls);
+	EXPECT_EQ(0u, freeCalls);
+	EXPECT_GT(aciGetMemoryArenaPeak(), 0u);
+
+	arenaFrees = 0;
+	aciSetMemoryArena(NULL, 0);
+	aciInit();
+	EXPECT_EQ(0u, arenaFrees);
+}
+
+TEST(AciArena, ContextInitAndEngineDoNotTouchTheHeap)
+{
+	aci_context_t * ctx = aciCtxCreate();
+	unsigned char noise[256];
+
+	ASSERT_TRUE(ctx != NULL);
+	for (unsigned int i = 0; i < sizeof(noise); i++)
+		noise[i] = (i * 37 + 11) & 0xff;
+	aciCtxSetMemoryArena(ctx, arena, sizeof(arena));
+
+	startCounting();
+	aciCtxInit(ctx);
+	for (int i = 0; i < 100; i++)
+		aciCtxEngine(ctx);
+	aciCtxReceiveBuffer(ctx, noise, sizeof(noise));
+	aciCtxInit(ctx);
+	stopCounting();
+	EXPECT_EQ(0u, mallocCalls);
+	EXPECT_EQ(0u, freeCalls);
+
+	aciCtxDestroy(ctx);
+}
+
+TEST(AciArena, LeavingTheArenaDoesNotFreeArenaMemory)
+{
+	aci_context_t * ctx = aciCtxCreate();
+
+	ASSERT_TRUE(ctx != NULL);
+	aciCtxSetMemoryArena(ctx, arena, sizeof(arena));
+	aciCtxInit(ctx);
+
+	arenaFrees = 0;
+	aciCtxSetMemoryArena(ctx, NULL, 0);
+	aciCtxInit(ctx);
+	aciCtxDestroy(ctx);
+	EXPECT_EQ(0u, arenaFrees);
+}
+
+TEST(AciArena, SwitchingFromTheHeapFreesTheHeapTables)
+{
+	aci_context_t * ctx = aciCtxCreate();
+
+	ASSERT_TRUE(ctx != NULL);
+	aciCtxInit(ctx);
+
+	startCounting();
+	aciCtxSetMemoryArena(ctx, arena, sizeof(arena));
+	stopCounting();
+	EXPECT_GT(freeCalls, 0u);
+
+	// the heap tables are gone, the arena accounting only sees arena blocks
+	aciCtxInit(ctx);
+	aciCtxInit(ctx);
+	EXPECT_GT(aciCtxGetMemoryArenaPeak(ctx), 0u);
+	EXPECT_LE(aciCtxGetMemoryArenaPeak(ctx), sizeof(arena));
+
+	aciCtxSetMemoryArena(ctx, NULL, 0);
+	aciCtxDestroy(ctx);
+}
+
+int main(int argc, char **argv)
+{
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
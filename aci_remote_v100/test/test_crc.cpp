@@ -0,0 +1,110 @@
+/*
+ * test_crc.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "asctecCommIntf.h"
+
+// internal functions of the remote, not part of the public header
+extern "C" {
+unsigned short aciCrcUpdate(unsigned short crc, unsigned char data);
+unsigned short aciUpdateCrc16(unsigned short crc, void * data, unsigned short cnt);
+extern const unsigned short aciCrcTable[256];
+extern const unsigned short aciCrcSliceTable[7][256];
+}
+
+// the shift and xor routine the remote and the HLP used before the tables
+static unsigned short bitwiseCrcUpdate(unsigned short crc, unsigned char data)
+{
+	data ^= (crc & 0xff);
+	data ^= data << 4;
+
+	return ((((unsigned short)data << 8) | ((crc >> 8) & 0xff)) ^ (unsigned char)(data >> 4)
+			^ ((unsigned short)data << 3));
+}
+
+static unsigned short bitwiseCrc16(unsigned short crc, const unsigned char * data, unsigned short cnt)
+{
+	for (unsigned short i = 0; i < cnt; i++)
+		crc = bitwiseCrcUpdate(crc, data[i]);
+	return crc;
+}
+
+// compares aciUpdateCrc16 with the bitwise routine on random buffers, lengths, alignments and start values
+static void checkRandomBuffers(int rounds)
+{
+	unsigned char buffer[608 + 8];
+
+	srand(4711);
+	for (int round = 0; round < rounds; round++) {
+		unsigned short length = rand() % 601;
+		unsigned short offset = rand() % 8;
+		unsigned short start = rand() & 0xffff;
+
+		for (int i = 0; i < length; i++)
+			buffer[offset + i] = rand() & 0xff;
+		ASSERT_EQ(bitwiseCrc16(start, &buffer[offset], length), aciUpdateCrc16(start, &buffer[offset], length))
+				<< "length " << length << ", offset " << offset << ", start " << start;
+	}
+}
+
+TEST(AciCrc, TableMatchesBitwiseUpdate)
+{
+	for (int i = 0; i < 256; i++)
+		ASSERT_EQ(bitwiseCrcUpdate(0, i), aciCrcTable[i]) << "byte " << i;
+}
+
+TEST(AciCrc, ByteUpdateMatchesBitwiseForEveryState)
+{
+	for (unsigned int crc = 0; crc <= 0xffff; crc++)
+		for (unsigned int data = 0; data < 256; data += 17)
+			ASSERT_EQ(bitwiseCrcUpdate(crc, data), aciCrcUpdate(crc, data)) << "crc " << crc << ", byte " << data;
+}
+
+TEST(AciCrc, SliceTablesMatchBitwise)
+{
+	for (int k = 0; k < 7; k++)
+		for (int i = 0; i < 256; i++) {
+			unsigned short crc = bitwiseCrcUpdate(0, i);
+
+			for (int zeros = 0; zeros <= k; zeros++)
+				crc = bitwiseCrcUpdate(crc, 0);
+			ASSERT_EQ(crc, aciCrcSliceTable[k][i]) << "table " << k << ", byte " << i;
+		}
+}
+
+TEST(AciCrc, ShortBufferMatchesBitwise)
+{
+	unsigned char buffer[7] = { 0xff, 0x02, 0x10, 0xaa, 0x55, 0x00, 0x81 };
+
+	// below eight bytes only the byte loop runs, the same one as on the HLP
+	for (unsigned short length = 0; length <= sizeof(buffer); length++)
+		ASSERT_EQ(bitwiseCrc16(0xff, buffer, length), aciUpdateCrc16(0xff, buffer, length)) << "length " << length;
+}
+
+TEST(AciCrc, SliceBy8MatchesBitwise)
+{
+	checkRandomBuffers(20000);
+}
+
+TEST(AciCrc, LongBufferMatchesBitwise)
+{
+	static unsigned char buffer[65535];
+
+	for (unsigned int i = 0; i < sizeof(buffer); i++)
+		buffer[i] = (i * 131 + 7) & 0xff;
+	EXPECT_EQ(bitwiseCrc16(0xff, buffer, sizeof(buffer)), aciUpdateCrc16(0xff, buffer, sizeof(buffer)));
+}
+
+int main(int argc, char **argv)
+{
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
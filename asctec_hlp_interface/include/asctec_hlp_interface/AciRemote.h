@@ -11,6 +11,8 @@
 #define ACIREMOTE_H_
 
 #include "asctec_hlp_interface/SerialComm.h"
+#include "asctec_hlp_interface/AciTableCache.h"
+#include "asctec_hlp_interface/JitterHistogram.h"
 #include "asctec_hlp_interface/AsctecSDK3.h"
 
 #include <boost/thread.hpp>
@@ -18,17 +20,40 @@
 #include <boost/thread/condition.hpp>
 #include <boost/function.hpp>
 #include <boost/bind.hpp>
+#include <boost/asio/basic_waitable_timer.hpp>
+#include <boost/chrono.hpp>
+
+#include <algorithm>
 
 #include <ros/ros.h>
+#include <dynamic_reconfigure/server.h>
+#include <diagnostic_updater/diagnostic_updater.h>
 #include <std_msgs/String.h>
 #include <geometry_msgs/Twist.h>
 #include <geographic_msgs/GeoPoint.h>
 #include <geographic_msgs/GeoPose.h>
+#include <sensor_msgs/Imu.h>
+#include <sensor_msgs/NavSatFix.h>
+#include <geometry_msgs/Vector3Stamped.h>
+#include "asctec_hlp_comm/mav_imu.h"
+#include "asctec_hlp_comm/mav_rcdata.h"
+#include "asctec_hlp_comm/mav_hlp_status.h"
+#include "asctec_hlp_comm/MotorSpeed.h"
+#include "asctec_hlp_comm/GpsCustom.h"
+#include "asctec_hlp_comm/mav_laser.h"
 #include "asctec_hlp_comm/WaypointGPSGoal.h"
 #include "asctec_hlp_comm/WaypointGPSResult.h"
 #include "asctec_hlp_comm/HlpCtrlSrv.h"
 #include "aci_remote_v100/asctecDefines.h"
 #include "aci_remote_v100/asctecCommIntf.h"
+#include "asctec_hlp_interface/HlpRatesConfig.h"
+
+// var packets set up by setupVarPackets: status, GPS, IMU and laser
+#define ACI_REMOTE_VAR_PACKETS 4
+// bytes the HLP frames a var packet with: start string, type, size, magic code and CRC
+#define ACI_VAR_PACKET_OVERHEAD 9
+// cmd packets set up by setupCmdPackets: control mode, CTRL input and waypoint
+#define ACI_REMOTE_CMD_PACKETS 3
 
 namespace AciRemote {
 
@@ -52,6 +77,11 @@ public:
 protected:
 	void checkVersions(struct ACI_INFO);
 	void setupVarPackets();
+	// fills the var packets with the variables of needs and sends contents and
+	// rates to the HLP, packets left empty are not sent at all
+	void configureVarPackets(unsigned int needs);
+	// sends the rates of the packets to the HLP
+	void sendVarPacketRates();
 	void setupCmdPackets();
 	void setupParPackets();
 
@@ -59,21 +89,172 @@ private:
 	AciRemote(const AciRemote&);
 	const AciRemote& operator=(const AciRemote&);
 
-	static void transmit(void*, unsigned short);
-	static void versions(struct ACI_INFO);
-	static void varListUpdateFinished();
-	static void cmdListUpdateFinished();
-	static void paramListUpdateFinished();
+	static void transmit(void*, const struct ACI_TX_SEGMENT*, unsigned char);
+	static void versions(void*, struct ACI_INFO);
+	static void varListUpdateFinished(void*);
+	static void cmdListUpdateFinished(void*);
+	static void paramListUpdateFinished(void*);
+	static int readTableCache(void*, void*, int);
+	static int writeTableCache(void*, void*, int);
+	static void resetTableCache(void*);
+	static void baudRateReply(void*, unsigned int, unsigned char);
+	static void varPacketReceived(void*, unsigned char, double);
+	static void cmdAck(void*, unsigned char);
 
-	void readHandler(const boost::system::error_code&, size_t);
+	void readHandler(const boost::system::error_code&, const unsigned char*, size_t, double, double);
+	void connectionLost();
+	void linkClosed();
 	void throttleEngine();
+
+	// Reactor mode: the IO thread of SerialComm also runs the ACI Engine off
+	// reactor_timer_ and publishes as packets arrive, no other thread is spawned.
+	// It owns the ACI context and uses it without locks, everyone else takes an AciLock
+	void startReactor();
+	void reactorTick(const boost::system::error_code&);
+	void pauseReactor();
+	void resumeReactor();
+	void reactorPaused();
+	// CPU time and context switches of the process since the last report
+	void reportLoad(const ros::WallTimerEvent&);
+
+	// mean and max of a latency between two diagnostics updates
+	struct LatencyStats {
+		LatencyStats(): count(0), sum(0), max(0) {}
+		void add(double latency) { ++count; sum += latency; max = std::max(max, latency); }
+		double mean() const { return count ? sum / count : 0; }
+		unsigned long count;
+		double sum;
+		double max;
+	};
+	// samples the counters of link, packets and ACI Engine and publishes the diagnostics
+	void updateDiagnostics(const ros::WallTimerEvent&);
+	void linkDiagnostics(diagnostic_updater::DiagnosticStatusWrapper&);
+	void packetDiagnostics(diagnostic_updater::DiagnosticStatusWrapper&);
+	void engineDiagnostics(diagnostic_updater::DiagnosticStatusWrapper&);
+	// how late the ACI Engine ran once, for the diagnostics
+	void engineTicked(double lateness);
+	// updates a cmd packet and notes the time, the ACK latency runs until cmdAcked.
+	// Packets sent without ACK never get one
+	void updateCmdPacket(unsigned char);
+	void cmdAcked(unsigned char);
+
+	// access to the ACI context outside the ACI Engine, takes ctrl_mtx_. In reactor
+	// mode it also parks the IO thread, as long as it runs
+	class AciLock {
+	public:
+		AciLock(AciRemote* remote): remote_(remote), lock_(remote->ctrl_mtx_) {
+			if (remote_->reactor_)
+				remote_->pauseReactor();
+		}
+		~AciLock() {
+			if (remote_->reactor_)
+				remote_->resumeReactor();
+		}
+	private:
+		AciRemote* remote_;
+		boost::mutex::scoped_lock lock_;
+	};
+	friend class AciLock;
+
+	// handler of reactor_timer_, brings the memory for its wait
+	class TickOp {
+	public:
+		TickOp(AciRemote* remote): remote_(remote), mem_(&remote->tick_mem_) {}
+		void operator()(const boost::system::error_code& error) { remote_->reactorTick(error); }
+		friend void* asio_handler_allocate(size_t size, TickOp* op) { return op->mem_->allocate(size); }
+		friend void asio_handler_deallocate(void* ptr, size_t, TickOp* op) { op->mem_->deallocate(ptr); }
+	private:
+		AciRemote* remote_;
+		HandlerMemory* mem_;
+	};
+	friend class TickOp;
+
+	// (re)initialises the ACI context and requests versions and lists from the HLP
+	void startAci();
+	// watches the link and reconnects with exponential backoff once it is lost
+	void superviseLink();
+	void reconnect();
+	bool restartAci();
+	// waits until the versions match and all lists arrived, false after timeout
+	// seconds or once the link is lost
+	bool waitForConfiguration(double timeout);
+	// moves HLP and port to baud_target_, both fall back to baud_rate_ if it fails
+	void switchBaudRate();
+	// sets link_up_, in reactor mode while the IO thread is parked
+	void setLinkUp(bool);
+	// variable groups the topics with subscribers need, VAR_ALL without subscriber_driven_packets_
+	unsigned int varPacketNeeds() const;
+	// connect and disconnect callback of the publishers
+	void subscribersChanged(const ros::SingleSubscriberPublisher&);
+	// reconfigures the var packets if the needs changed while the link is up
+	void updateVarPackets();
+	// bytes per second the configured var packets take at rates, one rate per packet
+	double varPacketLoad(const int* rates);
+	// bytes per second the serial line carries in each direction, 0 if it has no line rate
+	double lineCapacity();
+	// bytes per second the var packets may take on the line, 0 if it has no line rate
+	double linkBudget();
+	// dynamic_reconfigure callback, applies packet rates and ACI Engine throttle
+	void ratesReconfigured(asctec_hlp_interface::HlpRatesConfig&, uint32_t);
+	// waits for the reply with status or ACI_BAUDRATE_UNSUPPORTED, returns 0 on timeout
+	unsigned char waitBaudRateReply(unsigned char, double);
+	// publishes the topics fed by packet, in reactor mode right away, otherwise
+	// it wakes up the publisher threads waiting for it
+	void packetReceived(unsigned char);
+	// waits until packet has been received since seen, false if the publisher must stop
+	bool waitForPacket(unsigned char, unsigned long& seen);
+	// publisher threads, each one runs its publish function below once its packet arrived
 	void publishImuMagData();
 	void publishGpsData();
 	void publishStatusMotorsRcData();
 
   void publishLaserData();   // by Xun
 
+	// publish the latest data once, to the topics someone subscribed to
+	void publishImuMag();
+	void publishGps();
+	void publishStatusMotorsRc();
+	void publishLaser();
+	enum { PUBLISHER_STATUS, PUBLISHER_GPS, PUBLISHER_IMU, PUBLISHER_LASER, PUBLISHERS };
+	// time from the arrival of the packet until its messages went out, and the
+	// time the snapshots of the publisher took, waiting for locks included
+	void recordPublishTiming(int publisher, double rx_time, double snapshot_time);
+
+	// copy the variables assigned inside var from the last received var packets,
+	// consistent per packet and without blocking the ACI Engine.
+	// Leaves copy alone and returns false while the link to the HLP is down
+	template<typename T> bool snapshot(const T& var, T& copy) {
+		boost::shared_lock<boost::shared_mutex> lock(link_mtx_);
+		if (!link_up_)
+			return false;
+		for (unsigned char i = 0; i < aciCtxGetVarPacketCount(aci_ctx_); ++i)
+			aciCtxGetVarPacketSnapshot(aci_ctx_, i, &var, &copy, sizeof(T));
+		return true;
+	}
+	// same as above, stamp is the time the last byte of the given packet arrived.
+	// For the publishers only, in reactor mode they run in the IO thread, which
+	// link_up_ never changes under, and skip link_mtx_
+	template<typename T> bool snapshot(const T& var, T& copy, unsigned char packet, ros::Time& stamp,
+			double* packet_rx_time = NULL) {
+		boost::shared_lock<boost::shared_mutex> lock(link_mtx_, boost::defer_lock);
+		if (!reactor_)
+			lock.lock();
+		if (!link_up_)
+			return false;
+		double rx_time = 0;
+		for (unsigned char i = 0; i < aciCtxGetVarPacketCount(aci_ctx_); ++i)
+			aciCtxGetVarPacketSnapshotTimed(aci_ctx_, i, &var, &copy, sizeof(T), i == packet ? &rx_time : NULL);
+		stamp = rxStamp(rx_time);
+		if (packet_rx_time)
+			*packet_rx_time = rx_time;
+		return true;
+	}
+	// ROS time of a receive time of SerialComm, now if it is unknown
+	ros::Time rxStamp(double) const;
+
 	void ctrlTopicCallback(const geometry_msgs::TwistConstPtr&);
+	// sends the command to the HLP, in the IO thread in reactor mode
+	void applyCtrlCommand(const geometry_msgs::TwistConstPtr&);
 	bool ctrlServiceCallback(asctec_hlp_comm::HlpCtrlSrv::Request&,
 			asctec_hlp_comm::HlpCtrlSrv::Response&);
 
@@ -84,12 +265,30 @@ private:
 
 	// variables to store ROS parameters
 	std::string frame_id_;
+	// the rates can be reconfigured while the link is up, they change under an AciLock
 	int imu_rate_;
 	int gps_rate_;
 	int rc_status_rate_;
 	int aci_rate_;
 	int aci_heartbeat_;
-	int bytes_recv_;
+	int aci_list_window_;
+	bool table_cache_enabled_;
+	std::string table_cache_dir_;
+	std::string vehicle_id_;
+	bool reactor_;
+	double load_report_period_;
+	bool subscriber_driven_packets_;
+	bool reconnect_enabled_;
+	double reconnect_delay_min_;
+	double reconnect_delay_max_;
+	double reconnect_rx_timeout_;
+	double reconnect_config_timeout_;
+	// how long initRosLayer waits for the versions and lists
+	double config_timeout_;
+	int baud_target_;
+	double baud_switch_timeout_;
+	// bytes received since the start, guarded by buf_mtx_. Only used in the IO thread in reactor mode
+	unsigned long bytes_recv_;
 	double ang_vel_variance_;
 	double lin_acc_variance_;
     bool externalise_state_;
@@ -126,24 +325,106 @@ private:
 
   ros::Publisher laser_pub_;    // by Xun
 
+	// sequence numbers of the messages, each one is only used by its publish function
+	int imu_seq_[3];
+	int gps_seq_[2];
+	int status_seq_[3];
+	int laser_seq_;
+
+	// how late the ACI Engine ran, only used by the thread running it
+	JitterHistogram engine_jitter_;
+	// only used by the thread running the publisher
+	JitterHistogram publish_latency_[PUBLISHERS];
+	JitterHistogram snapshot_time_[PUBLISHERS];
+	// how long the IO thread waited for shared_mtx_ to count a packet
+	JitterHistogram notify_wait_;
+	double jitter_report_period_;
+	// var packets received since the start, guarded by shared_mtx_. The publisher
+	// threads wait for them on cond_any_
+	unsigned long packet_count_[ACI_REMOTE_VAR_PACKETS];
+
+	// /diagnostics every diagnostics_period seconds, 0 disables them
+	double diag_period_;
+	boost::shared_ptr<diagnostic_updater::Updater> diag_updater_;
+	ros::WallTimer diag_timer_;
+	// counters at the last update and their change since the one before, only used by diag_timer_
+	struct ACI_LINK_STATS diag_stats_;
+	struct ACI_LINK_STATS diag_delta_;
+	unsigned long diag_rx_bytes_;
+	unsigned long diag_tx_bytes_;
+	double diag_rx_rate_;
+	double diag_tx_rate_;
+	double diag_time_;
+	double diag_interval_;
+	LatencyStats diag_engine_;
+	LatencyStats diag_cmd_ack_;
+	// configured rate of each packet, 0 if it is empty
+	int diag_packet_rates_[ACI_REMOTE_VAR_PACKETS];
+	// guards the members below, the ACI Engine, the IO thread and the command callers write them
+	boost::mutex diag_mtx_;
+	LatencyStats engine_lateness_;
+	LatencyStats cmd_ack_latency_;
+	// when a cmd packet waiting for its ACK was updated, 0 if it is not waiting
+	double cmd_sent_[ACI_REMOTE_CMD_PACKETS];
+
+	ros::WallTimer load_timer_;
+	ros::WallTime load_time_;
+	double load_cpu_;
+	long load_switches_;
+
 	bool versions_match_;
 	bool var_list_recv_;
 	bool cmd_list_recv_;
 	bool par_list_recv_;
 	volatile bool must_stop_engine_;
 	volatile bool must_stop_pub_;
+	volatile bool must_stop_link_;
+	// set by connectionLost, cleared when the port is opened again
+	volatile bool link_lost_;
+	// versions and lists match and all packets are configured, the
+	// snapshots may be read. Guarded by link_mtx_ and an AciLock
+	bool link_up_;
+	boost::shared_mutex link_mtx_;
+	// last time bytes arrived, guarded by buf_mtx_. Only used in the IO thread in reactor mode
+	ros::WallTime last_rx_;
+	// last reply to a baud rate request, guarded by baud_mtx_
+	unsigned int baud_reply_rate_;
+	unsigned char baud_reply_status_;
+	// rate of the serial line, baud_rate_ or baud_target_. Guarded by baud_mtx_
+	int line_baud_;
+	boost::mutex baud_mtx_;
+	// changes the packet rates and aci_rate_ at run time, see cfg/HlpRates.cfg
+	boost::shared_ptr<dynamic_reconfigure::Server<asctec_hlp_interface::HlpRatesConfig> > rates_srv_;
 
 	boost::mutex mtx_, buf_mtx_, ctrl_mtx_;
 	boost::shared_mutex shared_mtx_;
 	boost::condition_variable cond_;
 	boost::condition_variable_any cond_any_;
+	// signalled by the ACI callbacks which set versions_match_ and the *_recv_ flags
+	boost::condition_variable config_cond_;
 	boost::shared_ptr<boost::thread> aci_throttle_thread_;
+	ThreadScheduling engine_sched_;
 	boost::shared_ptr<boost::thread> imu_mag_thread_;
 	boost::shared_ptr<boost::thread> gps_thread_;
 	boost::shared_ptr<boost::thread> rc_status_thread_;
+	boost::shared_ptr<boost::thread> link_thread_;
 
   boost::shared_ptr<boost::thread> laser_thread_;   // by Xun
 
+	// reactor mode, only used in the IO thread. The timer is on boost::chrono
+	// whether or not asio::steady_timer uses std::chrono
+	boost::asio::basic_waitable_timer<boost::chrono::steady_clock> reactor_timer_;
+	HandlerMemory tick_mem_;
+	// handshake of AciLock with the IO thread, guarded by reactor_mtx_
+	enum { REACTOR_RUNNING, REACTOR_PAUSE_REQUESTED, REACTOR_PAUSED } reactor_state_;
+	boost::mutex reactor_mtx_;
+	boost::condition_variable reactor_cond_;
+
+	// ACI Remote state of the HLP this instance talks to
+	aci_context_t* aci_ctx_;
+	// tables of the HLP from the last run, spares downloading them again
+	AciTableCache table_cache_;
+
 	// Asctec SDK 3.0 data structures
 	struct WO_SDK_STRUCT WO_SDK_;
 	struct WO_SDK_STRUCT RO_SDK_;
@@ -155,6 +436,21 @@ private:
 	struct WAYPOINT WO_wpToLL_;
 
   short laser_distance_;    // by Xun
+	// var packet of laser_distance_, 2 if the HLP has 3 packets only
+	unsigned char laser_packet_;
+	// groups of variables, besides those always needed by the waypoints and the control commands
+	enum {
+		VAR_IMU = 0x01,		// imu and imu_custom
+		VAR_MAG = 0x02,
+		VAR_GPS = 0x04,		// gps and gps_custom
+		VAR_RCDATA = 0x08,
+		VAR_STATUS = 0x10,
+		VAR_MOTORS = 0x20,
+		VAR_LASER = 0x40,
+		VAR_ALL = 0x7f
+	};
+	// groups the var packets are configured for, only used along with the ACI context
+	unsigned int var_packet_needs_;
 
 	// Asctec SDK 3.0 variables
 	//choose actual waypoint command from WP_CMD_* defines
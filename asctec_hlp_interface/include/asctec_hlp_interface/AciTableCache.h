@@ -0,0 +1,79 @@
+/*
+ * AciTableCache.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ */
+
+#ifndef ACITABLECACHE_H_
+#define ACITABLECACHE_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+
+// bump whenever the layout of the file or of the stored ACI table entries changes
+#define ACI_TABLE_CACHE_VERSION 1
+
+// Keeps the variable, command and parameter tables of one vehicle in a file,
+// so that a restart against unchanged firmware does not download them again.
+//
+// The ACI Remote writes and reads the tables as one stream through its HD
+// callbacks: a 12 byte header with the magic codes and sizes of the three
+// tables, followed by the table entries. This class backs that stream with
+// <dir>/<vehicle>.acitables. The file starts with a header carrying a version,
+// the size of a table entry and a CRC-32 of the stream. A file is only used
+// if all of them match; it is memory-mapped and read in place. The ACI Remote
+// itself compares the magic codes with the ones of the device.
+class AciTableCache {
+public:
+	AciTableCache();
+	~AciTableCache();
+
+	// maps the cache file of vehicle in dir, creating dir if needed.
+	// Returns true if the file holds valid tables, which can be read.
+	bool open(const std::string& dir, const std::string& vehicle);
+	void close();
+	bool isValid() const;
+	// starts reading the tables from the beginning again
+	void rewind();
+
+	// ACI HD callbacks
+	int read(void*, int);
+	int write(void*, int);
+	void reset();
+
+private:
+	AciTableCache(const AciTableCache&);
+	const AciTableCache& operator=(const AciTableCache&);
+
+	struct FileHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t entry_size;
+		uint32_t stream_size;
+		uint32_t crc;
+	};
+
+	bool mapFile();
+	void unmapFile();
+	bool commit();
+
+	std::string path_;
+
+	// mapped file and read position in its stream
+	const unsigned char* map_;
+	size_t map_size_;
+	const unsigned char* stream_;
+	size_t stream_size_;
+	size_t read_pos_;
+
+	// stream written by the ACI Remote since the last reset
+	std::vector<unsigned char> write_buf_;
+	bool writing_;
+};
+
+#endif /* ACITABLECACHE_H_ */
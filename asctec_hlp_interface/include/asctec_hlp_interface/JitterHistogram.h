@@ -0,0 +1,37 @@
+/*
+ * JitterHistogram.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ */
+
+#ifndef JITTERHISTOGRAM_H_
+#define JITTERHISTOGRAM_H_
+
+// Histogram of how late something happened, e.g. how late a periodic thread
+// woke up against its schedule. Only used by one thread, which logs it every
+// report period.
+class JitterHistogram {
+public:
+	JitterHistogram();
+
+	// seconds behind the schedule of one tick or event
+	void add(double lateness);
+	// logs and clears the histogram if period seconds have passed since the
+	// last report, now is in SerialComm::monotonicNow() time. 0 never reports
+	void report(const char* name, double now, double period);
+	void clear();
+
+private:
+	// upper bounds of the buckets in microseconds, the last one is open
+	static const int BUCKETS = 9;
+	static const int BOUNDS_US[BUCKETS - 1];
+
+	unsigned long counts_[BUCKETS];
+	unsigned long total_;
+	double sum_;
+	double max_;
+	double last_report_;
+};
+
+#endif /* JITTERHISTOGRAM_H_ */
@@ -21,10 +21,22 @@
 
 #include <ros/ros.h>
 
-#define SERIAL_PORT_READ_BUF_SIZE 512
+#include "asctec_hlp_interface/Transport.h"
+#include "asctec_hlp_interface/ThreadScheduling.h"
 
+#define SERIAL_PORT_READ_BUF_SIZE 512
+// the next read is armed on one buffer while readHandler parses the other
+#define SERIAL_PORT_READ_BUFFERS 2
+// an ACI frame is never larger than ACI_TX_RINGBUFFER_SIZE
+#define SERIAL_PORT_WRITE_BUF_SIZE 512
+// write buffers kept for reuse, more are only allocated while all of them are pending
+#define SERIAL_PORT_WRITE_POOL_SIZE 16
+
+// Talks to the HLP over the Transport selected by transport_type_, the serial port by default
 class SerialComm {
-	typedef boost::shared_ptr<boost::asio::serial_port> SerialPortPtr;
+	typedef boost::shared_ptr<Transport> TransportPtr;
+	friend class ReadOp;
+	friend class WriteOp;
 
 public:
 	SerialComm(); // default constructor
@@ -36,6 +48,12 @@ public:
 
 	// methods to be used as callbacks of ACI
 	void doWrite(void*, unsigned short);
+	// gathers the buffers into one pooled write buffer, the only copy on the way to the port.
+	// Frames are queued and all frames queued during a write go out together with the next one
+	void doWrite(const boost::asio::const_buffer*, size_t);
+	// frames written between holdWrites and releaseWrites go out in one write
+	void holdWrites();
+	void releaseWrites();
 	//boost::function<void (const unsigned char*, size_t)> receive;
 
 	//boost::shared_ptr<const boost::system::error_code&> errorStatus() const;
@@ -43,24 +61,102 @@ public:
 	int openPort();
 	void closePort();
 	bool isOpen() const;
+	// the serial port, host or pty the transport talks to, for log messages
+	const std::string& linkName() const;
+	// changes the rate of the open serial port on the IO thread and waits for it,
+	// openPort always starts at baud_rate_. Do not call it while the IO thread is
+	// held up, e.g. by an AciLock. Returns false if the transport has no line rate
+	// or it could not be set
+	bool setBaudRate(int);
+	// seconds of CLOCK_MONOTONIC, the clock of the receive times passed to readHandler
+	static double monotonicNow();
+
+	struct WriteStats {
+		unsigned long frames;
+		unsigned long writes;
+		unsigned long bytes;
+		// frames merged into one write
+		size_t max_queue_depth;
+		// from doWrite until the frame has been written
+		double mean_latency;
+		double max_latency;
+	};
+	WriteStats writeStats();
 
 private:
 	SerialComm(const SerialComm&);
 	const SerialComm& operator=(const SerialComm&);
 
 protected:
-	SerialPortPtr port_;
+	TransportPtr transport_;
 	//boost::asio::serial_port port_;
 	boost::asio::io_service io_service_;
 	// TODO: do I really need this thread?! Or is this the one which dies according to gdb?
 	boost::shared_ptr<boost::thread> io_thread_;
+	// priority and CPUs of io_thread_, applied whenever openPort creates it
+	ThreadScheduling io_thread_sched_;
 	//boost::shared_ptr<const boost::system::error_code&> io_error_;
 
+	// "serial", "tcp", "udp" or "pty", see TransportSettings
+	std::string transport_type_;
 	std::string port_name_;
 	int baud_rate_;
+	std::string remote_host_;
+	int remote_port_;
+	int local_port_;
+	std::string pty_link_;
 
 	//boost::array<unsigned char, SERIAL_PORT_READ_BUF_SIZE> buffer_;
-	std::vector<unsigned char> read_buffer_;
+	std::vector<unsigned char> read_buffers_[SERIAL_PORT_READ_BUFFERS];
+	int read_index_;
+	int read_buf_size_;
+	// termios VMIN and VTIME of the port, -1 leaves them as they are
+	int read_vmin_;
+	int read_vtime_;
+	// ask the driver for ASYNC_LOW_LATENCY, i.e. no buffering in USB adapters,
+	// or disable Nagle's algorithm on TCP
+	bool low_latency_;
+
+	struct WriteBuffer {
+		unsigned char data[SERIAL_PORT_WRITE_BUF_SIZE];
+		size_t size;
+		ros::WallTime queued;
+	};
+	// write buffers not owned by a pending write
+	std::vector<WriteBuffer*> free_write_buffers_;
+	// frames waiting for the next write
+	std::vector<WriteBuffer*> write_queue_;
+	// a flush is posted or a write in progress, the next doWrite does not post another
+	bool write_busy_;
+	int write_hold_;
+	WriteStats write_stats_;
+	double write_latency_sum_;
+	// guards all of the above
+	boost::mutex write_pool_mtx_;
+
+	// writes are started and completed on the strand only, so they never overlap
+	boost::asio::io_service::strand write_strand_;
+	// frames of the write in progress and their buffers, only used on the strand
+	std::vector<WriteBuffer*> write_frames_;
+	std::vector<boost::asio::const_buffer> write_bufs_;
+
+	// at most one flush is posted, one write and one read in progress at a time
+	HandlerMemory flush_mem_;
+	HandlerMemory write_mem_;
+	HandlerMemory read_mem_;
+
+	// handler posted to the strand, ReadOp and WriteOp are passed to the transport
+	class FlushOp {
+	public:
+		FlushOp(SerialComm* comm): comm_(comm) {}
+		void operator()() { comm_->flushWrites(); }
+		void* allocate(size_t size) { return comm_->flush_mem_.allocate(size); }
+		void deallocate(void* ptr) { comm_->flush_mem_.deallocate(ptr); }
+		friend void* asio_handler_allocate(size_t size, FlushOp* op) { return op->allocate(size); }
+		friend void asio_handler_deallocate(void* ptr, size_t, FlushOp* op) { op->deallocate(ptr); }
+	private:
+		SerialComm* comm_;
+	};
 
 	bool open_;
 
@@ -71,23 +167,59 @@ protected:
     void doRead();
 
     /**
-     * Callback called at the end of the asynchronous operation.
+     * Callback called at the end of the asynchronous operation with the bytes read,
+     * the next read is already armed on another buffer. The last byte arrived at the
+     * given monotonicNow() time, each one before it the given byte time earlier.
      * This callback is called by the io_service in the spawned thread.
      */
-    virtual void readHandler(const boost::system::error_code&, size_t) = 0;
+    virtual void readHandler(const boost::system::error_code&, const unsigned char*, size_t,
+    		double, double) = 0;
+
+    /**
+     * Starts one asynchronous write of all queued frames, if there are any.
+     * This callback is called on the write strand.
+     */
+    void flushWrites();
 
     /**
      * Callback called at the end of an asynchronous write operation,
      * if there is more data to write, restarts a new write operation.
+     * This callback is called on the write strand.
+     */
+    void writeHandler(const boost::system::error_code&, size_t);
+
+    WriteBuffer* acquireWriteBuffer();
+    void releaseWriteBuffer(WriteBuffer*);
+
+    void readComplete(int, const boost::system::error_code&, size_t);
+
+    /**
+     * Callback called when a read or write fails on the open port, but not when
+     * closePort cancels them. The port is closed already, call closePort and
+     * openPort from another thread to get it back.
+     * This callback is called by the io_service in the spawned thread.
+     */
+    virtual void connectionLost() {}
+
+    /**
+     * Callback called once the transport is closed. Cancel here whatever else
+     * keeps the io_service running, closePort waits for it to run out of work.
      * This callback is called by the io_service in the spawned thread.
      */
-    void writeHandler(boost::shared_ptr<std::vector<unsigned char> >,
-    		const boost::system::error_code&, size_t);
+    virtual void linkClosed() {}
 
     /**
-     * Callback to close serial port
+     * Callback to close the transport
      */
     void doClose();
+
+    struct BaudRateChange;
+    /**
+     * Callback to change the baud rate posted by setBaudRate.
+     * This callback is called by the io_service in the spawned thread.
+     */
+    void changeBaudRate(boost::shared_ptr<BaudRateChange>);
+    bool applyBaudRate(int);
 };
 
 #endif /* SERIALCOMM_H_ */
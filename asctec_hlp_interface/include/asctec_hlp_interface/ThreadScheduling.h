@@ -0,0 +1,33 @@
+/*
+ * ThreadScheduling.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ */
+
+#ifndef THREADSCHEDULING_H_
+#define THREADSCHEDULING_H_
+
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+
+// Real-time priority and CPU affinity of a thread, e.g. of the IO thread or the
+// ACI Engine thread. The process needs CAP_SYS_NICE or an rtprio limit
+// (ulimit -r) for SCHED_FIFO, without it the thread keeps the default policy.
+struct ThreadScheduling {
+	ThreadScheduling(): priority(0) {}
+
+	// parses a list of CPUs like "1" or "0,2-3", false if it is malformed
+	bool setCpus(const std::string&);
+	// applies priority and cpus to thread, warns about what is not permitted
+	void apply(pthread_t thread, const std::string& name) const;
+
+	// SCHED_FIFO priority, 1 (lowest) to 99. 0 keeps the default policy
+	int priority;
+	// CPUs the thread may run on, all if empty
+	std::vector<int> cpus;
+};
+
+#endif /* THREADSCHEDULING_H_ */
@@ -0,0 +1,117 @@
+/*
+ * Transport.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ */
+
+#ifndef TRANSPORT_H_
+#define TRANSPORT_H_
+
+#include <boost/asio.hpp>
+
+#include <string>
+#include <vector>
+
+class SerialComm;
+
+// room for one asynchronous operation at a time, spares asio a heap allocation
+#define TRANSPORT_HANDLER_MEM_SIZE 1024
+
+struct HandlerMemory {
+	HandlerMemory(): used(false) {}
+	void* allocate(size_t size) {
+		if (used || size > sizeof(data))
+			return ::operator new(size);
+		used = true;
+		return data;
+	}
+	void deallocate(void* ptr) {
+		if (ptr == data)
+			used = false;
+		else
+			::operator delete(ptr);
+	}
+	unsigned char data[TRANSPORT_HANDLER_MEM_SIZE];
+	bool used;
+};
+
+// completion handlers of the reads and writes of SerialComm, each one brings
+// the memory for its asynchronous operation
+class ReadOp {
+public:
+	ReadOp(SerialComm* comm, int index, HandlerMemory* mem): comm_(comm), index_(index), mem_(mem) {}
+	void operator()(const boost::system::error_code&, size_t);
+	friend void* asio_handler_allocate(size_t size, ReadOp* op) { return op->mem_->allocate(size); }
+	friend void asio_handler_deallocate(void* ptr, size_t, ReadOp* op) { op->mem_->deallocate(ptr); }
+private:
+	SerialComm* comm_;
+	int index_;
+	HandlerMemory* mem_;
+};
+
+class WriteOp {
+public:
+	WriteOp(SerialComm* comm, HandlerMemory* mem): comm_(comm), mem_(mem) {}
+	void operator()(const boost::system::error_code&, size_t);
+	friend void* asio_handler_allocate(size_t size, WriteOp* op) { return op->mem_->allocate(size); }
+	friend void asio_handler_deallocate(void* ptr, size_t, WriteOp* op) { op->mem_->deallocate(ptr); }
+private:
+	SerialComm* comm_;
+	HandlerMemory* mem_;
+};
+
+// where the bytes to and from the HLP go, selected by TransportSettings::type
+struct TransportSettings {
+	// "serial", "tcp", "udp" or "pty"
+	std::string type;
+	// serial: device
+	std::string device;
+	int baud_rate;
+	// termios VMIN and VTIME of the port, -1 leaves them as they are
+	int vmin;
+	int vtime;
+	// serial: ASYNC_LOW_LATENCY, i.e. no buffering in USB adapters. tcp: TCP_NODELAY
+	bool low_latency;
+	// tcp and udp: address of the bridge
+	std::string host;
+	int port;
+	// udp: port to receive on, 0 picks any
+	int local_port;
+	// pty: symlink to the slave side, so that a stand-in of the HLP finds it
+	std::string pty_link;
+};
+
+// A byte link to the HLP. Stream transports (serial, tcp, pty) write all buffers
+// of asyncWrite in one go, the udp transport sends one datagram per buffer,
+// i.e. per ACI frame.
+// All methods but open() are called by the io_service in the IO thread.
+class Transport {
+public:
+	virtual ~Transport() {}
+
+	// returns the transport selected by settings, NULL if the type is unknown
+	static Transport* create(boost::asio::io_service&, const TransportSettings&);
+
+	// opens and configures the link, throws boost::system::system_error if it fails
+	virtual void open() = 0;
+	// cancels pending operations and closes the link if it is open, throws boost::system::system_error
+	virtual void close() = 0;
+	virtual void asyncRead(const boost::asio::mutable_buffer&, const ReadOp&) = 0;
+	// the buffers must exist until the handler has been called on strand
+	virtual void asyncWrite(const std::vector<boost::asio::const_buffer>&,
+			boost::asio::io_service::strand&, const WriteOp&) = 0;
+	// changes the line rate once pending output is sent, false if the transport has none.
+	// Throws boost::system::system_error
+	virtual bool setBaudRate(int) { return false; }
+	// seconds it takes one byte to cross the link, 0 if bytes arrive in blocks
+	virtual double byteTime() const { return 0; }
+
+	// for log messages, e.g. tcp://bridge:2001
+	const std::string& name() const { return name_; }
+
+protected:
+	std::string name_;
+};
+
+#endif /* TRANSPORT_H_ */
@@ -62,7 +62,10 @@ namespace Waypoint {
 
 class WaypointGPSActionServer {
 public:
-	WaypointGPSActionServer(const std::string&, boost::shared_ptr<AciRemote::AciRemote>&);
+	// the action and the geofence service are advertised through the node handle,
+	// which defaults to the namespace of the node
+	WaypointGPSActionServer(const std::string&, boost::shared_ptr<AciRemote::AciRemote>&,
+			const ros::NodeHandle& = ros::NodeHandle());
 	~WaypointGPSActionServer();
 
 	// getters
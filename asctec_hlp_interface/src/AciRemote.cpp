@@ -29,30 +29,110 @@
 #include "asctec_hlp_comm/mav_laser.h"
 
 #include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include <sys/resource.h>
 
 namespace AciRemote {
 
-void* aci_obj_ptr = NULL;
+// same place as the ROS logs, $ROS_HOME or ~/.ros
+static std::string defaultTableCacheDir() {
+	const char* ros_home = std::getenv("ROS_HOME");
+	if (ros_home)
+		return std::string(ros_home) + "/asctec_hlp_interface";
+	const char* home = std::getenv("HOME");
+	return std::string(home ? home : "/tmp") + "/.ros/asctec_hlp_interface";
+}
+
+// counters of now minus those of last
+static struct ACI_LINK_STATS linkStatsSince(const struct ACI_LINK_STATS& now, const struct ACI_LINK_STATS& last) {
+	struct ACI_LINK_STATS delta;
+	delta.framesReceived = now.framesReceived - last.framesReceived;
+	delta.crcErrors = now.crcErrors - last.crcErrors;
+	for (int i = 0; i < MAX_VAR_PACKETS; ++i) {
+		delta.varPacketsReceived[i] = now.varPacketsReceived[i] - last.varPacketsReceived[i];
+		delta.varPacketsInvalid[i] = now.varPacketsInvalid[i] - last.varPacketsInvalid[i];
+	}
+	delta.varConfigResends = now.varConfigResends - last.varConfigResends;
+	delta.cmdConfigResends = now.cmdConfigResends - last.cmdConfigResends;
+	delta.paramConfigResends = now.paramConfigResends - last.paramConfigResends;
+	delta.cmdPacketResends = now.cmdPacketResends - last.cmdPacketResends;
+	return delta;
+}
+
+// one vehicle per namespace, e.g. /pelican -> pelican
+static std::string defaultVehicleId(const std::string& ns) {
+	std::string id;
+	for (size_t i = 0; i < ns.size(); ++i) {
+		if (ns[i] != '/')
+			id += ns[i];
+		else if (!id.empty())
+			id += '_';
+	}
+	return id.empty() ? std::string("hlp") : id;
+}
 
 AciRemote::AciRemote(ros::NodeHandle& nh):
 		SerialComm(), n_(nh), bytes_recv_(0),
+		diag_rx_bytes_(0), diag_tx_bytes_(0), diag_rx_rate_(0), diag_tx_rate_(0), diag_time_(0), diag_interval_(0),
 		versions_match_(false), var_list_recv_(false),
 		cmd_list_recv_(false), par_list_recv_(false),
-		must_stop_engine_(false), must_stop_pub_(false) {
-
-	// assign *this pointer of this instanced object to global pointer for use with callbacks
-	aci_obj_ptr = static_cast<void*>(this);
+		must_stop_engine_(false), must_stop_pub_(false), must_stop_link_(false),
+		link_lost_(false), link_up_(false), baud_reply_rate_(0), baud_reply_status_(0), line_baud_(0),
+		reactor_timer_(io_service_), reactor_state_(REACTOR_RUNNING), laser_packet_(3), var_packet_needs_(0) {
+
+	// every instance talks to its own HLP through its own ACI context,
+	// callbacks get *this pointer back as user data
+	aci_ctx_ = aciCtxCreate();
+	aciCtxSetUserData(aci_ctx_, static_cast<void*>(this));
+	memset(&diag_stats_, 0, sizeof(diag_stats_));
+	memset(&diag_delta_, 0, sizeof(diag_delta_));
+	std::fill(diag_packet_rates_, diag_packet_rates_ + ACI_REMOTE_VAR_PACKETS, 0);
+	std::fill(cmd_sent_, cmd_sent_ + ACI_REMOTE_CMD_PACKETS, 0.0);
 
 	// fetch values from ROS parameter server
+    n_.param<std::string>("transport", transport_type_, std::string("serial"));
     n_.param<std::string>("serial_port", port_name_, std::string("/dev/ttyS2"));
     n_.param<int>("baudrate", baud_rate_, 57600);
+    n_.param<int>("baudrate_target", baud_target_, 0);
+    n_.param<double>("baudrate_switch_timeout", baud_switch_timeout_, 1.0);
+    n_.param<int>("serial_read_buffer_size", read_buf_size_, SERIAL_PORT_READ_BUF_SIZE);
+    n_.param<int>("serial_vmin", read_vmin_, 1);
+    n_.param<int>("serial_vtime", read_vtime_, 0);
+    n_.param<bool>("serial_low_latency", low_latency_, true);
+    n_.param<std::string>("transport_host", remote_host_, std::string("localhost"));
+    n_.param<int>("transport_port", remote_port_, 2001);
+    n_.param<int>("transport_local_port", local_port_, 0);
+    n_.param<std::string>("pty_link", pty_link_, std::string(""));
     n_.param<std::string>("frame_id", frame_id_, std::string(n_.getNamespace() + "_base_link"));
-	// parameters below will (that is, should) be moving to dynamic reconfigure in a later release
+	// parameters below can also be changed through dynamic reconfigure, see ratesReconfigured
     n_.param<int>("packet_rate_imu_mag", imu_rate_, 50);
     n_.param<int>("packet_rate_gps", gps_rate_, 5);
     n_.param<int>("packet_rate_rcdata_status_motors", rc_status_rate_, 10);
     n_.param<int>("aci_engine_throttle", aci_rate_, 100);
     n_.param<int>("aci_heartbeat", aci_heartbeat_, 10);
+    n_.param<int>("aci_list_request_window", aci_list_window_, 4);
+    n_.param<bool>("aci_table_cache", table_cache_enabled_, true);
+    n_.param<std::string>("aci_table_cache_dir", table_cache_dir_, defaultTableCacheDir());
+    n_.param<std::string>("vehicle_id", vehicle_id_, defaultVehicleId(n_.getNamespace()));
+    n_.param<bool>("reactor", reactor_, false);
+    n_.param<double>("load_report_period", load_report_period_, 0.0);
+    n_.param<bool>("subscriber_driven_packets", subscriber_driven_packets_, true);
+    n_.param<double>("diagnostics_period", diag_period_, 1.0);
+    n_.param<double>("jitter_report_period", jitter_report_period_, 0.0);
+    n_.param<int>("io_thread_priority", io_thread_sched_.priority, 0);
+    n_.param<int>("aci_engine_priority", engine_sched_.priority, 0);
+    std::string io_cpus, engine_cpus;
+    n_.param<std::string>("io_thread_cpus", io_cpus, std::string(""));
+    n_.param<std::string>("aci_engine_cpus", engine_cpus, std::string(""));
+    n_.param<bool>("reconnect", reconnect_enabled_, true);
+    n_.param<double>("reconnect_delay_min", reconnect_delay_min_, 0.1);
+    n_.param<double>("reconnect_delay_max", reconnect_delay_max_, 5.0);
+    n_.param<double>("reconnect_rx_timeout", reconnect_rx_timeout_, 2.0);
+    n_.param<double>("reconnect_config_timeout", reconnect_config_timeout_, 10.0);
+    n_.param<double>("config_timeout", config_timeout_, 15.0);
     n_.param<double>("stddev_angular_velocity", ang_vel_variance_, 0.013); // taken from experiments
     n_.param<double>("stddev_linear_acceleration", lin_acc_variance_, 0.083); // taken from experiments
     n_.param<bool>("externalise_robot_state", externalise_state_, bool(true));
@@ -77,6 +157,24 @@ AciRemote::AciRemote(ros::NodeHandle& nh):
     n_.param<std::string>("laser_topic", laser_topic_, std::string("laser"));   // by Xun
 
 
+	std::fill(imu_seq_, imu_seq_ + 3, 0);
+	std::fill(gps_seq_, gps_seq_ + 2, 0);
+	std::fill(status_seq_, status_seq_ + 3, 0);
+	laser_seq_ = 0;
+	std::fill(packet_count_, packet_count_ + ACI_REMOTE_VAR_PACKETS, 0);
+	load_cpu_ = 0;
+	load_switches_ = 0;
+
+	if (!io_thread_sched_.setCpus(io_cpus))
+		ROS_WARN_STREAM("Ignoring malformed io_thread_cpus " << io_cpus);
+	if (!engine_sched_.setCpus(engine_cpus))
+		ROS_WARN_STREAM("Ignoring malformed aci_engine_cpus " << engine_cpus);
+	// the engine thread and the reactor divide by it
+	if (aci_rate_ < 1) {
+		ROS_WARN_STREAM("aci_engine_throttle of " << aci_rate_ << " Hz is not possible, using 1 Hz");
+		aci_rate_ = 1;
+	}
+
 	// TODO: Initialise Asctec SDK3 Command data structures before enabling RC serial switch
 	//WO_SDK_.ctrl_mode = 0x02;
 	//WO_SDK_.ctrl_enabled = 0x00;
@@ -84,6 +182,13 @@ AciRemote::AciRemote(ros::NodeHandle& nh):
 }
 
 AciRemote::~AciRemote() {
+	// no rate changes or diagnostics while shutting down
+	rates_srv_.reset();
+	diag_timer_.stop();
+	// do not let the link supervisor open the port again
+	must_stop_link_ = true;
+	if (link_thread_.get() != NULL)
+		link_thread_->join();
 	// first of all, close serial port, otherwise pure virtual method would be called
 	closePort();
 	// interrupt all running threads and wait for them to return
@@ -92,6 +197,7 @@ AciRemote::~AciRemote() {
 		boost::upgrade_to_unique_lock<boost::shared_mutex> un_lock(up_lock);
 		must_stop_pub_ = true;
 	}
+	cond_any_.notify_all();
 	if (imu_mag_thread_.get() != NULL)
 		imu_mag_thread_->join();
 	if (gps_thread_.get() != NULL)
@@ -114,8 +220,8 @@ AciRemote::~AciRemote() {
 	// at this point, ros::spin() will not be called anymore and thus ROS_INFO will not work
 	//ROS_INFO("All threads have shutdown");
 
-	// assign NULL to global object pointer
-	aci_obj_ptr = static_cast<void*>(NULL);
+	// no thread uses the ACI context anymore
+	aciCtxDestroy(aci_ctx_);
 }
 
 
@@ -129,21 +235,24 @@ int AciRemote::init() {
 	if (openPort() < 0) {
 		return -1;
 	}
-	// initialise ACI Remote
-	aciInit();
-	ROS_INFO("Asctec ACI initialised");
+	{
+		// the receive handler must not run on a context being initialised
+		boost::unique_lock<boost::mutex> buf_lock(buf_mtx_);
+		AciLock aci_lock(this);
+		startAci();
+	}
 
-	// set callbacks
-	aciSetSendDataCallback(AciRemote::transmit);
-	aciInfoPacketReceivedCallback(AciRemote::versions);
-	aciSetVarListUpdateFinishedCallback(AciRemote::varListUpdateFinished);
-	aciSetCmdListUpdateFinishedCallback(AciRemote::cmdListUpdateFinished);
-	aciSetParamListUpdateFinishedCallback(AciRemote::paramListUpdateFinished);
-	aciSetEngineRate(aci_rate_, aci_heartbeat_);
+	if (reactor_) {
+		if (engine_sched_.priority > 0 || !engine_sched_.cpus.empty())
+			ROS_WARN("Reactor mode runs the ACI Engine in the IO thread, aci_engine_priority and aci_engine_cpus are ignored");
+		startReactor();
+		return 0;
+	}
 
 	try {
 		aci_throttle_thread_ = boost::shared_ptr<boost::thread>
 			(new boost::thread(boost::bind(&AciRemote::throttleEngine, this)));
+		engine_sched_.apply(aci_throttle_thread_->native_handle(), "ACI Engine");
 	}
 	catch (boost::system::system_error::exception& e) {
 		ROS_ERROR_STREAM("Could not create ACI Engine thread. " << e.what());
@@ -151,98 +260,175 @@ int AciRemote::init() {
 
 	cond_.notify_one();
 
-	// request version info and lists of commands, parameters and variables to HLP
-	aciCheckVerConf();
-	aciGetDeviceCommandsList();
-	aciGetDeviceParametersList();
-	aciGetDeviceVariablesList();
-
 	return 0;
 }
 
+void AciRemote::startAci() {
+	// initialise ACI Remote
+	aciCtxInit(aci_ctx_);
+	ROS_INFO("Asctec ACI initialised");
+
+	// set callbacks
+	aciCtxSetSendSegmentsCallback(aci_ctx_, AciRemote::transmit);
+	aciCtxInfoPacketReceivedCallback(aci_ctx_, AciRemote::versions);
+	aciCtxSetVarListUpdateFinishedCallback(aci_ctx_, AciRemote::varListUpdateFinished);
+	aciCtxSetCmdListUpdateFinishedCallback(aci_ctx_, AciRemote::cmdListUpdateFinished);
+	aciCtxSetParamListUpdateFinishedCallback(aci_ctx_, AciRemote::paramListUpdateFinished);
+	aciCtxSetBaudRateCallback(aci_ctx_, AciRemote::baudRateReply);
+	aciCtxVarPacketReceivedTimedCallback(aci_ctx_, AciRemote::varPacketReceived);
+	aciCtxSetCmdAckCallback(aci_ctx_, AciRemote::cmdAck);
+	aciCtxSetEngineRate(aci_ctx_, aci_rate_, aci_heartbeat_);
+	aciCtxSetListRequestWindow(aci_ctx_, aci_list_window_);
+	{
+		// the new context never acknowledges commands of the old one
+		boost::mutex::scoped_lock lock(diag_mtx_);
+		std::fill(cmd_sent_, cmd_sent_ + ACI_REMOTE_CMD_PACKETS, 0.0);
+	}
+
+	// the lists are only read from the cache, if it holds any. Otherwise
+	// they are downloaded right away and stored afterwards
+	if (table_cache_enabled_) {
+		if (table_cache_.open(table_cache_dir_, vehicle_id_)) {
+			ROS_INFO_STREAM("Found ACI table cache of " << vehicle_id_);
+			aciCtxSetReadHDCallback(aci_ctx_, AciRemote::readTableCache);
+		}
+		else {
+			aciCtxSetReadHDCallback(aci_ctx_, NULL);
+		}
+		aciCtxSetWriteHDCallback(aci_ctx_, AciRemote::writeTableCache);
+		aciCtxSetResetHDCallback(aci_ctx_, AciRemote::resetTableCache);
+	}
+
+	// request version info and lists of commands, parameters and variables to HLP
+	aciCtxCheckVerConf(aci_ctx_);
+	aciCtxGetDeviceCommandsList(aci_ctx_);
+	aciCtxGetDeviceParametersList(aci_ctx_);
+	aciCtxGetDeviceVariablesList(aci_ctx_);
+}
+
 int AciRemote::initRosLayer() {
-	int c = 0;
-	boost::asio::io_service io;
-	while (++c < 4) {
-		boost::unique_lock<boost::mutex> u_lock(mtx_);
-		if (versions_match_ && var_list_recv_ && cmd_list_recv_ && par_list_recv_) {
-			// advertise ROS topics
-			imu_pub_ = n_.advertise<sensor_msgs::Imu>(imu_topic_, 1);
-			imu_custom_pub_ = n_.advertise<asctec_hlp_comm::mav_imu>(imu_custom_topic_, 1);
-			mag_pub_ = n_.advertise<geometry_msgs::Vector3Stamped>(mag_topic_, 1);
-			gps_pub_ = n_.advertise<sensor_msgs::NavSatFix>(gps_topic_, 1);
-			gps_custom_pub_ = n_.advertise<asctec_hlp_comm::GpsCustom>(gps_custom_topic_, 1);
-			rcdata_pub_ = n_.advertise<asctec_hlp_comm::mav_rcdata>(rcdata_topic_, 1);
-            status_pub_ = n_.advertise<asctec_hlp_comm::mav_hlp_status>(status_topic_, 1);
-			motor_pub_ = n_.advertise<asctec_hlp_comm::MotorSpeed>(motor_topic_, 1);
-
-      laser_pub_ = n_.advertise<asctec_hlp_comm::mav_laser>(laser_topic_, 1);   // by Xun
-
-            // only advertise topic if parameter is set to true
-            if (externalise_state_) {
-                extern_pub_ = n_.advertise<std_msgs::String>(extern_topic_, 10);
-            }
-
-			ctrl_sub_ = n_.subscribe(ctrl_topic_, 1, &AciRemote::ctrlTopicCallback, this);
-
-			ctrl_srv_ = n_.advertiseService(ctrl_srv_name_, &AciRemote::ctrlServiceCallback, this);
-			//motor_srv_ = n_.advertiseService(motors_srv_name_,
-			// &AciRemote::ctrlMotorsCallback, this);
-
-			// spawn publisher threads
-			try {
-				imu_mag_thread_ = boost::shared_ptr<boost::thread>
-					(new boost::thread(boost::bind(&AciRemote::publishImuMagData, this)));
-			}
-			catch (boost::system::system_error::exception& e) {
-				ROS_ERROR_STREAM("Could not create IMU publisher thread. " << e.what());
-			}
-			try {
-				gps_thread_ = boost::shared_ptr<boost::thread>
-					(new boost::thread(boost::bind(&AciRemote::publishGpsData, this)));
-			}
-			catch (boost::system::system_error::exception& e) {
-				ROS_ERROR_STREAM("Could not create GPS publisher thread. " << e.what());
-			}
-			try {
-				rc_status_thread_ = boost::shared_ptr<boost::thread>
-					(new boost::thread(boost::bind(&AciRemote::publishStatusMotorsRcData, this)));
-			}
-			catch (boost::system::system_error::exception& e) {
-				ROS_ERROR_STREAM("Could not create Status publisher thread. " << e.what());
-			}
+	// a warm start from the table cache is done long before a cold download
+	if (!waitForConfiguration(config_timeout_))
+		return -1;
+	switchBaudRate();
+	// advertise ROS topics, the var packets follow their subscribers
+	ros::SubscriberStatusCallback subscribers = boost::bind(&AciRemote::subscribersChanged, this, _1);
+	imu_pub_ = n_.advertise<sensor_msgs::Imu>(imu_topic_, 1, subscribers, subscribers);
+	imu_custom_pub_ = n_.advertise<asctec_hlp_comm::mav_imu>(imu_custom_topic_, 1, subscribers, subscribers);
+	mag_pub_ = n_.advertise<geometry_msgs::Vector3Stamped>(mag_topic_, 1, subscribers, subscribers);
+	gps_pub_ = n_.advertise<sensor_msgs::NavSatFix>(gps_topic_, 1, subscribers, subscribers);
+	gps_custom_pub_ = n_.advertise<asctec_hlp_comm::GpsCustom>(gps_custom_topic_, 1, subscribers, subscribers);
+	rcdata_pub_ = n_.advertise<asctec_hlp_comm::mav_rcdata>(rcdata_topic_, 1, subscribers, subscribers);
+	status_pub_ = n_.advertise<asctec_hlp_comm::mav_hlp_status>(status_topic_, 1, subscribers, subscribers);
+	motor_pub_ = n_.advertise<asctec_hlp_comm::MotorSpeed>(motor_topic_, 1, subscribers, subscribers);
+
+	laser_pub_ = n_.advertise<asctec_hlp_comm::mav_laser>(laser_topic_, 1, subscribers, subscribers);   // by Xun
+
+	// only advertise topic if parameter is set to true
+	if (externalise_state_) {
+		extern_pub_ = n_.advertise<std_msgs::String>(extern_topic_, 10);
+	}
 
-      // by Xun
-      try {
-        laser_thread_ = boost::shared_ptr<boost::thread>
-          (new boost::thread(boost::bind(&AciRemote::publishLaserData, this)));
-      }
-      catch (boost::system::system_error::exception& e) {
-        ROS_ERROR_STREAM("Could not create laser publisher thread. " << e.what());
-      }
+	ctrl_sub_ = n_.subscribe(ctrl_topic_, 1, &AciRemote::ctrlTopicCallback, this);
+
+	ctrl_srv_ = n_.advertiseService(ctrl_srv_name_, &AciRemote::ctrlServiceCallback, this);
+	//motor_srv_ = n_.advertiseService(motors_srv_name_,
+	// &AciRemote::ctrlMotorsCallback, this);
+
+	// the publishers in the IO thread of reactor mode start right away
+	setLinkUp(true);
+	// subscribers which connected before the link was up
+	updateVarPackets();
+	// the server keeps its parameters apart from the ones of the node, it starts with the rates read above
+	rates_srv_.reset(new dynamic_reconfigure::Server<asctec_hlp_interface::HlpRatesConfig>(
+			ros::NodeHandle(n_, "hlp_rates")));
+	asctec_hlp_interface::HlpRatesConfig rates;
+	rates.packet_rate_rcdata_status_motors = rc_status_rate_;
+	rates.packet_rate_gps = gps_rate_;
+	rates.packet_rate_imu_mag = imu_rate_;
+	rates.packet_rate_laser_mag = laser_rate_;
+	rates.aci_engine_throttle = aci_rate_;
+	rates_srv_->updateConfig(rates);
+	rates_srv_->setCallback(boost::bind(&AciRemote::ratesReconfigured, this, _1, _2));
+
+	if (diag_period_ > 0) {
+		diag_updater_.reset(new diagnostic_updater::Updater());
+		diag_updater_->setHardwareID(vehicle_id_);
+		diag_updater_->add("HLP link", this, &AciRemote::linkDiagnostics);
+		diag_updater_->add("HLP variables packets", this, &AciRemote::packetDiagnostics);
+		diag_updater_->add("ACI Engine", this, &AciRemote::engineDiagnostics);
+		diag_timer_ = n_.createWallTimer(ros::WallDuration(diag_period_),
+				&AciRemote::updateDiagnostics, this);
+	}
 
+	if (load_report_period_ > 0) {
+		load_timer_ = n_.createWallTimer(ros::WallDuration(load_report_period_),
+				&AciRemote::reportLoad, this);
+	}
 
-			cond_any_.notify_all();
+	// spawn publisher threads
+	if (reactor_) {
+		ROS_INFO_STREAM("Reactor mode: ACI Engine runs in the IO thread at "
+				<< aci_rate_ << " Hz, publishers as packets arrive");
+	}
+	else {
+		try {
+			imu_mag_thread_ = boost::shared_ptr<boost::thread>
+				(new boost::thread(boost::bind(&AciRemote::publishImuMagData, this)));
+		}
+		catch (boost::system::system_error::exception& e) {
+			ROS_ERROR_STREAM("Could not create IMU publisher thread. " << e.what());
+		}
+		try {
+			gps_thread_ = boost::shared_ptr<boost::thread>
+				(new boost::thread(boost::bind(&AciRemote::publishGpsData, this)));
+		}
+		catch (boost::system::system_error::exception& e) {
+			ROS_ERROR_STREAM("Could not create GPS publisher thread. " << e.what());
+		}
+		try {
+			rc_status_thread_ = boost::shared_ptr<boost::thread>
+				(new boost::thread(boost::bind(&AciRemote::publishStatusMotorsRcData, this)));
+		}
+		catch (boost::system::system_error::exception& e) {
+			ROS_ERROR_STREAM("Could not create Status publisher thread. " << e.what());
+		}
 
-			return 0;
+		// by Xun
+		try {
+			laser_thread_ = boost::shared_ptr<boost::thread>
+				(new boost::thread(boost::bind(&AciRemote::publishLaserData, this)));
 		}
-		else {
-			// release mutex, wait 5 seconds and try again (no more than 3 times)
-			u_lock.unlock();
-			boost::asio::deadline_timer t(io, boost::posix_time::seconds(5));
-			t.wait();
+		catch (boost::system::system_error::exception& e) {
+			ROS_ERROR_STREAM("Could not create laser publisher thread. " << e.what());
 		}
+
+
+		cond_any_.notify_all();
 	}
-	return -1;
+
+	if (reconnect_enabled_) {
+		try {
+			link_thread_ = boost::shared_ptr<boost::thread>
+				(new boost::thread(boost::bind(&AciRemote::superviseLink, this)));
+		}
+		catch (boost::system::system_error::exception& e) {
+			ROS_ERROR_STREAM("Could not create link supervisor thread. " << e.what());
+		}
+	}
+
+	return 0;
 }
 
 int AciRemote::setGpsWaypoint(const asctec_hlp_comm::WaypointGPSGoalConstPtr& pose) {
 	short uav_status, waypt_state;
 	double roll, pitch, yaw;
-	boost::shared_lock<boost::shared_mutex> s_lock(shared_mtx_);
-	uav_status = RO_ALL_Data_.UAV_status;
-	waypt_state = wayptStatus_;
-	s_lock.unlock();
+	struct RO_ALL_DATA ro_all = RO_ALL_DATA();
+	unsigned short waypt_status = 0;
+	snapshot(RO_ALL_Data_, ro_all);
+	snapshot(wayptStatus_, waypt_status);
+	uav_status = ro_all.UAV_status;
+	waypt_state = waypt_status;
 
 	// check flight mode
 	if ((uav_status & 0x000F) != HLP_FLIGHTMODE_GPS) {
@@ -255,7 +441,7 @@ int AciRemote::setGpsWaypoint(const asctec_hlp_comm::WaypointGPSGoalConstPtr& po
 	}
 	// GPS mode is enabled and state machine on HLP is in states 4 or 5
 	// hence, waypoint may be sent over to HLP (and then to LLP from within HLP)
-	boost::mutex::scoped_lock lock(ctrl_mtx_);
+	AciLock lock(this);
 
 	// convert pose waypoint into HLP-format waypoint
 	WO_wpToLL_.X = static_cast<int>(pose->geo_pose.position.latitude * 1.0e7);
@@ -295,43 +481,48 @@ int AciRemote::setGpsWaypoint(const asctec_hlp_comm::WaypointGPSGoalConstPtr& po
 	wpCtrlWpCmd_ = static_cast<unsigned char>(pose->command);
 
 	// update control commands packet
-    aciUpdateCmdPacket(0);
+    updateCmdPacket(0);
 	// update waypoint command packet
-	aciUpdateCmdPacket(2);
+	updateCmdPacket(2);
 
 	return waypt_state;
 }
 
 void AciRemote::getGpsWayptNavStatus(unsigned short& waypt_nav_status,
 		double& dist_to_goal) {
-	boost::shared_lock<boost::shared_mutex> s_lock(shared_mtx_);
-	waypt_nav_status = wpCtrlNavStatus_;
+	unsigned short dist_to_wp = 0;
+	waypt_nav_status = 0;
+	snapshot(wpCtrlNavStatus_, waypt_nav_status);
+	snapshot(wpCtrlDistToWp_, dist_to_wp);
 	// current distance to waypoint is in dm (=10cm)
-	dist_to_goal = double(wpCtrlDistToWp_) * 0.1;
+	dist_to_goal = double(dist_to_wp) * 0.1;
 }
 
 void AciRemote::getGpsWayptState(unsigned short& waypt_state) {
-	boost::shared_lock<boost::shared_mutex> s_lock(shared_mtx_);
-	waypt_state = wayptStatus_;
+	waypt_state = 0;
+	snapshot(wayptStatus_, waypt_state);
 }
 
 void AciRemote::getGpsWayptResultPose(asctec_hlp_comm::WaypointGPSResult& result) {
-	boost::shared_lock<boost::shared_mutex> s_lock(shared_mtx_);
+	struct RO_ALL_DATA ro_all = RO_ALL_DATA();
+	unsigned short nav_status = 0;
+	snapshot(RO_ALL_Data_, ro_all);
+	snapshot(wpCtrlNavStatus_, nav_status);
 
 	result.geo_pose.position.latitude =
-			static_cast<double>(RO_ALL_Data_.fusion_latitude) * 1.0e-7;
+			static_cast<double>(ro_all.fusion_latitude) * 1.0e-7;
 	result.geo_pose.position.longitude =
-			static_cast<double>(RO_ALL_Data_.fusion_longitude) * 1.0e-7;
+			static_cast<double>(ro_all.fusion_longitude) * 1.0e-7;
 	// TODO: check whether altitude should be GPS_height * 1.0e-3 instead
 	result.geo_pose.position.altitude =
-			static_cast<double>(RO_ALL_Data_.fusion_height * 1.0e-3);
+			static_cast<double>(ro_all.fusion_height * 1.0e-3);
 
 	// TODO: use data from IMU for more accurate estimate
 	tf::Quaternion q;
-	q.setRPY(0.0, 0.0, static_cast<double>(RO_ALL_Data_.GPS_heading)*M_PI/180000.0);
+	q.setRPY(0.0, 0.0, static_cast<double>(ro_all.GPS_heading)*M_PI/180000.0);
 	tf::quaternionTFToMsg(q, result.geo_pose.orientation);
 
-	result.status = wpCtrlNavStatus_;
+	result.status = nav_status;
 }
 
 
@@ -350,20 +541,23 @@ void AciRemote::checkVersions(struct ACI_INFO aciInfo) {
 	ROS_INFO("MAX_DESC_LENGTH\t\t%d\t=\t\%d",aciInfo.maxDescLength,MAX_DESC_LENGTH);
 	ROS_INFO("MAX_NAME_LENGTH\t\t%d\t=\t\%d",aciInfo.maxNameLength,MAX_NAME_LENGTH);
 	ROS_INFO("MAX_UNIT_LENGTH\t\t%d\t=\t\%d",aciInfo.maxUnitLength,MAX_UNIT_LENGTH);
-	ROS_INFO("MAX_VAR_PACKETS\t\t%d\t=\t\%d",aciInfo.maxVarPackets,MAX_VAR_PACKETS);
+	// the number of packets does not have to match, as many as both sides have are used
+	ROS_INFO("MAX_VAR_PACKETS\t\t%d\t<=\t\%d",aciInfo.maxVarPackets,MAX_VAR_PACKETS);
 
 	if (aciInfo.verMajor != ACI_VER_MAJOR ||
 			aciInfo.verMinor != ACI_VER_MINOR ||
 			aciInfo.maxDescLength != MAX_DESC_LENGTH ||
 			aciInfo.maxNameLength != MAX_NAME_LENGTH ||
 			aciInfo.maxUnitLength != MAX_UNIT_LENGTH ||
-			aciInfo.maxVarPackets != MAX_VAR_PACKETS) {
+			aciInfo.maxVarPackets == 0) {
 		match = false;
 	}
+	ROS_INFO_STREAM("Using " << static_cast<int>(aciCtxGetVarPacketCount(aci_ctx_)) << " variables packets");
 
 	if (match) {
 		boost::mutex::scoped_lock lock(mtx_);
 		versions_match_ = true;
+		config_cond_.notify_all();
 	}
 	else {
 		ROS_ERROR_STREAM("ACI versions do not match. Must abort now.");
@@ -372,104 +566,287 @@ void AciRemote::checkVersions(struct ACI_INFO aciInfo) {
 
 void AciRemote::setupVarPackets() {
 	ROS_INFO("Received variables list from HLP");
+
+	// packet ID 3 is for the laser, by Xun. HLPs with 3 packets only send it along with the IMU
+	laser_packet_ = 3;
+	if (aciCtxGetVarPacketCount(aci_ctx_) <= laser_packet_) {
+		laser_packet_ = 2;
+		ROS_WARN_STREAM("HLP has no variables packet for the laser, it comes at the IMU rate");
+	}
+	configureVarPackets(varPacketNeeds());
+
+	ROS_INFO_STREAM("Variables packets configured");
+
+	boost::mutex::scoped_lock lock(mtx_);
+	var_list_recv_ = true;
+	config_cond_.notify_all();
+}
+
+void AciRemote::configureVarPackets(unsigned int needs) {
 	// setup variables packets to be received
 	// along with reception rate (not more than ACI Engine rate)
+	var_packet_needs_ = needs;
+	for (unsigned char i = 0; i <= laser_packet_; ++i)
+		aciCtxResetVarPacketContent(aci_ctx_, i);
 
 	// packet ID 0 containing: status, motor speed and RC data
-	// status data
-	aciAddContentToVarPacket(0, 0x0001, &RO_ALL_Data_.UAV_status);
-	aciAddContentToVarPacket(0, 0x0002, &RO_ALL_Data_.flight_time);
-	aciAddContentToVarPacket(0, 0x0003, &RO_ALL_Data_.battery_voltage);
-	aciAddContentToVarPacket(0, 0x0004, &RO_ALL_Data_.HL_cpu_load);
-	aciAddContentToVarPacket(0, 0x0005, &RO_ALL_Data_.HL_up_time);
-	// motor speed data
-	aciAddContentToVarPacket(0, 0x0100, &RO_ALL_Data_.motor_rpm[0]);
-	aciAddContentToVarPacket(0, 0x0101, &RO_ALL_Data_.motor_rpm[1]);
-	aciAddContentToVarPacket(0, 0x0102, &RO_ALL_Data_.motor_rpm[2]);
-	aciAddContentToVarPacket(0, 0x0103, &RO_ALL_Data_.motor_rpm[3]);
+	// status data, the flight mode is always needed by the waypoints and control commands
+	aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0001, &RO_ALL_Data_.UAV_status);
+	if (needs & VAR_STATUS) {
+		aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0002, &RO_ALL_Data_.flight_time);
+		aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0003, &RO_ALL_Data_.battery_voltage);
+		aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0004, &RO_ALL_Data_.HL_cpu_load);
+		aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0005, &RO_ALL_Data_.HL_up_time);
+	}
+	// motor speed data, the status tells whether the motors are running
+	if (needs & (VAR_MOTORS | VAR_STATUS)) {
+		aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0100, &RO_ALL_Data_.motor_rpm[0]);
+		aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0101, &RO_ALL_Data_.motor_rpm[1]);
+		aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0102, &RO_ALL_Data_.motor_rpm[2]);
+		aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0103, &RO_ALL_Data_.motor_rpm[3]);
+	}
 	// Rc data
-	aciAddContentToVarPacket(0, 0x0600, &RO_ALL_Data_.channel[0]);
-	aciAddContentToVarPacket(0, 0x0601, &RO_ALL_Data_.channel[1]);
-	aciAddContentToVarPacket(0, 0x0602, &RO_ALL_Data_.channel[2]);
-	aciAddContentToVarPacket(0, 0x0603, &RO_ALL_Data_.channel[3]);
-	aciAddContentToVarPacket(0, 0x0604, &RO_ALL_Data_.channel[4]);
-	aciAddContentToVarPacket(0, 0x0605, &RO_ALL_Data_.channel[5]);
-	aciAddContentToVarPacket(0, 0x0606, &RO_ALL_Data_.channel[6]);
-	aciAddContentToVarPacket(0, 0x0607, &RO_ALL_Data_.channel[7]);
-	// data after sensor fusion
-	aciAddContentToVarPacket(0, 0x0303, &RO_ALL_Data_.fusion_latitude);
-	aciAddContentToVarPacket(0, 0x0304, &RO_ALL_Data_.fusion_longitude);
-	aciAddContentToVarPacket(0, 0x0305, &RO_ALL_Data_.fusion_dheight);
-	aciAddContentToVarPacket(0, 0x0306, &RO_ALL_Data_.fusion_height);
-	aciAddContentToVarPacket(0, 0x0307, &RO_ALL_Data_.fusion_speed_x);
-	aciAddContentToVarPacket(0, 0x0308, &RO_ALL_Data_.fusion_speed_y);
-	aciAddContentToVarPacket(0, 0x100C, &wpCtrlNavStatus_);
-	aciAddContentToVarPacket(0, 0x100D, &wpCtrlDistToWp_);
+	if (needs & VAR_RCDATA) {
+		aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0600, &RO_ALL_Data_.channel[0]);
+		aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0601, &RO_ALL_Data_.channel[1]);
+		aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0602, &RO_ALL_Data_.channel[2]);
+		aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0603, &RO_ALL_Data_.channel[3]);
+		aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0604, &RO_ALL_Data_.channel[4]);
+		aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0605, &RO_ALL_Data_.channel[5]);
+		aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0606, &RO_ALL_Data_.channel[6]);
+		aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0607, &RO_ALL_Data_.channel[7]);
+	}
+	// data after sensor fusion, the position is the result of the waypoint action
+	aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0303, &RO_ALL_Data_.fusion_latitude);
+	aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0304, &RO_ALL_Data_.fusion_longitude);
+	aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0305, &RO_ALL_Data_.fusion_dheight);
+	aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0306, &RO_ALL_Data_.fusion_height);
+	aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0307, &RO_ALL_Data_.fusion_speed_x);
+	aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x0308, &RO_ALL_Data_.fusion_speed_y);
+	aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x100C, &wpCtrlNavStatus_);
+	aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x100D, &wpCtrlDistToWp_);
 	// TODO the line below sets up the address I should be using, but
 	// I found a typo in the firmware (main.c) which I do not have time
 	// change at the moment (need to re-compile and re-flash the firmware to the HLP)
-	//aciAddContentToVarPacket(0, 0x100E, &wayptStatus_);
+	//aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x100E, &wayptStatus_);
 	// TODO the line below is currently setting the address according to main.c
 	// as of 30 Apr 2014
-	aciAddContentToVarPacket(0, 0x101E, &wayptStatus_);
+	aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x101E, &wayptStatus_);
 	// debug variables
-	aciAddContentToVarPacket(0, 0x100F, &RO_SDK_.ctrl_mode);
-	aciAddContentToVarPacket(0, 0x1010, &RO_SDK_.ctrl_enabled);
-	aciAddContentToVarPacket(0, 0x1011, &RO_SDK_.disable_motor_onoff_by_stick);
-	//aciAddContentToVarPacket(0, 0x1015, &debug1_);
-	//aciAddContentToVarPacket(0, 0x1016, &debug2_);
-	//aciAddContentToVarPacket(0, 0x1017, &debug3_);
-
-	// packet ID 1 containing: GPS data
-	aciAddContentToVarPacket(1, 0x0106, &RO_ALL_Data_.GPS_latitude);
-	aciAddContentToVarPacket(1, 0x0107, &RO_ALL_Data_.GPS_longitude);
-	aciAddContentToVarPacket(1, 0x0108, &RO_ALL_Data_.GPS_height);
-	aciAddContentToVarPacket(1, 0x0109, &RO_ALL_Data_.GPS_speed_x);
-	aciAddContentToVarPacket(1, 0x010A, &RO_ALL_Data_.GPS_speed_y);
-	aciAddContentToVarPacket(1, 0x010B, &RO_ALL_Data_.GPS_heading);
-	aciAddContentToVarPacket(1, 0x010C, &RO_ALL_Data_.GPS_position_accuracy);
-	aciAddContentToVarPacket(1, 0x010D, &RO_ALL_Data_.GPS_height_accuracy);
-	aciAddContentToVarPacket(1, 0x010E, &RO_ALL_Data_.GPS_speed_accuracy);
-	aciAddContentToVarPacket(1, 0x010F, &RO_ALL_Data_.GPS_sat_num);
-	aciAddContentToVarPacket(1, 0x0110, &RO_ALL_Data_.GPS_status);
-	//aciAddContentToVarPacket(1, 0x0111, &RO_ALL_Data_.GPS_time_of_week);
-	//aciAddContentToVarPacket(1, 0x0112, &RO_ALL_Data_.GPS_week);
+	aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x100F, &RO_SDK_.ctrl_mode);
+	aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x1010, &RO_SDK_.ctrl_enabled);
+	aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x1011, &RO_SDK_.disable_motor_onoff_by_stick);
+	//aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x1015, &debug1_);
+	//aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x1016, &debug2_);
+	//aciCtxAddContentToVarPacket(aci_ctx_, 0, 0x1017, &debug3_);
+
+	// packet ID 1 containing: GPS data, the heading is part of the waypoint result as well
+	if (needs & VAR_GPS) {
+		aciCtxAddContentToVarPacket(aci_ctx_, 1, 0x0106, &RO_ALL_Data_.GPS_latitude);
+		aciCtxAddContentToVarPacket(aci_ctx_, 1, 0x0107, &RO_ALL_Data_.GPS_longitude);
+		aciCtxAddContentToVarPacket(aci_ctx_, 1, 0x0108, &RO_ALL_Data_.GPS_height);
+		aciCtxAddContentToVarPacket(aci_ctx_, 1, 0x0109, &RO_ALL_Data_.GPS_speed_x);
+		aciCtxAddContentToVarPacket(aci_ctx_, 1, 0x010A, &RO_ALL_Data_.GPS_speed_y);
+	}
+	aciCtxAddContentToVarPacket(aci_ctx_, 1, 0x010B, &RO_ALL_Data_.GPS_heading);
+	if (needs & VAR_GPS) {
+		aciCtxAddContentToVarPacket(aci_ctx_, 1, 0x010C, &RO_ALL_Data_.GPS_position_accuracy);
+		aciCtxAddContentToVarPacket(aci_ctx_, 1, 0x010D, &RO_ALL_Data_.GPS_height_accuracy);
+		aciCtxAddContentToVarPacket(aci_ctx_, 1, 0x010E, &RO_ALL_Data_.GPS_speed_accuracy);
+	}
+	// the status reports the GPS fix too
+	if (needs & (VAR_GPS | VAR_STATUS)) {
+		aciCtxAddContentToVarPacket(aci_ctx_, 1, 0x010F, &RO_ALL_Data_.GPS_sat_num);
+		aciCtxAddContentToVarPacket(aci_ctx_, 1, 0x0110, &RO_ALL_Data_.GPS_status);
+	}
+	//aciCtxAddContentToVarPacket(aci_ctx_, 1, 0x0111, &RO_ALL_Data_.GPS_time_of_week);
+	//aciCtxAddContentToVarPacket(aci_ctx_, 1, 0x0112, &RO_ALL_Data_.GPS_week);
 
 	// packet ID 2 containing: IMU + magnetometer
-	aciAddContentToVarPacket(2, 0x0200, &RO_ALL_Data_.angvel_pitch);
-	aciAddContentToVarPacket(2, 0x0201, &RO_ALL_Data_.angvel_roll);
-	aciAddContentToVarPacket(2, 0x0202, &RO_ALL_Data_.angvel_yaw);
-	aciAddContentToVarPacket(2, 0x0203, &RO_ALL_Data_.acc_x);
-	aciAddContentToVarPacket(2, 0x0204, &RO_ALL_Data_.acc_y);
-	aciAddContentToVarPacket(2, 0x0205, &RO_ALL_Data_.acc_z);
-	aciAddContentToVarPacket(2, 0x0206, &RO_ALL_Data_.Hx);
-	aciAddContentToVarPacket(2, 0x0207, &RO_ALL_Data_.Hy);
-	aciAddContentToVarPacket(2, 0x0208, &RO_ALL_Data_.Hz);
-	aciAddContentToVarPacket(2, 0x0300, &RO_ALL_Data_.angle_pitch);
-	aciAddContentToVarPacket(2, 0x0301, &RO_ALL_Data_.angle_roll);
-	aciAddContentToVarPacket(2, 0x0302, &RO_ALL_Data_.angle_yaw);
-
-  // packet ID 3 containing: laser, by Xun
-  aciAddContentToVarPacket(3, 0x1001, &laser_distance_);
-
-	// set transmission rate for packets, update and send configuration
-	aciSetVarPacketTransmissionRate(0, rc_status_rate_);
-	aciSetVarPacketTransmissionRate(1, gps_rate_);
-	aciSetVarPacketTransmissionRate(2, imu_rate_);
-
-  aciSetVarPacketTransmissionRate(3, laser_rate_);    // by Xun
-
-	aciVarPacketUpdateTransmissionRates();
-	aciSendVariablePacketConfiguration(0);
-	aciSendVariablePacketConfiguration(1);
-	aciSendVariablePacketConfiguration(2);
-
-  aciSendVariablePacketConfiguration(3);    // by Xun
+	if (needs & VAR_IMU) {
+		aciCtxAddContentToVarPacket(aci_ctx_, 2, 0x0200, &RO_ALL_Data_.angvel_pitch);
+		aciCtxAddContentToVarPacket(aci_ctx_, 2, 0x0201, &RO_ALL_Data_.angvel_roll);
+		aciCtxAddContentToVarPacket(aci_ctx_, 2, 0x0202, &RO_ALL_Data_.angvel_yaw);
+		aciCtxAddContentToVarPacket(aci_ctx_, 2, 0x0203, &RO_ALL_Data_.acc_x);
+		aciCtxAddContentToVarPacket(aci_ctx_, 2, 0x0204, &RO_ALL_Data_.acc_y);
+		aciCtxAddContentToVarPacket(aci_ctx_, 2, 0x0205, &RO_ALL_Data_.acc_z);
+	}
+	if (needs & VAR_MAG) {
+		aciCtxAddContentToVarPacket(aci_ctx_, 2, 0x0206, &RO_ALL_Data_.Hx);
+		aciCtxAddContentToVarPacket(aci_ctx_, 2, 0x0207, &RO_ALL_Data_.Hy);
+		aciCtxAddContentToVarPacket(aci_ctx_, 2, 0x0208, &RO_ALL_Data_.Hz);
+	}
+	if (needs & VAR_IMU) {
+		aciCtxAddContentToVarPacket(aci_ctx_, 2, 0x0300, &RO_ALL_Data_.angle_pitch);
+		aciCtxAddContentToVarPacket(aci_ctx_, 2, 0x0301, &RO_ALL_Data_.angle_roll);
+		aciCtxAddContentToVarPacket(aci_ctx_, 2, 0x0302, &RO_ALL_Data_.angle_yaw);
+	}
 
-	ROS_INFO_STREAM("Variables packets configured");
+	// packet ID 3 (or 2) containing: laser, by Xun
+	if (needs & VAR_LASER)
+		aciCtxAddContentToVarPacket(aci_ctx_, laser_packet_, 0x1001, &laser_distance_);
 
-	boost::mutex::scoped_lock lock(mtx_);
-	var_list_recv_ = true;
+	// update and send configuration
+	sendVarPacketRates();
+	for (unsigned char i = 0; i <= laser_packet_; ++i)
+		aciCtxSendVariablePacketConfiguration(aci_ctx_, i);
+}
+
+void AciRemote::sendVarPacketRates() {
+	// set transmission rate for packets, the HLP does not send those left empty
+	const int rates[ACI_REMOTE_VAR_PACKETS] = { rc_status_rate_, gps_rate_, imu_rate_, laser_rate_ };
+	for (unsigned char i = 0; i <= laser_packet_; ++i)
+		aciCtxSetVarPacketTransmissionRate(aci_ctx_, i, aciCtxGetVarPacketLength(aci_ctx_, i) ? rates[i] : 0);
+	aciCtxVarPacketUpdateTransmissionRates(aci_ctx_);
+}
+
+unsigned int AciRemote::varPacketNeeds() const {
+	if (!subscriber_driven_packets_)
+		return VAR_ALL;
+
+	// publishers not advertised yet have no subscribers
+	unsigned int needs = 0;
+	if (imu_pub_.getNumSubscribers() > 0 || imu_custom_pub_.getNumSubscribers() > 0)
+		needs |= VAR_IMU;
+	if (mag_pub_.getNumSubscribers() > 0)
+		needs |= VAR_MAG;
+	if (gps_pub_.getNumSubscribers() > 0 || gps_custom_pub_.getNumSubscribers() > 0)
+		needs |= VAR_GPS;
+	if (rcdata_pub_.getNumSubscribers() > 0)
+		needs |= VAR_RCDATA;
+	if (status_pub_.getNumSubscribers() > 0)
+		needs |= VAR_STATUS;
+	if (motor_pub_.getNumSubscribers() > 0)
+		needs |= VAR_MOTORS;
+	if (laser_pub_.getNumSubscribers() > 0)
+		needs |= VAR_LASER;
+	return needs;
+}
+
+void AciRemote::subscribersChanged(const ros::SingleSubscriberPublisher&) {
+	if (subscriber_driven_packets_)
+		updateVarPackets();
+}
+
+void AciRemote::updateVarPackets() {
+	unsigned int needs = varPacketNeeds();
+
+	boost::unique_lock<boost::mutex> buf_lock(buf_mtx_);
+	AciLock aci_lock(this);
+	// while the link is down, setupVarPackets configures the packets once the lists arrive
+	if (!link_up_ || needs == var_packet_needs_)
+		return;
+	// snapshots of the publishers and services use the decode plans being rebuilt
+	boost::unique_lock<boost::shared_mutex> link_lock(link_mtx_);
+	configureVarPackets(needs);
+
+	std::ostringstream ss;
+	for (unsigned char i = 0; i <= laser_packet_; ++i)
+		ss << (i ? "/" : "") << aciCtxGetVarPacketLength(aci_ctx_, i);
+	ROS_INFO_STREAM("Variables packets reconfigured for the subscribed topics, " << ss.str() << " variables");
+
+	const int rates[ACI_REMOTE_VAR_PACKETS] = { rc_status_rate_, gps_rate_, imu_rate_, laser_rate_ };
+	double load = varPacketLoad(rates);
+	double budget = linkBudget();
+	if (budget > 0 && load > budget)
+		ROS_WARN_STREAM("Variables packets need " << load << " bytes/s, more than the "
+				<< budget << " bytes/s of the link, lower the packet rates");
+}
+
+double AciRemote::varPacketLoad(const int* rates) {
+	double load = 0;
+	for (unsigned char i = 0; i <= laser_packet_; ++i) {
+		unsigned short length = aciCtxGetVarPacketLength(aci_ctx_, i);
+		if (length == 0)
+			continue;
+		unsigned int size = ACI_VAR_PACKET_OVERHEAD;
+		for (unsigned short z = 0; z < length; ++z) {
+			struct ACI_MEM_TABLE_ENTRY* entry = aciCtxGetVariableItemById(aci_ctx_,
+					aciCtxGetVarPacketItem(aci_ctx_, i, z));
+			if (entry)
+				size += entry->varType >> 2;
+		}
+		load += static_cast<double>(size) * rates[i];
+	}
+	return load;
+}
+
+double AciRemote::lineCapacity() {
+	if (transport_type_ != "serial")
+		return 0;
+	boost::mutex::scoped_lock lock(baud_mtx_);
+	// 8N1 takes 10 bits per byte
+	return line_baud_ / 10.0;
+}
+
+double AciRemote::linkBudget() {
+	// leave a fifth of the line to commands, heartbeats and packets sent again after a CRC error
+	return lineCapacity() * 0.8;
+}
+
+void AciRemote::ratesReconfigured(asctec_hlp_interface::HlpRatesConfig& config, uint32_t) {
+	boost::unique_lock<boost::mutex> buf_lock(buf_mtx_);
+	AciLock aci_lock(this);
+
+	// the engine thread and the reactor pick it up with their next call, and divide by it
+	int throttle = std::max(1, config.aci_engine_throttle);
+	if (throttle != aci_rate_) {
+		aci_rate_ = throttle;
+		aciCtxSetEngineRate(aci_ctx_, aci_rate_, aci_heartbeat_);
+		ROS_INFO_STREAM("ACI Engine throttling at " << aci_rate_ << " Hz");
+	}
+
+	// the packets are received along with the ACI Engine, not faster
+	const char* names[ACI_REMOTE_VAR_PACKETS] = { "packet_rate_rcdata_status_motors", "packet_rate_gps",
+			"packet_rate_imu_mag", "packet_rate_laser_mag" };
+	int rates[ACI_REMOTE_VAR_PACKETS] = { config.packet_rate_rcdata_status_motors, config.packet_rate_gps,
+			config.packet_rate_imu_mag, config.packet_rate_laser_mag };
+	int current[ACI_REMOTE_VAR_PACKETS] = { rc_status_rate_, gps_rate_, imu_rate_, laser_rate_ };
+	for (int i = 0; i < ACI_REMOTE_VAR_PACKETS; ++i) {
+		if (rates[i] > aci_rate_) {
+			ROS_WARN_STREAM("Rate " << rates[i] << " Hz of var packet " << i << " is above the ACI Engine throttle, "
+					"limited to " << aci_rate_ << " Hz");
+			rates[i] = aci_rate_;
+		}
+	}
+
+	// the contents are known once the variables list arrived
+	double budget = link_up_ ? linkBudget() : 0;
+	double load = budget > 0 ? varPacketLoad(rates) : 0;
+	if (budget > 0 && load > budget) {
+		ROS_WARN_STREAM("Rejected new rates, the variables packets would need " << load
+				<< " bytes/s, more than the " << budget << " bytes/s of the link");
+		// a lower throttle still limits the rates in effect, which only lowers the load
+		for (int i = 0; i < ACI_REMOTE_VAR_PACKETS; ++i) {
+			int kept = std::min(current[i], aci_rate_);
+			if (rates[i] != kept)
+				ROS_WARN_STREAM(names[i] << " reverted to " << kept << " Hz");
+			rates[i] = kept;
+		}
+		load = varPacketLoad(rates);
+	}
+
+	bool changed = false;
+	for (int i = 0; i < ACI_REMOTE_VAR_PACKETS; ++i)
+		changed = changed || rates[i] != current[i];
+	rc_status_rate_ = rates[0];
+	gps_rate_ = rates[1];
+	imu_rate_ = rates[2];
+	laser_rate_ = rates[3];
+	if (changed && link_up_) {
+		sendVarPacketRates();
+		ROS_INFO_STREAM("Variables packets rates set to " << rc_status_rate_ << "/" << gps_rate_ << "/"
+				<< imu_rate_ << "/" << laser_rate_ << " Hz");
+		if (budget > 0)
+			ROS_INFO_STREAM("Variables packets take " << load << " of " << budget << " bytes/s of the link");
+	}
+
+	// report back what is in effect
+	config.packet_rate_rcdata_status_motors = rc_status_rate_;
+	config.packet_rate_gps = gps_rate_;
+	config.packet_rate_imu_mag = imu_rate_;
+	config.packet_rate_laser_mag = laser_rate_;
+	config.aci_engine_throttle = aci_rate_;
 }
 
 void AciRemote::setupCmdPackets() {
@@ -478,55 +855,57 @@ void AciRemote::setupCmdPackets() {
 	// along with configuration to whether or not receive ACK
 
 	// packet ID 0 containing: control mode
-	aciAddContentToCmdPacket(0, 0x0600, &WO_SDK_.ctrl_mode);
-	aciAddContentToCmdPacket(0, 0x0601, &WO_SDK_.ctrl_enabled);
-	aciAddContentToCmdPacket(0, 0x0602, &WO_SDK_.disable_motor_onoff_by_stick);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 0, 0x0600, &WO_SDK_.ctrl_mode);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 0, 0x0601, &WO_SDK_.ctrl_enabled);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 0, 0x0602, &WO_SDK_.disable_motor_onoff_by_stick);
 
-	aciAddContentToCmdPacket(0, 0x0500, &WO_DIMC_.motor[0]);
-	aciAddContentToCmdPacket(0, 0x0501, &WO_DIMC_.motor[1]);
-	aciAddContentToCmdPacket(0, 0x0502, &WO_DIMC_.motor[2]);
-	aciAddContentToCmdPacket(0, 0x0503, &WO_DIMC_.motor[3]);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 0, 0x0500, &WO_DIMC_.motor[0]);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 0, 0x0501, &WO_DIMC_.motor[1]);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 0, 0x0502, &WO_DIMC_.motor[2]);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 0, 0x0503, &WO_DIMC_.motor[3]);
 
 	// packet ID 1 containing: CTRL -- DMC not used here
-	aciAddContentToCmdPacket(1, 0x050A, &WO_CTRL_.pitch);
-	aciAddContentToCmdPacket(1, 0x050B, &WO_CTRL_.roll);
-	aciAddContentToCmdPacket(1, 0x050C, &WO_CTRL_.yaw);
-	aciAddContentToCmdPacket(1, 0x050D, &WO_CTRL_.thrust);
-	aciAddContentToCmdPacket(1, 0x050E, &WO_CTRL_.ctrl);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 1, 0x050A, &WO_CTRL_.pitch);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 1, 0x050B, &WO_CTRL_.roll);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 1, 0x050C, &WO_CTRL_.yaw);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 1, 0x050D, &WO_CTRL_.thrust);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 1, 0x050E, &WO_CTRL_.ctrl);
 
 	// packet ID 2 containing: single waypoint data structure
-	aciAddContentToCmdPacket(2, 0x1001, &WO_wpToLL_.wp_activated);
-	aciAddContentToCmdPacket(2, 0x1002, &WO_wpToLL_.properties);
-	aciAddContentToCmdPacket(2, 0x1003, &WO_wpToLL_.max_speed);
-	aciAddContentToCmdPacket(2, 0x1004, &WO_wpToLL_.time);
-	aciAddContentToCmdPacket(2, 0x1005, &WO_wpToLL_.pos_acc);
-	aciAddContentToCmdPacket(2, 0x1006, &WO_wpToLL_.chksum);
-	aciAddContentToCmdPacket(2, 0x1007, &WO_wpToLL_.X);
-	aciAddContentToCmdPacket(2, 0x1008, &WO_wpToLL_.Y);
-	aciAddContentToCmdPacket(2, 0x1009, &WO_wpToLL_.yaw);
-	aciAddContentToCmdPacket(2, 0x100A, &WO_wpToLL_.height);
-	aciAddContentToCmdPacket(2, 0x100B, &wpCtrlWpCmd_);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 2, 0x1001, &WO_wpToLL_.wp_activated);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 2, 0x1002, &WO_wpToLL_.properties);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 2, 0x1003, &WO_wpToLL_.max_speed);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 2, 0x1004, &WO_wpToLL_.time);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 2, 0x1005, &WO_wpToLL_.pos_acc);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 2, 0x1006, &WO_wpToLL_.chksum);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 2, 0x1007, &WO_wpToLL_.X);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 2, 0x1008, &WO_wpToLL_.Y);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 2, 0x1009, &WO_wpToLL_.yaw);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 2, 0x100A, &WO_wpToLL_.height);
+	aciCtxAddContentToCmdPacket(aci_ctx_, 2, 0x100B, &wpCtrlWpCmd_);
 
 	// set whether or not should receive ACK, and send configuration
-	aciSendCommandPacketConfiguration(0, 1); // control mode must be set with ACK
-	aciSendCommandPacketConfiguration(1, 0);
-	aciSendCommandPacketConfiguration(2, 1); // waypoint should be set with ACK as well
+	aciCtxSendCommandPacketConfiguration(aci_ctx_, 0, 1); // control mode must be set with ACK
+	aciCtxSendCommandPacketConfiguration(aci_ctx_, 1, 0);
+	aciCtxSendCommandPacketConfiguration(aci_ctx_, 2, 1); // waypoint should be set with ACK as well
 
 	// send commands to HLP (DANGER: make sure data structures were properly initialised)
-	//aciUpdateCmdPacket(0);
-	//aciUpdateCmdPacket(1);
-	//aciUpdateCmdPacket(2);
+	//aciCtxUpdateCmdPacket(aci_ctx_, 0);
+	//aciCtxUpdateCmdPacket(aci_ctx_, 1);
+	//aciCtxUpdateCmdPacket(aci_ctx_, 2);
 
 	ROS_INFO_STREAM("Commands packets configured");
 
 	boost::mutex::scoped_lock lock(mtx_);
 	cmd_list_recv_ = true;
+	config_cond_.notify_all();
 }
 
 void AciRemote::setupParPackets() {
 	ROS_INFO("Received parameters list from HLP");
 	boost::mutex::scoped_lock lock(mtx_);
 	par_list_recv_ = true;
+	config_cond_.notify_all();
 }
 
 
@@ -535,53 +914,166 @@ void AciRemote::setupParPackets() {
 //	Private member functions
 //-------------------------------------------------------
 
-void AciRemote::transmit(void* bytes, unsigned short len) {
-	AciRemote* this_obj = static_cast<AciRemote*>(aci_obj_ptr);
-	this_obj->doWrite(bytes, len);
+void AciRemote::transmit(void* user_data, const struct ACI_TX_SEGMENT* segments, unsigned char count) {
+	AciRemote* this_obj = static_cast<AciRemote*>(user_data);
+	boost::asio::const_buffer bufs[ACI_TX_MAX_SEGMENTS];
+	for (unsigned char i = 0; i < count; ++i)
+		bufs[i] = boost::asio::const_buffer(segments[i].data, segments[i].length);
+	this_obj->doWrite(bufs, count);
 }
 
-void AciRemote::versions(struct ACI_INFO aciInfo) {
-	AciRemote* this_obj = static_cast<AciRemote*>(aci_obj_ptr);
+void AciRemote::versions(void* user_data, struct ACI_INFO aciInfo) {
+	AciRemote* this_obj = static_cast<AciRemote*>(user_data);
 	this_obj->checkVersions(aciInfo);
 }
 
-void AciRemote::varListUpdateFinished() {
-	AciRemote* this_obj = static_cast<AciRemote*>(aci_obj_ptr);
+void AciRemote::baudRateReply(void* user_data, unsigned int baud_rate, unsigned char status) {
+	AciRemote* this_obj = static_cast<AciRemote*>(user_data);
+	boost::mutex::scoped_lock lock(this_obj->baud_mtx_);
+	this_obj->baud_reply_rate_ = baud_rate;
+	this_obj->baud_reply_status_ = status;
+}
+
+int AciRemote::readTableCache(void* user_data, void* data, int bytes) {
+	AciRemote* this_obj = static_cast<AciRemote*>(user_data);
+	return this_obj->table_cache_.read(data, bytes);
+}
+
+int AciRemote::writeTableCache(void* user_data, void* data, int bytes) {
+	AciRemote* this_obj = static_cast<AciRemote*>(user_data);
+	return this_obj->table_cache_.write(data, bytes);
+}
+
+void AciRemote::resetTableCache(void* user_data) {
+	AciRemote* this_obj = static_cast<AciRemote*>(user_data);
+	this_obj->table_cache_.reset();
+}
+
+void AciRemote::varPacketReceived(void* user_data, unsigned char packet, double) {
+	AciRemote* this_obj = static_cast<AciRemote*>(user_data);
+	this_obj->packetReceived(packet);
+}
+
+void AciRemote::cmdAck(void* user_data, unsigned char packet) {
+	AciRemote* this_obj = static_cast<AciRemote*>(user_data);
+	this_obj->cmdAcked(packet);
+}
+
+void AciRemote::varListUpdateFinished(void* user_data) {
+	AciRemote* this_obj = static_cast<AciRemote*>(user_data);
 	this_obj->setupVarPackets();
 }
 
-void AciRemote::cmdListUpdateFinished() {
-	AciRemote* this_obj = static_cast<AciRemote*>(aci_obj_ptr);
+void AciRemote::cmdListUpdateFinished(void* user_data) {
+	AciRemote* this_obj = static_cast<AciRemote*>(user_data);
 	this_obj->setupCmdPackets();
 }
 
-void AciRemote::paramListUpdateFinished() {
-	AciRemote* this_obj = static_cast<AciRemote*>(aci_obj_ptr);
+void AciRemote::paramListUpdateFinished(void* user_data) {
+	AciRemote* this_obj = static_cast<AciRemote*>(user_data);
 	this_obj->setupParPackets();
 }
 
 void AciRemote::readHandler(const boost::system::error_code& error,
-		size_t bytes_transferred) {
+		const unsigned char* bytes, size_t bytes_transferred, double rx_time, double byte_time) {
 	if (!error) {
-		// the read_buffer_ should have some data from initial/previous call to
-		// async_read_some ( doRead() ), thus feed ACI Engine with received data
-		boost::unique_lock<boost::mutex> lock(buf_mtx_);
-		for (std::vector<unsigned char>::iterator it = read_buffer_.begin();
-				it != (read_buffer_.begin() + bytes_transferred); ++it) {
-			aciReceiveHandler(*it);
-		}
-		lock.unlock();
-		// carry on reading more data into the buffer...
-		doRead();
+		// feed ACI Engine with received data, SerialComm is already
+		// reading more data into its other buffer. Every var packet keeps
+		// the time its last byte arrived. In reactor mode no other thread
+		// uses the context meanwhile
+		boost::unique_lock<boost::mutex> lock(buf_mtx_, boost::defer_lock);
+		if (!reactor_)
+			lock.lock();
+		aciCtxReceiveBufferTimed(aci_ctx_, bytes, bytes_transferred, rx_time, byte_time);
+		last_rx_ = ros::WallTime::now();
+		bytes_recv_ += bytes_transferred;
 	}
 	else {
-		ROS_ERROR_STREAM("Async read to serial port " << port_name_ << ". " << error.message());
+		ROS_ERROR_STREAM("Async read to serial port " << linkName() << ". " << error.message());
 		if (isOpen()) {
 			doClose();
 		}
 	}
 }
 
+ros::Time AciRemote::rxStamp(double rx_time) const {
+	ros::Time now(ros::Time::now());
+	if (rx_time <= 0)
+		return now;
+	// the monotonic clock does not jump, only its age of rx_time is applied to ROS time
+	double age = monotonicNow() - rx_time;
+	return age > 0 ? now - ros::Duration(age) : now;
+}
+
+void AciRemote::switchBaudRate() {
+	{
+		// openPort always starts at baud_rate_
+		boost::mutex::scoped_lock lock(baud_mtx_);
+		line_baud_ = baud_rate_;
+	}
+	if (baud_target_ <= 0 || baud_target_ == baud_rate_)
+		return;
+	if (transport_type_ != "serial") {
+		ROS_INFO_STREAM("Keeping the rate of the " << transport_type_ << " transport");
+		return;
+	}
+	if (!(aciCtxGetInfo(aci_ctx_).flags & ACI_INFO_FLAG_BAUDRATE_SWITCH)) {
+		ROS_WARN_STREAM("HLP cannot switch to " << baud_target_ << " baud, staying at " << baud_rate_);
+		return;
+	}
+
+	{
+		boost::mutex::scoped_lock lock(baud_mtx_);
+		baud_reply_status_ = 0;
+	}
+	{
+		AciLock lock(this);
+		aciCtxRequestBaudRate(aci_ctx_, baud_target_);
+	}
+	unsigned char status = waitBaudRateReply(ACI_BAUDRATE_SWITCHING, baud_switch_timeout_);
+	if (status != ACI_BAUDRATE_SWITCHING) {
+		ROS_WARN_STREAM("HLP " << (status ? "does not support " : "did not answer request for ")
+				<< baud_target_ << " baud, staying at " << baud_rate_);
+		return;
+	}
+
+	// the HLP switches right after its reply, follow it and confirm on the new rate
+	if (!setBaudRate(baud_target_))
+		return;
+	ros::WallTime deadline = ros::WallTime::now() + ros::WallDuration(baud_switch_timeout_);
+	while (ros::WallTime::now() < deadline) {
+		{
+			AciLock lock(this);
+			aciCtxConfirmBaudRate(aci_ctx_, baud_target_);
+		}
+		if (waitBaudRateReply(ACI_BAUDRATE_CONFIRMED, 0.1) == ACI_BAUDRATE_CONFIRMED) {
+			ROS_INFO_STREAM("HLP switched to " << baud_target_ << " baud");
+			boost::mutex::scoped_lock lock(baud_mtx_);
+			line_baud_ = baud_target_;
+			return;
+		}
+	}
+
+	// the HLP falls back on its own, once it misses the confirmation
+	ROS_WARN_STREAM("HLP did not confirm " << baud_target_ << " baud, going back to " << baud_rate_);
+	setBaudRate(baud_rate_);
+}
+
+unsigned char AciRemote::waitBaudRateReply(unsigned char status, double timeout) {
+	ros::WallTime deadline = ros::WallTime::now() + ros::WallDuration(timeout);
+	for (;;) {
+		{
+			boost::mutex::scoped_lock lock(baud_mtx_);
+			if (baud_reply_status_ && baud_reply_rate_ == static_cast<unsigned int>(baud_target_)
+					&& (baud_reply_status_ == status || baud_reply_status_ == ACI_BAUDRATE_UNSUPPORTED))
+				return baud_reply_status_;
+		}
+		if (ros::WallTime::now() >= deadline)
+			return 0;
+		boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+	}
+}
+
 void AciRemote::throttleEngine() {
 	ROS_INFO_STREAM("ACI Engine thread throttling at " << aci_rate_ << " Hz");
 	// throttle ACI Engine at aci_rate_ Hz
@@ -591,6 +1083,8 @@ void AciRemote::throttleEngine() {
 		for (;;) {
 			boost::system_time const throttle_timeout =
 					boost::get_system_time() + boost::posix_time::milliseconds(aci_throttle);
+			// the same deadline on a clock which does not jump
+			double deadline = monotonicNow() + aci_throttle * 1e-3;
 
 			boost::unique_lock<boost::mutex> u_lock(buf_mtx_);
 
@@ -599,16 +1093,22 @@ void AciRemote::throttleEngine() {
 				if (must_stop_engine_)
 					return;
 
+				double now = monotonicNow();
+				double lateness = std::max(now - deadline, 0.0);
+				engine_jitter_.add(lateness);
+				engineTicked(lateness);
+				engine_jitter_.report("ACI Engine jitter", now, jitter_report_period_);
+
 				boost::unique_lock<boost::mutex> ctrl_lock(ctrl_mtx_);
-				// throttle ACI Engine
-				aciEngine();
+				// throttle ACI Engine, everything it sends in one call goes out in one write
+				holdWrites();
+				aciCtxEngine(aci_ctx_);
+				releaseWrites();
+				// ratesReconfigured changes it under an AciLock
+				aci_throttle = 1000 / aci_rate_;
 				ctrl_lock.unlock();
-
-				// lock shared mutex: get upgradable then exclusive access
-				boost::upgrade_lock<boost::shared_mutex> up_lock(shared_mtx_);
-				boost::upgrade_to_unique_lock<boost::shared_mutex> un_lock(up_lock);
-				// synchronise variables
-				aciSynchronizeVars();
+				// no need to synchronise variables: readers take snapshots of the
+				// received packets with snapshot() and never block the engine
 			}
 		}
 	}
@@ -617,287 +1117,699 @@ void AciRemote::throttleEngine() {
 	}
 }
 
-void AciRemote::publishImuMagData() {
-	sensor_msgs::ImuPtr imu_msg(new sensor_msgs::Imu);
-	asctec_hlp_comm::mav_imuPtr imu_custom_msg(new asctec_hlp_comm::mav_imu);
-	geometry_msgs::Vector3StampedPtr mag_msg(new geometry_msgs::Vector3Stamped);
-	imu_msg->header.frame_id = frame_id_;
-	imu_custom_msg->header.frame_id = frame_id_;
-	mag_msg->header.frame_id = frame_id_;
-	int imu_throttle = 1000 / imu_rate_;
-	static int seq[] = {0, 0, 0};
-	try {
-		for (;;) {
-			boost::system_time const imu_timeout =
-					boost::get_system_time() + boost::posix_time::milliseconds(imu_throttle);
-			// acquire multiple reader shared lock
-			boost::shared_lock<boost::shared_mutex> s_lock(shared_mtx_);
+void AciRemote::startReactor() {
+	// closePort cancelled the timer, it starts over with the new link
+	io_service_.post(boost::bind(&AciRemote::reactorTick, this, boost::system::error_code()));
+}
 
-			if (cond_any_.timed_wait(s_lock, imu_timeout) == false) {
-				// check whether thread should terminate (::interrupt() appears to have no effect)
-				if (must_stop_pub_)
-					return;
-				// TODO: implement flag to put thread into idle mode to save computational resources
-
-				ros::Time time_stamp(ros::Time::now());
-				double roll = helper::asctecAttitudeToSI(RO_ALL_Data_.angle_roll);
-				double pitch = helper::asctecAttitudeToSI(RO_ALL_Data_.angle_pitch);
-				double yaw = helper::asctecAttitudeToSI(RO_ALL_Data_.angle_yaw);
-				if (yaw> M_PI) {
-					yaw -= 2.0 * M_PI;
-				}
-				geometry_msgs::Quaternion q;
-				helper::angle2quaternion(roll, pitch, yaw, &q.w, &q.x, &q.y, &q.z);
-
-				// only publish if someone has already subscribed to topics
-				if (imu_pub_.getNumSubscribers() > 0) {
-					imu_msg->header.stamp = time_stamp;
-					imu_msg->header.seq = seq[0];
-					seq[0]++;
-					imu_msg->linear_acceleration.x = helper::asctecAccToSI(RO_ALL_Data_.acc_x);
-					imu_msg->linear_acceleration.y = helper::asctecAccToSI(RO_ALL_Data_.acc_y);
-					imu_msg->linear_acceleration.z = helper::asctecAccToSI(RO_ALL_Data_.acc_z);
-					imu_msg->angular_velocity.x = helper::asctecAccToSI(RO_ALL_Data_.angle_roll);
-					imu_msg->angular_velocity.y = helper::asctecAccToSI(RO_ALL_Data_.angle_pitch);
-					imu_msg->angular_velocity.z = helper::asctecAccToSI(RO_ALL_Data_.angle_yaw);
-					imu_msg->orientation = q;
-					helper::setDiagonalCovariance(imu_msg->angular_velocity_covariance,
-							ang_vel_variance_);
-					helper::setDiagonalCovariance(imu_msg->linear_acceleration_covariance,
-							lin_acc_variance_);
-					imu_pub_.publish(imu_msg);
-				}
-				if (imu_custom_pub_.getNumSubscribers() > 0) {
-					double height = static_cast<double>(RO_ALL_Data_.fusion_height) * 0.001;
-					double dheight = static_cast<double>(RO_ALL_Data_.fusion_dheight) * 0.001;
-					imu_custom_msg->header.stamp = time_stamp;
-					imu_custom_msg->header.seq = seq[1];
-					seq[1]++;
-					imu_custom_msg->acceleration.x = helper::asctecAccToSI(RO_ALL_Data_.acc_x);
-					imu_custom_msg->acceleration.y = helper::asctecAccToSI(RO_ALL_Data_.acc_y);
-					imu_custom_msg->acceleration.z = helper::asctecAccToSI(RO_ALL_Data_.acc_z);
-					imu_custom_msg->angular_velocity.x =
-							helper::asctecAccToSI(RO_ALL_Data_.angle_roll);
-					imu_custom_msg->angular_velocity.y =
-							helper::asctecAccToSI(RO_ALL_Data_.angle_pitch);
-					imu_custom_msg->angular_velocity.z =
-							helper::asctecAccToSI(RO_ALL_Data_.angle_yaw);
-					imu_custom_msg->height = height;
-					imu_custom_msg->differential_height = dheight;
-					imu_custom_msg->orientation = q;
-					imu_custom_pub_.publish(imu_custom_msg);
-				}
-				if (mag_pub_.getNumSubscribers() > 0) {
-					mag_msg->header.stamp = time_stamp;
-					mag_msg->header.seq = seq[2];
-					seq[2]++;
-					mag_msg->vector.x = static_cast<double>(RO_ALL_Data_.Hx);
-					mag_msg->vector.y = static_cast<double>(RO_ALL_Data_.Hy);
-					mag_msg->vector.z = static_cast<double>(RO_ALL_Data_.Hz);
-					mag_pub_.publish(mag_msg);
-				}
+void AciRemote::reactorTick(const boost::system::error_code& error) {
+	// cancelled by linkClosed
+	if (error)
+		return;
+
+	boost::chrono::steady_clock::time_point now = boost::chrono::steady_clock::now();
+	if (reactor_timer_.expires_at() + boost::chrono::seconds(1) < now) {
+		// first tick or way behind, do not catch up
+		reactor_timer_.expires_at(now);
+	}
+	else {
+		double lateness = boost::chrono::duration<double>(now - reactor_timer_.expires_at()).count();
+		engine_jitter_.add(lateness);
+		engineTicked(lateness);
+		engine_jitter_.report("ACI Engine jitter", monotonicNow(), jitter_report_period_);
+	}
+
+	holdWrites();
+	aciCtxEngine(aci_ctx_);
+	releaseWrites();
+
+	// the publishers run in readHandler, as packets arrive
+	if (link_up_ && reconnect_enabled_ && reconnect_rx_timeout_ > 0 && !link_lost_) {
+		double silence = (ros::WallTime::now() - last_rx_).toSec();
+		if (silence > reconnect_rx_timeout_) {
+			ROS_WARN_STREAM("Nothing received from HLP for " << silence << " s");
+			link_lost_ = true;
+		}
+	}
+
+	reactor_timer_.expires_at(reactor_timer_.expires_at() + boost::chrono::microseconds(1000000 / aci_rate_));
+	reactor_timer_.async_wait(TickOp(this));
+}
+
+void AciRemote::pauseReactor() {
+	boost::unique_lock<boost::mutex> lock(reactor_mtx_);
+	reactor_state_ = REACTOR_PAUSE_REQUESTED;
+	io_service_.post(boost::bind(&AciRemote::reactorPaused, this));
+	while (reactor_state_ == REACTOR_PAUSE_REQUESTED) {
+		// nobody runs the io_service once it ran out of work, the context is ours then
+		if (!reactor_cond_.timed_wait(lock, boost::posix_time::milliseconds(10)) && io_service_.stopped())
+			break;
+	}
+}
+
+void AciRemote::resumeReactor() {
+	boost::unique_lock<boost::mutex> lock(reactor_mtx_);
+	reactor_state_ = REACTOR_RUNNING;
+	reactor_cond_.notify_all();
+}
+
+void AciRemote::reactorPaused() {
+	boost::unique_lock<boost::mutex> lock(reactor_mtx_);
+	// left over from a pause, which did not wait for the IO thread
+	if (reactor_state_ != REACTOR_PAUSE_REQUESTED)
+		return;
+	reactor_state_ = REACTOR_PAUSED;
+	reactor_cond_.notify_all();
+	while (reactor_state_ == REACTOR_PAUSED)
+		reactor_cond_.wait(lock);
+}
+
+void AciRemote::setLinkUp(bool up) {
+	// the IO thread reads link_up_ without lock in reactor mode
+	AciLock aci_lock(this);
+	boost::unique_lock<boost::shared_mutex> lock(link_mtx_);
+	link_up_ = up;
+}
+
+void AciRemote::linkClosed() {
+	// let closePort join the IO thread
+	if (reactor_)
+		reactor_timer_.cancel();
+}
+
+void AciRemote::reportLoad(const ros::WallTimerEvent&) {
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) < 0)
+		return;
+	ros::WallTime now = ros::WallTime::now();
+	double cpu = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6
+			+ usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+	// every time a thread blocks or is preempted, i.e. about one per wakeup
+	long switches = usage.ru_nvcsw + usage.ru_nivcsw;
+	if (!load_time_.isZero()) {
+		double period = (now - load_time_).toSec();
+		ROS_INFO_STREAM((reactor_ ? "Reactor" : "Threaded") << " mode: CPU "
+				<< 100.0 * (cpu - load_cpu_) / period << " %, "
+				<< (switches - load_switches_) / period << " context switches/s");
+	}
+	load_time_ = now;
+	load_cpu_ = cpu;
+	load_switches_ = switches;
+}
+
+void AciRemote::updateDiagnostics(const ros::WallTimerEvent&) {
+	struct ACI_LINK_STATS stats;
+	unsigned long rx_bytes;
+	{
+		boost::unique_lock<boost::mutex> buf_lock(buf_mtx_);
+		AciLock aci_lock(this);
+		aciCtxGetLinkStats(aci_ctx_, &stats);
+		rx_bytes = bytes_recv_;
+		const int rates[ACI_REMOTE_VAR_PACKETS] = { rc_status_rate_, gps_rate_, imu_rate_, laser_rate_ };
+		for (unsigned char i = 0; i < ACI_REMOTE_VAR_PACKETS; ++i)
+			diag_packet_rates_[i] = i <= laser_packet_ && aciCtxGetVarPacketLength(aci_ctx_, i) ? rates[i] : 0;
+	}
+	unsigned long tx_bytes = writeStats().bytes;
+	{
+		boost::mutex::scoped_lock lock(diag_mtx_);
+		diag_engine_ = engine_lateness_;
+		diag_cmd_ack_ = cmd_ack_latency_;
+		engine_lateness_ = LatencyStats();
+		cmd_ack_latency_ = LatencyStats();
+	}
+
+	// the first update only takes the counters to start from
+	double now = monotonicNow();
+	diag_interval_ = diag_time_ > 0 ? now - diag_time_ : 0;
+	diag_delta_ = linkStatsSince(stats, diag_stats_);
+	if (diag_interval_ > 0) {
+		diag_rx_rate_ = (rx_bytes - diag_rx_bytes_) / diag_interval_;
+		diag_tx_rate_ = (tx_bytes - diag_tx_bytes_) / diag_interval_;
+	}
+	diag_stats_ = stats;
+	diag_rx_bytes_ = rx_bytes;
+	diag_tx_bytes_ = tx_bytes;
+	diag_time_ = now;
+
+	diag_updater_->force_update();
+}
+
+void AciRemote::linkDiagnostics(diagnostic_updater::DiagnosticStatusWrapper& stat) {
+	bool up;
+	{
+		boost::shared_lock<boost::shared_mutex> lock(link_mtx_);
+		up = link_up_;
+	}
+	if (up)
+		stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "Link to HLP up");
+	else
+		stat.summary(diagnostic_msgs::DiagnosticStatus::ERROR, "Link to HLP down");
+
+	stat.add("Interval [s]", diag_interval_);
+	stat.add("Bytes received/s", diag_rx_rate_);
+	stat.add("Bytes sent/s", diag_tx_rate_);
+	double capacity = lineCapacity();
+	if (capacity > 0) {
+		stat.add("Baud rate", capacity * 10);
+		stat.addf("Receive utilization", "%.1f %%", 100 * diag_rx_rate_ / capacity);
+		stat.addf("Send utilization", "%.1f %%", 100 * diag_tx_rate_ / capacity);
+		if (diag_rx_rate_ > linkBudget())
+			stat.mergeSummary(diagnostic_msgs::DiagnosticStatus::WARN, "HLP sends close to the baud rate");
+	}
+
+	unsigned long config_resends = diag_delta_.varConfigResends + diag_delta_.cmdConfigResends
+			+ diag_delta_.paramConfigResends;
+	stat.add("Frames received", diag_delta_.framesReceived);
+	stat.add("CRC failures", diag_delta_.crcErrors);
+	stat.add("Packet configurations sent again", config_resends);
+	stat.add("Commands sent again", diag_delta_.cmdPacketResends);
+	stat.add("Commands acknowledged", diag_cmd_ack_.count);
+	stat.addf("Command ACK latency mean", "%.1f ms", diag_cmd_ack_.mean() * 1e3);
+	stat.addf("Command ACK latency max", "%.1f ms", diag_cmd_ack_.max * 1e3);
+	if (diag_delta_.crcErrors > 0)
+		stat.mergeSummary(diagnostic_msgs::DiagnosticStatus::WARN, "CRC failures");
+	if (config_resends > 0 || diag_delta_.cmdPacketResends > 0)
+		stat.mergeSummary(diagnostic_msgs::DiagnosticStatus::WARN, "HLP did not acknowledge packets");
+}
+
+void AciRemote::packetDiagnostics(diagnostic_updater::DiagnosticStatusWrapper& stat) {
+	stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "Variables packets arrive");
+	for (int i = 0; i < ACI_REMOTE_VAR_PACKETS; ++i) {
+		// empty packets are not sent
+		if (diag_packet_rates_[i] == 0)
+			continue;
+		std::ostringstream name;
+		name << "Packet " << i;
+		double rate = diag_interval_ > 0 ? diag_delta_.varPacketsReceived[i] / diag_interval_ : 0;
+		stat.addf(name.str() + " rate", "%.1f Hz of %d Hz", rate, diag_packet_rates_[i]);
+		stat.add(name.str() + " magic code mismatches", diag_delta_.varPacketsInvalid[i]);
+		if (diag_interval_ > 0 && diag_delta_.varPacketsReceived[i] == 0)
+			stat.mergeSummary(diagnostic_msgs::DiagnosticStatus::WARN, name.str() + " not received");
+		if (diag_delta_.varPacketsInvalid[i] > 0)
+			stat.mergeSummary(diagnostic_msgs::DiagnosticStatus::WARN, name.str() + " does not match its configuration");
+	}
+}
+
+void AciRemote::engineDiagnostics(diagnostic_updater::DiagnosticStatusWrapper& stat) {
+	double period = 1.0 / aci_rate_;
+	if (diag_engine_.max > period)
+		stat.summary(diagnostic_msgs::DiagnosticStatus::WARN, "ACI Engine ran more than one period late");
+	else
+		stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "ACI Engine on time");
+
+	stat.add("Mode", reactor_ ? "reactor" : "threaded");
+	stat.add("Throttle [Hz]", aci_rate_);
+	stat.add("Ticks", diag_engine_.count);
+	stat.addf("Lateness mean", "%.3f ms", diag_engine_.mean() * 1e3);
+	stat.addf("Lateness max", "%.3f ms", diag_engine_.max * 1e3);
+}
+
+void AciRemote::engineTicked(double lateness) {
+	boost::mutex::scoped_lock lock(diag_mtx_);
+	engine_lateness_.add(lateness);
+}
+
+void AciRemote::updateCmdPacket(unsigned char packet) {
+	aciCtxUpdateCmdPacket(aci_ctx_, packet);
+	// updates before the ACK are sent along with the pending one
+	boost::mutex::scoped_lock lock(diag_mtx_);
+	if (packet < ACI_REMOTE_CMD_PACKETS && cmd_sent_[packet] == 0)
+		cmd_sent_[packet] = monotonicNow();
+}
+
+void AciRemote::cmdAcked(unsigned char packet) {
+	boost::mutex::scoped_lock lock(diag_mtx_);
+	if (packet >= ACI_REMOTE_CMD_PACKETS || cmd_sent_[packet] == 0)
+		return;
+	cmd_ack_latency_.add(monotonicNow() - cmd_sent_[packet]);
+	cmd_sent_[packet] = 0;
+}
+
+void AciRemote::connectionLost() {
+	// called from the IO thread, which must not wait for the port to close
+	link_lost_ = true;
+}
+
+void AciRemote::superviseLink() {
+	for (;;) {
+		boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+		if (must_stop_link_)
+			return;
+
+		bool lost = link_lost_;
+		// the reactor watches for silence itself
+		if (!lost && !reactor_ && reconnect_rx_timeout_ > 0) {
+			boost::unique_lock<boost::mutex> lock(buf_mtx_);
+			double silence = (ros::WallTime::now() - last_rx_).toSec();
+			lock.unlock();
+			if (silence > reconnect_rx_timeout_) {
+				ROS_WARN_STREAM("Nothing received from HLP for " << silence << " s");
+				lost = true;
 			}
 		}
+		if (lost)
+			reconnect();
+	}
+}
+
+void AciRemote::reconnect() {
+	ros::WallTime start = ros::WallTime::now();
+	// publishers and services stop reading the ACI context
+	setLinkUp(false);
+	ROS_WARN_STREAM("Lost link to HLP on " << linkName() << ", reconnecting");
+
+	double delay = reconnect_delay_min_;
+	int attempts = 0;
+	for (;;) {
+		++attempts;
+		closePort();
+		link_lost_ = false;
+		bool open = openPort() == 0;
+		if (open && reactor_)
+			startReactor();
+		if (open && restartAci()) {
+			switchBaudRate();
+			break;
+		}
+
+		ROS_WARN_STREAM("Reconnection attempt " << attempts << " to HLP failed, retrying in "
+				<< delay << " s");
+		for (double slept = 0; slept < delay; slept += 0.1) {
+			if (must_stop_link_)
+				return;
+			boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+		}
+		delay = std::min(delay * 2, reconnect_delay_max_);
+	}
+
+	setLinkUp(true);
+	updateVarPackets();
+	ROS_INFO_STREAM("Reconnected to HLP after " << attempts << " attempts in "
+			<< (ros::WallTime::now() - start).toSec() << " s");
+}
+
+bool AciRemote::restartAci() {
+	{
+		boost::mutex::scoped_lock lock(mtx_);
+		versions_match_ = false;
+		var_list_recv_ = false;
+		cmd_list_recv_ = false;
+		par_list_recv_ = false;
+	}
+	{
+		// the ACI Engine must not run on a context being reinitialised
+		boost::unique_lock<boost::mutex> buf_lock(buf_mtx_);
+		AciLock aci_lock(this);
+		last_rx_ = ros::WallTime::now();
+		startAci();
+	}
+
+	// the tables come from the cache if the HLP did not change, wait for the packets
+	return waitForConfiguration(reconnect_config_timeout_);
+}
+
+bool AciRemote::waitForConfiguration(double timeout) {
+	boost::system_time deadline = boost::get_system_time()
+			+ boost::posix_time::milliseconds(static_cast<long>(timeout * 1000));
+	boost::unique_lock<boost::mutex> lock(mtx_);
+	while (!(versions_match_ && var_list_recv_ && cmd_list_recv_ && par_list_recv_)) {
+		if (must_stop_link_ || link_lost_)
+			return false;
+		boost::system_time now = boost::get_system_time();
+		if (now >= deadline) {
+			ROS_ERROR_STREAM("HLP did not send" << (versions_match_ ? "" : " matching versions")
+					<< (var_list_recv_ ? "" : " variables list") << (cmd_list_recv_ ? "" : " commands list")
+					<< (par_list_recv_ ? "" : " parameters list") << " within " << timeout << " s");
+			return false;
+		}
+		// wakes up now and then to notice a lost link
+		config_cond_.timed_wait(lock, std::min(deadline, now + boost::posix_time::milliseconds(50)));
+	}
+	return true;
+}
+
+void AciRemote::packetReceived(unsigned char packet) {
+	if (packet >= ACI_REMOTE_VAR_PACKETS)
+		return;
+	if (reactor_) {
+		// in the IO thread, the snapshot of packet is complete
+		if (packet == 0)
+			publishStatusMotorsRc();
+		else if (packet == 1)
+			publishGps();
+		else if (packet == 2)
+			publishImuMag();
+		if (packet == laser_packet_)
+			publishLaser();
+		return;
+	}
+	double start = monotonicNow();
+	{
+		boost::unique_lock<boost::shared_mutex> lock(shared_mtx_);
+		++packet_count_[packet];
+	}
+	cond_any_.notify_all();
+	// the publishers only hold shared_mtx_ to check their packet counts
+	double now = monotonicNow();
+	notify_wait_.add(now - start);
+	notify_wait_.report("Packet notify lock wait", now, jitter_report_period_);
+}
+
+bool AciRemote::waitForPacket(unsigned char packet, unsigned long& seen) {
+	// acquire multiple reader shared lock
+	boost::shared_lock<boost::shared_mutex> s_lock(shared_mtx_);
+	while (!must_stop_pub_ && packet_count_[packet] == seen) {
+		// check whether thread should terminate now and then, not only when notified
+		cond_any_.timed_wait(s_lock, boost::get_system_time() + boost::posix_time::milliseconds(100));
+	}
+	// a publisher which fell behind publishes the latest packet only
+	seen = packet_count_[packet];
+	return !must_stop_pub_;
+}
+
+void AciRemote::recordPublishTiming(int publisher, double rx_time, double snapshot_time) {
+	static const char* latency_names[PUBLISHERS] = {
+		"Status publish latency", "GPS publish latency", "IMU publish latency", "Laser publish latency"
+	};
+	static const char* snapshot_names[PUBLISHERS] = {
+		"Status snapshot time", "GPS snapshot time", "IMU snapshot time", "Laser snapshot time"
+	};
+	double now = monotonicNow();
+	snapshot_time_[publisher].add(snapshot_time);
+	snapshot_time_[publisher].report(snapshot_names[publisher], now, jitter_report_period_);
+	if (rx_time <= 0)
+		return;
+	publish_latency_[publisher].add(now - rx_time);
+	publish_latency_[publisher].report(latency_names[publisher], now, jitter_report_period_);
+}
+
+void AciRemote::publishImuMag() {
+	// consistent copy of the received data, does not block the ACI Engine
+	// stamped with the arrival of packet 2, the IMU data
+	struct RO_ALL_DATA ro_all = RO_ALL_DATA();
+	ros::Time time_stamp;
+	double rx_time = 0;
+	double start = monotonicNow();
+	if (!snapshot(RO_ALL_Data_, ro_all, 2, time_stamp, &rx_time))
+		return;
+	double snapshot_time = monotonicNow() - start;
+	// no lock is held from here on, neither while converting nor while publishing
+	bool published = false;
+
+	double roll = helper::asctecAttitudeToSI(ro_all.angle_roll);
+	double pitch = helper::asctecAttitudeToSI(ro_all.angle_pitch);
+	double yaw = helper::asctecAttitudeToSI(ro_all.angle_yaw);
+	if (yaw> M_PI) {
+		yaw -= 2.0 * M_PI;
+	}
+	geometry_msgs::Quaternion q;
+	helper::angle2quaternion(roll, pitch, yaw, &q.w, &q.x, &q.y, &q.z);
+
+	// only publish if someone has already subscribed to topics
+	if (imu_pub_.getNumSubscribers() > 0) {
+		// a new message every time, subscribers in the same process (nodelets)
+		// keep the one they got without a copy
+		sensor_msgs::ImuPtr imu_msg(new sensor_msgs::Imu);
+		imu_msg->header.frame_id = frame_id_;
+		imu_msg->header.stamp = time_stamp;
+		imu_msg->header.seq = imu_seq_[0];
+		imu_seq_[0]++;
+		imu_msg->linear_acceleration.x = helper::asctecAccToSI(ro_all.acc_x);
+		imu_msg->linear_acceleration.y = helper::asctecAccToSI(ro_all.acc_y);
+		imu_msg->linear_acceleration.z = helper::asctecAccToSI(ro_all.acc_z);
+		imu_msg->angular_velocity.x = helper::asctecAccToSI(ro_all.angle_roll);
+		imu_msg->angular_velocity.y = helper::asctecAccToSI(ro_all.angle_pitch);
+		imu_msg->angular_velocity.z = helper::asctecAccToSI(ro_all.angle_yaw);
+		imu_msg->orientation = q;
+		helper::setDiagonalCovariance(imu_msg->angular_velocity_covariance,
+				ang_vel_variance_);
+		helper::setDiagonalCovariance(imu_msg->linear_acceleration_covariance,
+				lin_acc_variance_);
+		imu_pub_.publish(imu_msg);
+		published = true;
+	}
+	if (imu_custom_pub_.getNumSubscribers() > 0) {
+		asctec_hlp_comm::mav_imuPtr imu_custom_msg(new asctec_hlp_comm::mav_imu);
+		imu_custom_msg->header.frame_id = frame_id_;
+		double height = static_cast<double>(ro_all.fusion_height) * 0.001;
+		double dheight = static_cast<double>(ro_all.fusion_dheight) * 0.001;
+		imu_custom_msg->header.stamp = time_stamp;
+		imu_custom_msg->header.seq = imu_seq_[1];
+		imu_seq_[1]++;
+		imu_custom_msg->acceleration.x = helper::asctecAccToSI(ro_all.acc_x);
+		imu_custom_msg->acceleration.y = helper::asctecAccToSI(ro_all.acc_y);
+		imu_custom_msg->acceleration.z = helper::asctecAccToSI(ro_all.acc_z);
+		imu_custom_msg->angular_velocity.x =
+				helper::asctecAccToSI(ro_all.angle_roll);
+		imu_custom_msg->angular_velocity.y =
+				helper::asctecAccToSI(ro_all.angle_pitch);
+		imu_custom_msg->angular_velocity.z =
+				helper::asctecAccToSI(ro_all.angle_yaw);
+		imu_custom_msg->height = height;
+		imu_custom_msg->differential_height = dheight;
+		imu_custom_msg->orientation = q;
+		imu_custom_pub_.publish(imu_custom_msg);
+		published = true;
+	}
+	if (mag_pub_.getNumSubscribers() > 0) {
+		geometry_msgs::Vector3StampedPtr mag_msg(new geometry_msgs::Vector3Stamped);
+		mag_msg->header.frame_id = frame_id_;
+		mag_msg->header.stamp = time_stamp;
+		mag_msg->header.seq = imu_seq_[2];
+		imu_seq_[2]++;
+		mag_msg->vector.x = static_cast<double>(ro_all.Hx);
+		mag_msg->vector.y = static_cast<double>(ro_all.Hy);
+		mag_msg->vector.z = static_cast<double>(ro_all.Hz);
+		mag_pub_.publish(mag_msg);
+		published = true;
+	}
+	if (published)
+		recordPublishTiming(PUBLISHER_IMU, rx_time, snapshot_time);
+}
+
+void AciRemote::publishImuMagData() {
+	unsigned long seen = 0;
+	try {
+		// one message per packet, at the rate the HLP sends it
+		while (waitForPacket(2, seen))
+			publishImuMag();
 	}
 	catch (boost::thread_interrupted const&) {
 		ROS_INFO("publishImuMagData() thread interrupted");
 	}
 }
 
+void AciRemote::publishGps() {
+	// consistent copy of the received data, does not block the ACI Engine
+	// stamped with the arrival of packet 1, the GPS data
+	struct RO_ALL_DATA ro_all = RO_ALL_DATA();
+	ros::Time time_stamp;
+	double rx_time = 0;
+	double start = monotonicNow();
+	if (!snapshot(RO_ALL_Data_, ro_all, 1, time_stamp, &rx_time))
+		return;
+	double snapshot_time = monotonicNow() - start;
+	bool published = false;
+
+	// TODO: check covariance
+	double var_h, var_v;
+	var_h = static_cast<double>(ro_all.GPS_position_accuracy) * 1.0e-3 / 3.0;
+	var_v = static_cast<double>(ro_all.GPS_height_accuracy) * 1.0e-3 / 3.0;
+	var_h *= var_h;
+	var_v *= var_v;
+	// only publish if someone has already subscribed to topics
+	if (gps_pub_.getNumSubscribers() > 0) {
+		sensor_msgs::NavSatFixPtr gps_msg(new sensor_msgs::NavSatFix);
+		gps_msg->header.frame_id = frame_id_;
+		gps_msg->header.stamp = time_stamp;
+		gps_msg->header.seq = gps_seq_[0];
+		gps_seq_[0]++;
+		gps_msg->latitude = static_cast<double>(ro_all.GPS_latitude) * 1.0e-7;
+		gps_msg->longitude = static_cast<double>(ro_all.GPS_longitude) * 1.0e-7;
+		gps_msg->altitude = static_cast<double>(ro_all.GPS_height) * 1.0e-3;
+		gps_msg->position_covariance[0] = var_h;
+		gps_msg->position_covariance[4] = var_h;
+		gps_msg->position_covariance[8] = var_v;
+		gps_msg->position_covariance_type =
+				sensor_msgs::NavSatFix::COVARIANCE_TYPE_APPROXIMATED;
+
+		gps_msg->status.service = sensor_msgs::NavSatStatus::SERVICE_GPS;
+		// bit 0: GPS lock
+		if (ro_all.GPS_status & 0x01)
+			gps_msg->status.status =
+					sensor_msgs::NavSatStatus::STATUS_FIX;
+		else
+			gps_msg->status.status =
+					sensor_msgs::NavSatStatus::STATUS_NO_FIX;
+		gps_pub_.publish(gps_msg);
+		published = true;
+	}
+	if (gps_custom_pub_.getNumSubscribers() > 0) {
+		asctec_hlp_comm::GpsCustomPtr gps_custom_msg(new asctec_hlp_comm::GpsCustom);
+		gps_custom_msg->header.frame_id = frame_id_;
+		gps_custom_msg->header.stamp = time_stamp;
+		gps_custom_msg->header.seq = gps_seq_[1];
+		gps_seq_[1]++;
+		gps_custom_msg->latitude =
+				static_cast<double>(ro_all.fusion_latitude) * 1.0e-7;
+		gps_custom_msg->longitude =
+				static_cast<double>(ro_all.fusion_longitude) * 1.0e-7;
+		gps_custom_msg->altitude =
+				static_cast<double>(ro_all.GPS_height) * 1.0e-3;
+		gps_custom_msg->position_covariance[0] = var_h;
+		gps_custom_msg->position_covariance[4] = var_h;
+		gps_custom_msg->position_covariance[8] = var_v;
+		gps_custom_msg->position_covariance_type =
+				sensor_msgs::NavSatFix::COVARIANCE_TYPE_APPROXIMATED;
+		gps_custom_msg->velocity_x =
+				static_cast<double>(ro_all.GPS_speed_x) * 1.0e-3;
+		gps_custom_msg->velocity_y =
+				static_cast<double>(ro_all.GPS_speed_y) * 1.0e-3;
+		gps_custom_msg->pressure_height =
+				static_cast<double>(ro_all.fusion_height) * 1.0e-3;
+		// TODO: check covariance
+		double var_vel =
+				static_cast<double>(ro_all.GPS_speed_accuracy) * 1.0e-3 / 3.0;
+		var_vel *= var_vel;
+		gps_custom_msg->velocity_covariance[0] = var_vel;
+		gps_custom_msg->velocity_covariance[3] = var_vel;
+
+		gps_custom_msg->status.service = sensor_msgs::NavSatStatus::SERVICE_GPS;
+		// bit 0: GPS lock
+		if (ro_all.GPS_status & 0x01)
+			gps_custom_msg->status.status =
+					sensor_msgs::NavSatStatus::STATUS_FIX;
+		else
+			gps_custom_msg->status.status =
+					sensor_msgs::NavSatStatus::STATUS_NO_FIX;
+		gps_custom_pub_.publish(gps_custom_msg);
+		published = true;
+	}
+	if (published)
+		recordPublishTiming(PUBLISHER_GPS, rx_time, snapshot_time);
+}
+
 void AciRemote::publishGpsData() {
-	sensor_msgs::NavSatFixPtr gps_msg(new sensor_msgs::NavSatFix);
-	asctec_hlp_comm::GpsCustomPtr gps_custom_msg(new asctec_hlp_comm::GpsCustom);
-	gps_msg->header.frame_id = frame_id_;
-	gps_custom_msg->header.frame_id = frame_id_;
-	int gps_throttle = 1000 / gps_rate_;
-	static int seq[] = {0, 0};
+	unsigned long seen = 0;
 	try {
-		for (;;) {
-			boost::system_time const gps_timeout =
-					boost::get_system_time() + boost::posix_time::milliseconds(gps_throttle);
-			// acquire multiple reader shared lock
-			boost::shared_lock<boost::shared_mutex> s_lock(shared_mtx_);
+		// one message per packet, at the rate the HLP sends it
+		while (waitForPacket(1, seen))
+			publishGps();
+	}
+	catch (boost::thread_interrupted const&) {
+		ROS_INFO("publishGpsData() thread interrupted");
+	}
+}
 
-			if (cond_any_.timed_wait(s_lock, gps_timeout) == false) {
-				// check whether thread should terminate (::interrupt() appears to have no effect)
-				if (must_stop_pub_)
-					return;
-				// TODO: implement flag to put thread into idle mode to save computational resources
-
-				ros::Time time_stamp(ros::Time::now());
-				// TODO: check covariance
-				double var_h, var_v;
-				var_h = static_cast<double>(RO_ALL_Data_.GPS_position_accuracy) * 1.0e-3 / 3.0;
-				var_v = static_cast<double>(RO_ALL_Data_.GPS_height_accuracy) * 1.0e-3 / 3.0;
-				var_h *= var_h;
-				var_v *= var_v;
-				// only publish if someone has already subscribed to topics
-				if (gps_pub_.getNumSubscribers() > 0) {
-					gps_msg->header.stamp = time_stamp;
-					gps_msg->header.seq = seq[0];
-					seq[0]++;
-					gps_msg->latitude = static_cast<double>(RO_ALL_Data_.GPS_latitude) * 1.0e-7;
-					gps_msg->longitude = static_cast<double>(RO_ALL_Data_.GPS_longitude) * 1.0e-7;
-					gps_msg->altitude = static_cast<double>(RO_ALL_Data_.GPS_height) * 1.0e-3;
-					gps_msg->position_covariance[0] = var_h;
-					gps_msg->position_covariance[4] = var_h;
-					gps_msg->position_covariance[8] = var_v;
-					gps_msg->position_covariance_type =
-							sensor_msgs::NavSatFix::COVARIANCE_TYPE_APPROXIMATED;
-
-					gps_msg->status.service = sensor_msgs::NavSatStatus::SERVICE_GPS;
-					// bit 0: GPS lock
-					if (RO_ALL_Data_.GPS_status & 0x01)
-						gps_msg->status.status =
-								sensor_msgs::NavSatStatus::STATUS_FIX;
-					else
-						gps_msg->status.status =
-								sensor_msgs::NavSatStatus::STATUS_NO_FIX;
-					gps_pub_.publish(gps_msg);
-				}
-				if (gps_custom_pub_.getNumSubscribers() > 0) {
-					gps_custom_msg->header.stamp = time_stamp;
-					gps_custom_msg->header.seq = seq[1];
-					seq[1]++;
-					gps_custom_msg->latitude =
-							static_cast<double>(RO_ALL_Data_.fusion_latitude) * 1.0e-7;
-					gps_custom_msg->longitude =
-							static_cast<double>(RO_ALL_Data_.fusion_longitude) * 1.0e-7;
-					gps_custom_msg->altitude =
-							static_cast<double>(RO_ALL_Data_.GPS_height) * 1.0e-3;
-					gps_custom_msg->position_covariance[0] = var_h;
-					gps_custom_msg->position_covariance[4] = var_h;
-					gps_custom_msg->position_covariance[8] = var_v;
-					gps_custom_msg->position_covariance_type =
-							sensor_msgs::NavSatFix::COVARIANCE_TYPE_APPROXIMATED;
-					gps_custom_msg->velocity_x =
-							static_cast<double>(RO_ALL_Data_.GPS_speed_x) * 1.0e-3;
-					gps_custom_msg->velocity_y =
-							static_cast<double>(RO_ALL_Data_.GPS_speed_y) * 1.0e-3;
-					gps_custom_msg->pressure_height =
-							static_cast<double>(RO_ALL_Data_.fusion_height) * 1.0e-3;
-					// TODO: check covariance
-					double var_vel =
-							static_cast<double>(RO_ALL_Data_.GPS_speed_accuracy) * 1.0e-3 / 3.0;
-					var_vel *= var_vel;
-					gps_custom_msg->velocity_covariance[0] = var_vel;
-					gps_custom_msg->velocity_covariance[3] = var_vel;
-
-					gps_custom_msg->status.service = sensor_msgs::NavSatStatus::SERVICE_GPS;
-					// bit 0: GPS lock
-					if (RO_ALL_Data_.GPS_status & 0x01)
-						gps_custom_msg->status.status =
-								sensor_msgs::NavSatStatus::STATUS_FIX;
-					else
-						gps_custom_msg->status.status =
-								sensor_msgs::NavSatStatus::STATUS_NO_FIX;
-					gps_custom_pub_.publish(gps_custom_msg);
-				}
+void AciRemote::publishStatusMotorsRc() {
+	// consistent copy of the received data, does not block the ACI Engine
+	// stamped with the arrival of packet 0, status, motors and RC data
+	struct RO_ALL_DATA ro_all = RO_ALL_DATA();
+	ros::Time time_stamp;
+	double rx_time = 0;
+	double start = monotonicNow();
+	if (!snapshot(RO_ALL_Data_, ro_all, 0, time_stamp, &rx_time))
+		return;
+	// in packet 0 as well
+	struct WO_SDK_STRUCT ro_sdk = WO_SDK_STRUCT();
+	unsigned short waypt_status = 0;
+	ros::Time sdk_stamp;
+	snapshot(RO_SDK_, ro_sdk, 0, sdk_stamp);
+	snapshot(wayptStatus_, waypt_status, 0, sdk_stamp);
+	double snapshot_time = monotonicNow() - start;
+	bool published = false;
+
+	// only publish if someone has already subscribed to topics
+	if (rcdata_pub_.getNumSubscribers() > 0) {
+		asctec_hlp_comm::mav_rcdataPtr rcdata_msg(new asctec_hlp_comm::mav_rcdata);
+		rcdata_msg->header.frame_id = frame_id_;
+		rcdata_msg->header.stamp = time_stamp;
+		rcdata_msg->header.seq = status_seq_[0];
+		status_seq_[0]++;
+		for (int i = 0; i < NUM_RC_CHANNELS; ++i) {
+			rcdata_msg->channel[i] = ro_all.channel[i];
+		}
+		rcdata_pub_.publish(rcdata_msg);
+		published = true;
+	}
+	if (status_pub_.getNumSubscribers() > 0) {
+		asctec_hlp_comm::mav_hlp_statusPtr status_msg(new asctec_hlp_comm::mav_hlp_status);
+		status_msg->header.frame_id = frame_id_;
+		status_msg->header.stamp = time_stamp;
+		status_msg->header.seq = status_seq_[1];
+		status_seq_[1]++;
+
+		status_msg->UAV_status = ro_all.UAV_status;
+
+		if ((ro_all.UAV_status & 0x0F) == HLP_FLIGHTMODE_ATTITUDE)
+			status_msg->flight_mode = "Attitude";
+		else if ((ro_all.UAV_status & 0x0F) == HLP_FLIGHTMODE_HEIGHT)
+			status_msg->flight_mode = "Height";
+		else if ((ro_all.UAV_status & 0x0F) == HLP_FLIGHTMODE_GPS)
+			status_msg->flight_mode = "GPS";
+
+		status_msg->flight_time = static_cast<float>(ro_all.flight_time);
+		status_msg->battery_voltage =
+				static_cast<float>(ro_all.battery_voltage) * 0.001;
+		status_msg->cpu_load = static_cast<float>(ro_all.HL_cpu_load) * 0.001;
+		status_msg->up_time = static_cast<float>(ro_all.HL_up_time) * 0.001;
+		status_msg->serial_interface_enabled =
+				ro_all.UAV_status & SERIAL_INTERFACE_ENABLED;
+		status_msg->serial_interface_active =
+				ro_all.UAV_status & SERIAL_INTERFACE_ACTIVE;
+
+		status_msg->motor_status = "off";
+		for (int i = 0; i < NUM_MOTORS; ++i) {
+			if (ro_all.motor_rpm[i] > 0) {
+				status_msg->motor_status = "running";
+				break;
 			}
 		}
+
+		// bit 0: GPS lock
+		if (ro_all.GPS_status & 0x01)
+			status_msg->gps_status = "GPS fix";
+		else
+			status_msg->gps_status = "GPS no fix";
+
+		status_msg->gps_num_satellites = ro_all.GPS_sat_num;
+
+		// other status variables
+		status_msg->ctrl_mode = ro_sdk.ctrl_mode;
+		status_msg->ctrl_enabled = ro_sdk.ctrl_enabled;
+		status_msg->disable_motor_onoff_by_stick = ro_sdk.disable_motor_onoff_by_stick;
+		status_msg->waypt_status = waypt_status;
+
+		// debug variables
+		//status_msg->debug1 = static_cast<unsigned short>(debug1_);
+		//status_msg->debug2 = static_cast<unsigned short>(debug2_);
+		//status_msg->debug3 = static_cast<unsigned short>(debug3_);
+
+		status_pub_.publish(status_msg);
+		published = true;
 	}
-	catch (boost::thread_interrupted const&) {
-		ROS_INFO("publishGpsData() thread interrupted");
+	if (motor_pub_.getNumSubscribers() > 0) {
+		asctec_hlp_comm::MotorSpeedPtr motor_msg(new asctec_hlp_comm::MotorSpeed);
+		motor_msg->header.frame_id = frame_id_;
+		motor_msg->header.stamp = time_stamp;
+		motor_msg->header.seq = status_seq_[2];
+		status_seq_[2]++;
+		for (int i = 0; i < NUM_MOTORS; ++i) {
+			motor_msg->motor_speed[i] = ro_all.motor_rpm[i];
+		}
+		motor_pub_.publish(motor_msg);
+		published = true;
 	}
+	if (published)
+		recordPublishTiming(PUBLISHER_STATUS, rx_time, snapshot_time);
 }
 
 void AciRemote::publishStatusMotorsRcData() {
-	asctec_hlp_comm::mav_rcdataPtr rcdata_msg(new asctec_hlp_comm::mav_rcdata);
-	asctec_hlp_comm::mav_hlp_statusPtr status_msg(new asctec_hlp_comm::mav_hlp_status);
-	asctec_hlp_comm::MotorSpeedPtr motor_msg(new asctec_hlp_comm::MotorSpeed);
-	rcdata_msg->header.frame_id = frame_id_;
-	status_msg->header.frame_id = frame_id_;
-	motor_msg->header.frame_id = frame_id_;
-	int status_throttle = 1000 / rc_status_rate_;
-	static int seq[] = {0, 0, 0};
+	unsigned long seen = 0;
 	try {
-		for (;;) {
-			boost::system_time const status_timeout =
-					boost::get_system_time() + boost::posix_time::milliseconds(status_throttle);
-			// acquire multiple reader shared lock
-			boost::shared_lock<boost::shared_mutex> s_lock(shared_mtx_);
-
-			if (cond_any_.timed_wait(s_lock, status_timeout) == false) {
-				// check whether thread should terminate (::interrupt() appears to have no effect)
-				if (must_stop_pub_)
-					return;
-				// TODO: implement flag to put thread into idle mode to save computational resources
-
-				ros::Time time_stamp(ros::Time::now());
-				// only publish if someone has already subscribed to topics
-				if (rcdata_pub_.getNumSubscribers() > 0) {
-					rcdata_msg->header.stamp = time_stamp;
-					rcdata_msg->header.seq = seq[0];
-					seq[0]++;
-					for (int i = 0; i < NUM_RC_CHANNELS; ++i) {
-						rcdata_msg->channel[i] = RO_ALL_Data_.channel[i];
-					}
-					rcdata_pub_.publish(rcdata_msg);
-				}
-				if (status_pub_.getNumSubscribers() > 0) {
-					status_msg->header.stamp = time_stamp;
-					status_msg->header.seq = seq[1];
-					seq[1]++;
-
-					status_msg->UAV_status = RO_ALL_Data_.UAV_status;
-
-					if ((RO_ALL_Data_.UAV_status & 0x0F) == HLP_FLIGHTMODE_ATTITUDE)
-						status_msg->flight_mode = "Attitude";
-					else if ((RO_ALL_Data_.UAV_status & 0x0F) == HLP_FLIGHTMODE_HEIGHT)
-						status_msg->flight_mode = "Height";
-					else if ((RO_ALL_Data_.UAV_status & 0x0F) == HLP_FLIGHTMODE_GPS)
-						status_msg->flight_mode = "GPS";
-
-					status_msg->flight_time = static_cast<float>(RO_ALL_Data_.flight_time);
-					status_msg->battery_voltage =
-							static_cast<float>(RO_ALL_Data_.battery_voltage) * 0.001;
-					status_msg->cpu_load = static_cast<float>(RO_ALL_Data_.HL_cpu_load) * 0.001;
-					status_msg->up_time = static_cast<float>(RO_ALL_Data_.HL_up_time) * 0.001;
-					status_msg->serial_interface_enabled =
-							RO_ALL_Data_.UAV_status & SERIAL_INTERFACE_ENABLED;
-					status_msg->serial_interface_active =
-							RO_ALL_Data_.UAV_status & SERIAL_INTERFACE_ACTIVE;
-
-					status_msg->motor_status = "off";
-					for (int i = 0; i < NUM_MOTORS; ++i) {
-						if (RO_ALL_Data_.motor_rpm[i] > 0) {
-							status_msg->motor_status = "running";
-							break;
-						}
-					}
-
-					// bit 0: GPS lock
-					if (RO_ALL_Data_.GPS_status & 0x01)
-						status_msg->gps_status = "GPS fix";
-					else
-						status_msg->gps_status = "GPS no fix";
-
-					status_msg->gps_num_satellites = RO_ALL_Data_.GPS_sat_num;
-
-					// other status variables
-					status_msg->ctrl_mode = RO_SDK_.ctrl_mode;
-					status_msg->ctrl_enabled = RO_SDK_.ctrl_enabled;
-					status_msg->disable_motor_onoff_by_stick = RO_SDK_.disable_motor_onoff_by_stick;
-					status_msg->waypt_status = wayptStatus_;
-
-					// debug variables
-					//status_msg->debug1 = static_cast<unsigned short>(debug1_);
-					//status_msg->debug2 = static_cast<unsigned short>(debug2_);
-					//status_msg->debug3 = static_cast<unsigned short>(debug3_);
-
-					status_pub_.publish(status_msg);
-				}
-				if (motor_pub_.getNumSubscribers() > 0) {
-					motor_msg->header.stamp = time_stamp;
-					motor_msg->header.seq = seq[2];
-					seq[2]++;
-					for (int i = 0; i < NUM_MOTORS; ++i) {
-						motor_msg->motor_speed[i] = RO_ALL_Data_.motor_rpm[i];
-					}
-					motor_pub_.publish(motor_msg);
-				}
-			}
-		}
+		// one message per packet, at the rate the HLP sends it
+		while (waitForPacket(0, seen))
+			publishStatusMotorsRc();
 	}
 	catch (boost::thread_interrupted const&) {
 		ROS_INFO("publishStatusMotorsRcData() thread interrupted");
@@ -908,35 +1820,34 @@ void AciRemote::publishStatusMotorsRcData() {
 
 
 // by Xun
+void AciRemote::publishLaser() {
+  short laser_distance = 0;
+  ros::Time time_stamp;
+  double rx_time = 0;
+  double start = monotonicNow();
+  if (!snapshot(laser_distance_, laser_distance, laser_packet_, time_stamp, &rx_time))
+    return;
+  double snapshot_time = monotonicNow() - start;
+
+  // only publish if someone has already subscribed to topics
+  if (laser_pub_.getNumSubscribers() > 0) {
+    asctec_hlp_comm::mav_laserPtr laser_msg(new asctec_hlp_comm::mav_laser);
+    laser_msg->header.frame_id = frame_id_;
+    laser_msg->header.stamp = time_stamp;
+    laser_msg->header.seq = laser_seq_;
+    laser_seq_++;
+    laser_msg->laser_measurement = laser_distance;
+    laser_pub_.publish(laser_msg);
+    recordPublishTiming(PUBLISHER_LASER, rx_time, snapshot_time);
+  }
+}
+
 void AciRemote::publishLaserData() {
-  asctec_hlp_comm::mav_laserPtr laser_msg(new asctec_hlp_comm::mav_laser);
-  laser_msg->header.frame_id = frame_id_;
-  int laser_throttle = 1000 / laser_rate_;
-  static int seq[] = {0, 0};
+  unsigned long seen = 0;
   try {
-    for (;;) {
-      boost::system_time const laser_timeout =
-          boost::get_system_time() + boost::posix_time::milliseconds(laser_throttle);
-      // acquire multiple reader shared lock
-      boost::shared_lock<boost::shared_mutex> s_lock(shared_mtx_);
-
-      if (cond_any_.timed_wait(s_lock, laser_timeout) == false) {
-        // check whether thread should terminate (::interrupt() appears to have no effect)
-        if (must_stop_pub_)
-          return;
-        // TODO: implement flag to put thread into idle mode to save computational resources
-
-        ros::Time time_stamp(ros::Time::now());
-        // only publish if someone has already subscribed to topics
-        if (laser_pub_.getNumSubscribers() > 0) {
-          laser_msg->header.stamp = time_stamp;
-          laser_msg->header.seq = seq[0];
-          seq[0]++;
-          laser_msg->laser_measurement = laser_distance_;
-          laser_pub_.publish(laser_msg);
-        }
-      }
-    }
+    // laser_packet_ is only set up again once the link is down, which stops the packets
+    while (waitForPacket(laser_packet_, seen))
+      publishLaser();
   }
   catch (boost::thread_interrupted const&) {
     ROS_INFO("publishLaserData() thread interrupted");
@@ -1037,16 +1948,28 @@ void AciRemote::publishLaserData() {
  */
 
 void AciRemote::ctrlTopicCallback(const geometry_msgs::TwistConstPtr& cmd) {
-    // acquire shared lock in order to read from RO_ALL_Data_
-    boost::shared_lock<boost::shared_mutex> s_lock(shared_mtx_);
+    // the IO thread owns the ACI context in reactor mode, hand the command over
+    if (reactor_)
+        io_service_.post(boost::bind(&AciRemote::applyCtrlCommand, this, cmd));
+    else
+        applyCtrlCommand(cmd);
+}
+
+void AciRemote::applyCtrlCommand(const geometry_msgs::TwistConstPtr& cmd) {
+    // take a consistent copy of RO_ALL_Data_
+    struct RO_ALL_DATA ro_all = RO_ALL_DATA();
+    if (!snapshot(RO_ALL_Data_, ro_all)) {
+        ROS_WARN_STREAM("Link to HLP is down, dropping control command");
+        return;
+    }
 
-    if (RO_ALL_Data_.UAV_status & HLP_FLIGHTMODE_GPS) {
+    if (ro_all.UAV_status & HLP_FLIGHTMODE_GPS) {
         ROS_WARN_STREAM("UAV in GPS mode");
     }
-    else if (RO_ALL_Data_.UAV_status & HLP_FLIGHTMODE_HEIGHT) {
+    else if (ro_all.UAV_status & HLP_FLIGHTMODE_HEIGHT) {
         ROS_WARN_STREAM("UAV in Height mode");
     }
-    else if (RO_ALL_Data_.UAV_status & HLP_FLIGHTMODE_ATTITUDE) {
+    else if (ro_all.UAV_status & HLP_FLIGHTMODE_ATTITUDE) {
         ROS_ERROR_STREAM("UAV in manual mode: IGNORING for safety reasons");
         return;
     }
@@ -1067,6 +1990,10 @@ void AciRemote::ctrlTopicCallback(const geometry_msgs::TwistConstPtr& cmd) {
     // which means via the corresponding geometry_msgs/Twist value in 'cmd',
     // and whichever bit not set will still be controlled by the remote control
     // (i.e., the RC sticks)
+    // WO_CTRL_ is read by the ACI Engine, which runs under ctrl_mtx_ or in this thread
+    boost::mutex::scoped_lock lock(ctrl_mtx_, boost::defer_lock);
+    if (!reactor_)
+        lock.lock();
     WO_CTRL_.ctrl = 0x3F; // 0011 1111 = 3F
 
     // thrust range = [0, 4095]
@@ -1108,14 +2035,14 @@ void AciRemote::ctrlTopicCallback(const geometry_msgs::TwistConstPtr& cmd) {
     }
 
     // update CTRL command packet
-    aciUpdateCmdPacket(1);
+    updateCmdPacket(1);
 }
 
 bool AciRemote::ctrlServiceCallback(asctec_hlp_comm::HlpCtrlSrv::Request& req,
 		asctec_hlp_comm::HlpCtrlSrv::Response& res) {
 	// TODO: analyse whether the lock should be acquired only just before the call
-	// to aciUpdateCmdPacket()
-	boost::mutex::scoped_lock lock(ctrl_mtx_);
+	// to aciCtxUpdateCmdPacket(aci_ctx_)
+	AciLock lock(this);
 
 	/*
 	 *  truth table for flight mode-related variables
@@ -1166,7 +2093,7 @@ bool AciRemote::ctrlServiceCallback(asctec_hlp_comm::HlpCtrlSrv::Request& req,
         WO_DIMC_.motor[3] = 0;
     */
 
-	aciUpdateCmdPacket(0);
+	updateCmdPacket(0);
 
 	res.motor1 = WO_DIMC_.motor[0];
 	res.motor2 = WO_DIMC_.motor[1];
@@ -0,0 +1,209 @@
+/*
+ * AciTableCache.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ */
+
+#include "asctec_hlp_interface/AciTableCache.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <boost/crc.hpp>
+
+#include "aci_remote_v100/asctecDefines.h"
+#include "aci_remote_v100/asctecCommIntf.h"
+
+static const char CACHE_FILE_MAGIC[8] = { 'A', 'C', 'I', 'T', 'A', 'B', 'L', 0 };
+// magic codes and table sizes in front of the entries, see aciStoreList()
+static const size_t CACHE_STREAM_HEADER_SIZE = 12;
+
+static uint32_t streamCrc(const unsigned char* data, size_t size) {
+	boost::crc_32_type crc;
+	crc.process_bytes(data, size);
+	return crc.checksum();
+}
+
+// size of the complete stream announced by its header, 0 if the header is not there yet
+static size_t streamSize(const unsigned char* data, size_t size) {
+	if (size < CACHE_STREAM_HEADER_SIZE)
+		return 0;
+	uint16_t count[3];
+	memcpy(count, &data[6], sizeof(count));
+	return CACHE_STREAM_HEADER_SIZE
+			+ (count[0] + count[1] + count[2]) * sizeof(struct ACI_MEM_TABLE_ENTRY);
+}
+
+static int makeDirectories(const std::string& dir) {
+	for (size_t pos = dir.find('/', 1); ; pos = dir.find('/', pos + 1)) {
+		std::string sub = dir.substr(0, pos);
+		if (!sub.empty() && mkdir(sub.c_str(), 0755) < 0 && errno != EEXIST)
+			return -1;
+		if (pos == std::string::npos)
+			break;
+	}
+	return 0;
+}
+
+AciTableCache::AciTableCache(): map_(NULL), map_size_(0), stream_(NULL), stream_size_(0),
+		read_pos_(0), writing_(false) {
+}
+
+AciTableCache::~AciTableCache() {
+	close();
+}
+
+bool AciTableCache::open(const std::string& dir, const std::string& vehicle) {
+	close();
+	if (makeDirectories(dir) < 0) {
+		ROS_WARN_STREAM("Could not create ACI table cache directory " << dir << ". " << strerror(errno));
+		return false;
+	}
+	path_ = dir + "/" + vehicle + ".acitables";
+	return mapFile();
+}
+
+void AciTableCache::close() {
+	unmapFile();
+	write_buf_.clear();
+	writing_ = false;
+	path_.clear();
+}
+
+bool AciTableCache::isValid() const {
+	return stream_ != NULL;
+}
+
+void AciTableCache::rewind() {
+	read_pos_ = 0;
+}
+
+int AciTableCache::read(void* data, int bytes) {
+	if (!stream_ || bytes <= 0)
+		return 0;
+	size_t cnt = stream_size_ - read_pos_;
+	if (cnt > static_cast<size_t>(bytes))
+		cnt = bytes;
+	memcpy(data, stream_ + read_pos_, cnt);
+	read_pos_ += cnt;
+	return cnt;
+}
+
+int AciTableCache::write(void* data, int bytes) {
+	if (!writing_ || bytes <= 0)
+		return 0;
+	const unsigned char* ptr = static_cast<const unsigned char*>(data);
+	write_buf_.insert(write_buf_.end(), ptr, ptr + bytes);
+
+	// the ACI Remote does not tell when it is done, the header does
+	size_t size = streamSize(&write_buf_[0], write_buf_.size());
+	if (size && write_buf_.size() >= size) {
+		write_buf_.resize(size);
+		writing_ = false;
+		if (!commit())
+			ROS_WARN_STREAM("Could not write ACI table cache " << path_ << ". " << strerror(errno));
+		write_buf_.clear();
+	}
+	return bytes;
+}
+
+void AciTableCache::reset() {
+	write_buf_.clear();
+	writing_ = !path_.empty();
+	read_pos_ = 0;
+}
+
+bool AciTableCache::mapFile() {
+	int fd = ::open(path_.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+		::close(fd);
+		return false;
+	}
+	void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (map == MAP_FAILED)
+		return false;
+	map_ = static_cast<const unsigned char*>(map);
+	map_size_ = st.st_size;
+
+	FileHeader header;
+	memcpy(&header, map_, sizeof(header));
+	const unsigned char* stream = map_ + sizeof(header);
+	if (memcmp(header.magic, CACHE_FILE_MAGIC, sizeof(header.magic)) != 0
+			|| header.version != ACI_TABLE_CACHE_VERSION
+			|| header.entry_size != sizeof(struct ACI_MEM_TABLE_ENTRY)
+			|| header.stream_size != map_size_ - sizeof(header)
+			|| header.stream_size != streamSize(stream, header.stream_size)
+			|| header.crc != streamCrc(stream, header.stream_size)) {
+		ROS_WARN_STREAM("Ignoring outdated or corrupt ACI table cache " << path_);
+		unmapFile();
+		return false;
+	}
+	stream_ = stream;
+	stream_size_ = header.stream_size;
+	read_pos_ = 0;
+	return true;
+}
+
+void AciTableCache::unmapFile() {
+	if (map_)
+		munmap(const_cast<unsigned char*>(map_), map_size_);
+	map_ = NULL;
+	map_size_ = 0;
+	stream_ = NULL;
+	stream_size_ = 0;
+	read_pos_ = 0;
+}
+
+bool AciTableCache::commit() {
+	FileHeader header;
+	memcpy(header.magic, CACHE_FILE_MAGIC, sizeof(header.magic));
+	header.version = ACI_TABLE_CACHE_VERSION;
+	header.entry_size = sizeof(struct ACI_MEM_TABLE_ENTRY);
+	header.stream_size = write_buf_.size();
+	header.crc = streamCrc(&write_buf_[0], write_buf_.size());
+	size_t size = sizeof(header) + write_buf_.size();
+
+	// write a temporary file and rename it, readers never see half a cache
+	std::string tmp_path = path_ + ".tmp";
+	int fd = ::open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return false;
+	if (ftruncate(fd, size) < 0) {
+		::close(fd);
+		unlink(tmp_path.c_str());
+		return false;
+	}
+	void* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		::close(fd);
+		unlink(tmp_path.c_str());
+		return false;
+	}
+	memcpy(map, &header, sizeof(header));
+	memcpy(static_cast<unsigned char*>(map) + sizeof(header), &write_buf_[0], write_buf_.size());
+	int ret = msync(map, size, MS_SYNC);
+	munmap(map, size);
+	::close(fd);
+	if (ret < 0 || rename(tmp_path.c_str(), path_.c_str()) < 0) {
+		unlink(tmp_path.c_str());
+		return false;
+	}
+
+	// serve the next start of the ACI Remote from the new tables
+	unmapFile();
+	mapFile();
+	ROS_INFO_STREAM("ACI tables cached in " << path_);
+	return true;
+}
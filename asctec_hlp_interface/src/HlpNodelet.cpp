@@ -0,0 +1,64 @@
+/*
+ * HlpNodelet.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ */
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+#include <boost/make_shared.hpp>
+
+#include "asctec_hlp_interface/AciRemote.h"
+#include "asctec_hlp_interface/WaypointGPSActionServer.h"
+
+namespace asctec_hlp_interface {
+
+// hlp_node as a nodelet. Nodelets in the same manager get its messages as
+// shared pointers, without serialisation. With ~waypoint_action set, it also
+// runs the GPS waypoint action server, which needs the same AciRemote
+class HlpNodelet: public nodelet::Nodelet {
+public:
+	~HlpNodelet() {
+		if (start_thread_.get() != NULL)
+			start_thread_->join();
+		// the action server calls into the HLP interface, it goes first
+		waypt_.reset();
+		hlp_.reset();
+	}
+
+private:
+	void onInit() {
+		// waiting for the HLP takes seconds, the manager must not wait along
+		start_thread_.reset(new boost::thread(boost::bind(&HlpNodelet::start, this)));
+	}
+
+	void start() {
+		hlp_ = boost::make_shared<AciRemote::AciRemote>(boost::ref(getNodeHandle()));
+
+		if (hlp_->init() < 0) {
+			NODELET_ERROR("Could not open the link to the HLP");
+			hlp_.reset();
+			return;
+		}
+		if (hlp_->initRosLayer() < 0) {
+			NODELET_ERROR("ROS topics not advertised because data has not yet arrived from HLP");
+			hlp_.reset();
+			return;
+		}
+
+		bool waypoint_action;
+		getPrivateNodeHandle().param("waypoint_action", waypoint_action, false);
+		if (waypoint_action)
+			waypt_.reset(new WaypointGPSActionServer("gps_waypt_nav", hlp_, getNodeHandle()));
+	}
+
+	boost::shared_ptr<AciRemote::AciRemote> hlp_;
+	boost::shared_ptr<WaypointGPSActionServer> waypt_;
+	boost::shared_ptr<boost::thread> start_thread_;
+};
+
+} // namespace asctec_hlp_interface
+
+PLUGINLIB_EXPORT_CLASS(asctec_hlp_interface::HlpNodelet, nodelet::Nodelet)
@@ -0,0 +1,64 @@
+/*
+ * JitterHistogram.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ */
+
+#include "asctec_hlp_interface/JitterHistogram.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include <ros/ros.h>
+
+const int JitterHistogram::BOUNDS_US[JitterHistogram::BUCKETS - 1] = {
+	50, 100, 200, 500, 1000, 2000, 5000, 10000
+};
+
+JitterHistogram::JitterHistogram(): last_report_(0) {
+	clear();
+}
+
+void JitterHistogram::add(double lateness) {
+	double us = lateness * 1e6;
+	int i = 0;
+	while (i < BUCKETS - 1 && us >= BOUNDS_US[i])
+		++i;
+	++counts_[i];
+	++total_;
+	sum_ += lateness;
+	max_ = std::max(max_, lateness);
+}
+
+void JitterHistogram::report(const char* name, double now, double period) {
+	if (period <= 0)
+		return;
+	if (last_report_ == 0) {
+		// starts with the first tick, not at the epoch of the clock
+		last_report_ = now;
+		return;
+	}
+	if (now - last_report_ < period)
+		return;
+
+	std::ostringstream ss;
+	ss << name << " over " << total_ << " samples: mean " << (total_ ? sum_ / total_ * 1e6 : 0)
+			<< " us, max " << max_ * 1e6 << " us |";
+	for (int i = 0; i < BUCKETS; ++i) {
+		if (i < BUCKETS - 1)
+			ss << " <" << BOUNDS_US[i] << ": " << counts_[i];
+		else
+			ss << " >=" << BOUNDS_US[i - 1] << ": " << counts_[i];
+	}
+	ROS_INFO_STREAM(ss.str());
+	clear();
+	last_report_ = now;
+}
+
+void JitterHistogram::clear() {
+	std::fill(counts_, counts_ + BUCKETS, 0);
+	total_ = 0;
+	sum_ = 0;
+	max_ = 0;
+}
@@ -9,8 +9,21 @@
 
 #include "asctec_hlp_interface/SerialComm.h"
 
-SerialComm::SerialComm(): port_name_("/dev/ttyS2"), baud_rate_(57600), open_(false) {
-	read_buffer_.assign(SERIAL_PORT_READ_BUF_SIZE, 0);
+#include <string.h>
+#include <time.h>
+
+SerialComm::SerialComm(): transport_type_("serial"), port_name_("/dev/ttyS2"), baud_rate_(57600),
+		remote_host_("localhost"), remote_port_(2001), local_port_(0), read_index_(0),
+		read_buf_size_(SERIAL_PORT_READ_BUF_SIZE), read_vmin_(1), read_vtime_(0), low_latency_(true),
+		write_busy_(false), write_hold_(0), write_latency_sum_(0), write_strand_(io_service_),
+		open_(false) {
+	free_write_buffers_.reserve(SERIAL_PORT_WRITE_POOL_SIZE);
+	for (int i = 0; i < SERIAL_PORT_WRITE_POOL_SIZE; ++i)
+		free_write_buffers_.push_back(new WriteBuffer);
+	write_queue_.reserve(SERIAL_PORT_WRITE_POOL_SIZE);
+	write_frames_.reserve(SERIAL_PORT_WRITE_POOL_SIZE);
+	write_bufs_.reserve(SERIAL_PORT_WRITE_POOL_SIZE);
+	memset(&write_stats_, 0, sizeof(write_stats_));
 }
 
 SerialComm::~SerialComm() {
@@ -22,40 +35,53 @@ SerialComm::~SerialComm() {
 			// do not throw exceptions from a destructor
 		}
 	}
+	// the IO thread is gone, no write is pending anymore
+	for (size_t i = 0; i < write_queue_.size(); ++i)
+		delete write_queue_[i];
+	for (size_t i = 0; i < free_write_buffers_.size(); ++i)
+		delete free_write_buffers_[i];
 }
 
 int SerialComm::openPort() {
 	if (!open_) {
-		try {
-			port_.reset(new boost::asio::serial_port(io_service_));
-			port_->open(port_name_);
-		}
-		catch (boost::system::system_error::exception& e) {
-			ROS_ERROR_STREAM("Could not open serial port " << port_name_ << ". " << e.what());
+		TransportSettings settings;
+		settings.type = transport_type_;
+		settings.device = port_name_;
+		settings.baud_rate = baud_rate_;
+		settings.vmin = read_vmin_;
+		settings.vtime = read_vtime_;
+		settings.low_latency = low_latency_;
+		settings.host = remote_host_;
+		settings.port = remote_port_;
+		settings.local_port = local_port_;
+		settings.pty_link = pty_link_;
+		transport_.reset(Transport::create(io_service_, settings));
+		if (!transport_) {
+			ROS_ERROR_STREAM("Unknown transport " << transport_type_);
 			return -1;
 		}
-		ROS_INFO_STREAM("Port " << port_name_ << " open");
 
 		try {
-			port_->set_option(boost::asio::serial_port_base::baud_rate(baud_rate_));
-			port_->set_option(boost::asio::serial_port_base::character_size(8));
-			port_->set_option(boost::asio::serial_port_base::stop_bits(
-					boost::asio::serial_port_base::stop_bits::one));
-			port_->set_option(boost::asio::serial_port_base::parity(
-					boost::asio::serial_port_base::parity::none));
+			transport_->open();
 		}
 		catch (boost::system::system_error::exception& e) {
-			ROS_ERROR_STREAM("Could not configure serial port " << port_name_ << ". " << e.what());
+			ROS_ERROR_STREAM("Could not open " << transport_type_ << " transport " << linkName() << ". " << e.what());
 			return -1;
 		}
-		ROS_INFO_STREAM("Baud rate set to " << baud_rate_);
+		ROS_INFO_STREAM("Port " << linkName() << " open");
 
+		if (read_buf_size_ < 1)
+			read_buf_size_ = SERIAL_PORT_READ_BUF_SIZE;
+		for (int i = 0; i < SERIAL_PORT_READ_BUFFERS; ++i)
+			read_buffers_[i].assign(read_buf_size_, 0);
+		read_index_ = 0;
 		doRead();
 
 		// TODO: do I really need this thread?! Or is this the one which dies according to gdb?
 		try {
 			io_thread_ = boost::shared_ptr<boost::thread>
 				(new boost::thread(boost::bind(&boost::asio::io_service::run, &io_service_)));
+			io_thread_sched_.apply(io_thread_->native_handle(), "IO");
 		}
 		catch (boost::system::system_error::exception& e) {
 			ROS_ERROR_STREAM("Could not create Boost IO thread. " << e.what());
@@ -64,7 +90,7 @@ int SerialComm::openPort() {
 		open_ = true;
 	}
 	else {
-		ROS_WARN_STREAM("Serial port " << port_name_ << " is already open");
+		ROS_WARN_STREAM("Serial port " << linkName() << " is already open");
 	}
 	return 0;
 }
@@ -77,52 +103,264 @@ void SerialComm::closePort() {
 	io_service_.post(boost::bind(&SerialComm::doClose, this));
 	io_thread_->join();
 	io_service_.reset();
+	// the IO thread may have run out of work before it got to doClose, e.g. after a
+	// read error. Do not leave it to the next openPort, it would close the new link
+	io_service_.poll();
+	io_service_.reset();
+
+	WriteStats stats = writeStats();
+	ROS_INFO_STREAM("Serial port " << linkName() << " wrote " << stats.frames << " frames in "
+			<< stats.writes << " writes, up to " << stats.max_queue_depth << " frames per write, latency "
+			<< stats.mean_latency * 1e3 << " ms mean, " << stats.max_latency * 1e3 << " ms max");
 }
 
 bool SerialComm::isOpen() const {
 	return open_;
 }
 
+const std::string& SerialComm::linkName() const {
+	return transport_ ? transport_->name() : port_name_;
+}
+
+struct SerialComm::BaudRateChange {
+	BaudRateChange(int rate): baud_rate(rate), done(false), ok(false) {}
+	int baud_rate;
+	bool done;
+	bool ok;
+	boost::mutex mtx;
+	boost::condition_variable cond;
+};
+
+bool SerialComm::setBaudRate(int baud_rate) {
+	if (!isOpen())
+		return false;
+	// the IO thread has reads pending on the transport, so the port is changed there
+	if (io_thread_ && io_thread_->get_id() == boost::this_thread::get_id())
+		return applyBaudRate(baud_rate);
+	boost::shared_ptr<BaudRateChange> change(new BaudRateChange(baud_rate));
+	io_service_.post(boost::bind(&SerialComm::changeBaudRate, this, change));
+	boost::unique_lock<boost::mutex> lock(change->mtx);
+	while (!change->done) {
+		// nobody runs the io_service once it ran out of work, the transport is ours then
+		if (!change->cond.timed_wait(lock, boost::posix_time::milliseconds(10)) && io_service_.stopped()) {
+			lock.unlock();
+			return applyBaudRate(baud_rate);
+		}
+	}
+	return change->ok;
+}
+
+void SerialComm::changeBaudRate(boost::shared_ptr<BaudRateChange> change) {
+	bool ok = applyBaudRate(change->baud_rate);
+	boost::unique_lock<boost::mutex> lock(change->mtx);
+	change->ok = ok;
+	change->done = true;
+	change->cond.notify_all();
+}
+
+bool SerialComm::applyBaudRate(int baud_rate) {
+	try {
+		if (!transport_->setBaudRate(baud_rate))
+			return false;
+	}
+	catch (boost::system::system_error::exception& e) {
+		ROS_ERROR_STREAM("Could not set baud rate of " << linkName() << " to " << baud_rate << ". " << e.what());
+		return false;
+	}
+	ROS_INFO_STREAM("Baud rate set to " << baud_rate);
+	return true;
+}
+
+double SerialComm::monotonicNow() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+SerialComm::WriteStats SerialComm::writeStats() {
+	boost::mutex::scoped_lock lock(write_pool_mtx_);
+	WriteStats stats = write_stats_;
+	stats.mean_latency = stats.frames ? write_latency_sum_ / stats.frames : 0;
+	return stats;
+}
+
 void SerialComm::doClose() {
 	try {
-		port_->cancel();
-		port_->close();
+		transport_->close();
 	}
 	catch (boost::system::system_error& e) {
 		// at this point ros::spin() is likely to not be called anymore,
 		// but I will leave the call to ROS_ERROR below anyway
-		ROS_ERROR_STREAM("Could not close serial port " << port_name_ << ". " << e.what());
+		ROS_ERROR_STREAM("Could not close serial port " << linkName() << ". " << e.what());
 	}
+	linkClosed();
 }
 
 void SerialComm::doWrite(void* bytes, unsigned short len) {
-	unsigned char* ucharBuf = static_cast<unsigned char*>(bytes);
-	// make a copy of the buffer because it must exist and not change whilst being sent
-	// and owner of void* bytes may not guarantee existence nor "const-ness"
-	boost::shared_ptr<std::vector<unsigned char> >
-			vecBuf(new std::vector<unsigned char>(ucharBuf, ucharBuf + len));
+	boost::asio::const_buffer buf(bytes, len);
+	doWrite(&buf, 1);
+}
+
+void SerialComm::doWrite(const boost::asio::const_buffer* bufs, size_t count) {
+	if (!isOpen())
+		return;
+	size_t len = 0;
+	for (size_t i = 0; i < count; ++i)
+		len += boost::asio::buffer_size(bufs[i]);
+	if (len > SERIAL_PORT_WRITE_BUF_SIZE) {
+		ROS_ERROR_STREAM("Cannot write " << len << " bytes at once to serial port " << linkName());
+		return;
+	}
 
-	// since vecBuf is a shared_ptr, passing the ptr to the handler will guarantee
-	// it does not get freed once this function returns
-	boost::asio::async_write(*port_, boost::asio::buffer(*vecBuf),
-			boost::bind(&SerialComm::writeHandler, this, vecBuf,
-					boost::asio::placeholders::error,
-					boost::asio::placeholders::bytes_transferred));
+	// make a copy of the buffers because they must exist and not change whilst being sent
+	// and their owner may not guarantee existence nor "const-ness"
+	WriteBuffer* writeBuf = acquireWriteBuffer();
+	writeBuf->size = 0;
+	for (size_t i = 0; i < count; ++i) {
+		size_t size = boost::asio::buffer_size(bufs[i]);
+		memcpy(writeBuf->data + writeBuf->size,
+				boost::asio::buffer_cast<const unsigned char*>(bufs[i]), size);
+		writeBuf->size += size;
+	}
+	writeBuf->queued = ros::WallTime::now();
+
+	// only the first frame since the last write posts a flush, the others join it
+	bool post = false;
+	{
+		boost::mutex::scoped_lock lock(write_pool_mtx_);
+		write_queue_.push_back(writeBuf);
+		post = !write_busy_ && !write_hold_;
+		if (post)
+			write_busy_ = true;
+	}
+	if (post)
+		write_strand_.post(FlushOp(this));
+}
+
+void SerialComm::holdWrites() {
+	boost::mutex::scoped_lock lock(write_pool_mtx_);
+	++write_hold_;
+}
+
+void SerialComm::releaseWrites() {
+	bool post = false;
+	{
+		boost::mutex::scoped_lock lock(write_pool_mtx_);
+		if (write_hold_ > 0)
+			--write_hold_;
+		post = !write_busy_ && !write_hold_ && !write_queue_.empty();
+		if (post)
+			write_busy_ = true;
+	}
+	if (post && isOpen())
+		write_strand_.post(FlushOp(this));
+}
+
+void SerialComm::flushWrites() {
+	{
+		boost::mutex::scoped_lock lock(write_pool_mtx_);
+		// releaseWrites posts the next flush for held frames
+		if (write_queue_.empty() || write_hold_) {
+			write_busy_ = false;
+			return;
+		}
+		write_frames_.swap(write_queue_);
+	}
+
+	// one gathered write for all queued frames
+	write_bufs_.clear();
+	for (size_t i = 0; i < write_frames_.size(); ++i)
+		write_bufs_.push_back(boost::asio::buffer(write_frames_[i]->data, write_frames_[i]->size));
+	transport_->asyncWrite(write_bufs_, write_strand_, WriteOp(this, &write_mem_));
 }
 
 void SerialComm::doRead() {
 	// call async_read_some for the first time so that something is received in the buffer
-	port_->async_read_some(boost::asio::buffer(read_buffer_),
-			boost::bind(&SerialComm::readHandler, this, boost::asio::placeholders::error,
-					boost::asio::placeholders::bytes_transferred));
+	transport_->asyncRead(boost::asio::buffer(read_buffers_[read_index_]),
+			ReadOp(this, read_index_, &read_mem_));
+}
+
+void ReadOp::operator()(const boost::system::error_code& error, size_t bytes_transferred) {
+	comm_->readComplete(index_, error, bytes_transferred);
 }
 
-void SerialComm::writeHandler(boost::shared_ptr<std::vector<unsigned char> > bytesVec,
-		const boost::system::error_code& error, size_t bytes_transferred) {
-	if ( error || (bytes_transferred != bytesVec->size()) ) {
-		ROS_ERROR_STREAM("Async write to serial port " << port_name_ << ". " << error.message());
+void WriteOp::operator()(const boost::system::error_code& error, size_t bytes_transferred) {
+	comm_->writeHandler(error, bytes_transferred);
+}
+
+void SerialComm::readComplete(int index, const boost::system::error_code& error,
+		size_t bytes_transferred) {
+	// first thing, the time the last byte arrived is only getting staler
+	double rx_time = monotonicNow();
+	if (error) {
+		readHandler(error, NULL, 0, rx_time, 0);
+		if (isOpen())
+			connectionLost();
+		return;
+	}
+	// arm the next read before parsing, so that bytes arriving meanwhile
+	// are read into the other buffer
+	read_index_ = (index + 1) % SERIAL_PORT_READ_BUFFERS;
+	doRead();
+	readHandler(error, &read_buffers_[index][0], bytes_transferred, rx_time, transport_->byteTime());
+}
+
+void SerialComm::writeHandler(const boost::system::error_code& error, size_t bytes_transferred) {
+	ros::WallTime now = ros::WallTime::now();
+	size_t size = 0;
+	{
+		boost::mutex::scoped_lock lock(write_pool_mtx_);
+		++write_stats_.writes;
+		write_stats_.frames += write_frames_.size();
+		if (write_frames_.size() > write_stats_.max_queue_depth)
+			write_stats_.max_queue_depth = write_frames_.size();
+		for (size_t i = 0; i < write_frames_.size(); ++i) {
+			double latency = (now - write_frames_[i]->queued).toSec();
+			write_latency_sum_ += latency;
+			if (latency > write_stats_.max_latency)
+				write_stats_.max_latency = latency;
+			size += write_frames_[i]->size;
+			releaseWriteBuffer(write_frames_[i]);
+		}
+		write_stats_.bytes += size;
+	}
+	write_frames_.clear();
+
+	if ( error || (bytes_transferred != size) ) {
+		ROS_ERROR_STREAM("Async write to serial port " << linkName() << ". " << error.message());
 		doClose();
+		// the port is gone, drop the frames queued meanwhile
+		boost::mutex::scoped_lock lock(write_pool_mtx_);
+		for (size_t i = 0; i < write_queue_.size(); ++i)
+			releaseWriteBuffer(write_queue_[i]);
+		write_queue_.clear();
+		write_busy_ = false;
+		lock.unlock();
+		if (isOpen())
+			connectionLost();
+		return;
 	}
+	// frames queued during this write go out with the next one
+	flushWrites();
+}
+
+SerialComm::WriteBuffer* SerialComm::acquireWriteBuffer() {
+	boost::mutex::scoped_lock lock(write_pool_mtx_);
+	if (free_write_buffers_.empty()) {
+		// more frames pending than the pool holds, releaseWriteBuffer frees this one again
+		return new WriteBuffer;
+	}
+	WriteBuffer* writeBuf = free_write_buffers_.back();
+	free_write_buffers_.pop_back();
+	return writeBuf;
+}
+
+// the caller holds write_pool_mtx_
+void SerialComm::releaseWriteBuffer(WriteBuffer* writeBuf) {
+	if (free_write_buffers_.size() < SERIAL_PORT_WRITE_POOL_SIZE)
+		free_write_buffers_.push_back(writeBuf);
+	else
+		delete writeBuf;
 }
 
 
@@ -0,0 +1,72 @@
+/*
+ * ThreadScheduling.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ */
+
+#include "asctec_hlp_interface/ThreadScheduling.h"
+
+#include <errno.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include <ros/ros.h>
+
+bool ThreadScheduling::setCpus(const std::string& list) {
+	cpus.clear();
+	std::istringstream ss(list);
+	std::string item;
+	while (std::getline(ss, item, ',')) {
+		if (item.empty())
+			continue;
+		char* end;
+		long first = strtol(item.c_str(), &end, 10);
+		long last = first;
+		if (*end == '-')
+			last = strtol(end + 1, &end, 10);
+		if (*end != '\0' || first < 0 || last < first || last >= CPU_SETSIZE) {
+			cpus.clear();
+			return false;
+		}
+		for (long cpu = first; cpu <= last; ++cpu)
+			cpus.push_back(static_cast<int>(cpu));
+	}
+	return true;
+}
+
+void ThreadScheduling::apply(pthread_t thread, const std::string& name) const {
+	if (priority > 0) {
+		struct sched_param param;
+		memset(&param, 0, sizeof(param));
+		param.sched_priority = std::min(std::max(priority, sched_get_priority_min(SCHED_FIFO)),
+				sched_get_priority_max(SCHED_FIFO));
+		int ret = pthread_setschedparam(thread, SCHED_FIFO, &param);
+		if (ret == 0)
+			ROS_INFO_STREAM(name << " thread runs with SCHED_FIFO priority " << param.sched_priority);
+		else
+			ROS_WARN_STREAM("Could not run " << name << " thread with SCHED_FIFO priority " << param.sched_priority
+					<< ", it keeps the default policy. " << strerror(ret)
+					<< (ret == EPERM ? " (needs CAP_SYS_NICE or an rtprio limit)" : ""));
+	}
+
+	if (!cpus.empty()) {
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		std::ostringstream ss;
+		for (size_t i = 0; i < cpus.size(); ++i) {
+			CPU_SET(cpus[i], &set);
+			ss << (i ? "," : "") << cpus[i];
+		}
+		int ret = pthread_setaffinity_np(thread, sizeof(set), &set);
+		if (ret == 0)
+			ROS_INFO_STREAM(name << " thread pinned to CPU " << ss.str());
+		else
+			ROS_WARN_STREAM("Could not pin " << name << " thread to CPU " << ss.str()
+					<< ", it may run on any CPU. " << strerror(ret));
+	}
+}
@@ -0,0 +1,311 @@
+/*
+ * Transport.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ */
+
+#include "asctec_hlp_interface/Transport.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#ifdef __linux__
+#include <linux/serial.h>
+#endif
+
+#include <sstream>
+
+#include <boost/lexical_cast.hpp>
+
+#include <ros/ros.h>
+
+// the frames of one write as a buffer sequence, which asio copies without allocating
+struct WriteSequence {
+	typedef boost::asio::const_buffer value_type;
+	typedef const boost::asio::const_buffer* const_iterator;
+	WriteSequence(const std::vector<boost::asio::const_buffer>& bufs):
+		begin_(&bufs[0]), end_(&bufs[0] + bufs.size()) {}
+	const_iterator begin() const { return begin_; }
+	const_iterator end() const { return end_; }
+	const_iterator begin_;
+	const_iterator end_;
+};
+
+static void throwErrno(int err) {
+	throw boost::system::system_error(boost::system::error_code(err, boost::system::system_category()));
+}
+
+// the transports which are byte streams, they only differ in opening
+template<typename Stream> class StreamTransport: public Transport {
+public:
+	StreamTransport(boost::asio::io_service& io): stream_(io) {}
+
+	void close() {
+		if (!stream_.is_open())
+			return;
+		stream_.cancel();
+		stream_.close();
+	}
+	void asyncRead(const boost::asio::mutable_buffer& buf, const ReadOp& op) {
+		stream_.async_read_some(boost::asio::mutable_buffers_1(buf), op);
+	}
+	void asyncWrite(const std::vector<boost::asio::const_buffer>& bufs,
+			boost::asio::io_service::strand& strand, const WriteOp& op) {
+		// one gathered write for all frames
+		boost::asio::async_write(stream_, WriteSequence(bufs), strand.wrap(op));
+	}
+
+protected:
+	Stream stream_;
+};
+
+class SerialTransport: public StreamTransport<boost::asio::serial_port> {
+public:
+	SerialTransport(boost::asio::io_service& io, const TransportSettings& settings):
+		StreamTransport<boost::asio::serial_port>(io), settings_(settings), baud_rate_(settings.baud_rate) {
+		name_ = settings.device;
+	}
+
+	void open() {
+		stream_.open(settings_.device);
+		stream_.set_option(boost::asio::serial_port_base::baud_rate(settings_.baud_rate));
+		baud_rate_ = settings_.baud_rate;
+		stream_.set_option(boost::asio::serial_port_base::character_size(8));
+		stream_.set_option(boost::asio::serial_port_base::stop_bits(
+				boost::asio::serial_port_base::stop_bits::one));
+		stream_.set_option(boost::asio::serial_port_base::parity(
+				boost::asio::serial_port_base::parity::none));
+		ROS_INFO_STREAM("Baud rate set to " << settings_.baud_rate);
+		configureLowLatency();
+	}
+
+	bool setBaudRate(int baud_rate) {
+		// bytes still in the driver would go out on the new rate
+		tcdrain(stream_.native_handle());
+		stream_.set_option(boost::asio::serial_port_base::baud_rate(baud_rate));
+		baud_rate_ = baud_rate;
+		return true;
+	}
+
+	double byteTime() const {
+		// 8N1: start bit, 8 data bits, stop bit
+		return baud_rate_ > 0 ? 10.0 / baud_rate_ : 0;
+	}
+
+private:
+	// sets VMIN/VTIME and ASYNC_LOW_LATENCY, warns if the port does not support them
+	void configureLowLatency() {
+		int fd = stream_.native_handle();
+		if (settings_.vmin >= 0 || settings_.vtime >= 0) {
+			struct termios tio;
+			int ret = tcgetattr(fd, &tio);
+			if (ret == 0) {
+				if (settings_.vmin >= 0)
+					tio.c_cc[VMIN] = settings_.vmin;
+				if (settings_.vtime >= 0)
+					tio.c_cc[VTIME] = settings_.vtime;
+				ret = tcsetattr(fd, TCSANOW, &tio);
+			}
+			if (ret < 0)
+				ROS_WARN_STREAM("Could not set VMIN/VTIME of serial port " << name_ << ". " << strerror(errno));
+		}
+#ifdef ASYNC_LOW_LATENCY
+		if (settings_.low_latency) {
+			struct serial_struct serial;
+			if (ioctl(fd, TIOCGSERIAL, &serial) < 0) {
+				ROS_WARN_STREAM("Serial port " << name_ << " does not support ASYNC_LOW_LATENCY. " << strerror(errno));
+				return;
+			}
+			serial.flags |= ASYNC_LOW_LATENCY;
+			if (ioctl(fd, TIOCSSERIAL, &serial) < 0)
+				ROS_WARN_STREAM("Could not set ASYNC_LOW_LATENCY on serial port " << name_ << ". " << strerror(errno));
+			else
+				ROS_INFO_STREAM("ASYNC_LOW_LATENCY set on serial port " << name_);
+		}
+#endif
+	}
+
+	TransportSettings settings_;
+	// current line rate, changed by setBaudRate
+	int baud_rate_;
+};
+
+class TcpTransport: public StreamTransport<boost::asio::ip::tcp::socket> {
+public:
+	TcpTransport(boost::asio::io_service& io, const TransportSettings& settings):
+		StreamTransport<boost::asio::ip::tcp::socket>(io), io_(io), settings_(settings) {
+		std::ostringstream ss;
+		ss << "tcp://" << settings.host << ":" << settings.port;
+		name_ = ss.str();
+	}
+
+	void open() {
+		boost::asio::ip::tcp::resolver resolver(io_);
+		boost::asio::ip::tcp::resolver::query query(settings_.host,
+				boost::lexical_cast<std::string>(settings_.port));
+		boost::asio::connect(stream_, resolver.resolve(query));
+		// ACI frames are small, do not let Nagle hold them back
+		if (settings_.low_latency)
+			stream_.set_option(boost::asio::ip::tcp::no_delay(true));
+	}
+
+private:
+	boost::asio::io_service& io_;
+	TransportSettings settings_;
+};
+
+// a pseudo-terminal, a stand-in of the HLP opens the slave side like a serial port
+class PtyTransport: public StreamTransport<boost::asio::posix::stream_descriptor> {
+public:
+	PtyTransport(boost::asio::io_service& io, const TransportSettings& settings):
+		StreamTransport<boost::asio::posix::stream_descriptor>(io), settings_(settings), slave_fd_(-1) {
+		name_ = "pty";
+	}
+	~PtyTransport() {
+		closeSlave();
+	}
+
+	void open() {
+		int fd = posix_openpt(O_RDWR | O_NOCTTY);
+		if (fd < 0)
+			throwErrno(errno);
+		const char* slave = NULL;
+		struct termios tio;
+		if (grantpt(fd) < 0 || unlockpt(fd) < 0 || (slave = ptsname(fd)) == NULL
+				|| tcgetattr(fd, &tio) < 0) {
+			int err = errno;
+			::close(fd);
+			throwErrno(err);
+		}
+		// raw bytes both ways, in particular no echo of our own frames
+		cfmakeraw(&tio);
+		tcsetattr(fd, TCSANOW, &tio);
+		stream_.assign(fd);
+		name_ = slave;
+
+		// keep the slave open, so that the master does not hang up whenever the stand-in closes it
+		closeSlave();
+		slave_fd_ = ::open(slave, O_RDWR | O_NOCTTY);
+		if (slave_fd_ < 0)
+			ROS_WARN_STREAM("Could not open pty " << name_ << ". " << strerror(errno));
+
+		if (!settings_.pty_link.empty()) {
+			unlink(settings_.pty_link.c_str());
+			if (symlink(slave, settings_.pty_link.c_str()) < 0)
+				ROS_WARN_STREAM("Could not link " << settings_.pty_link << " to pty " << name_ << ". " << strerror(errno));
+			else
+				name_ = settings_.pty_link + " -> " + name_;
+		}
+	}
+
+	void close() {
+		StreamTransport<boost::asio::posix::stream_descriptor>::close();
+		closeSlave();
+	}
+
+private:
+	void closeSlave() {
+		if (slave_fd_ >= 0)
+			::close(slave_fd_);
+		slave_fd_ = -1;
+	}
+
+	TransportSettings settings_;
+	int slave_fd_;
+};
+
+// one datagram per ACI frame, to and from the bridge only
+class UdpTransport: public Transport {
+public:
+	UdpTransport(boost::asio::io_service& io, const TransportSettings& settings):
+		io_(io), socket_(io), settings_(settings), bufs_(NULL), strand_(NULL), next_(0), sent_(0) {
+		std::ostringstream ss;
+		ss << "udp://" << settings.host << ":" << settings.port;
+		name_ = ss.str();
+	}
+
+	void open() {
+		boost::asio::ip::udp::resolver resolver(io_);
+		boost::asio::ip::udp::resolver::query query(boost::asio::ip::udp::v4(), settings_.host,
+				boost::lexical_cast<std::string>(settings_.port));
+		boost::asio::ip::udp::endpoint remote = *resolver.resolve(query);
+		socket_.open(remote.protocol());
+		socket_.bind(boost::asio::ip::udp::endpoint(remote.protocol(), settings_.local_port));
+		// drops datagrams of anyone but the bridge
+		socket_.connect(remote);
+	}
+	void close() {
+		if (!socket_.is_open())
+			return;
+		socket_.cancel();
+		socket_.close();
+	}
+	void asyncRead(const boost::asio::mutable_buffer& buf, const ReadOp& op) {
+		socket_.async_receive(boost::asio::mutable_buffers_1(buf), op);
+	}
+	void asyncWrite(const std::vector<boost::asio::const_buffer>& bufs,
+			boost::asio::io_service::strand& strand, const WriteOp& op) {
+		// only one write at a time is in progress, see SerialComm::flushWrites
+		bufs_ = &bufs;
+		strand_ = &strand;
+		next_ = 0;
+		sent_ = 0;
+		sendNext(boost::system::error_code(), op);
+	}
+
+private:
+	// sends the next frame and calls op once all have been sent
+	class SendOp {
+	public:
+		SendOp(UdpTransport* udp, const WriteOp& op): udp_(udp), op_(op) {}
+		void operator()(const boost::system::error_code& error, size_t bytes_transferred) {
+			udp_->sent_ += bytes_transferred;
+			udp_->sendNext(error, op_);
+		}
+		// the sends follow each other, they share the memory of the write
+		friend void* asio_handler_allocate(size_t size, SendOp* op) {
+			return asio_handler_allocate(size, &op->op_);
+		}
+		friend void asio_handler_deallocate(void* ptr, size_t size, SendOp* op) {
+			asio_handler_deallocate(ptr, size, &op->op_);
+		}
+	private:
+		UdpTransport* udp_;
+		WriteOp op_;
+	};
+
+	void sendNext(const boost::system::error_code& error, WriteOp op) {
+		if (error || next_ == bufs_->size()) {
+			op(error, sent_);
+			return;
+		}
+		socket_.async_send(boost::asio::const_buffers_1((*bufs_)[next_++]),
+				strand_->wrap(SendOp(this, op)));
+	}
+
+	boost::asio::io_service& io_;
+	boost::asio::ip::udp::socket socket_;
+	TransportSettings settings_;
+	// the write in progress
+	const std::vector<boost::asio::const_buffer>* bufs_;
+	boost::asio::io_service::strand* strand_;
+	size_t next_;
+	size_t sent_;
+};
+
+Transport* Transport::create(boost::asio::io_service& io, const TransportSettings& settings) {
+	if (settings.type == "serial")
+		return new SerialTransport(io, settings);
+	if (settings.type == "tcp")
+		return new TcpTransport(io, settings);
+	if (settings.type == "udp")
+		return new UdpTransport(io, settings);
+	if (settings.type == "pty")
+		return new PtyTransport(io, settings);
+	return NULL;
+}
@@ -11,9 +11,9 @@
 #include "asctec_hlp_interface/Helper.h"
 
 WaypointGPSActionServer::WaypointGPSActionServer(const std::string& name,
-		boost::shared_ptr<AciRemote::AciRemote>& aci):
+		boost::shared_ptr<AciRemote::AciRemote>& aci, const ros::NodeHandle& nh):
 		//n_("~"),
-		n_(),
+		n_(nh),
 		as_(n_, name, boost::bind(&WaypointGPSActionServer::GpsWaypointAction, this, _1), false),
 		action_name_(name),
 		iter_rate_(1),
@@ -0,0 +1,263 @@
+/*
+ * bench_node_pty.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ */
+
+// Benchmarks of the node against a stand-in HLP (aci_remote_v100/test/hlp_pty.c) on the pty of transport:=pty.
+// The node runs in this process, the stand-in in a child, so the figures are those of the node alone.
+//   bench_node_pty <hlp_pty> latency threaded|reactor [seconds]
+//       tick of the stand-in to the mag message in a subscriber of this process, median/p99/max
+//   bench_node_pty <hlp_pty> restart [runs]
+//       init() to the return of initRosLayer(), cold (empty table cache) and warm
+//   bench_node_pty <hlp_pty> load threaded|reactor [seconds]
+//       CPU% and wakeups/s of this process while all var packets are published. A wakeup is a voluntary
+//       context switch, a thread that blocked and is woken again; involuntary ones are preemptions
+// Needs a ROS master, like the node itself.
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <errno.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <ros/ros.h>
+#include <geometry_msgs/Vector3Stamped.h>
+
+#include "asctec_hlp_interface/AciRemote.h"
+
+extern char** environ;
+
+namespace {
+
+const int BENCH_BAUD = 921600;
+
+boost::mutex latency_mtx;
+std::vector<double> latencies;
+bool recording = false;
+
+double monotonicSec() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Hx carries the microseconds of the tick that sent it, modulo 2^32
+void magReceived(const geometry_msgs::Vector3StampedConstPtr& msg) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	unsigned int now = static_cast<unsigned int>(ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000);
+	int latency = static_cast<int>(now - static_cast<unsigned int>(static_cast<int>(msg->vector.x)));
+	boost::mutex::scoped_lock lock(latency_mtx);
+	if (recording)
+		latencies.push_back(latency);
+}
+
+double percentile(std::vector<double> v, double p) {
+	if (v.empty())
+		return 0;
+	std::sort(v.begin(), v.end());
+	size_t i = static_cast<size_t>(p * (v.size() - 1) + 0.5);
+	return v[i];
+}
+
+// the node and the stand-in on its pty
+class Bench {
+public:
+	Bench(const std::string& hlp_pty, const std::string& dir): hlp_pty_(hlp_pty), dir_(dir), child_(-1) {}
+	~Bench() {
+		stop();
+	}
+
+	// from the node's constructor to the return of initRosLayer()
+	bool start(bool reactor, const std::string& cache_dir, double* elapsed) {
+		std::string link = dir_ + "/hlp";
+		ros::param::set("transport", std::string("pty"));
+		ros::param::set("pty_link", link);
+		ros::param::set("baudrate", BENCH_BAUD);
+		ros::param::set("reactor", reactor);
+		ros::param::set("subscriber_driven_packets", false);
+		ros::param::set("diagnostics_period", 0.0);
+		ros::param::set("reconnect", false);
+		// the firmware counts these in 1 kHz ticks between packets: IMU at 100 Hz, status at 10 Hz, GPS at 5 Hz
+		ros::param::set("packet_rate_imu_mag", 10);
+		ros::param::set("packet_rate_rcdata_status_motors", 100);
+		ros::param::set("packet_rate_gps", 200);
+		ros::param::set("packet_rate_laser_mag", 20);
+		ros::param::set("aci_table_cache_dir", cache_dir);
+		ros::param::set("vehicle_id", std::string("bench"));
+
+		double t0 = monotonicSec();
+		// the node handle of hlp_node.cpp
+		ros::NodeHandle nh;
+		node_.reset(new AciRemote::AciRemote(nh));
+		if (node_->init() < 0)
+			return false;
+
+		std::string baud = boost::lexical_cast<std::string>(BENCH_BAUD);
+		char* argv[] = { const_cast<char*>(hlp_pty_.c_str()), const_cast<char*>(link.c_str()),
+				const_cast<char*>(baud.c_str()), NULL };
+		int err = posix_spawn(&child_, hlp_pty_.c_str(), NULL, NULL, argv, environ);
+		if (err != 0) {
+			std::cerr << "cannot run " << hlp_pty_ << ": " << strerror(err) << std::endl;
+			child_ = -1;
+			return false;
+		}
+
+		if (node_->initRosLayer() < 0)
+			return false;
+		if (elapsed)
+			*elapsed = monotonicSec() - t0;
+		return true;
+	}
+
+	void stop() {
+		if (child_ > 0) {
+			kill(child_, SIGTERM);
+			waitpid(child_, NULL, 0);
+			child_ = -1;
+		}
+		node_.reset();
+	}
+
+private:
+	std::string hlp_pty_;
+	std::string dir_;
+	pid_t child_;
+	boost::shared_ptr<AciRemote::AciRemote> node_;
+};
+
+int usage(const char* name) {
+	std::cerr << "usage: " << name << " <hlp_pty> latency|load threaded|reactor [seconds]" << std::endl
+			<< "       " << name << " <hlp_pty> restart [runs]" << std::endl;
+	return 2;
+}
+
+void sleepSec(double s) {
+	struct timespec ts = { static_cast<time_t>(s), static_cast<long>((s - static_cast<time_t>(s)) * 1e9) };
+	while (nanosleep(&ts, &ts) < 0 && errno == EINTR)
+		;
+}
+
+int latency(Bench& bench, bool reactor, double seconds, const std::string& dir) {
+	if (!bench.start(reactor, dir + "/cache", NULL))
+		return 1;
+	// settle after the configuration, then record
+	sleepSec(1.0);
+	{
+		boost::mutex::scoped_lock lock(latency_mtx);
+		latencies.clear();
+		recording = true;
+	}
+	sleepSec(seconds);
+	std::vector<double> v;
+	{
+		boost::mutex::scoped_lock lock(latency_mtx);
+		recording = false;
+		v.swap(latencies);
+	}
+	bench.stop();
+	printf("latency %s: %zu messages, median %.0f us, p99 %.0f us, max %.0f us\n",
+			reactor ? "reactor" : "threaded", v.size(), percentile(v, 0.5), percentile(v, 0.99), percentile(v, 1.0));
+	return v.empty() ? 1 : 0;
+}
+
+int restart(Bench& bench, int runs, const std::string& dir) {
+	std::vector<double> cold, warm;
+	for (int i = 0; i < runs; ++i) {
+		// a fresh directory has no cache, the run after it reads the one just written
+		std::string cache = dir + "/cache" + boost::lexical_cast<std::string>(i);
+		double t;
+		if (!bench.start(false, cache, &t))
+			return 1;
+		bench.stop();
+		cold.push_back(t);
+		if (!bench.start(false, cache, &t))
+			return 1;
+		bench.stop();
+		warm.push_back(t);
+	}
+	printf("restart cold: %d runs, median %.3f s, max %.3f s\n", runs, percentile(cold, 0.5), percentile(cold, 1.0));
+	printf("restart warm: %d runs, median %.3f s, max %.3f s\n", runs, percentile(warm, 0.5), percentile(warm, 1.0));
+	return 0;
+}
+
+double cpuSec(const struct rusage& ru) {
+	return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec * 1e-6 + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec * 1e-6;
+}
+
+int load(Bench& bench, bool reactor, double seconds, const std::string& dir) {
+	if (!bench.start(reactor, dir + "/cache", NULL))
+		return 1;
+	sleepSec(1.0);
+	struct rusage r0, r1;
+	getrusage(RUSAGE_SELF, &r0);
+	double t0 = monotonicSec();
+	sleepSec(seconds);
+	getrusage(RUSAGE_SELF, &r1);
+	double t = monotonicSec() - t0;
+	bench.stop();
+	printf("load %s: CPU %.2f%%, %.0f wakeups/s, %.0f preemptions/s\n", reactor ? "reactor" : "threaded",
+			100.0 * (cpuSec(r1) - cpuSec(r0)) / t, (r1.ru_nvcsw - r0.ru_nvcsw) / t, (r1.ru_nivcsw - r0.ru_nivcsw) / t);
+	return 0;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+	ros::init(argc, argv, "bench_node_pty");
+	if (argc < 3)
+		return usage(argv[0]);
+	std::string hlp_pty = argv[1];
+	std::string mode = argv[2];
+
+	char tmpl[] = "/tmp/bench_node_pty.XXXXXX";
+	if (mkdtemp(tmpl) == NULL) {
+		perror("mkdtemp");
+		return 1;
+	}
+	std::string dir = tmpl;
+
+	ros::NodeHandle nh;
+	ros::Subscriber mag_sub = nh.subscribe("mag", 100, magReceived);
+	ros::AsyncSpinner spinner(1);
+	spinner.start();
+
+	int ret;
+	{
+		Bench bench(hlp_pty, dir);
+		if (mode == "restart") {
+			ret = restart(bench, (argc > 3) ? atoi(argv[3]) : 5, dir);
+		}
+		else if ((mode == "latency" || mode == "load") && argc > 3) {
+			bool reactor = std::string(argv[3]) == "reactor";
+			double seconds = (argc > 4) ? atof(argv[4]) : 10.0;
+			ret = (mode == "latency") ? latency(bench, reactor, seconds, dir) : load(bench, reactor, seconds, dir);
+		}
+		else {
+			ret = usage(argv[0]);
+		}
+	}
+	spinner.stop();
+
+	std::string rm = "rm -rf " + dir;
+	if (std::system(rm.c_str()) != 0)
+		std::cerr << "could not remove " << dir << std::endl;
+	return ret;
+}
@@ -41,50 +41,50 @@ int aciListParCount = 0;
 // Variabeln
 unsigned short aciVarPacketSelect[MAX_VAR_PACKETS][MEMPACKET_MAX_VARS];
 unsigned char aciVarPacketSelectLength[MAX_VAR_PACKETS];
-unsigned char aciVarPacketMagicCode[MAX_VAR_PACKETS]={0,0,0};
+unsigned char aciVarPacketMagicCode[MAX_VAR_PACKETS];
 void * aciVarPacketPtrList[MAX_VAR_PACKETS][MEMPACKET_MAX_VARS];
 unsigned char aciVarPacketTypeList[MAX_VAR_PACKETS][MEMPACKET_MAX_VARS];
 
 unsigned short aciVarPacketContentBufferLength[MAX_VAR_PACKETS];
-unsigned char aciVarPacketContentBuffer[MAX_VAR_PACKETS][MAX_VARIABLE_LIST*8];
+unsigned char aciVarPacketContentBuffer[MAX_VAR_PACKETS][ACI_VAR_PACKET_MAX_SIZE];
 
-unsigned short aciVarPacketTransmissionRate[MAX_VAR_PACKETS]={10,10,10};
-unsigned short aciVarPacketCurrentSize[MAX_VAR_PACKETS]={0,0,0};
-unsigned short aciVarPacketNumberOfVars[MAX_VAR_PACKETS]={0,0,0};
-unsigned short aciVarPacketUpdated[MAX_VAR_PACKETS]={0,0,0};
+unsigned short aciVarPacketTransmissionRate[MAX_VAR_PACKETS];
+unsigned short aciVarPacketCurrentSize[MAX_VAR_PACKETS];
+unsigned short aciVarPacketNumberOfVars[MAX_VAR_PACKETS];
+unsigned short aciVarPacketUpdated[MAX_VAR_PACKETS];
 
 // Command
 unsigned short aciCmdPacketSelect[MAX_VAR_PACKETS][MEMPACKET_MAX_VARS];
 unsigned char aciCmdPacketSelectLength[MAX_VAR_PACKETS];
-unsigned char aciCmdPacketMagicCode[MAX_VAR_PACKETS]={0,0,0};
-unsigned char aciCmdPacketWithACK[MAX_VAR_PACKETS]={0,0,0};
+unsigned char aciCmdPacketMagicCode[MAX_VAR_PACKETS];
+unsigned char aciCmdPacketWithACK[MAX_VAR_PACKETS];
 
 unsigned short aciCmdPacketContentBufferLength[MAX_VAR_PACKETS];
 unsigned char aciCmdPacketContentBuffer[MAX_VAR_PACKETS][MAX_COMMAND_LIST*8];
 unsigned char aciCmdPacketContentBufferValid[MAX_VAR_PACKETS];
-unsigned char aciCmdPacketSendAck[MAX_VAR_PACKETS] = {0,0,0};
-unsigned char aciCmdPacketReceived[MAX_VAR_PACKETS] = {0,0,0};
+unsigned char aciCmdPacketSendAck[MAX_VAR_PACKETS];
+unsigned char aciCmdPacketReceived[MAX_VAR_PACKETS];
 unsigned char aciCmdPacketContentBufferInvalidCnt[MAX_VAR_PACKETS];
 
 // Parameter
 unsigned short aciParPacketSelect[MAX_VAR_PACKETS][MEMPACKET_MAX_VARS];
 unsigned char aciParPacketSelectLength[MAX_VAR_PACKETS];
-unsigned char aciParPacketMagicCode[MAX_VAR_PACKETS]={0,0,0};
+unsigned char aciParPacketMagicCode[MAX_VAR_PACKETS];
 
 unsigned short aciParPacketContentBufferLength[MAX_VAR_PACKETS];
 unsigned char aciParPacketContentBuffer[MAX_VAR_PACKETS][MAX_PARAMETER_LIST*8];
 unsigned char aciParPacketContentBufferValid[MAX_VAR_PACKETS];
-unsigned char aciParPacketSendAck[MAX_VAR_PACKETS] = {0,0,0};
-unsigned char aciParamPacketReceived[MAX_VAR_PACKETS] = {0,0,0};
+unsigned char aciParPacketSendAck[MAX_VAR_PACKETS];
+unsigned char aciParamPacketReceived[MAX_VAR_PACKETS];
 unsigned char aciParPacketContentBufferInvalidCnt[MAX_VAR_PACKETS];
-unsigned char aciParPacketRequest[MAX_VAR_PACKETS] = {0,0,0};
+unsigned char aciParPacketRequest[MAX_VAR_PACKETS];
 
 unsigned char aciParamSaveIt=0;
 unsigned char entry_exist = 1;
 
 //internal global vars
 unsigned int aciEngineRate=1000;
-unsigned int aciEngineRateCounter[MAX_VAR_PACKETS]= {0,0,0};
+unsigned int aciEngineRateCounter[MAX_VAR_PACKETS];
 
 
 //aciTxRingbuffer global vars
@@ -96,6 +96,15 @@ unsigned short aciHeartBeatCnt=0;
 unsigned short aciHeartBeatTimeout=2000; // in ms. Default: 2s timeout
 unsigned char aciInhibitPacketTransmission=0;
 
+//UART rate switching, see aciSetBaudRateCallbacks()
+unsigned char (*aciBaudRateSupportedCallback)(unsigned int baud) = NULL;
+void (*aciSetBaudRateCallback)(unsigned int baud) = NULL;
+unsigned int aciBaudRateDefault=0;
+unsigned int aciBaudRate=0;
+unsigned int aciBaudRateFallback=0;
+unsigned int aciBaudRatePending=0;
+unsigned short aciBaudRateConfirmCnt=0;
+
 //aciTxRingbuffer prototypes
 void aciTxRingBufferReset(void);
 unsigned short aciTxRingBufferGetFreeSpace(void);
@@ -114,6 +123,11 @@ void aciPublishVariableInt(void * ptr, unsigned char varType, unsigned short id,
 void aciPublishCommandInt(void * ptr, unsigned char varType, unsigned short id, char * name, char * description, char * unit);
 void aciPublishParameterInt(void * ptr, unsigned char varType, unsigned short id, char * name, char * description, char * unit);
 void aciSendSingleWithAck(short i);
+void aciQueueTableRequests(unsigned char messagetype, unsigned short length);
+void aciServeTableRequests(void);
+void aciSendBaudRate(unsigned int baud, unsigned char status);
+void aciHandleBaudRate(void);
+unsigned char aciSendTableEntry(unsigned char messagetype, unsigned short id);
 
 //aciRxHandler prototypes
 void aciRxHandleMessage(unsigned char messagetype, unsigned short length);
@@ -134,6 +148,12 @@ unsigned char aciSendSingleVarType[MAX_VARIABLE_LIST];
 unsigned char aciSendSingleBuffer[MAX_VARIABLE_LIST*8];
 unsigned short aciSendSingleBufferCnt[MAX_VARIABLE_LIST];
 
+// Table entry requests. Filled by the rx handler, served by aciEngine when the entry fits into the tx ringbuffer
+unsigned char aciTableRequestType[ACI_TABLE_REQUEST_QUEUE_SIZE];
+unsigned short aciTableRequestId[ACI_TABLE_REQUEST_QUEUE_SIZE];
+volatile unsigned char aciTableRequestWritePtr = 0;
+volatile unsigned char aciTableRequestReadPtr = 0;
+
 unsigned short aciMagicCodeVar = 0x00FF;
 unsigned short aciMagicCodeCmd = 0x00FF;
 unsigned short aciMagicCodePar = 0x00FF;
@@ -154,6 +174,7 @@ void aciInit(unsigned short callsPerSecond)
         aciParPacketContentBufferValid[i]=0;
         aciParPacketContentBufferInvalidCnt[i]=0;
     	aciVarPacketContentBufferLength[i] = 0;
+    	aciVarPacketTransmissionRate[i] = 10;
     }
 
 
@@ -334,6 +355,11 @@ void aciSendVar(void)
 						break;
 					packetSize += aciVarPacketTypeList[i][z] >> 2;
 				}
+				//a packet, which does not fit into the tx ringbuffer, could never be sent
+				if (packetSize > ACI_VAR_PACKET_MAX_SIZE) {
+					aciVarPacketNumberOfVars[i] = 0;
+					packetSize = 0;
+				}
 				aciVarPacketCurrentSize[i] = packetSize;
 				aciVarPacketContentBufferLength[i] = packetSize;
 			}
@@ -447,8 +473,19 @@ void aciEngine(void)
 		//stop transmitting packets
 		aciHeartBeatCnt=0;
 		aciInhibitPacketTransmission=1;
+		//the remote is gone, it looks for us on the default rate again
+		if ((aciBaudRate!=aciBaudRateDefault) && (!aciBaudRatePending) && (!aciBaudRateConfirmCnt))
+		{
+			aciSetBaudRateCallback(aciBaudRateDefault);
+			aciBaudRate=aciBaudRateDefault;
+		}
 	}
 
+	aciHandleBaudRate();
+
+	//requested table entries go first, the remote waits for them
+	aciServeTableRequests();
+
 	if (!aciInhibitPacketTransmission)
 	{
 		aciSendVar();
@@ -493,6 +530,108 @@ void aciEngine(void)
 unsigned char aciRxDataBuffer[ACI_RX_BUFFER_SIZE];
 unsigned short aciRxDataCnt;
 
+void aciQueueTableRequests(unsigned char messagetype, unsigned short length)
+{
+	int i;
+
+	for (i=0;i<length/2;i++)
+	{
+		unsigned char next=(aciTableRequestWritePtr+1)&(ACI_TABLE_REQUEST_QUEUE_SIZE-1);
+
+		//queue full, the remote will ask again for missing entries
+		if (next==aciTableRequestReadPtr)
+			break;
+		aciTableRequestType[aciTableRequestWritePtr]=messagetype;
+		aciTableRequestId[aciTableRequestWritePtr]=(aciRxDataBuffer[i*2+1]<<8)|aciRxDataBuffer[i*2];
+		aciTableRequestWritePtr=next;
+	}
+}
+
+void aciServeTableRequests(void)
+{
+	while (aciTableRequestReadPtr!=aciTableRequestWritePtr)
+	{
+		if (!aciSendTableEntry(aciTableRequestType[aciTableRequestReadPtr],aciTableRequestId[aciTableRequestReadPtr]))
+			break;
+		aciTableRequestReadPtr=(aciTableRequestReadPtr+1)&(ACI_TABLE_REQUEST_QUEUE_SIZE-1);
+	}
+}
+
+unsigned char aciSendTableEntry(unsigned char messagetype, unsigned short id)
+{
+	struct ACI_MEM_TABLE_ENTRY * list;
+	int count;
+	unsigned char entryType;
+	unsigned char invalidType;
+	int k;
+
+	switch (messagetype)
+	{
+	case ACIMT_REQUESTVARTABLEENTRIES:
+		list=aciListVar;
+		count=aciListVarCount;
+		entryType=ACIMT_SENDVARTABLEENTRY;
+		invalidType=ACIMT_SENDVARTABLEENTRYINVALID;
+		break;
+	case ACIMT_REQUESTCMDTABLEENTRIES:
+		list=aciListCmd;
+		count=aciListCmdCount;
+		entryType=ACIMT_SENDCMDTABLEENTRY;
+		invalidType=ACIMT_SENDCMDTABLEENTRYINVALID;
+		break;
+	case ACIMT_REQUESTPARAMTABLEENTRIES:
+		list=aciListPar;
+		count=aciListParCount;
+		entryType=ACIMT_SENDPARAMTABLEENTRY;
+		invalidType=ACIMT_SENDPARAMTABLEENTRYINVALID;
+		break;
+	default:
+		return 1;
+	}
+
+	//wait, until the whole entry fits into the tx ringbuffer
+	if (sizeof(struct ACI_MEM_TABLE_ENTRY_WITH_STRINGS)-sizeof(void*)+10>=aciTxRingBufferGetFreeSpace())
+		return 0;
+
+	for(k=0;k<count;k++)
+		if (id==list[k].id)
+			break;
+	if (k<count)
+	{
+		//before we send the data, the strings have to be copied from flash to memory
+		struct ACI_MEM_TABLE_ENTRY_WITH_STRINGS tableEntry;
+
+		if (strlen(list[k].name)>MAX_NAME_LENGTH)
+		{
+			memcpy(&(tableEntry.name[0]),list[k].name,MAX_NAME_LENGTH);
+			tableEntry.name[MAX_NAME_LENGTH-1]=0;
+		}else
+			strcpy(&(tableEntry.name[0]),list[k].name);
+
+		if (strlen(list[k].description)>MAX_DESC_LENGTH)
+		{
+			memcpy(&(tableEntry.description[0]),list[k].description,MAX_DESC_LENGTH);
+			tableEntry.description[MAX_DESC_LENGTH-1]=0;
+		}else
+			strcpy(&(tableEntry.description[0]),list[k].description);
+
+		if (strlen(list[k].unit)>MAX_UNIT_LENGTH)
+		{
+			memcpy(&(tableEntry.unit[0]),list[k].unit,MAX_UNIT_LENGTH);
+			tableEntry.unit[MAX_UNIT_LENGTH-1]=0;
+		}else
+			strcpy(&(tableEntry.unit[0]),list[k].unit);
+
+		tableEntry.id=list[k].id;
+		tableEntry.varType=list[k].varType;
+		tableEntry.ptrToVar=NULL;
+		aciTxSendPacket(entryType,&tableEntry,sizeof (struct ACI_MEM_TABLE_ENTRY_WITH_STRINGS)-sizeof(tableEntry.ptrToVar));
+
+	}else
+		aciTxSendPacket(invalidType,&id,2);
+	return 1;
+}
+
 void aciRxHandleMessage(unsigned char messagetype, unsigned short length)
 {
 	short i=0;
@@ -505,11 +644,11 @@ void aciRxHandleMessage(unsigned char messagetype, unsigned short length)
 	unsigned char c[2];
 	unsigned char switch_type;
 	short output;
-	if((messagetype>ACIMT_UPDATEVARPACKET) && (messagetype<ACIMT_UPDATEVARPACKET+0x0f)) switch_type = ACIMT_UPDATEVARPACKET;
-	else if((messagetype>ACIMT_UPDATECMDPACKET) && (messagetype<ACIMT_UPDATECMDPACKET+0x0f)) switch_type = ACIMT_UPDATECMDPACKET;
-	else if((messagetype>ACIMT_UPDATEPARAMPACKET) &&(messagetype<ACIMT_UPDATEPARAMPACKET+0x0f)) switch_type = ACIMT_UPDATEPARAMPACKET;
-	else if((messagetype>ACIMT_CMDPACKET) && (messagetype<ACIMT_CMDPACKET+0x0f)) switch_type = ACIMT_CMDPACKET;
-	else if((messagetype>ACIMT_PARAMPACKET) && (messagetype<ACIMT_PARAMPACKET+0x0f)) switch_type = ACIMT_PARAMPACKET;
+	if((messagetype>ACIMT_UPDATEVARPACKET) && (messagetype<=ACIMT_UPDATEVARPACKET+0x0f)) switch_type = ACIMT_UPDATEVARPACKET;
+	else if((messagetype>ACIMT_UPDATECMDPACKET) && (messagetype<=ACIMT_UPDATECMDPACKET+0x0f)) switch_type = ACIMT_UPDATECMDPACKET;
+	else if((messagetype>ACIMT_UPDATEPARAMPACKET) &&(messagetype<=ACIMT_UPDATEPARAMPACKET+0x0f)) switch_type = ACIMT_UPDATEPARAMPACKET;
+	else if((messagetype>ACIMT_CMDPACKET) && (messagetype<=ACIMT_CMDPACKET+0x0f)) switch_type = ACIMT_CMDPACKET;
+	else if((messagetype>ACIMT_PARAMPACKET) && (messagetype<=ACIMT_PARAMPACKET+0x0f)) switch_type = ACIMT_PARAMPACKET;
 	else switch_type=messagetype;
 
 	switch (switch_type)
@@ -522,63 +661,16 @@ void aciRxHandleMessage(unsigned char messagetype, unsigned short length)
 		aciInfo.maxUnitLength=MAX_UNIT_LENGTH;
 		aciInfo.maxVarPackets=MAX_VAR_PACKETS;
 		aciInfo.memPacketMaxVars=MEMPACKET_MAX_VARS;
-		aciInfo.flags=0;
+		aciInfo.flags=ACI_INFO_FLAG_QUEUED_TABLE_REQUESTS;
+		if (aciSetBaudRateCallback)
+			aciInfo.flags|=ACI_INFO_FLAG_BAUDRATE_SWITCH;
 		for (i=0;i<8;i++)
 			aciInfo.dummy[i]=0;
 		aciTxSendPacket(ACIMT_INFO_REPLY,&aciInfo,sizeof(aciInfo));
 
 	break;
 	case ACIMT_REQUESTVARTABLEENTRIES:
-		for (i=0;i<length/2;i++)
-		{
-			unsigned short selectedId;
-			unsigned char idFound=0;
-
-			selectedId=(aciRxDataBuffer[i*2+1]<<8)|aciRxDataBuffer[i*2];
-			//determine no of entries in var table
-			for(k=0;k<aciListVarCount;k++) {
-				if (selectedId==aciListVar[k].id)
-				{
-					idFound=1;
-					break;
-				}
-			}
-			if ((idFound))
-				{
-					//before we send the data, the strings have to be copied from flash to memory
-					struct ACI_MEM_TABLE_ENTRY_WITH_STRINGS tableEntry;
-
-					if (strlen(aciListVar[k].name)>MAX_NAME_LENGTH)
-					{
-						memcpy(&(tableEntry.name[0]),aciListVar[k].name,MAX_NAME_LENGTH);
-						tableEntry.name[MAX_NAME_LENGTH-1]=0;
-					}else
-						strcpy(&(tableEntry.name[0]),aciListVar[k].name);
-
-					if (strlen(aciListVar[k].description)>MAX_DESC_LENGTH)
-					{
-						memcpy(&(tableEntry.description[0]),aciListVar[k].description,MAX_NAME_LENGTH);
-						tableEntry.description[MAX_DESC_LENGTH-1]=0;
-					}else
-						strcpy(&(tableEntry.description[0]),aciListVar[k].description);
-
-					if (strlen(aciListVar[k].unit)>MAX_UNIT_LENGTH)
-					{
-						memcpy(&(tableEntry.unit[0]),aciListVar[k].unit,MAX_UNIT_LENGTH);
-						tableEntry.unit[MAX_UNIT_LENGTH-1]=0;
-					}else
-						strcpy(&(tableEntry.unit[0]),aciListVar[k].unit);
-
-					tableEntry.id=aciListVar[k].id;
-					tableEntry.varType=aciListVar[k].varType;
-					tableEntry.ptrToVar=NULL;
-					aciTxSendPacket(ACIMT_SENDVARTABLEENTRY,&tableEntry,sizeof (struct ACI_MEM_TABLE_ENTRY_WITH_STRINGS)-sizeof(tableEntry.ptrToVar));
-
-				}else
-					aciTxSendPacket(ACIMT_SENDVARTABLEENTRYINVALID,&selectedId,2);
-
-		}
-
+		aciQueueTableRequests(messagetype,length);
 	break;
 	case ACIMT_GETVARTABLEINFO:
 	{
@@ -625,56 +717,7 @@ void aciRxHandleMessage(unsigned char messagetype, unsigned short length)
 		break;
 
 	case ACIMT_REQUESTCMDTABLEENTRIES:
-		for (i=0;i<length/2;i++)
-		{
-			unsigned short selectedId;
-			unsigned char  idFound=0;
-
-			selectedId=(aciRxDataBuffer[i*2+1]<<8)|aciRxDataBuffer[i*2];
-			//determine no of entries in var table
-			for(k=0;k<aciListCmdCount;k++) {
-					if (selectedId==aciListCmd[k].id)
-					{
-						idFound=1;
-						break;
-					}
-			}
-			if ((idFound))
-				{
-					//before we send the data, the strings have to be copied from flash to memory
-					struct ACI_MEM_TABLE_ENTRY_WITH_STRINGS tableEntry;
-
-					if (strlen(aciListCmd[k].name)>MAX_NAME_LENGTH)
-					{
-						memcpy(&(tableEntry.name[0]),aciListCmd[k].name,MAX_NAME_LENGTH);
-						tableEntry.name[MAX_NAME_LENGTH-1]=0;
-					} else
-						strcpy(&(tableEntry.name[0]),aciListCmd[k].name);
-
-					if (strlen(aciListCmd[k].description)>MAX_DESC_LENGTH)
-					{
-						memcpy(&(tableEntry.description[0]),aciListCmd[k].description,MAX_NAME_LENGTH);
-						tableEntry.description[MAX_DESC_LENGTH-1]=0;
-					}else
-						strcpy(&(tableEntry.description[0]),aciListCmd[k].description);
-
-					if (strlen(aciListCmd[k].unit)>MAX_UNIT_LENGTH)
-					{
-						memcpy(&(tableEntry.unit[0]),aciListCmd[k].unit,MAX_UNIT_LENGTH);
-						tableEntry.unit[MAX_UNIT_LENGTH-1]=0;
-					}else
-						strcpy(&(tableEntry.unit[0]),aciListCmd[k].unit);
-
-					tableEntry.id=aciListCmd[k].id;
-					tableEntry.varType=aciListCmd[k].varType;
-					tableEntry.ptrToVar=NULL;
-					aciTxSendPacket(ACIMT_SENDCMDTABLEENTRY,&tableEntry,sizeof (struct ACI_MEM_TABLE_ENTRY_WITH_STRINGS)-sizeof(tableEntry.ptrToVar));
-
-				}else
-					aciTxSendPacket(ACIMT_SENDCMDTABLEENTRYINVALID,&selectedId,2);
-
-		}
-
+		aciQueueTableRequests(messagetype,length);
 	break;
 	case ACIMT_GETCMDTABLEINFO:
 	{
@@ -790,57 +833,7 @@ void aciRxHandleMessage(unsigned char messagetype, unsigned short length)
 
     // Parameter
     case ACIMT_REQUESTPARAMTABLEENTRIES:
-    		for (i=0;i<length/2;i++)
-    		{
-    			unsigned short selectedId;
-    			unsigned char  idFound=0;
-    			k=0;
-
-    			selectedId=(aciRxDataBuffer[i*2+1]<<8)|aciRxDataBuffer[i*2];
-    			//determine no of entries in param table
-    			for(k=0;k<aciListParCount;k++) {
-    							if (selectedId==aciListPar[k].id)
-    							{
-    								idFound=1;
-    								break;
-    							}
-    						}
-    			if ((idFound))
-    				{
-    					//before we send the data, the strings have to be copied from flash to memory
-    					struct ACI_MEM_TABLE_ENTRY_WITH_STRINGS tableEntry;
-
-    					if (strlen(aciListPar[k].name)>MAX_NAME_LENGTH)
-    					{
-    						memcpy(&(tableEntry.name[0]),aciListPar[k].name,MAX_NAME_LENGTH);
-    						tableEntry.name[MAX_NAME_LENGTH-1]=0;
-    					} else
-    						strcpy(&(tableEntry.name[0]),aciListPar[k].name);
-
-    					if (strlen(aciListPar[k].description)>MAX_DESC_LENGTH)
-    					{
-    						memcpy(&(tableEntry.description[0]),aciListPar[k].description,MAX_NAME_LENGTH);
-    						tableEntry.description[MAX_DESC_LENGTH-1]=0;
-    					} else
-    						strcpy(&(tableEntry.description[0]),aciListPar[k].description);
-
-    					if (strlen(aciListPar[k].unit)>MAX_UNIT_LENGTH)
-    					{
-    						memcpy(&(tableEntry.unit[0]),aciListPar[k].unit,MAX_UNIT_LENGTH);
-    						tableEntry.unit[MAX_UNIT_LENGTH-1]=0;
-    					}else
-    						strcpy(&(tableEntry.unit[0]),aciListPar[k].unit);
-
-    					tableEntry.id=aciListPar[k].id;
-    					tableEntry.varType=aciListPar[k].varType;
-    					tableEntry.ptrToVar=NULL;
-    					aciTxSendPacket(ACIMT_SENDPARAMTABLEENTRY,&tableEntry,sizeof (struct ACI_MEM_TABLE_ENTRY_WITH_STRINGS)-sizeof(tableEntry.ptrToVar));
-
-    				}else
-    					aciTxSendPacket(ACIMT_SENDPARAMTABLEENTRYINVALID,&selectedId,2);
-
-    		}
-
+    		aciQueueTableRequests(messagetype,length);
     	break;
     	case ACIMT_GETPARAMTABLEINFO:
     	{
@@ -912,9 +905,10 @@ void aciRxHandleMessage(unsigned char messagetype, unsigned short length)
 	case ACIMT_CHANGEPACKETRATE:
 		aciInhibitPacketTransmission=0;
 
-		if (length==sizeof(aciVarPacketTransmissionRate))
+		//the remote sends one rate for each packet it uses
+		if ((length<=sizeof(aciVarPacketTransmissionRate)) && !(length&1))
 		{
-			for(i=0;i<(sizeof(aciVarPacketTransmissionRate)/2);i++) {
+			for(i=0;i<length/2;i++) {
 				aciVarPacketTransmissionRate[i]=(aciRxDataBuffer[i*2+1]<<8) | (aciRxDataBuffer[i*2]);
 			}
 		}
@@ -962,6 +956,34 @@ void aciRxHandleMessage(unsigned char messagetype, unsigned short length)
 		aciHeartBeatCnt=0;
 
 	break;
+	case ACIMT_SETBAUDRATE:
+		if (length==sizeof(struct ACI_BAUDRATE))
+		{
+			struct ACI_BAUDRATE request;
+			memcpy(&request,&aciRxDataBuffer[0],sizeof(request));
+			if ((!aciSetBaudRateCallback) || (!aciBaudRateSupportedCallback(request.baudrate)))
+				aciSendBaudRate(request.baudrate,ACI_BAUDRATE_UNSUPPORTED);
+			else
+			{
+				//switch as soon as this reply has left
+				aciSendBaudRate(request.baudrate,ACI_BAUDRATE_SWITCHING);
+				aciBaudRatePending=request.baudrate;
+			}
+		}
+		break;
+	case ACIMT_CONFIRMBAUDRATE:
+		if (length==sizeof(struct ACI_BAUDRATE))
+		{
+			struct ACI_BAUDRATE request;
+			memcpy(&request,&aciRxDataBuffer[0],sizeof(request));
+			//arrived on the new rate, keep it. Repeated confirmations are answered as well
+			if ((request.baudrate==aciBaudRate) && (!aciBaudRatePending))
+			{
+				aciBaudRateConfirmCnt=0;
+				aciSendBaudRate(request.baudrate,ACI_BAUDRATE_CONFIRMED);
+			}
+		}
+		break;
 	case ACIMT_SAVEPARAM:
 		if (aciSaveParaCallback) {
 			aciSaveParaCallback();
@@ -1215,23 +1237,54 @@ unsigned char aciTxRingBufferGetNextByte(void)
  *
  */
 
-unsigned short aciCrcUpdate (unsigned short crc, unsigned char data)
-     {
-         data ^= (crc & 0xff);
-         data ^= data << 4;
+/// CRC-16/CCITT (reflected, poly 0x8408) of every single byte value, kept in flash
+const unsigned short aciCrcTable[256] = {
+	0x0000, 0x1189, 0x2312, 0x329b, 0x4624, 0x57ad, 0x6536, 0x74bf,
+	0x8c48, 0x9dc1, 0xaf5a, 0xbed3, 0xca6c, 0xdbe5, 0xe97e, 0xf8f7,
+	0x1081, 0x0108, 0x3393, 0x221a, 0x56a5, 0x472c, 0x75b7, 0x643e,
+	0x9cc9, 0x8d40, 0xbfdb, 0xae52, 0xdaed, 0xcb64, 0xf9ff, 0xe876,
+	0x2102, 0x308b, 0x0210, 0x1399, 0x6726, 0x76af, 0x4434, 0x55bd,
+	0xad4a, 0xbcc3, 0x8e58, 0x9fd1, 0xeb6e, 0xfae7, 0xc87c, 0xd9f5,
+	0x3183, 0x200a, 0x1291, 0x0318, 0x77a7, 0x662e, 0x54b5, 0x453c,
+	0xbdcb, 0xac42, 0x9ed9, 0x8f50, 0xfbef, 0xea66, 0xd8fd, 0xc974,
+	0x4204, 0x538d, 0x6116, 0x709f, 0x0420, 0x15a9, 0x2732, 0x36bb,
+	0xce4c, 0xdfc5, 0xed5e, 0xfcd7, 0x8868, 0x99e1, 0xab7a, 0xbaf3,
+	0x5285, 0x430c, 0x7197, 0x601e, 0x14a1, 0x0528, 0x37b3, 0x263a,
+	0xdecd, 0xcf44, 0xfddf, 0xec56, 0x98e9, 0x8960, 0xbbfb, 0xaa72,
+	0x6306, 0x728f, 0x4014, 0x519d, 0x2522, 0x34ab, 0x0630, 0x17b9,
+	0xef4e, 0xfec7, 0xcc5c, 0xddd5, 0xa96a, 0xb8e3, 0x8a78, 0x9bf1,
+	0x7387, 0x620e, 0x5095, 0x411c, 0x35a3, 0x242a, 0x16b1, 0x0738,
+	0xffcf, 0xee46, 0xdcdd, 0xcd54, 0xb9eb, 0xa862, 0x9af9, 0x8b70,
+	0x8408, 0x9581, 0xa71a, 0xb693, 0xc22c, 0xd3a5, 0xe13e, 0xf0b7,
+	0x0840, 0x19c9, 0x2b52, 0x3adb, 0x4e64, 0x5fed, 0x6d76, 0x7cff,
+	0x9489, 0x8500, 0xb79b, 0xa612, 0xd2ad, 0xc324, 0xf1bf, 0xe036,
+	0x18c1, 0x0948, 0x3bd3, 0x2a5a, 0x5ee5, 0x4f6c, 0x7df7, 0x6c7e,
+	0xa50a, 0xb483, 0x8618, 0x9791, 0xe32e, 0xf2a7, 0xc03c, 0xd1b5,
+	0x2942, 0x38cb, 0x0a50, 0x1bd9, 0x6f66, 0x7eef, 0x4c74, 0x5dfd,
+	0xb58b, 0xa402, 0x9699, 0x8710, 0xf3af, 0xe226, 0xd0bd, 0xc134,
+	0x39c3, 0x284a, 0x1ad1, 0x0b58, 0x7fe7, 0x6e6e, 0x5cf5, 0x4d7c,
+	0xc60c, 0xd785, 0xe51e, 0xf497, 0x8028, 0x91a1, 0xa33a, 0xb2b3,
+	0x4a44, 0x5bcd, 0x6956, 0x78df, 0x0c60, 0x1de9, 0x2f72, 0x3efb,
+	0xd68d, 0xc704, 0xf59f, 0xe416, 0x90a9, 0x8120, 0xb3bb, 0xa232,
+	0x5ac5, 0x4b4c, 0x79d7, 0x685e, 0x1ce1, 0x0d68, 0x3ff3, 0x2e7a,
+	0xe70e, 0xf687, 0xc41c, 0xd595, 0xa12a, 0xb0a3, 0x8238, 0x93b1,
+	0x6b46, 0x7acf, 0x4854, 0x59dd, 0x2d62, 0x3ceb, 0x0e70, 0x1ff9,
+	0xf78f, 0xe606, 0xd49d, 0xc514, 0xb1ab, 0xa022, 0x92b9, 0x8330,
+	0x7bc7, 0x6a4e, 0x58d5, 0x495c, 0x3de3, 0x2c6a, 0x1ef1, 0x0f78
+};
 
-         return ((((unsigned short )data << 8) | ((crc>>8)&0xff)) ^ (unsigned char )(data >> 4)
-                 ^ ((unsigned short )data << 3));
-     }
+unsigned short aciCrcUpdate (unsigned short crc, unsigned char data)
+{
+	return (crc>>8)^aciCrcTable[(crc^data)&0xff];
+}
 
 unsigned short aciUpdateCrc16(unsigned short crc, void * data, unsigned short cnt)
 {
-	int i=0;
 	unsigned short crcNew=crc;
 	unsigned char * chrData=(unsigned char *)data;
 
-	for (i=0;i<cnt;i++)
-		crcNew=aciCrcUpdate(crcNew,chrData[i]);
+	while (cnt--)
+		crcNew=(crcNew>>8)^aciCrcTable[(crcNew^*chrData++)&0xff];
 
 	return crcNew;
 }
@@ -1246,6 +1299,44 @@ void aciSetSaveParaCallback(void (*aciSaveParaCallback_func)(void))
 	aciSaveParaCallback=aciSaveParaCallback_func;
 }
 
+void aciSetBaudRateCallbacks(unsigned char (*aciBaudRateSupported_func)(unsigned int baud), void (*aciSetBaudRate_func)(unsigned int baud), unsigned int baud)
+{
+	aciBaudRateSupportedCallback=aciBaudRateSupported_func;
+	aciSetBaudRateCallback=aciSetBaudRate_func;
+	aciBaudRateDefault=baud;
+	aciBaudRate=baud;
+	aciBaudRatePending=0;
+	aciBaudRateConfirmCnt=0;
+}
+
+void aciSendBaudRate(unsigned int baud, unsigned char status)
+{
+	struct ACI_BAUDRATE reply;
+	reply.baudrate=baud;
+	reply.status=status;
+	aciTxSendPacket(ACIMT_BAUDRATE,&reply,sizeof(reply));
+}
+
+void aciHandleBaudRate(void)
+{
+	//switch once the reply to ACIMT_SETBAUDRATE has been sent on the old rate
+	if ((aciBaudRatePending) && (!aciTxRingBufferByteAvailable()))
+	{
+		aciSetBaudRateCallback(aciBaudRatePending);
+		if (!aciBaudRateConfirmCnt)
+			aciBaudRateFallback=aciBaudRate;
+		aciBaudRate=aciBaudRatePending;
+		aciBaudRatePending=0;
+		aciBaudRateConfirmCnt=ACI_BAUDRATE_CONFIRM_TIMEOUT(aciEngineRate);
+	}
+	//not confirmed in time, go back to the rate the remote is still listening on
+	else if ((aciBaudRateConfirmCnt) && (--aciBaudRateConfirmCnt==0))
+	{
+		aciSetBaudRateCallback(aciBaudRateFallback);
+		aciBaudRate=aciBaudRateFallback;
+	}
+}
+
 void aciSetWriteParatoFlashCallback(short (*aciWriteParatoFlashCallback_func)(void))
 {
 	aciWriteParatoFlashCallback=aciWriteParatoFlashCallback_func;
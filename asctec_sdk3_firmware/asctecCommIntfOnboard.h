@@ -87,6 +87,10 @@ extern void aciSetSaveParaCallback(void (*aciSaveParaCallback_func)(void));
  */
 extern void aciSetWriteParatoFlashCallback(short (*aciWriteParatoFlashCallback_func)(void));
 
+// lets the remote change the UART rate with ACIMT_SETBAUDRATE. baud is the rate the UART runs at now,
+// the device goes back to it whenever the heartbeat of the remote times out
+extern void aciSetBaudRateCallbacks(unsigned char (*aciBaudRateSupported_func)(unsigned int baud), void (*aciSetBaudRate_func)(unsigned int baud), unsigned int baud);
+
 /**
  * Return, if there are some bytes to transmit
  * @return true or false if there are bytes or not
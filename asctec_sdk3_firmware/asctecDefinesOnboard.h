@@ -71,6 +71,9 @@ DAMAGE.
 #define ACI_RX_BUFFER_SIZE		384
 #define ACI_TX_RINGBUFFER_SIZE 	160
 
+// requested table entries, which wait for space in the tx ringbuffer. Has to be a power of 2
+#define ACI_TABLE_REQUEST_QUEUE_SIZE	32
+
 // ID defines
 #define ID_NONE 0
 
@@ -207,6 +210,8 @@ DAMAGE.
 #define ACIMT_SETHEARTBEATTIMEOUT       	0x23
 #define ACIMT_GETHEARTBEATTIMEOUT       	0x24
 #define ACIMT_RESETREMOTE					0x25
+#define ACIMT_SETBAUDRATE					0x26
+#define ACIMT_CONFIRMBAUDRATE				0x27
 
 #define ACIMT_UPDATECMDPACKET           	0x30
 //0x30-0x3f are reserved for update cmd packet config!
@@ -245,6 +250,7 @@ DAMAGE.
 #define ACIMT_SINGLESEND					0xA3
 #define ACIMT_SINGLEREQ						0xA4
 #define ACIMT_MAGICCODES					0xA5
+#define ACIMT_BAUDRATE						0xA6
 
 
 //GENERAL
@@ -262,11 +268,34 @@ DAMAGE.
 
 #define ACI_DBG								0xFF
 
+// flags of struct ACI_INFO
+// requested table entries are queued and sent as soon as they fit, so the remote may request several at once
+#define ACI_INFO_FLAG_QUEUED_TABLE_REQUESTS	0x0001
+// the UART rate can be changed with ACIMT_SETBAUDRATE
+#define ACI_INFO_FLAG_BAUDRATE_SWITCH		0x0002
+
+// status of struct ACI_BAUDRATE
+// the rate is supported, the device switches to it right after this reply
+#define ACI_BAUDRATE_SWITCHING				0x01
+// the remote confirmed the new rate on the new rate, the device keeps it
+#define ACI_BAUDRATE_CONFIRMED				0x02
+#define ACI_BAUDRATE_UNSUPPORTED			0xF0
+
+// the device falls back to the previous rate, if the new one is not confirmed within 1s
+#define ACI_BAUDRATE_CONFIRM_TIMEOUT(engineRate) (1000*(engineRate)/1000)
+
 //internal structures
 
-//this defines the maximum number of different variables packets. Both (onboard and offboard) have to be compiled with
-//the setting. 3 is standard due to limited memory of the onboard code
-#define MAX_VAR_PACKETS 3
+//this defines the number of different variables, command and parameter packets. It is announced to the remote in ACI_INFO,
+//which uses as many packets as both sides have. Every packet costs about 1.7kB RAM, the message types allow up to 16
+#define MAX_VAR_PACKETS 4
+
+#if MAX_VAR_PACKETS > 16
+#error MAX_VAR_PACKETS must not exceed 16
+#endif
+
+//a variable packet has to fit into the tx ringbuffer together with header and crc
+#define ACI_VAR_PACKET_MAX_SIZE (ACI_TX_RINGBUFFER_SIZE-12)
 
 
 #define PACKEDDEF __attribute__((packed))
@@ -317,6 +346,13 @@ struct __attribute__((packed)) ACI_INFO
 	unsigned short dummy[8];
 };
 
+//payload of ACIMT_SETBAUDRATE, ACIMT_CONFIRMBAUDRATE and ACIMT_BAUDRATE
+struct __attribute__((packed)) ACI_BAUDRATE
+{
+	unsigned int baudrate;
+	unsigned char status;
+};
+
 struct __attribute__((packed)) ACI_MEM_VAR_TABLE
 {
 	struct ACI_MEM_TABLE_ENTRY tableEntry;
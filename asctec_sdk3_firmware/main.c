@@ -311,6 +311,7 @@ void ACISDK(void)
 	lpc_aci_init();
 
 	aciSetStartTxCallback(UARTWriteChar);
+	aciSetBaudRateCallbacks(UARTBaudRateSupported, UARTSetBaudRate, UART0_BAUDRATE);
 	// Variables
 	aciPublishVariable(&RO_ALL_Data.UAV_status, VARTYPE_INT16, 0x0001, "UAV_status", "UAV status information","See in wiki");
 	aciPublishVariable(&RO_ALL_Data.flight_time, VARTYPE_INT16, 0x0002, "flight_time", "Total flight time","s");
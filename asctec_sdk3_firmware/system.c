@@ -48,7 +48,7 @@ void init(void)
 #ifdef MATLAB
   UART_Matlab_Initialize(57600);
 #else
-  UARTInitialize(230400);	//debug / command
+  UARTInitialize(UART0_BAUDRATE);	//debug / command
 #endif
   UART1Initialize(57600);	//57600 Servo / GPS, 38400 "indoor GPS"
   init_spi();
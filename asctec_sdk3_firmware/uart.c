@@ -313,6 +313,28 @@ void UARTInitialize(unsigned int baud)
 
 }
 
+//the divisor of UARTInitialize must hit the rate within 2%
+unsigned char UARTBaudRateSupported(unsigned int baud)
+{
+  unsigned int divisor, actual;
+  if (baud == 0)
+    return 0;
+  divisor = peripheralClockFrequency() / (16 * baud);
+  if ((divisor == 0) || (divisor > 0xFFFF))
+    return 0;
+  actual = peripheralClockFrequency() / (16 * divisor);
+  if (actual > baud)
+    return (actual - baud) <= baud / 50;
+  return (baud - actual) <= baud / 50;
+}
+
+void UARTSetBaudRate(unsigned int baud)
+{
+  //let the last byte leave the shift register on the old rate
+  while ((U0LSR & 0x40) == 0);
+  UARTInitialize(baud);
+}
+
 void UART1Initialize(unsigned int baud)
 {
   unsigned int divisor = peripheralClockFrequency() / (16 * baud);
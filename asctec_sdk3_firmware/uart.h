@@ -30,6 +30,8 @@ DAMAGE.
 #define __UART_H
 
 extern void UARTInitialize(unsigned int);
+extern unsigned char UARTBaudRateSupported(unsigned int);
+extern void UARTSetBaudRate(unsigned int);
 extern void UART_Matlab_Initialize(unsigned int);
 extern void UART1Initialize(unsigned int baud);
 extern void UARTWriteChar(unsigned char);
@@ -59,6 +61,9 @@ extern unsigned char UART_CalibDoneFlag;
 extern unsigned char trigger_transmission;
 extern unsigned char transmission_running;
 
+//rate of UART0 at startup, the ACI may switch to a higher one on request of the remote
+#define UART0_BAUDRATE 230400
+
 #define RBREAD 0
 #define RBWRITE 1
 #define RBFREE  2